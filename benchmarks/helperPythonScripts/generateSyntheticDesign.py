@@ -0,0 +1,727 @@
+"""
+generateSyntheticDesign.py
+
+Generate a synthetic design together with a scaled UltraScale-like device in the same text formats as the
+Vivado-extracted benchmarks, so the placer can be stressed with designs (e.g. 1M-5M cells) larger than the
+VCU108 benchmarks. The outputs in <OutputDirectory>/<DesignName>/ are:
+
+    <DesignName>_allCellPinNet.zip        cells/pins/nets (the "vivado extracted design information file")
+    <DesignName>_clocks                   global clock driver pins
+    <DesignName>_fixedUnits               IO buffers and global clock buffers locked on the device
+    <DesignName>_unpredictableMacros      (no LUTRAM macro is generated, so only a header line)
+    <DesignName>_exportSiteLocation.zip   the scaled device (the "vivado extracted device information file")
+    <DesignName>.json                     a placement configuration referring to all the files above
+
+Netlist model:
+    The cells are laid out on a linear order which implicitly forms a binary hierarchy. Each input pin picks its
+    driver in the sibling sub-tree at a level sampled from a geometric distribution whose ratio 2^(p-1) gives a
+    netlist with Rent exponent p. Combinational drivers are only taken from lower positions and the logic depth is
+    bounded (CARRY8 chains are exempt from the bound), so the netlist is free of combinational loops. The drivers are weighted according to the fanout
+    distribution, and each driver is firstly reserved to a nearby sink so that few outputs are left dangling.
+
+The device keeps the 5 clock region columns of VCU108 (the spreader has VCU108-specific clock region handling) and
+scales the number of clock region rows and the CLB/BRAM/DSP columns in each clock region to the design size.
+
+usage example:
+    python3 generateSyntheticDesign.py -o ../synthetic -n syn1M --CellNum 1000000 --RentExponent 0.65
+"""
+
+import argparse
+import bisect
+import collections
+import json
+import math
+import os
+import random
+import zipfile
+from array import array
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("-o", "--OutputDirectory", help="The directory to store the generated files", required=True)
+parser.add_argument("-n", "--DesignName", help="The name of the generated design", default="synthetic")
+parser.add_argument("--CellNum", help="The total number of cells", type=int, default=100000)
+parser.add_argument("--LUTRatio", help="The ratio of LUTs in the cells", type=float, default=0.52)
+parser.add_argument("--FFRatio", help="The ratio of FFs in the cells", type=float, default=0.44)
+parser.add_argument("--CARRYRatio", help="The ratio of CARRY8s in the cells", type=float, default=0.025)
+parser.add_argument("--DSPRatio", help="The ratio of DSP48E2s in the cells", type=float, default=0.0025)
+parser.add_argument("--BRAMRatio", help="The ratio of RAMB18E2/RAMB36E2s in the cells", type=float, default=0.0025)
+parser.add_argument("--BRAM36Ratio", help="The ratio of RAMB36E2s in the BRAMs", type=float, default=0.5)
+parser.add_argument("--LUTFFPairRatio", help="The ratio of FFs directly driven by a dedicated LUT", type=float,
+                    default=0.6)
+parser.add_argument("--MaxCarryChainLength", help="The maximum number of CARRY8s in a chain", type=int, default=8)
+parser.add_argument("--RentExponent", help="The Rent exponent of the netlist (0 < p < 1)", type=float, default=0.65)
+parser.add_argument("--FanoutDistribution", help="The distribution of the driver weights", choices=[
+                    "uniform", "powerlaw"], default="powerlaw")
+parser.add_argument("--FanoutAlpha", help="The shape of the power-law fanout distribution (larger for fewer "
+                    "high-fanout nets)", type=float, default=2.2)
+parser.add_argument("--MaxLogicDepth", help="The maximum combinational depth between sequential elements",
+                    type=int, default=12)
+parser.add_argument("--ControlSetNum", help="The number of FF control sets (clock, CE, SR)", type=int, default=200)
+parser.add_argument("--ClockNum", help="The number of global clocks", type=int, default=4)
+parser.add_argument("--IONum", help="The number of data input/output buffers", type=int, default=128)
+parser.add_argument("--Utilization", help="The target utilization of the scaled device", type=float, default=0.5)
+parser.add_argument("--ClockRegionYNum", help="The number of clock region rows (auto by default)", type=int,
+                    default=0)
+parser.add_argument("--Seed", help="The seed of the random generator", type=int, default=0)
+parser.add_argument("--Jobs", help="The number of threads in the generated placement configuration", type=int,
+                    default=8)
+
+args = parser.parse_args()
+
+assert(0 < args.RentExponent < 1)
+assert(args.ClockNum > 0 and args.ControlSetNum >= args.ClockNum)
+random.seed(args.Seed)
+
+scriptDir = os.path.dirname(os.path.abspath(__file__))
+compatibleTableDir = os.path.abspath(os.path.join(scriptDir, "../VCU108/compatibleTable"))
+PCIEPinOffsetFile = os.path.abspath(os.path.join(scriptDir, "../VCU108/device/PCIEPin2SwXY"))
+outputDir = os.path.abspath(os.path.join(args.OutputDirectory, args.DesignName))
+os.makedirs(outputDir, exist_ok=True)
+
+clockRegionXNum = 5
+clockRegionRowNum = 60  # CLB rows in a clock region, as VCU108
+tileRowNumOfBRAMDSP = 5
+IOBNumPerClockRegion = 52
+BUFGCENumPerClockRegion = 24
+
+# cell kinds
+KIND_LUT, KIND_FF, KIND_CARRY, KIND_DSP, KIND_RAMB18, KIND_RAMB36, KIND_IBUF, KIND_OBUF, KIND_BUFGCE = range(9)
+LUTTypeRatios = [("LUT1", 0.04), ("LUT2", 0.16), ("LUT3", 0.16), ("LUT4", 0.14), ("LUT5", 0.15), ("LUT6", 0.35)]
+
+DSPInputs = ["A[%d]" % i for i in range(16)] + ["B[%d]" % i for i in range(16)]
+DSPOutputs = ["P[%d]" % i for i in range(16)]
+RAMB18Inputs = ["ADDRARDADDR[%d]" % i for i in range(4, 14)] + ["DINADIN[%d]" % i for i in range(16)] + ["WEA[0]"]
+RAMB18Outputs = ["DOUTADOUT[%d]" % i for i in range(16)]
+RAMB36Inputs = ["ADDRARDADDR[%d]" % i for i in range(5, 15)] + ["DINADIN[%d]" % i for i in range(32)] + ["WEA[0]"]
+RAMB36Outputs = ["DOUTADOUT[%d]" % i for i in range(32)]
+CARRYInputs = ["S[%d]" % i for i in range(8)] + ["DI[%d]" % i for i in range(8)]
+CARRYOutputs = ["O[%d]" % i for i in range(8)] + ["CO[7]"]
+
+
+#
+# 1. cell composition
+#
+
+logicCellNum = args.CellNum - args.IONum - 2 * args.ClockNum
+ratioSum = args.LUTRatio + args.FFRatio + args.CARRYRatio + args.DSPRatio + args.BRAMRatio
+LUTNum = int(logicCellNum * args.LUTRatio / ratioSum)
+CARRYNum = int(logicCellNum * args.CARRYRatio / ratioSum)
+DSPNum = int(logicCellNum * args.DSPRatio / ratioSum)
+BRAMNum = int(logicCellNum * args.BRAMRatio / ratioSum)
+RAMB36Num = int(BRAMNum * args.BRAM36Ratio)
+RAMB18Num = BRAMNum - RAMB36Num
+FFNum = logicCellNum - LUTNum - CARRYNum - DSPNum - BRAMNum
+pairNum = int(min(LUTNum, FFNum) * args.LUTFFPairRatio)
+inputIONum = args.IONum // 2
+outputIONum = args.IONum - inputIONum
+
+# items are placed on the linear order as a whole: LUT-FF pairs and CARRY chains stay adjacent
+items = [("P", 0)] * pairNum + [("L", 0)] * (LUTNum - pairNum) + [("F", 0)] * (FFNum - pairNum)
+items += [("D", 0)] * DSPNum + [("B18", 0)] * RAMB18Num + [("B36", 0)] * RAMB36Num
+items += [("I", 0)] * inputIONum + [("O", 0)] * outputIONum
+remainingCARRYNum = CARRYNum
+while remainingCARRYNum > 0:
+    chainLength = min(remainingCARRYNum, random.randint(1, args.MaxCarryChainLength))
+    items.append(("C", chainLength))
+    remainingCARRYNum -= chainLength
+random.shuffle(items)
+
+LUTTypeCumWeights = []
+for LUTType, ratio in LUTTypeRatios:
+    LUTTypeCumWeights.append((LUTTypeCumWeights[-1] if LUTTypeCumWeights else 0) + ratio)
+
+cellKind = array('b')
+cellLUTSize = array('b')  # LUT input number, or the offset in the CARRY chain
+for item, chainLength in items:
+    if item == "P" or item == "L":
+        cellKind.append(KIND_LUT)
+        LUTTypeId = bisect.bisect_left(LUTTypeCumWeights, random.random() * LUTTypeCumWeights[-1])
+        cellLUTSize.append(int(LUTTypeRatios[min(LUTTypeId, len(LUTTypeRatios) - 1)][0][3]))
+        if item == "P":
+            cellKind.append(KIND_FF)
+            cellLUTSize.append(-1)  # D pin is driven by the previous LUT
+    elif item == "F":
+        cellKind.append(KIND_FF)
+        cellLUTSize.append(0)
+    elif item == "C":
+        for offset in range(chainLength):
+            cellKind.append(KIND_CARRY)
+            cellLUTSize.append(offset)
+    else:
+        cellKind.append({"D": KIND_DSP, "B18": KIND_RAMB18, "B36": KIND_RAMB36,
+                         "I": KIND_IBUF, "O": KIND_OBUF}[item])
+        cellLUTSize.append(0)
+del items
+orderedCellNum = len(cellKind)
+
+# clock input buffers and global clock buffers are out of the linear order
+for clockId in range(args.ClockNum):
+    cellKind.append(KIND_IBUF)
+    cellLUTSize.append(0)
+for clockId in range(args.ClockNum):
+    cellKind.append(KIND_BUFGCE)
+    cellLUTSize.append(0)
+cellNum = len(cellKind)
+clockIBUFBase = orderedCellNum
+clockBUFGCEBase = orderedCellNum + args.ClockNum
+
+cellNamePrefix = {KIND_LUT: "lut", KIND_FF: "ff", KIND_CARRY: "carry", KIND_DSP: "dsp", KIND_RAMB18: "bram",
+                  KIND_RAMB36: "bram", KIND_IBUF: "ibuf", KIND_OBUF: "obuf", KIND_BUFGCE: "bufg"}
+
+
+def getCellName(cellId):
+    return "syn/%s_%d" % (cellNamePrefix[cellKind[cellId]], cellId)
+
+
+def getGeneralInputs(cellId):
+    kind = cellKind[cellId]
+    if kind == KIND_LUT:
+        return ["I%d" % i for i in range(cellLUTSize[cellId])]
+    if kind == KIND_FF:
+        return ["D"] if cellLUTSize[cellId] == 0 else []  # connected with the FF control set
+    if kind == KIND_CARRY:
+        return CARRYInputs
+    if kind == KIND_DSP:
+        return DSPInputs
+    if kind == KIND_RAMB18:
+        return RAMB18Inputs
+    if kind == KIND_RAMB36:
+        return RAMB36Inputs
+    if kind == KIND_OBUF:
+        return ["I"]
+    return []
+
+
+def getOutputs(cellId):
+    kind = cellKind[cellId]
+    if kind == KIND_LUT or kind == KIND_IBUF or kind == KIND_BUFGCE:
+        return ["O"]
+    if kind == KIND_FF:
+        return ["Q"]
+    if kind == KIND_CARRY:
+        return CARRYOutputs
+    if kind == KIND_DSP:
+        return DSPOutputs
+    if kind == KIND_RAMB18:
+        return RAMB18Outputs
+    if kind == KIND_RAMB36:
+        return RAMB36Outputs
+    return []
+
+
+def isSequentialSink(cellId):
+    return cellKind[cellId] not in (KIND_LUT, KIND_CARRY)
+
+
+#
+# 2. drivers and their fanout weights
+#
+
+# driver id -> (cell, output pin index); the drivers in the linear order are sorted by cell id
+driverCell = array('i')
+driverPinId = array('b')
+driverIsComb = array('b')
+firstDriverOfCell = array('i', [-1] * cellNum)
+pairedLUTs = set()
+for cellId in range(cellNum):
+    if cellKind[cellId] == KIND_FF and cellLUTSize[cellId] == -1:
+        pairedLUTs.add(cellId - 1)
+for cellId in range(cellNum):
+    firstDriverOfCell[cellId] = len(driverCell)
+    for pinId in range(len(getOutputs(cellId))):
+        driverCell.append(cellId)
+        driverPinId.append(pinId)
+        driverIsComb.append(1 if cellKind[cellId] in (KIND_LUT, KIND_CARRY) else 0)
+driverNum = len(driverCell)
+
+
+def isGeneralDriver(driverId):
+    # drivers which can be picked by arbitrary input pins
+    cellId = driverCell[driverId]
+    if cellId >= orderedCellNum or cellId in pairedLUTs:
+        return False
+    if cellKind[cellId] == KIND_CARRY and driverPinId[driverId] == 8:
+        # CO[7] is reserved for the cascade unless it is the end of the chain
+        return cellId + 1 >= orderedCellNum or cellKind[cellId + 1] != KIND_CARRY or cellLUTSize[cellId + 1] == 0
+    return True
+
+
+def getDriverWeight():
+    if args.FanoutDistribution == "uniform":
+        return 1.0
+    return min(random.paretovariate(args.FanoutAlpha), 2000.0)
+
+
+# pools of drivers with prefix sums of weights for weighted sampling in a range of the linear order
+allPoolCell = array('i')
+allPoolDriver = array('i')
+allPoolCumWeight = array('d')
+seqPoolCell = array('i')
+seqPoolDriver = array('i')
+seqPoolCumWeight = array('d')
+for driverId in range(driverNum):
+    if not isGeneralDriver(driverId):
+        continue
+    weight = getDriverWeight()
+    allPoolCell.append(driverCell[driverId])
+    allPoolDriver.append(driverId)
+    allPoolCumWeight.append((allPoolCumWeight[-1] if len(allPoolCumWeight) else 0.0) + weight)
+    if not driverIsComb[driverId]:
+        seqPoolCell.append(driverCell[driverId])
+        seqPoolDriver.append(driverId)
+        seqPoolCumWeight.append((seqPoolCumWeight[-1] if len(seqPoolCumWeight) else 0.0) + weight)
+
+
+def pickFromPool(poolCell, poolDriver, poolCumWeight, lo, hi):
+    begin = bisect.bisect_left(poolCell, lo)
+    end = bisect.bisect_left(poolCell, hi)
+    if begin >= end:
+        return -1
+    baseWeight = poolCumWeight[begin - 1] if begin > 0 else 0.0
+    target = baseWeight + random.random() * (poolCumWeight[end - 1] - baseWeight)
+    return poolDriver[min(bisect.bisect_right(poolCumWeight, target, begin, end), end - 1)]
+
+
+# level l (sibling sub-tree of size 2^(l-1)) is chosen with probability proportional to (2^(p-1))^(l-1)
+levelNum = max(1, math.ceil(math.log2(max(2, orderedCellNum))))
+levelRatio = 2 ** (args.RentExponent - 1)
+levelCumWeights = []
+for level in range(1, levelNum + 1):
+    levelCumWeights.append((levelCumWeights[-1] if levelCumWeights else 0) + levelRatio ** (level - 1))
+
+#
+# 3. control sets and clocks
+#
+
+DRIVER_UNCONNECTED = -1
+DRIVER_GND = -2
+DRIVER_VCC = -3
+
+unpairedLUTDrivers = [firstDriverOfCell[cellId] for cellId in range(orderedCellNum)
+                      if cellKind[cellId] == KIND_LUT and not cellId in pairedLUTs]
+assert(len(unpairedLUTDrivers) > 0)
+controlSets = []
+for controlSetId in range(args.ControlSetNum):
+    clockId = controlSetId * args.ClockNum // args.ControlSetNum
+    CEDriver = random.choice(unpairedLUTDrivers) if random.random() < 0.7 else DRIVER_VCC
+    if random.random() < 0.6:
+        SRDriver = random.choice(unpairedLUTDrivers)
+        FFType, SRPin = random.choices([("FDRE", "R"), ("FDCE", "CLR"), ("FDSE", "S"), ("FDPE", "PRE")],
+                                       weights=[0.6, 0.3, 0.05, 0.05])[0]
+    else:
+        SRDriver = DRIVER_GND
+        FFType, SRPin = ("FDRE", "R")
+    controlSets.append((clockId, CEDriver, SRDriver, FFType, SRPin))
+
+
+def getClockDriver(clockId):
+    return firstDriverOfCell[clockBUFGCEBase + clockId]
+
+
+carryChainControlSet = {}
+
+
+def getControlSetId(cellId, DDriver):
+    # the FFs driven by a CARRY chain are packed with it and hence should share the control set
+    if DDriver >= 0 and cellKind[driverCell[DDriver]] == KIND_CARRY:
+        chainHead = driverCell[DDriver] - cellLUTSize[driverCell[DDriver]]
+        if not chainHead in carryChainControlSet:
+            carryChainControlSet[chainHead] = min(args.ControlSetNum - 1,
+                                                  chainHead * args.ControlSetNum // orderedCellNum)
+        return carryChainControlSet[chainHead]
+    # FFs nearby in the linear order (i.e. in the same module) tend to share control sets
+    if random.random() < 0.9:
+        return min(args.ControlSetNum - 1, cellId * args.ControlSetNum // orderedCellNum)
+    return random.randrange(args.ControlSetNum)
+
+
+#
+# 4. connect the input pins
+#
+
+fanout = array('i', [0] * driverNum)
+logicDepth = array('H', [0] * cellNum)
+cellControlSet = array('i', [-1] * cellNum)
+pinDriverOffset = array('i', [0] * (cellNum + 1))
+pinDriver = array('i')
+combQueue = collections.deque()  # reserved drivers for nearby sinks
+cappedQueue = collections.deque()  # combinational drivers at the maximum depth, only for sequential sinks
+
+
+def pickRandomDriver(cellId, sequentialSink):
+    level = min(bisect.bisect_left(levelCumWeights, random.random() * levelCumWeights[-1]), levelNum - 1) + 1
+    while level <= levelNum:
+        half = 1 << (level - 1)
+        base = (cellId >> level) << level
+        if cellId & half:
+            lo, hi, siblingIsLeft = base, base + half, True
+        else:
+            lo, hi, siblingIsLeft = base + half, min(base + 2 * half, orderedCellNum), False
+        driverId = -1
+        if lo < hi:
+            if sequentialSink or siblingIsLeft:
+                driverId = pickFromPool(allPoolCell, allPoolDriver, allPoolCumWeight, lo, hi)
+                if driverId >= 0 and not sequentialSink and driverIsComb[driverId] and \
+                        logicDepth[driverCell[driverId]] >= args.MaxLogicDepth:
+                    driverId = pickFromPool(seqPoolCell, seqPoolDriver, seqPoolCumWeight, lo, hi)
+            else:
+                driverId = pickFromPool(seqPoolCell, seqPoolDriver, seqPoolCumWeight, lo, hi)
+        if driverId >= 0:
+            return driverId
+        level += 1
+    return pickFromPool(seqPoolCell, seqPoolDriver, seqPoolCumWeight, 0, orderedCellNum)
+
+
+def connect(driverId):
+    pinDriver.append(driverId)
+    if driverId >= 0:
+        fanout[driverId] += 1
+
+
+for cellId in range(cellNum):
+    pinDriverOffset[cellId] = len(pinDriver)
+    kind = cellKind[cellId]
+    sequentialSink = isSequentialSink(cellId)
+    generalInputs = getGeneralInputs(cellId)
+    depth = 0
+
+    # special pins first: CI of CARRY8, D of paired FFs, C/CE/SR of FFs, clocks of DSPs/BRAMs, clock buffers
+    if kind == KIND_CARRY:
+        if cellLUTSize[cellId] > 0:
+            connect(firstDriverOfCell[cellId - 1] + 8)
+            depth = logicDepth[cellId - 1]
+        else:
+            connect(DRIVER_GND)
+    elif kind == KIND_FF:
+        if cellLUTSize[cellId] == -1:
+            DDriver = firstDriverOfCell[cellId - 1]
+        elif cappedQueue:
+            DDriver = cappedQueue.popleft()
+        elif combQueue:
+            DDriver = combQueue.popleft()
+        else:
+            DDriver = pickRandomDriver(cellId, True)
+        connect(DDriver)
+        generalInputs = []
+        controlSetId = getControlSetId(cellId, DDriver)
+        cellControlSet[cellId] = controlSetId
+        clockId, CEDriver, SRDriver, FFType, SRPin = controlSets[controlSetId]
+        connect(getClockDriver(clockId))
+        connect(CEDriver)
+        connect(SRDriver)
+    elif kind == KIND_DSP or kind == KIND_RAMB18 or kind == KIND_RAMB36:
+        connect(getClockDriver(min(args.ClockNum - 1, cellId * args.ClockNum // orderedCellNum)))
+    elif kind == KIND_BUFGCE:
+        connect(firstDriverOfCell[clockIBUFBase + cellId - clockBUFGCEBase])
+    elif kind == KIND_IBUF:
+        connect(DRIVER_UNCONNECTED)  # top-level port
+
+    if cellId < orderedCellNum:
+        reservedNum = min(len(generalInputs), 1 + (len(combQueue) + len(cappedQueue)) // 32)
+        for pinId in range(len(generalInputs)):
+            driverId = -1
+            if pinId < reservedNum:
+                if sequentialSink and cappedQueue:
+                    driverId = cappedQueue.popleft()
+                elif combQueue:
+                    driverId = combQueue.popleft()
+            if driverId < 0:
+                driverId = pickRandomDriver(cellId, sequentialSink)
+            if driverId >= 0 and driverIsComb[driverId]:
+                depth = max(depth, logicDepth[driverCell[driverId]])
+            connect(driverId)
+
+        if not sequentialSink:
+            logicDepth[cellId] = depth + 1
+        for driverId in range(firstDriverOfCell[cellId], firstDriverOfCell[cellId] + len(getOutputs(cellId))):
+            if not isGeneralDriver(driverId):
+                continue
+            if driverIsComb[driverId] and logicDepth[cellId] >= args.MaxLogicDepth:
+                cappedQueue.append(driverId)
+            else:
+                combQueue.append(driverId)
+pinDriverOffset[cellNum] = len(pinDriver)
+
+#
+# 5. write the design
+#
+
+
+def getDriverPinName(driverId):
+    if driverId == DRIVER_GND:
+        return "syn/<const0>"
+    if driverId == DRIVER_VCC:
+        return "syn/<const1>"
+    cellId = driverCell[driverId]
+    return getCellName(cellId) + "/" + getOutputs(cellId)[driverPinId[driverId]]
+
+
+def getCellType(cellId):
+    kind = cellKind[cellId]
+    if kind == KIND_LUT:
+        return "LUT%d" % cellLUTSize[cellId]
+    if kind == KIND_FF:
+        return controlSets[cellControlSet[cellId]][3]
+    return {KIND_CARRY: "CARRY8", KIND_DSP: "DSP48E2", KIND_RAMB18: "RAMB18E2", KIND_RAMB36: "RAMB36E2",
+            KIND_IBUF: "IBUF", KIND_OBUF: "OBUF", KIND_BUFGCE: "BUFGCE"}[kind]
+
+
+def getInputPinNames(cellId):
+    kind = cellKind[cellId]
+    if kind == KIND_LUT or kind == KIND_OBUF:
+        return getGeneralInputs(cellId)
+    if kind == KIND_CARRY:
+        return ["CI"] + CARRYInputs
+    if kind == KIND_FF:
+        SRPin = controlSets[cellControlSet[cellId]][4]
+        return ["D", "C", "CE", SRPin]
+    if kind == KIND_DSP:
+        return ["CLK"] + DSPInputs
+    if kind == KIND_RAMB18 or kind == KIND_RAMB36:
+        return ["CLKARDCLK"] + getGeneralInputs(cellId)
+    return ["I"]
+
+
+def writeDesign(zipFileName, arcName):
+    with zipfile.ZipFile(zipFileName, "w", zipfile.ZIP_DEFLATED) as archive:
+        with archive.open(arcName, "w", force_zip64=True) as outputFile:
+            lines = []
+            for cellId in range(cellNum):
+                cellName = getCellName(cellId)
+                lines.append("curCell=> %s type=> %s" % (cellName, getCellType(cellId)))
+                inputPinNames = getInputPinNames(cellId)
+                assert(len(inputPinNames) == pinDriverOffset[cellId + 1] - pinDriverOffset[cellId])
+                for pinName, pinOffset in zip(inputPinNames, range(pinDriverOffset[cellId],
+                                                                   pinDriverOffset[cellId + 1])):
+                    driverId = pinDriver[pinOffset]
+                    if driverId == DRIVER_UNCONNECTED:
+                        lines.append("   pin=> %s/%s refpin=> %s dir=> IN net=> drivepin=> " %
+                                     (cellName, pinName, pinName))
+                    else:
+                        driverPinName = getDriverPinName(driverId)
+                        lines.append("   pin=> %s/%s refpin=> %s dir=> IN net=> %s drivepin=> %s" %
+                                     (cellName, pinName, pinName, driverPinName, driverPinName))
+                for pinId, pinName in enumerate(getOutputs(cellId)):
+                    if fanout[firstDriverOfCell[cellId] + pinId] > 0:
+                        lines.append("   pin=> %s/%s refpin=> %s dir=> OUT net=> %s/%s drivepin=> %s/%s" %
+                                     (cellName, pinName, pinName, cellName, pinName, cellName, pinName))
+                    else:
+                        lines.append("   pin=> %s/%s refpin=> %s dir=> OUT net=> drivepin=> " %
+                                     (cellName, pinName, pinName))
+                if len(lines) > 100000:
+                    outputFile.write(("\n".join(lines) + "\n").encode())
+                    lines = []
+            outputFile.write(("\n".join(lines) + "\n").encode())
+
+
+designFileName = os.path.join(outputDir, args.DesignName + "_allCellPinNet.zip")
+writeDesign(designFileName, args.DesignName + "_allCellPinNet")
+
+#
+# 6. scale the device
+#
+
+# a CARRY8 macro occupies all the LUT slots of its SLICE
+sliceDemand = max(LUTNum / 8.0 + CARRYNum, FFNum / 16.0) / args.Utilization
+RAMB18Demand = max(1, RAMB18Num + 2 * RAMB36Num) / args.Utilization
+DSPDemand = max(1, DSPNum) / args.Utilization
+clockRegionYNum = args.ClockRegionYNum
+if clockRegionYNum <= 0:
+    # VCU108 has 8 clock region rows for about 68K SLICEs
+    clockRegionYNum = max(2, int(round(8 * math.sqrt(sliceDemand / 68000.0))),
+                          math.ceil((args.IONum + args.ClockNum) / IOBNumPerClockRegion))
+clockRegionNum = clockRegionXNum * clockRegionYNum
+CLBColumnNum = max(2, math.ceil(sliceDemand / clockRegionNum / (2 * clockRegionRowNum)))
+BRAMColumnNum = max(1, math.ceil(RAMB18Demand / clockRegionNum / (2 * clockRegionRowNum / tileRowNumOfBRAMDSP)))
+DSPColumnNum = max(1, math.ceil(DSPDemand / clockRegionNum / (2 * clockRegionRowNum / tileRowNumOfBRAMDSP)))
+
+# the column pattern in a clock region: BRAM/DSP columns are evenly inserted between the CLB columns
+columnPattern = ["CLB"] * CLBColumnNum
+for columnType, columnNum in [("BRAM", BRAMColumnNum), ("DSP", DSPColumnNum)]:
+    for i in range(columnNum):
+        columnPattern.insert((2 * i + 1) * len(columnPattern) // (2 * columnNum) + 1, columnType)
+
+SLICEBELs = []
+for letter in "ABCDEFGH":
+    SLICEBELs += [letter + "5LUT", letter + "6LUT", letter + "FF", letter + "FF2"]
+SLICEBELs += ["CARRY8", "F7MUX_AB", "F7MUX_CD", "F7MUX_EF", "F7MUX_GH", "F8MUX_BOT", "F8MUX_TOP", "F9MUX"]
+
+# the device text is streamed into the archive since it is too large to be held in memory for 5M-cell designs
+deviceFileName = os.path.join(outputDir, args.DesignName + "_exportSiteLocation.zip")
+deviceArchive = zipfile.ZipFile(deviceFileName, "w", zipfile.ZIP_DEFLATED)
+deviceOutputFile = deviceArchive.open(args.DesignName + "_exportSiteLocation", "w", force_zip64=True)
+deviceLines = []
+deviceSiteNum = 0
+IOBSites = []
+BUFGCESites = []
+
+
+def addSite(siteName, tileName, clockRegion, siteType, tileType, centerX, centerY, BELs):
+    global deviceSiteNum, deviceLines
+    deviceLines.append("site=> %s tile=> %s clockRegionName=> X%dY%d sitetype=> %s tiletype=> %s centerx=> %s "
+                       "centery=> %s BELs=> [%s]" % (siteName, tileName, clockRegion[0], clockRegion[1], siteType,
+                                                     tileType, repr(centerX), repr(centerY),
+                                                     ",".join([siteName + "/" + BEL for BEL in BELs])))
+    deviceSiteNum += 1
+    if len(deviceLines) >= 10000:
+        deviceOutputFile.write(("\n".join(deviceLines) + "\n").encode())
+        deviceLines = []
+
+
+deviceRowNum = clockRegionYNum * clockRegionRowNum
+
+# every site type in the compatible table should exist on the device, so the sites other than CLB/BRAM/DSP are
+# collected from the table with their BELs
+siteType2BELs = collections.OrderedDict()
+with open(os.path.join(compatibleTableDir, "sharedCellType2BELtype"), "r") as tableFile:
+    for line in tableFile:
+        tokens = line.split()
+        if len(tokens) < 2:
+            continue
+        BELs = siteType2BELs.setdefault(tokens[1], [])
+        for BEL in (tokens[2].split(",") if len(tokens) > 2 else [tokens[1]]):
+            if not BEL in BELs:
+                BELs.append(BEL)
+
+# the IO column on the left edge hosts the IO buffers, global clock buffers and one site of each auxiliary type in
+# each clock region
+auxSiteTypes = [siteType for siteType in siteType2BELs.keys() if not siteType in
+                ["SLICEL", "SLICEM", "DSP48E2", "RAMBFIFO18", "RAMB181", "HPIOB", "HRIO", "BUFGCE"]]
+for row in range(deviceRowNum):
+    clockRegion = (0, row // clockRegionRowNum)
+    rowInClockRegion = row % clockRegionRowNum
+    if rowInClockRegion < IOBNumPerClockRegion:
+        siteName = "IOB_X0Y%d" % len(IOBSites)
+        addSite(siteName, "HPIO_L_X0Y%d" % row, clockRegion, "HPIOB", "HPIO_L", -0.25, row + 0.15,
+                siteType2BELs["HPIOB"])
+        IOBSites.append(siteName)
+    else:
+        addSite("IOB_X1Y%d" % row, "HRIO_L_X0Y%d" % row, clockRegion, "HRIO", "HRIO_L", -0.25, row + 0.15,
+                siteType2BELs["HRIO"])
+    if rowInClockRegion < BUFGCENumPerClockRegion:
+        siteName = "BUFGCE_X0Y%d" % len(BUFGCESites)
+        addSite(siteName, "CMT_L_X0Y%d" % row, clockRegion, "BUFGCE", "CMT_L", 0.25, row + 0.15,
+                siteType2BELs["BUFGCE"])
+        BUFGCESites.append(siteName)
+    if rowInClockRegion < len(auxSiteTypes):
+        siteType = auxSiteTypes[rowInClockRegion]
+        addSite("%s_X0Y%d" % (siteType, clockRegion[1]), "AUX_L_X0Y%d" % row, clockRegion, siteType, "AUX_L", 0.0,
+                row + 0.5, siteType2BELs[siteType])
+
+tileX = 1
+SLICEX = 0
+BRAMX = 0
+DSPX = 0
+for clockRegionX in range(clockRegionXNum):
+    for columnId, columnType in enumerate(columnPattern):
+        for row in range(deviceRowNum):
+            clockRegion = (clockRegionX, row // clockRegionRowNum)
+            if columnType == "CLB":
+                leftIsSLICEM = (columnId % 2 == 0)
+                addSite("SLICE_X%dY%d" % (SLICEX, row), ("CLE_M_X%dY%d" if leftIsSLICEM else "CLEL_L_X%dY%d") %
+                        (tileX, row), clockRegion, "SLICEM" if leftIsSLICEM else "SLICEL",
+                        "CLE_M" if leftIsSLICEM else "CLEL_L", tileX - 0.25, row + 0.15, SLICEBELs)
+                addSite("SLICE_X%dY%d" % (SLICEX + 1, row), "CLEL_R_X%dY%d" % (tileX, row), clockRegion, "SLICEL",
+                        "CLEL_R", tileX + 0.25, row + 0.15, SLICEBELs)
+            elif row % tileRowNumOfBRAMDSP == 0:
+                tileY = row // tileRowNumOfBRAMDSP
+                if columnType == "BRAM":
+                    tileName = "BRAM_X%dY%d" % (tileX, row)
+                    addSite("RAMB36_X%dY%d" % (BRAMX, tileY), tileName, clockRegion, "RAMBFIFO36", "BRAM",
+                            tileX - 0.25, row + 2.5, ["RAMB36E2"])
+                    addSite("RAMB18_X%dY%d" % (BRAMX, 2 * tileY), tileName, clockRegion, "RAMBFIFO18", "BRAM",
+                            tileX - 0.25, row + 1.25, ["RAMB18E2_L"])
+                    addSite("RAMB18_X%dY%d" % (BRAMX, 2 * tileY + 1), tileName, clockRegion, "RAMB181", "BRAM",
+                            tileX - 0.25, row + 3.75, ["RAMB18E2_U"])
+                else:
+                    tileName = "DSP_X%dY%d" % (tileX, row)
+                    addSite("DSP48E2_X%dY%d" % (DSPX, 2 * tileY), tileName, clockRegion, "DSP48E2", "DSP",
+                            tileX + 0.25, row + 1.25, ["DSP_ALU"])
+                    addSite("DSP48E2_X%dY%d" % (DSPX, 2 * tileY + 1), tileName, clockRegion, "DSP48E2", "DSP",
+                            tileX + 0.25, row + 3.75, ["DSP_ALU"])
+        if columnType == "CLB":
+            SLICEX += 2
+        elif columnType == "BRAM":
+            BRAMX += 1
+        else:
+            DSPX += 1
+        tileX += 1
+
+deviceOutputFile.write(("\n".join(deviceLines) + "\n").encode())
+deviceOutputFile.close()
+deviceArchive.close()
+
+#
+# 7. clocks, fixed units, unpredictable macros and the placement configuration
+#
+
+if len(IOBSites) < args.IONum + args.ClockNum or len(BUFGCESites) < args.ClockNum:
+    parser.error("the scaled device has only %d IOBs and %d BUFGCEs, please reduce --IONum/--ClockNum or increase "
+                 "--ClockRegionYNum" % (len(IOBSites), len(BUFGCESites)))
+with open(os.path.join(outputDir, args.DesignName + "_clocks"), "w") as clockFile:
+    for clockId in range(args.ClockNum):
+        print(getDriverPinName(getClockDriver(clockId)), file=clockFile)
+
+# the loaders skip the first line of the fixed unit / unpredictable macro files
+with open(os.path.join(outputDir, args.DesignName + "_fixedUnits"), "w") as fixedUnitFile:
+    print("# fixed units of the synthetic design " + args.DesignName, file=fixedUnitFile)
+    IOCells = [cellId for cellId in range(cellNum) if cellKind[cellId] in (KIND_IBUF, KIND_OBUF)]
+    for IOCellId, cellId in enumerate(IOCells):
+        siteName = IOBSites[IOCellId * len(IOBSites) // len(IOCells)]
+        BELName = "HPIOB.INBUF" if cellKind[cellId] == KIND_IBUF else "HPIOB.OUTBUF"
+        print("name=> %s loc=>  %s bel=>  %s" % (getCellName(cellId), siteName, BELName), file=fixedUnitFile)
+    for clockId in range(args.ClockNum):
+        siteName = BUFGCESites[clockId * len(BUFGCESites) // args.ClockNum]
+        print("name=> %s loc=>  %s bel=>  BUFGCE.BUFCE" % (getCellName(clockBUFGCEBase + clockId), siteName),
+              file=fixedUnitFile)
+
+with open(os.path.join(outputDir, args.DesignName + "_unpredictableMacros"), "w") as macroFile:
+    print("# unpredictable macros of the synthetic design " + args.DesignName, file=macroFile)
+
+config = collections.OrderedDict([
+    ("vivado extracted design information file", designFileName),
+    ("vivado extracted device information file", deviceFileName),
+    ("special pin offset info file", PCIEPinOffsetFile),
+    ("cellType2fixedAmo file", os.path.join(compatibleTableDir, "cellType2fixedAmo")),
+    ("cellType2sharedCellType file", os.path.join(compatibleTableDir, "cellType2sharedCellType")),
+    ("sharedCellType2BELtype file", os.path.join(compatibleTableDir, "sharedCellType2BELtype")),
+    ("mergedSharedCellType2sharedCellType", os.path.join(compatibleTableDir, "mergedSharedCellType2sharedCellType")),
+    ("unpredictable macro file", os.path.join(outputDir, args.DesignName + "_unpredictableMacros")),
+    ("fixed units file", os.path.join(outputDir, args.DesignName + "_fixedUnits")),
+    ("clock file", os.path.join(outputDir, args.DesignName + "_clocks")),
+    ("GlobalPlacerPrintHPWL", "true"),
+    ("ClockPeriod", "10"),
+    ("Simulated Annealing restartNum", "600"),
+    ("Simulated Annealing IterNum", "30000000"),
+    ("DrawNetAfterEachIteration", "false"),
+    ("PseudoNetWeight", "0.0025"),
+    ("GlobalPlacementIteration", "30"),
+    ("clockRegionXNum", str(clockRegionXNum)),
+    ("clockRegionYNum", str(clockRegionYNum)),
+    ("clockRegionDSPNum", str(DSPColumnNum * 2 * clockRegionRowNum // tileRowNumOfBRAMDSP)),
+    ("clockRegionBRAMNum", str(BRAMColumnNum * 2 * clockRegionRowNum // tileRowNumOfBRAMDSP)),
+    ("jobs", str(args.Jobs)),
+    ("y2xRatio", "0.4"),
+    ("ClusterPlacerVerbose", "false"),
+    ("GlobalPlacerVerbose", "false"),
+    ("drawClusters", "false"),
+    ("MKL", "true"),
+    ("dumpDirectory", "./dumpData_" + args.DesignName),
+])
+with open(os.path.join(outputDir, args.DesignName + ".json"), "w") as configFile:
+    json.dump(config, configFile, indent=4)
+
+depthHistogram = collections.Counter(logicDepth[cellId] for cellId in range(orderedCellNum)
+                                     if not isSequentialSink(cellId))
+clockDrivers = set(getClockDriver(clockId) for clockId in range(args.ClockNum))
+danglingOutputNum = sum(1 for driverId in range(driverNum) if fanout[driverId] == 0)
+maxDataFanout = max(fanout[driverId] for driverId in range(driverNum) if not driverId in clockDrivers)
+print("design: %d cells (LUT %d, FF %d, CARRY8 %d, DSP48E2 %d, RAMB18E2 %d, RAMB36E2 %d, IO %d, clock %d), "
+      "%d pins, %d control sets" % (cellNum, LUTNum, FFNum, CARRYNum, DSPNum, RAMB18Num, RAMB36Num, args.IONum,
+                                    2 * args.ClockNum, len(pinDriver) + driverNum, args.ControlSetNum))
+print("nets: %d, dangling outputs: %d, max non-clock fanout: %d, max logic depth: %d" %
+      (sum(1 for f in fanout if f > 0), danglingOutputNum, maxDataFanout, max(depthHistogram)))
+print("device: %d sites, %dx%d clock regions, %d CLB/%d BRAM/%d DSP columns per clock region" %
+      (deviceSiteNum, clockRegionXNum, clockRegionYNum, CLBColumnNum, BRAMColumnNum, DSPColumnNum))
+print("output: " + outputDir)
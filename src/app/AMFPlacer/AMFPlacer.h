@@ -19,6 +19,7 @@
 #include "ParallelCLBPacker.h"
 #include "PlacementInfo.h"
 #include "PlacementTimingOptimizer.h"
+#include "profiler.h"
 #include "utils/simpleJSON.h"
 #include <boost/filesystem.hpp>
 #include <iostream>
@@ -72,8 +73,36 @@ class AMFPlacer
                        "the specified dump directory should be created successfully.");
         }
 
+        if (JSON.find("StageCheckpointDirectory") != JSON.end())
+        {
+            stageCheckpointDirectory = JSON["StageCheckpointDirectory"];
+            if (!fileExists(stageCheckpointDirectory))
+                assert(boost::filesystem::create_directories(stageCheckpointDirectory) &&
+                       "the specified checkpoint directory should be created successfully.");
+        }
+        else if (JSON.find("dumpDirectory") != JSON.end())
+        {
+            stageCheckpointDirectory = JSON["dumpDirectory"];
+        }
+        if (stageCheckpointDirectory != "")
+        {
+            dumpStageCheckpoints = true;
+            if (JSON.find("DumpStageCheckpoints") != JSON.end())
+                dumpStageCheckpoints = JSON["DumpStageCheckpoints"] == "true";
+        }
+        assert((JSON.find("ResumeFromStage") == JSON.end() || stageCheckpointDirectory != "") &&
+               "the directory of the stage checkpoints should be specified for resuming.");
+
         oriTime = std::chrono::steady_clock::now();
 
+        if (JSON.find("Profiling") != JSON.end())
+        {
+            profilingEnabled = JSON["Profiling"] == "true";
+            assert((!profilingEnabled || JSON.find("dumpDirectory") != JSON.end()) &&
+                   "the dump directory should be specified for the profiling results.");
+            Profiler::getInstance().setEnabled(profilingEnabled);
+        }
+
         omp_set_num_threads(std::stoi(JSON["jobs"]));
         if (JSON.find("jobs") != JSON.end())
         {
@@ -85,12 +114,18 @@ class AMFPlacer
         }
 
         // load device information
-        deviceinfo = new DeviceInfo(JSON, "VCU108");
-        deviceinfo->printStat();
+        {
+            ProfileZone profileZone("LoadDevice");
+            deviceinfo = new DeviceInfo(JSON, "VCU108");
+            deviceinfo->printStat();
+        }
 
         // load design information
-        designInfo = new DesignInfo(JSON, deviceinfo);
-        designInfo->printStat();
+        {
+            ProfileZone profileZone("LoadDesign");
+            designInfo = new DesignInfo(JSON, deviceinfo);
+            designInfo->printStat();
+        }
         paintData = new PaintDataBase();
 
         if (guiEnable)
@@ -126,113 +161,234 @@ class AMFPlacer
         }
     }
 
+    /**
+     * @brief get the index of a named stage of the placement flow
+     *
+     * @param stageName
+     * @return int
+     */
+    int getStageId(std::string stageName)
+    {
+        for (unsigned int stageId = 0; stageId < stageNames.size(); stageId++)
+        {
+            if (stageNames[stageId] == stageName)
+                return stageId;
+        }
+        print_error("undefined placement stage: " + stageName);
+        assert(false);
+        return -1;
+    }
+
+    /**
+     * @brief get the name of the checkpoint file dumped after a stage
+     *
+     * @param stageId
+     * @return std::string
+     */
+    std::string getStageCheckpointFileName(int stageId)
+    {
+        return stageCheckpointDirectory + "/" + stageNames[stageId] + ".amfckpt";
+    }
+
+    /**
+     * @brief dump the checkpoint after a stage if stage checkpoints are enabled
+     *
+     * @param stageName
+     * @param timingOptimizer
+     */
+    void dumpStageCheckpoint(std::string stageName, PlacementTimingOptimizer *timingOptimizer)
+    {
+        if (!dumpStageCheckpoints)
+            return;
+        std::map<std::string, float> placerStates;
+        globalPlacer->getCheckpointStates(placerStates);
+        timingOptimizer->getCheckpointStates(placerStates);
+        placementInfo->dumpCheckpoint(getStageCheckpointFileName(getStageId(stageName)), stageName, placerStates);
+    }
+
+    /**
+     * @brief dump the Chrome trace and the stage summary of the profiler into the dump directory if profiling is
+     * enabled
+     *
+     */
+    void dumpProfile()
+    {
+        if (!profilingEnabled)
+            return;
+        Profiler::getInstance().dumpChromeTrace(JSON["dumpDirectory"] + "/profile_trace.json");
+        Profiler::getInstance().dumpSummary(JSON["dumpDirectory"] + "/profile_summary.txt");
+    }
+
     /**
      * @brief launch the analytical mixed-size FPGA placement procedure
      *
      */
     void run()
     {
-        // initialize placement information, including how to map cells to BELs
-        placementInfo = new PlacementInfo(designInfo, deviceinfo, JSON);
-        placementInfo->setPaintDataBase(paintData);
+        PlacementTimingOptimizer *timingOptimizer = nullptr;
+        int longPathThr = 0;
+        int resumeStageId = 0;
+        {
+            ProfileZone profileZone("Preparation");
+            // initialize placement information, including how to map cells to BELs
+            placementInfo = new PlacementInfo(designInfo, deviceinfo, JSON);
+            placementInfo->setPaintDataBase(paintData);
+
+            // we have to pack cells in design info into placement units in placement info with packer
+            InitialPacker *initialPacker = new InitialPacker(designInfo, deviceinfo, placementInfo, JSON);
+            initialPacker->pack();
+            placementInfo->resetLUTFFDeterminedOccupation();
+
+            placementInfo->printStat();
+            placementInfo->createGridBins(5.0, 5.0);
+            placementInfo->verifyDeviceForDesign();
+
+            placementInfo->buildSimpleTimingGraph();
+            timingOptimizer = new PlacementTimingOptimizer(placementInfo, JSON);
+            longPathThr = placementInfo->getLongPathThresholdLevel();
+            // int mediumPathThr = placementInfo->getMediumPathThresholdLevel();
+
+            // the flow can be resumed from a stage with the checkpoint dumped after its previous stage
+            std::map<std::string, float> placerStates;
+            if (JSON.find("ResumeFromStage") != JSON.end())
+            {
+                resumeStageId = getStageId(JSON["ResumeFromStage"]);
+                if (resumeStageId > 0 &&
+                    !placementInfo->loadCheckpoint(getStageCheckpointFileName(resumeStageId - 1),
+                                                   stageNames[resumeStageId - 1], placerStates))
+                {
+                    print_error("cannot resume from stage [" + JSON["ResumeFromStage"] +
+                                "] since the checkpoint of its previous stage cannot be loaded.");
+                    assert(false);
+                }
+            }
 
-        // we have to pack cells in design info into placement units in placement info with packer
-        InitialPacker *initialPacker = new InitialPacker(designInfo, deviceinfo, placementInfo, JSON);
-        initialPacker->pack();
-        placementInfo->resetLUTFFDeterminedOccupation();
+            // go through several glable placement iterations to get initial placement
+            globalPlacer = new GlobalPlacer(placementInfo, JSON, resumeStageId == 0);
+            if (resumeStageId > 0)
+            {
+                print_status("AMFPlacer: resume from stage [" + stageNames[resumeStageId] + "]");
+                globalPlacer->setCheckpointStates(placerStates);
+                timingOptimizer->setCheckpointStates(placerStates);
+                placementInfo->getTimingInfo()->setDSPInnerDelay();
+                print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+                // the clock region utilization is not recorded in the checkpoint and the stages skipped by the
+                // resumption, so it is rebuilt from the bounding boxes of the clock nets updated above
+                placementInfo->checkClockUtilization(false);
+            }
+        }
 
-        placementInfo->printStat();
-        placementInfo->createGridBins(5.0, 5.0);
-        placementInfo->verifyDeviceForDesign();
+        // enable the timing optimization, start initial placement and global placement.
+        if (resumeStageId <= getStageId("InitialPlacement"))
+        {
+            ProfileZone profileZone("InitialPlacement");
+            globalPlacer->clusterPlacement();
+            timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
+            globalPlacer->GlobalPlacement_fixedCLB(1, 0.0002);
 
-        placementInfo->buildSimpleTimingGraph();
-        PlacementTimingOptimizer *timingOptimizer = new PlacementTimingOptimizer(placementInfo, JSON);
-        int longPathThr = placementInfo->getLongPathThresholdLevel();
-        // int mediumPathThr = placementInfo->getMediumPathThresholdLevel();
+            placementInfo->getTimingInfo()->setDSPInnerDelay();
+            dumpStageCheckpoint("InitialPlacement", timingOptimizer);
+        }
 
-        // go through several glable placement iterations to get initial placement
-        globalPlacer = new GlobalPlacer(placementInfo, JSON);
+        if (resumeStageId <= getStageId("GlobalPlacement0"))
+        {
+            ProfileZone profileZone("GlobalPlacement0");
+            globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) / 3, false, 5, true,
+                                                      true, 200, timingOptimizer);
+            dumpStageCheckpoint("GlobalPlacement0", timingOptimizer);
+        }
 
-        // enable the timing optimization, start initial placement and global placement.
+        if (resumeStageId <= getStageId("GlobalPlacement1"))
+        {
+            ProfileZone profileZone("GlobalPlacement1");
+            timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
+            globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.85);
+            globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.8,
+                                                         globalPlacer->getMacroLegalizationWeight() * 0.8);
+            placementInfo->createGridBins(2.5, 2.5);
+            placementInfo->adjustLUTFFUtilization(-10, true);
+            // globalPlacer->spreading(-1);
+            globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5,
+                                                      true, true, 200, timingOptimizer);
+            placementInfo->getPU2ClockRegionCenters().clear();
+            print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+            dumpStageCheckpoint("GlobalPlacement1", timingOptimizer);
+        }
 
-        globalPlacer->clusterPlacement();
-        timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
-        globalPlacer->GlobalPlacement_fixedCLB(1, 0.0002);
-
-        placementInfo->getTimingInfo()->setDSPInnerDelay();
-
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) / 3, false, 5, true, true,
-                                                  200, timingOptimizer);
-        timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
-        globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.85);
-        globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.8,
-                                                     globalPlacer->getMacroLegalizationWeight() * 0.8);
-        placementInfo->createGridBins(2.5, 2.5);
-        placementInfo->adjustLUTFFUtilization(-10, true);
-        // globalPlacer->spreading(-1);
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5, true,
-                                                  true, 200, timingOptimizer);
-        placementInfo->getPU2ClockRegionCenters().clear();
-        print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+        if (resumeStageId <= getStageId("BELPairing"))
+        {
+            ProfileZone profileZone("BELPairing");
+            // pack simple LUT-FF pairs and go through several global placement iterations
+            incrementalBELPacker = new IncrementalBELPacker(designInfo, deviceinfo, placementInfo, JSON);
+            incrementalBELPacker->LUTFFPairing(4.0);
+            incrementalBELPacker->FFPairing(4.0);
+            placementInfo->printStat();
+            print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+            dumpStageCheckpoint("BELPairing", timingOptimizer);
+        }
 
-        // pack simple LUT-FF pairs and go through several global placement iterations
-        incrementalBELPacker = new IncrementalBELPacker(designInfo, deviceinfo, placementInfo, JSON);
-        incrementalBELPacker->LUTFFPairing(4.0);
-        incrementalBELPacker->FFPairing(4.0);
-        placementInfo->printStat();
-        print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+        if (resumeStageId <= getStageId("GlobalPlacement2"))
+        {
+            ProfileZone profileZone("GlobalPlacement2");
+            timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
+
+            globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.85);
+            globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.8,
+                                                         globalPlacer->getMacroLegalizationWeight() * 0.8);
+            globalPlacer->setNeighborDisplacementUpperbound(3.0);
+
+            globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5,
+                                                      true, true, 25, timingOptimizer);
+            // placementInfo->getPU2ClockRegionCenters().clear();
+            dumpStageCheckpoint("GlobalPlacement2", timingOptimizer);
+        }
+
+        if (resumeStageId <= getStageId("GlobalPlacement3"))
+        {
+            ProfileZone profileZone("GlobalPlacement3");
+            globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.9);
+            globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.9,
+                                                         globalPlacer->getMacroLegalizationWeight() * 0.9);
+            placementInfo->createGridBins(2, 2);
+            placementInfo->adjustLUTFFUtilization(-10, true);
+            // placementInfo->getDesignInfo()->resetNetEnhanceRatio();
+            // timingOptimizer->enhanceNetWeight_LevelBased(mediumPathThr);
+            globalPlacer->setNeighborDisplacementUpperbound(2.0);
+
+            // timingOptimizer->moveDriverIntoBetterClockRegion(longPathThr, 0.75);
+            globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5,
+                                                      true, true, 25, timingOptimizer);
+            dumpStageCheckpoint("GlobalPlacement3", timingOptimizer);
+        }
 
-        timingOptimizer->clusterLongPathInOneClockRegion(longPathThr, 0.5);
-
-        globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.85);
-        globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.8,
-                                                     globalPlacer->getMacroLegalizationWeight() * 0.8);
-        globalPlacer->setNeighborDisplacementUpperbound(3.0);
-
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5, true,
-                                                  true, 25, timingOptimizer);
-        // placementInfo->getPU2ClockRegionCenters().clear();
-
-        globalPlacer->setPseudoNetWeight(globalPlacer->getPseudoNetWeight() * 0.9);
-        globalPlacer->setMacroLegalizationParameters(globalPlacer->getMacroPseudoNetEnhanceCnt() * 0.9,
-                                                     globalPlacer->getMacroLegalizationWeight() * 0.9);
-        placementInfo->createGridBins(2, 2);
-        placementInfo->adjustLUTFFUtilization(-10, true);
-        // placementInfo->getDesignInfo()->resetNetEnhanceRatio();
-        // timingOptimizer->enhanceNetWeight_LevelBased(mediumPathThr);
-        globalPlacer->setNeighborDisplacementUpperbound(2.0);
-
-        // timingOptimizer->moveDriverIntoBetterClockRegion(longPathThr, 0.75);
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) * 2 / 9, true, 5, true,
-                                                  true, 25, timingOptimizer);
         JSON["SpreaderSimpleExpland"] = "true";
-        // placementInfo->getPU2ClockRegionCenters().clear();
-        globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) / 2, true, 5, true, false,
-                                                  25, timingOptimizer);
-
-        // // currently, some fixed/packed flag cannot be stored in the check-point (TODO)
-        // clearSomeAttributesCannotRecord();
-
-        // // test the check-point mechanism
-        // placementInfo->dumpPlacementUnitInformation(JSON["dumpDirectory"] + "/PUInfoBeforeFinalPacking");
-        // placementInfo->loadPlacementUnitInformation(JSON["dumpDirectory"] + "/PUInfoBeforeFinalPacking.gz");
-        // print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
-
-        timingOptimizer->conductStaticTimingAnalysis();
-        // finally pack the elements into sites on the FPGA device
-        parallelCLBPacker =
-            new ParallelCLBPacker(designInfo, deviceinfo, placementInfo, JSON, 3, 10, 0.25, 0.5, 6, 10, 0.02, "first",
-                                  timingOptimizer, globalPlacer->getWirelengthOptimizer());
-        parallelCLBPacker->packCLBs(30, true);
-        parallelCLBPacker->setPULocationToPackedSite();
-        timingOptimizer->conductStaticTimingAnalysis();
-        placementInfo->checkClockUtilization(true);
-        print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
-        placementInfo->resetLUTFFDeterminedOccupation();
-        parallelCLBPacker->updatePackedMacro(true, true);
-        placementInfo->dumpOverflowClockUtilization();
-        placementInfo->adjustLUTFFUtilization(1, true);
-        placementInfo->dumpCongestion(JSON["dumpDirectory"] + "/congestionInfo");
+        if (resumeStageId <= getStageId("GlobalPlacement4"))
+        {
+            ProfileZone profileZone("GlobalPlacement4");
+            // placementInfo->getPU2ClockRegionCenters().clear();
+            globalPlacer->GlobalPlacement_CLBElements(std::stoi(JSON["GlobalPlacementIteration"]) / 2, true, 5, true,
+                                                      false, 25, timingOptimizer);
+            dumpStageCheckpoint("GlobalPlacement4", timingOptimizer);
+        }
+
+        {
+            ProfileZone profileZone("CLBPacking");
+            timingOptimizer->conductStaticTimingAnalysis();
+            // finally pack the elements into sites on the FPGA device
+            parallelCLBPacker =
+                new ParallelCLBPacker(designInfo, deviceinfo, placementInfo, JSON, 3, 10, 0.25, 0.5, 6, 10, 0.02,
+                                      "first", timingOptimizer, globalPlacer->getWirelengthOptimizer());
+            parallelCLBPacker->packCLBs(30, true);
+            parallelCLBPacker->setPULocationToPackedSite();
+            timingOptimizer->conductStaticTimingAnalysis();
+            placementInfo->checkClockUtilization(true);
+            print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+            placementInfo->resetLUTFFDeterminedOccupation();
+            parallelCLBPacker->updatePackedMacro(true, true);
+            placementInfo->dumpOverflowClockUtilization();
+            placementInfo->adjustLUTFFUtilization(1, true);
+            placementInfo->dumpCongestion(JSON["dumpDirectory"] + "/congestionInfo");
+        }
 
         if (parallelCLBPacker)
             delete parallelCLBPacker;
@@ -244,6 +400,7 @@ class AMFPlacer
 
         print_status("Placement Done");
         print_info("Current Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
+        dumpProfile();
 
         // auto nowTime = std::chrono::steady_clock::now();
         // auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(nowTime - oriTime).count();
@@ -301,4 +458,31 @@ class AMFPlacer
      *
      */
     std::map<std::string, std::string> JSON;
+
+    /**
+     * @brief the named stages of the placement flow. The flow can be resumed from a stage with the checkpoint dumped
+     * after its previous stage.
+     *
+     */
+    std::vector<std::string> stageNames = {"InitialPlacement", "GlobalPlacement0", "GlobalPlacement1",
+                                           "BELPairing",       "GlobalPlacement2", "GlobalPlacement3",
+                                           "GlobalPlacement4", "CLBPacking"};
+
+    /**
+     * @brief whether to dump a checkpoint after each stage
+     *
+     */
+    bool dumpStageCheckpoints = false;
+
+    /**
+     * @brief the directory of the stage checkpoints
+     *
+     */
+    std::string stageCheckpointDirectory = "";
+
+    /**
+     * @brief whether to record the runtime/memory profile of the stages and dump it when the placement is done
+     *
+     */
+    bool profilingEnabled = false;
 };
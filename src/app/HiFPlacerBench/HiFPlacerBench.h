@@ -0,0 +1,473 @@
+/**
+ * @file HiFPlacerBench.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief The benchmark suite which times the core kernels of the placer on a loaded design with different numbers of
+ * threads
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#ifndef _HIFPLACERBENCH
+#define _HIFPLACERBENCH
+
+#include "CLBLegalizer.h"
+#include "DesignInfo.h"
+#include "DeviceInfo.h"
+#include "GeneralSpreader.h"
+#include "GlobalPlacer.h"
+#include "InitialPacker.h"
+#include "MacroLegalizer.h"
+#include "ParallelCLBPacker.h"
+#include "PlacementInfo.h"
+#include "PlacementTimingOptimizer.h"
+#include "utils/simpleJSON.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <omp.h>
+
+/**
+ * @brief HiFPlacerBench loads a design once, brings it to a placed state and times the isolated core kernels of the
+ * placer (HPWL evaluation, QP solving, cell spreading, legalization, CLB packing and static timing analysis) with a
+ * sweep of thread numbers. The results are dumped as a JSON file so the scaling of each kernel can be tracked.
+ *
+ * Before each timed run of a kernel, the locations of the PlacementUnits are restored to the benchmark state so the
+ * runs of different thread numbers process the same input.
+ */
+class HiFPlacerBench
+{
+  public:
+    /**
+     * @brief the settings of the benchmark
+     *
+     */
+    struct BenchSettings
+    {
+        /**
+         * @brief the thread numbers to sweep
+         *
+         */
+        std::vector<int> threadNums;
+
+        /**
+         * @brief the number of timed runs of each kernel for each thread number
+         *
+         */
+        int repeat = 3;
+
+        /**
+         * @brief the number of global placement iterations to reach the benchmark state if no checkpoint is loaded
+         *
+         */
+        int warmupIterations = 10;
+
+        /**
+         * @brief the stage whose checkpoint is loaded as the benchmark state (empty to run the warm-up iterations)
+         *
+         */
+        std::string checkpointStage = "";
+
+        /**
+         * @brief the kernels to run (empty to run all of them)
+         *
+         */
+        std::vector<std::string> kernels;
+
+        /**
+         * @brief the JSON file of the results
+         *
+         */
+        std::string outputFile = "";
+    };
+
+    /**
+     * @brief Construct a new HiFPlacerBench object and load the design/device according to a given placer
+     * configuration file
+     *
+     * @param JSONFileName
+     * @param settings
+     */
+    HiFPlacerBench(std::string JSONFileName, BenchSettings &settings) : settings(settings)
+    {
+        JSON = parseJSONFile(JSONFileName);
+        assert(JSON.find("vivado extracted device information file") != JSON.end());
+        assert(JSON.find("vivado extracted design information file") != JSON.end());
+        oriTime = std::chrono::steady_clock::now();
+
+        if (settings.threadNums.size() == 0)
+        {
+            int maxThreadNum = std::max(1, omp_get_num_procs());
+            if (JSON.find("jobs") != JSON.end())
+                maxThreadNum = std::stoi(JSON["jobs"]);
+            for (int threadNum = 1; threadNum < maxThreadNum; threadNum *= 2)
+                settings.threadNums.push_back(threadNum);
+            settings.threadNums.push_back(maxThreadNum);
+        }
+        if (settings.outputFile == "")
+        {
+            if (JSON.find("dumpDirectory") != JSON.end())
+                settings.outputFile = JSON["dumpDirectory"] + "/HiFPlacerBench.json";
+            else
+                settings.outputFile = "HiFPlacerBench.json";
+        }
+
+        auto loadBeginTime = std::chrono::steady_clock::now();
+        deviceinfo = new DeviceInfo(JSON, "VCU108");
+        designInfo = new DesignInfo(JSON, deviceinfo);
+        paintData = new PaintDataBase();
+        loadTime = getSecondsSince(loadBeginTime);
+    }
+
+    ~HiFPlacerBench()
+    {
+        if (globalPlacer)
+            delete globalPlacer;
+        if (timingOptimizer)
+            delete timingOptimizer;
+        if (placementInfo)
+            delete placementInfo;
+        delete paintData;
+        delete designInfo;
+        delete deviceinfo;
+    }
+
+    /**
+     * @brief bring the design to the benchmark state, time the kernels and dump the results
+     *
+     */
+    void run()
+    {
+        auto setupBeginTime = std::chrono::steady_clock::now();
+        setupPlacementState();
+        setupTime = getSecondsSince(setupBeginTime);
+
+        for (auto threadNum : settings.threadNums)
+        {
+            print_status("HiFPlacerBench: benchmarking with " + std::to_string(threadNum) + " threads");
+            JSON["jobs"] = std::to_string(threadNum);
+            omp_set_num_threads(threadNum);
+            benchHPWL(threadNum);
+            benchQPSolve(threadNum);
+            benchSpreader(threadNum);
+            benchMacroLegalizer(threadNum);
+            benchCLBLegalizer(threadNum);
+            benchCLBPacker(threadNum);
+            benchSTA(threadNum);
+        }
+        dumpResults();
+    }
+
+  private:
+    /**
+     * @brief the timing results of a kernel with a thread number
+     *
+     */
+    struct KernelResult
+    {
+        std::string kernel;
+        int threadNum;
+        std::vector<double> runTimes;
+    };
+
+    inline double getSecondsSince(std::chrono::steady_clock::time_point beginTime)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - beginTime).count();
+    }
+
+    inline bool kernelEnabled(std::string kernel)
+    {
+        return settings.kernels.size() == 0 ||
+               std::find(settings.kernels.begin(), settings.kernels.end(), kernel) != settings.kernels.end();
+    }
+
+    /**
+     * @brief pack the design into PlacementUnits and get the placed state to benchmark, either from a stage
+     * checkpoint or by running some global placement iterations
+     *
+     */
+    void setupPlacementState()
+    {
+        placementInfo = new PlacementInfo(designInfo, deviceinfo, JSON);
+        placementInfo->setPaintDataBase(paintData);
+        InitialPacker *initialPacker = new InitialPacker(designInfo, deviceinfo, placementInfo, JSON);
+        initialPacker->pack();
+        delete initialPacker;
+        placementInfo->resetLUTFFDeterminedOccupation();
+        placementInfo->createGridBins(5.0, 5.0);
+        placementInfo->verifyDeviceForDesign();
+        placementInfo->buildSimpleTimingGraph();
+        timingOptimizer = new PlacementTimingOptimizer(placementInfo, JSON);
+
+        if (settings.checkpointStage != "")
+        {
+            std::string checkpointDirectory = JSON["dumpDirectory"];
+            if (JSON.find("StageCheckpointDirectory") != JSON.end())
+                checkpointDirectory = JSON["StageCheckpointDirectory"];
+            std::map<std::string, float> placerStates;
+            if (!placementInfo->loadCheckpoint(checkpointDirectory + "/" + settings.checkpointStage + ".amfckpt",
+                                               settings.checkpointStage, placerStates))
+            {
+                print_error("HiFPlacerBench: cannot load the checkpoint of stage [" + settings.checkpointStage + "]");
+                assert(false);
+            }
+            globalPlacer = new GlobalPlacer(placementInfo, JSON, false);
+            globalPlacer->setCheckpointStates(placerStates);
+            timingOptimizer->setCheckpointStates(placerStates);
+            placementInfo->getTimingInfo()->setDSPInnerDelay();
+        }
+        else
+        {
+            globalPlacer = new GlobalPlacer(placementInfo, JSON);
+            globalPlacer->clusterPlacement();
+            globalPlacer->GlobalPlacement_fixedCLB(1, 0.0002);
+            placementInfo->getTimingInfo()->setDSPInnerDelay();
+            globalPlacer->GlobalPlacement_CLBElements(settings.warmupIterations, false, 5, true, true, 200,
+                                                      timingOptimizer);
+        }
+        placementInfo->updateB2BAndGetTotalHPWL();
+        recordPULocations(benchPULocations);
+
+        // a second placement state for STA, so each timed analysis has to update the delays of changed edges
+        globalPlacer->getWirelengthOptimizer()->GlobalPlacementQPSolve(globalPlacer->getPseudoNetWeight(), true, false,
+                                                                       true, true, false);
+        recordPULocations(perturbedPULocations);
+        restorePULocations(benchPULocations);
+        timingOptimizer->conductStaticTimingAnalysis();
+    }
+
+    void recordPULocations(std::vector<std::pair<float, float>> &PULocations)
+    {
+        PULocations.clear();
+        for (auto curPU : placementInfo->getPlacementUnits())
+            PULocations.emplace_back(curPU->X(), curPU->Y());
+    }
+
+    void restorePULocations(std::vector<std::pair<float, float>> &PULocations)
+    {
+        auto &PUs = placementInfo->getPlacementUnits();
+        assert(PUs.size() == PULocations.size());
+        for (unsigned int i = 0; i < PUs.size(); i++)
+        {
+            if (!PUs[i]->isLocked())
+                PUs[i]->setAnchorLocationAndForgetTheOriginalOne(PULocations[i].first, PULocations[i].second);
+        }
+        placementInfo->updateElementBinGrid();
+        placementInfo->updateB2BAndGetTotalHPWL();
+    }
+
+    /**
+     * @brief time the given kernel for several runs. The preparation is conducted before each run and not timed.
+     *
+     * @param kernel the name of the kernel
+     * @param threadNum
+     * @param prepare
+     * @param kernelFunc
+     */
+    void timeKernel(std::string kernel, int threadNum, std::function<void(int)> prepare,
+                    std::function<void(int)> kernelFunc)
+    {
+        KernelResult result;
+        result.kernel = kernel;
+        result.threadNum = threadNum;
+        for (int runId = 0; runId < settings.repeat; runId++)
+        {
+            prepare(runId);
+            auto beginTime = std::chrono::steady_clock::now();
+            kernelFunc(runId);
+            result.runTimes.push_back(getSecondsSince(beginTime));
+        }
+        print_info("HiFPlacerBench: " + kernel + " with " + std::to_string(threadNum) +
+                   " threads takes (min) " + std::to_string(*std::min_element(result.runTimes.begin(),
+                                                                              result.runTimes.end())) +
+                   " s");
+        results.push_back(result);
+    }
+
+    /**
+     * @brief time a kernel which moves the PlacementUnits. The benchmark state is restored before each run and after
+     * all the runs.
+     *
+     * @param kernel the name of the kernel
+     * @param threadNum
+     * @param kernelFunc
+     */
+    void timeKernelWithRestore(std::string kernel, int threadNum, std::function<void(int)> kernelFunc)
+    {
+        timeKernel(
+            kernel, threadNum, [&](int) { restorePULocations(benchPULocations); }, kernelFunc);
+        restorePULocations(benchPULocations);
+    }
+
+    void benchHPWL(int threadNum)
+    {
+        if (!kernelEnabled("updateB2BAndGetTotalHPWL"))
+            return;
+        restorePULocations(benchPULocations);
+        timeKernel(
+            "updateB2BAndGetTotalHPWL", threadNum, [](int) {},
+            [&](int) { placementInfo->updateB2BAndGetTotalHPWL(); });
+    }
+
+    void benchQPSolve(int threadNum)
+    {
+        if (!kernelEnabled("GlobalPlacementQPSolve"))
+            return;
+        timeKernelWithRestore("GlobalPlacementQPSolve", threadNum, [&](int) {
+            globalPlacer->getWirelengthOptimizer()->GlobalPlacementQPSolve(globalPlacer->getPseudoNetWeight(), true,
+                                                                           false, true, true, false);
+        });
+    }
+
+    void benchSpreader(int threadNum)
+    {
+        if (!kernelEnabled("GeneralSpreader"))
+            return;
+        std::string sharedCellType = "SLICEL_LUT";
+        float supplyRatio = (placementInfo->getBinGridW() < 2.5) ? 0.95 : 0.85;
+        timeKernelWithRestore("GeneralSpreader", threadNum, [&](int) {
+            GeneralSpreader generalSpreader(placementInfo, JSON, sharedCellType, 0, supplyRatio, false);
+            generalSpreader.spreadPlacementUnits(0.2);
+        });
+    }
+
+    void benchMacroLegalizer(int threadNum)
+    {
+        if (!kernelEnabled("MacroLegalizer"))
+            return;
+        std::vector<DesignInfo::DesignCellType> macroTypesToLegalize = {
+            DesignInfo::CellType_RAMB18E2, DesignInfo::CellType_RAMB36E2, DesignInfo::CellType_FIFO18E2,
+            DesignInfo::CellType_FIFO36E2, DesignInfo::CellType_DSP48E2};
+        MacroLegalizer macroLegalizer("BenchBRAMDSPLegalizer", placementInfo, deviceinfo, macroTypesToLegalize, JSON);
+        timeKernelWithRestore("MacroLegalizer", threadNum, [&](int) { macroLegalizer.legalize(); });
+    }
+
+    void benchCLBLegalizer(int threadNum)
+    {
+        if (!kernelEnabled("CLBLegalizer"))
+            return;
+        std::vector<std::string> siteTypesToLegalize(1, "SLICEL");
+        CLBLegalizer lCLBLegalizer("BenchCLBLegalizer", placementInfo, deviceinfo, siteTypesToLegalize, JSON);
+        timeKernelWithRestore("CLBLegalizer", threadNum, [&](int) { lCLBLegalizer.legalize(); });
+    }
+
+    /**
+     * @brief time the iterations of the parallel CLB packer. The packer can only be initialized when the CARRY/LUTRAM
+     * macros have been legalized (e.g., with the checkpoint of GlobalPlacement4), otherwise the kernel is skipped.
+     *
+     * @param threadNum
+     */
+    void benchCLBPacker(int threadNum)
+    {
+        if (!kernelEnabled("packCLBsIteration"))
+            return;
+        auto &PULegalSite = placementInfo->getPULegalSite();
+        for (auto tmpMacro : placementInfo->getPlacementMacros())
+        {
+            if ((tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY ||
+                 tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MCLB) &&
+                !PULegalSite.count(tmpMacro))
+            {
+                print_warning("HiFPlacerBench: packCLBsIteration is skipped since the CARRY/LUTRAM macros are not "
+                              "legalized in the benchmark state.");
+                return;
+            }
+        }
+        restorePULocations(benchPULocations);
+        ParallelCLBPacker *parallelCLBPacker =
+            new ParallelCLBPacker(designInfo, deviceinfo, placementInfo, JSON, 3, 10, 0.25, 0.5, 6, 10, 0.02, "bench",
+                                  timingOptimizer, globalPlacer->getWirelengthOptimizer());
+        // the iterations are timed successively since each iteration continues the previous one
+        timeKernel(
+            "packCLBsIteration", threadNum, [](int) {},
+            [&](int runId) { parallelCLBPacker->packCLBsIteration(runId == 0); });
+        delete parallelCLBPacker;
+    }
+
+    void benchSTA(int threadNum)
+    {
+        if (!kernelEnabled("conductStaticTimingAnalysis"))
+            return;
+        // alternate between two placement states so the delays of the edges are changed before each analysis
+        timeKernel(
+            "conductStaticTimingAnalysis", threadNum,
+            [&](int runId) { restorePULocations(runId % 2 ? benchPULocations : perturbedPULocations); },
+            [&](int) { timingOptimizer->conductStaticTimingAnalysis(); });
+        restorePULocations(benchPULocations);
+        timingOptimizer->conductStaticTimingAnalysis();
+    }
+
+    /**
+     * @brief dump the results as a JSON file. The speedup of a kernel is the ratio of its minimum runtime with the
+     * first thread number in the sweep to that with the current thread number.
+     *
+     */
+    void dumpResults()
+    {
+        print_status("HiFPlacerBench: dumping results to: " + settings.outputFile);
+        std::ofstream outfile0(settings.outputFile.c_str());
+        assert(outfile0.is_open() && "The path for HiFPlacerBench results does not exist and please check your path "
+                                     "settings");
+
+        std::map<std::string, double> kernel2BaselineTime;
+        outfile0 << std::setprecision(6);
+        outfile0 << "{\n";
+        outfile0 << "  \"design\": \"" << JSON["vivado extracted design information file"] << "\",\n";
+        outfile0 << "  \"benchmarkState\": \""
+                 << (settings.checkpointStage == "" ? "warmup" : "checkpoint:" + settings.checkpointStage) << "\",\n";
+        outfile0 << "  \"cellNum\": " << designInfo->getNumCells() << ",\n";
+        outfile0 << "  \"PUNum\": " << placementInfo->getPlacementUnits().size() << ",\n";
+        outfile0 << "  \"loadTime\": " << loadTime << ",\n";
+        outfile0 << "  \"setupTime\": " << setupTime << ",\n";
+        outfile0 << "  \"repeat\": " << settings.repeat << ",\n";
+        outfile0 << "  \"results\": [";
+        for (unsigned int i = 0; i < results.size(); i++)
+        {
+            auto &result = results[i];
+            std::vector<double> sortedTimes = result.runTimes;
+            std::sort(sortedTimes.begin(), sortedTimes.end());
+            double minTime = sortedTimes[0];
+            double meanTime = 0;
+            for (auto runTime : sortedTimes)
+                meanTime += runTime / sortedTimes.size();
+            if (kernel2BaselineTime.find(result.kernel) == kernel2BaselineTime.end())
+                kernel2BaselineTime[result.kernel] = minTime;
+
+            outfile0 << (i ? ",\n" : "\n") << "    {\"kernel\": \"" << result.kernel
+                     << "\", \"threads\": " << result.threadNum << ", \"min\": " << minTime
+                     << ", \"median\": " << sortedTimes[sortedTimes.size() / 2] << ", \"mean\": " << meanTime
+                     << ", \"max\": " << sortedTimes.back()
+                     << ", \"speedup\": " << kernel2BaselineTime[result.kernel] / std::max(minTime, 1e-9)
+                     << ", \"runs\": [";
+            for (unsigned int j = 0; j < result.runTimes.size(); j++)
+                outfile0 << (j ? ", " : "") << result.runTimes[j];
+            outfile0 << "]}";
+        }
+        outfile0 << "\n  ]\n}\n";
+        outfile0.close();
+    }
+
+    BenchSettings &settings;
+    std::map<std::string, std::string> JSON;
+
+    DeviceInfo *deviceinfo = nullptr;
+    DesignInfo *designInfo = nullptr;
+    PlacementInfo *placementInfo = nullptr;
+    PaintDataBase *paintData = nullptr;
+    GlobalPlacer *globalPlacer = nullptr;
+    PlacementTimingOptimizer *timingOptimizer = nullptr;
+
+    std::vector<std::pair<float, float>> benchPULocations;
+    std::vector<std::pair<float, float>> perturbedPULocations;
+    std::vector<KernelResult> results;
+    double loadTime = 0;
+    double setupTime = 0;
+};
+
+#endif
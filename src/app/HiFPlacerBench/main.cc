@@ -0,0 +1,75 @@
+/**
+ * @file main.cc
+ * @author Tingyuan Liang (tliang@connect.ust.hk)
+ * @brief HiFPlacerBench Main file which parses the benchmark options and launches the kernel benchmarks
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ */
+
+#include "HiFPlacerBench.h"
+
+std::vector<std::string> splitOption(std::string option)
+{
+    std::vector<std::string> res;
+    std::stringstream ss(option);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (item != "")
+            res.push_back(item);
+    }
+    return res;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " <config JSON file> [-threads 1,2,4,8] [-repeat N] [-warmup N] [-checkpoint <stage name>]"
+                     " [-kernels k1,k2,...] [-output <result JSON file>]"
+                  << std::endl;
+        std::cerr << "kernels: updateB2BAndGetTotalHPWL, GlobalPlacementQPSolve, GeneralSpreader, MacroLegalizer, "
+                     "CLBLegalizer, packCLBsIteration, conductStaticTimingAnalysis"
+                  << std::endl;
+        return 1;
+    }
+
+    HiFPlacerBench::BenchSettings settings;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string option(argv[i]);
+        std::string value(argv[i + 1]);
+        if (option == "-threads")
+        {
+            for (auto threadNum : splitOption(value))
+                settings.threadNums.push_back(std::stoi(threadNum));
+        }
+        else if (option == "-repeat")
+            settings.repeat = std::stoi(value);
+        else if (option == "-warmup")
+            settings.warmupIterations = std::stoi(value);
+        else if (option == "-checkpoint")
+            settings.checkpointStage = value;
+        else if (option == "-kernels")
+            settings.kernels = splitOption(value);
+        else if (option == "-output")
+            settings.outputFile = value;
+        else
+        {
+            std::cerr << "unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+    assert(settings.repeat > 0);
+
+    HiFPlacerBench *bench = new HiFPlacerBench(argv[1], settings);
+    bench->run();
+    delete bench;
+
+    return 0;
+}
@@ -26,9 +26,18 @@
 #include "readZip.h"
 #include "strPrint.h"
 #include "stringCheck.h"
+#include "stringInterner.h"
 #include <assert.h>
+#include <omp.h>
 #include <queue>
-#include <regex>
+#include <string_view>
+
+/**
+ * @brief the kind tag of the binary database of design information, which should be updated when the records are
+ * changed
+ *
+ */
+const char designBinaryDBKind[] = "AMFDSN01";
 
 void DesignInfo::DesignPin::updateParentCellNetInfo()
 {
@@ -131,7 +140,7 @@ void DesignInfo::addPinToNet(DesignPin *curPin)
 {
     if (name2Net.find(curPin->getNetName()) == name2Net.end())
     {
-        DesignNet *curNet = new DesignNet(curPin->getNetName(), getNumNets());
+        DesignNet *curNet = netArena.create(curPin->getNetName(), getNumNets());
         netlist.push_back(curNet);
         name2Net[curPin->getNetName()] = curNet;
     }
@@ -176,79 +185,52 @@ DesignInfo::DesignInfo(std::map<std::string, std::string> &JSONCfg, DeviceInfo *
 
     print_status("Design Information Loading.");
 
-    std::string unzipCmnd = "unzip -p " + designArchievedTextFileName;
-    FILEbuf sbuf(popen(unzipCmnd.c_str(), "r"));
-    std::istream infile(&sbuf);
-    // std::ifstream infile(designTextFileName.c_str());
-
-    std::string line;
-    std::getline(infile, line);
-    std::string cellType, cellName, targetName, dir, refpinname, netName, drivepinName, fill0, fill1, fill2, fill3,
-        aliasNetName;
-    std::istringstream iss(line);
-    iss >> fill0 >> cellName >> fill1 >> cellType;
-
-    DesignCell *curCell = new DesignCell(cellName, fromStringToCellType(cellName, cellType), getNumCells());
-    curCell = addCell(curCell);
-
-    while (std::getline(infile, line))
+    bool useBinaryDBCache = true;
+    if (JSONCfg.find("BinaryDatabaseCache") != JSONCfg.end())
+        useBinaryDBCache = JSONCfg["BinaryDatabaseCache"] == "true";
+    std::string binaryDBCacheDir = "";
+    if (JSONCfg.find("BinaryDatabaseCacheDir") != JSONCfg.end())
+        binaryDBCacheDir = JSONCfg["BinaryDatabaseCacheDir"];
+
+    uint64_t sourceSignature = getFileSignature(designArchievedTextFileName);
+    std::string binaryDBFileName = getBinaryDBFileName(designArchievedTextFileName, binaryDBCacheDir);
+    BinaryDB binaryDB;
+    if (useBinaryDBCache && binaryDB.open(binaryDBFileName, designBinaryDBKind, sourceSignature))
     {
-        std::istringstream iss(line);
-        iss >> fill0 >> targetName;
-        if (strContains(fill0, "pin=>"))
-        {
-            iss >> fill3 >> refpinname >> fill0 >> dir >> fill1 >> netName >> fill2 >> drivepinName;
-            DesignPin *curPin = new DesignPin(targetName, refpinname,
-                                              DesignPin::checkPinType(curCell, refpinname, dir == std::string("IN")),
-                                              dir == std::string("IN"), curCell, pins.size());
-            pins.push_back(curPin);
-            curCell->addPin(curPin);
-            aliasNetName = netName;
-
-            if (aliasNet2AliasNetId.find(aliasNetName) == aliasNet2AliasNetId.end())
-            {
-                int numAliasNet = aliasNet2AliasNetId.size();
-                aliasNet2AliasNetId[aliasNetName] = numAliasNet;
-            }
-            if (netName == "drivepin=>")
-            {
-                curPin->updateParentCellNetInfo();
-                curPin->setUnconnected();
-                continue; // not connected
-            }
-            assert(drivepinName != "");
-
-            assert(fill1 == "net=>");
-            std::regex GNDpattern(".*/<const0>");
-            if (std::regex_match(netName, GNDpattern))
-            {
-                netName = drivepinName = "<const0>";
-            }
-            std::regex VCCpattern(".*/<const1>");
-            if (std::regex_match(netName, VCCpattern))
-            {
-                netName = drivepinName = "<const1>";
-            }
-            netName = drivepinName; // don't use the net name, which has aliases in Vivado, otherwise will fail to map
-            curPin->setDriverPinName(drivepinName); // bind to a net name first
-            curPin->connectToNetName(netName);
-            addPinToNet(curPin);                             // update net in netlist
-            curPin->connectToNetVariable(name2Net[netName]); // bind to a net pointer
-            curPin->updateParentCellNetInfo();
-            curPin->setAliasNetId(aliasNet2AliasNetId[aliasNetName]);
-        }
-        else if (strContains(fill0, "curCell=>"))
+        print_info("load design information from binary database: " + binaryDBFileName);
+        size_t cellNum, pinNum;
+        const DesignCellRecord *cellRecords = binaryDB.getSection<DesignCellRecord>(0, cellNum);
+        const DesignPinRecord *pinRecords = binaryDB.getSection<DesignPinRecord>(1, pinNum);
+        loadDesignFromRecords(cellRecords, cellNum, pinRecords, binaryDB.getStringNum(),
+                              [&binaryDB](int32_t strId) { return binaryDB.getString(strId); });
+    }
+    else
+    {
+        std::vector<DesignCellRecord> cellRecords;
+        std::vector<DesignPinRecord> pinRecords;
+        BinaryDBWriter binaryDBWriter;
+        parseDesignTextFile(cellRecords, pinRecords, binaryDBWriter);
+        // a missing source file has no signature and should not be cached
+        if (useBinaryDBCache && sourceSignature)
         {
-            iss >> fill1 >> cellType;
-            curCell = new DesignCell(targetName, fromStringToCellType(targetName, cellType), getNumCells());
-            curCell = addCell(curCell);
+            binaryDBWriter.addSection(cellRecords);
+            binaryDBWriter.addSection(pinRecords);
+            if (binaryDBWriter.write(binaryDBFileName, designBinaryDBKind, sourceSignature))
+                print_info("design information is compiled into binary database: " + binaryDBFileName);
+            else
+                print_warning("failed to write the binary database: " + binaryDBFileName);
         }
-        else
-            assert(false && "Parser Error");
+        loadDesignFromRecords(cellRecords.data(), cellRecords.size(), pinRecords.data(),
+                              binaryDBWriter.getStringNum(),
+                              [&binaryDBWriter](int32_t strId) { return binaryDBWriter.getString(strId); });
     }
 
-    for (DesignNet *curNet : netlist)
+    // each pin belongs to only one net, so the driver pins can be resolved in parallel
+    int netNum = netlist.size();
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int netId = 0; netId < netNum; netId++)
     {
+        DesignNet *curNet = netlist[netId];
         for (DesignPin *driverPin : curNet->getDriverPins())
             for (DesignPin *pinBeDriven : curNet->getPinsBeDriven())
             {
@@ -369,6 +351,238 @@ DesignInfo::DesignInfo(std::map<std::string, std::string> &JSONCfg, DeviceInfo *
     print_status("New Design Info Created.");
 }
 
+void DesignInfo::parseDesignTextFile(std::vector<DesignCellRecord> &cellRecords,
+                                     std::vector<DesignPinRecord> &pinRecords, BinaryDBWriter &stringTable)
+{
+    std::string content;
+    bool unzipSucc = readWholeZipFile(designArchievedTextFileName, content);
+    if (!unzipSucc || content.empty())
+    {
+        print_error("failed to read the design information file: " + designArchievedTextFileName);
+        assert(false && "failed to read the design information file. Please check your path settings.");
+    }
+
+    // split the content at the beginnings of some cell lines, so the chunks can be parsed independently
+    int chunkNum = omp_get_max_threads() * 4;
+    std::vector<size_t> chunkBegins(1, 0);
+    for (int chunkId = 1; chunkId < chunkNum; chunkId++)
+    {
+        size_t searchBegin = std::max(chunkBegins.back(), content.size() / chunkNum * chunkId);
+        size_t splitPos = content.find("\ncurCell=>", searchBegin);
+        if (splitPos == std::string::npos)
+            break;
+        chunkBegins.push_back(splitPos + 1);
+    }
+    chunkBegins.push_back(content.size());
+    chunkNum = chunkBegins.size() - 1;
+
+    // the string fields of the records in a chunk are the ids of the tokens in the chunk before interning
+    struct DesignTextChunk
+    {
+        std::vector<DesignCellRecord> cellRecords;
+        std::vector<DesignPinRecord> pinRecords;
+        std::vector<std::string_view> tokens;
+        std::vector<int32_t> tokenStrIds;
+        std::vector<std::vector<int32_t>> shardTokenIds;
+        int32_t cellBase = 0;
+        int32_t pinBase = 0;
+    };
+    std::vector<DesignTextChunk> chunks(chunkNum);
+    StringInterner stringInterner;
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int chunkId = 0; chunkId < chunkNum; chunkId++)
+    {
+        DesignTextChunk &chunk = chunks[chunkId];
+        chunk.shardTokenIds.resize(stringInterner.getShardNum());
+        auto addToken = [&chunk, &stringInterner](std::string_view token) -> int32_t {
+            int32_t tokenId = chunk.tokens.size();
+            chunk.tokens.push_back(token);
+            chunk.shardTokenIds[stringInterner.getShardId(token)].push_back(tokenId);
+            return tokenId;
+        };
+
+        std::string_view lineTokens[10];
+        size_t lineBegin = chunkBegins[chunkId];
+        size_t chunkEnd = chunkBegins[chunkId + 1];
+        while (lineBegin < chunkEnd)
+        {
+            size_t lineEnd = std::min(content.find('\n', lineBegin), chunkEnd);
+            std::string_view line(content.data() + lineBegin, lineEnd - lineBegin);
+            lineBegin = lineEnd + 1;
+            int tokenNum = 0;
+            size_t tokenBegin = line.find_first_not_of(" \t\r");
+            while (tokenBegin != std::string_view::npos && tokenNum < 10)
+            {
+                size_t tokenEnd = std::min(line.find_first_of(" \t\r", tokenBegin), line.size());
+                lineTokens[tokenNum++] = line.substr(tokenBegin, tokenEnd - tokenBegin);
+                tokenBegin = line.find_first_not_of(" \t\r", tokenEnd);
+            }
+            if (tokenNum == 0)
+                continue;
+
+            // pin=> <pin> refpin=> <refpin> dir=> <IN/OUT> net=> <net> drivepin=> <driver pin>
+            if (lineTokens[0].find("pin=>") != std::string_view::npos)
+            {
+                assert(chunk.cellRecords.size() && "a pin should follow its cell.");
+                assert(tokenNum >= 8 && lineTokens[6] == "net=>");
+                std::string_view netName = lineTokens[7];
+                DesignPinRecord pinRecord = {addToken(lineTokens[1]), addToken(lineTokens[3]), addToken(netName), -1,
+                                             lineTokens[5] == "IN"};
+                if (netName != "drivepin=>") // otherwise, not connected
+                {
+                    assert(tokenNum >= 10 && lineTokens[9] != "");
+                    std::string_view drivepinName = lineTokens[9];
+                    if (netName.size() >= 9 && netName.substr(netName.size() - 9) == "/<const0>")
+                        drivepinName = "<const0>";
+                    if (netName.size() >= 9 && netName.substr(netName.size() - 9) == "/<const1>")
+                        drivepinName = "<const1>";
+                    // don't use the net name, which has aliases in Vivado, otherwise will fail to map
+                    pinRecord.netNameId = addToken(drivepinName);
+                }
+                chunk.pinRecords.push_back(pinRecord);
+            }
+            // curCell=> <cell> type=> <type>
+            else if (lineTokens[0].find("curCell=>") != std::string_view::npos)
+            {
+                assert(tokenNum >= 4);
+                if (chunk.cellRecords.size())
+                    chunk.cellRecords.back().pinEnd = chunk.pinRecords.size();
+                chunk.cellRecords.push_back(
+                    {addToken(lineTokens[1]), addToken(lineTokens[3]), (int32_t)chunk.pinRecords.size(), 0});
+            }
+            else
+                assert(false && "Parser Error");
+        }
+        if (chunk.cellRecords.size())
+            chunk.cellRecords.back().pinEnd = chunk.pinRecords.size();
+        chunk.tokenStrIds.resize(chunk.tokens.size());
+    }
+
+    // intern the tokens shard by shard. The tokens of a shard are interned in the order of the file.
+    int shardNum = stringInterner.getShardNum();
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int shardId = 0; shardId < shardNum; shardId++)
+    {
+        for (auto &chunk : chunks)
+        {
+            for (int32_t tokenId : chunk.shardTokenIds[shardId])
+                chunk.tokenStrIds[tokenId] = stringInterner.intern(shardId, chunk.tokens[tokenId]);
+        }
+    }
+    stringInterner.finalize();
+    std::string().swap(content);
+
+    int32_t cellNum = 0, pinNum = 0;
+    for (auto &chunk : chunks)
+    {
+        chunk.cellBase = cellNum;
+        chunk.pinBase = pinNum;
+        cellNum += chunk.cellRecords.size();
+        pinNum += chunk.pinRecords.size();
+    }
+    cellRecords.resize(cellNum);
+    pinRecords.resize(pinNum);
+
+    // fix up the token ids to the dense string ids and the pin ranges to the global ones
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int chunkId = 0; chunkId < chunkNum; chunkId++)
+    {
+        DesignTextChunk &chunk = chunks[chunkId];
+        auto getStrId = [&chunk, &stringInterner](int32_t tokenId) -> int32_t {
+            return stringInterner.getDenseId(chunk.tokenStrIds[tokenId]);
+        };
+        for (size_t i = 0; i < chunk.cellRecords.size(); i++)
+        {
+            const DesignCellRecord &cellRecord = chunk.cellRecords[i];
+            cellRecords[chunk.cellBase + i] = {getStrId(cellRecord.nameId), getStrId(cellRecord.typeId),
+                                               cellRecord.pinBegin + chunk.pinBase, cellRecord.pinEnd + chunk.pinBase};
+        }
+        for (size_t i = 0; i < chunk.pinRecords.size(); i++)
+        {
+            const DesignPinRecord &pinRecord = chunk.pinRecords[i];
+            pinRecords[chunk.pinBase + i] = {getStrId(pinRecord.nameId), getStrId(pinRecord.refPinNameId),
+                                             getStrId(pinRecord.aliasNetNameId),
+                                             pinRecord.netNameId < 0 ? -1 : getStrId(pinRecord.netNameId),
+                                             pinRecord.isInput};
+        }
+        std::vector<std::vector<int32_t>>().swap(chunk.shardTokenIds);
+        std::vector<std::string_view>().swap(chunk.tokens);
+        std::vector<int32_t>().swap(chunk.tokenStrIds);
+    }
+    chunks.clear();
+
+    std::vector<uint64_t> strOffsets;
+    std::vector<char> strChars;
+    stringInterner.exportStringTable(strOffsets, strChars);
+    stringTable.adoptStringTable(std::move(strOffsets), std::move(strChars));
+}
+
+template <typename StrGetter>
+void DesignInfo::loadDesignFromRecords(const DesignCellRecord *cellRecords, size_t cellNum,
+                                       const DesignPinRecord *pinRecords, size_t strNum, StrGetter getStr)
+{
+    // the nets/alias nets are found by the ids of their names in the string table instead of the name maps
+    std::vector<DesignNet *> strId2Net(strNum, nullptr);
+    std::vector<int> strId2AliasNetId(strNum, -1);
+
+    std::string cellType, cellName, targetName, refpinname, netName, aliasNetName;
+    for (size_t cellRecordId = 0; cellRecordId < cellNum; cellRecordId++)
+    {
+        const DesignCellRecord &cellRecord = cellRecords[cellRecordId];
+        cellName = getStr(cellRecord.nameId);
+        cellType = getStr(cellRecord.typeId);
+        DesignCell *curCell = createCell(cellName, fromStringToCellType(cellName, cellType), getNumCells());
+        curCell = addCell(curCell);
+
+        for (int32_t pinRecordId = cellRecord.pinBegin; pinRecordId < cellRecord.pinEnd; pinRecordId++)
+        {
+            const DesignPinRecord &pinRecord = pinRecords[pinRecordId];
+            bool isInput = pinRecord.isInput;
+            targetName = getStr(pinRecord.nameId);
+            refpinname = getStr(pinRecord.refPinNameId);
+            DesignPin *curPin = pinArena.create(targetName, refpinname,
+                                                DesignPin::checkPinType(curCell, refpinname, isInput), isInput,
+                                                curCell, pins.size());
+            pins.push_back(curPin);
+            curCell->addPin(curPin);
+
+            int &aliasNetId = strId2AliasNetId[pinRecord.aliasNetNameId];
+            if (aliasNetId < 0)
+            {
+                aliasNetName = getStr(pinRecord.aliasNetNameId);
+                aliasNetId = aliasNet2AliasNetId.size();
+                aliasNet2AliasNetId[aliasNetName] = aliasNetId;
+            }
+            if (pinRecord.netNameId < 0)
+            {
+                curPin->updateParentCellNetInfo();
+                curPin->setUnconnected();
+                continue; // not connected
+            }
+
+            netName = getStr(pinRecord.netNameId);
+            curPin->setDriverPinName(netName); // bind to a net name first
+            curPin->connectToNetName(netName);
+
+            // update net in netlist
+            DesignNet *&curNet = strId2Net[pinRecord.netNameId];
+            if (!curNet)
+            {
+                curNet = netArena.create(netName, getNumNets());
+                netlist.push_back(curNet);
+                name2Net[netName] = curNet;
+            }
+            curNet->connectToPinName(curPin->getName());
+            curNet->connectToPinVariable(curPin);
+
+            curPin->connectToNetVariable(curNet); // bind to a net pointer
+            curPin->updateParentCellNetInfo();
+            curPin->setAliasNetId(aliasNetId);
+        }
+    }
+}
+
 void DesignInfo::loadClocks(std::string clockFileName)
 {
     std::ifstream clockFile(clockFileName);
@@ -621,7 +835,7 @@ DesignInfo::DesignCell *DesignInfo::addCell(DesignCell *curCell)
         auto existingCell = name2Cell[curCell->getName()];
         print_warning("get duplicated cells from the design archieve. Maybe bug in Vivado Tcl Libs.");
         std::cout << "duplicated cell: " << existingCell << "\n";
-        delete curCell;
+        cellArena.destroy(curCell);
         return existingCell;
     }
     cells.push_back(curCell);
@@ -26,7 +26,10 @@
 #define _DESIGNINFO
 
 #include "DeviceInfo.h"
+#include "binaryDB.h"
+#include "objectArena.h"
 #include <assert.h>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -869,13 +872,12 @@ class DesignInfo
         }
 
         /**
-         * @brief Destroy the Design Cell object and its binded DesignPin objects
+         * @brief Destroy the Design Cell object. Its binded DesignPin objects are freed with the pin arena of the
+         * design.
          *
          */
         ~DesignCell()
         {
-            for (auto pin : pinPtrs)
-                delete pin;
         }
 
         inline DesignCellType getCellType()
@@ -1432,14 +1434,24 @@ class DesignInfo
 
     ~DesignInfo()
     {
-        for (auto net : netlist)
-            delete net;
-        for (auto cell : cells)
-            delete cell;
+        // the cells/pins/nets are freed with their arenas
         for (auto CS : controlSets)
             delete CS;
     }
 
+    /**
+     * @brief create a cell in the cell arena, so the cells are laid out in the order of their ids. The cell is freed
+     * with the design information and should be added by addCell().
+     *
+     * @tparam Args
+     * @param args the arguments of the constructor of DesignCell
+     * @return DesignCell*
+     */
+    template <typename... Args> inline DesignCell *createCell(Args &&...args)
+    {
+        return cellArena.create(std::forward<Args>(args)...);
+    }
+
     /**
      * @brief bind a pin to an existing net. If the net does not exist, new one.
      *
@@ -1459,8 +1471,8 @@ class DesignInfo
     /**
      * @brief add a cell into the design information
      *
-     * @param curCell target cell
-     * @return DesignCell* if there is duplicated object, delete the new cell and return the existing object
+     * @param curCell target cell created by createCell()
+     * @return DesignCell* if there is duplicated object, destroy the new cell and return the existing object
      */
     DesignCell *addCell(DesignCell *curCell);
 
@@ -1738,6 +1750,14 @@ class DesignInfo
     }
 
   private:
+    /**
+     * @brief the arenas of the cells/pins/nets, which are bump-allocated in the order of their ids and freed en masse
+     *
+     */
+    ObjectArena<DesignCell> cellArena;
+    ObjectArena<DesignPin> pinArena;
+    ObjectArena<DesignNet> netArena;
+
     std::vector<DesignNet *> netlist;
     std::vector<DesignCell *> cells;
     std::vector<DesignPin *> pins;
@@ -1788,6 +1808,61 @@ class DesignInfo
 
     std::map<std::string, std::string> &JSONCfg;
     std::string designArchievedTextFileName;
+
+    /**
+     * @brief a cell parsed from the design information file, with the ids of its strings in the string table. Its
+     * pins are pinRecords[pinBegin, pinEnd).
+     *
+     */
+    struct DesignCellRecord
+    {
+        int32_t nameId;
+        int32_t typeId;
+        int32_t pinBegin;
+        int32_t pinEnd;
+    };
+
+    /**
+     * @brief a pin parsed from the design information file, with the ids of its strings in the string table.
+     * netNameId is the id of the name of the driver pin (used as the net name) or -1 if the pin is unconnected.
+     *
+     */
+    struct DesignPinRecord
+    {
+        int32_t nameId;
+        int32_t refPinNameId;
+        int32_t aliasNetNameId;
+        int32_t netNameId;
+        int32_t isInput;
+    };
+
+    /**
+     * @brief parse the archived design information text file into cell/pin records and an interned string table
+     *
+     * The decompressed text is split into chunks at cell lines and the chunks are parsed by multiple threads. The
+     * names are then interned into a sharded StringInterner in parallel (one shard per task) and the token ids in the
+     * records are fixed up to the dense string ids in parallel.
+     *
+     * @param cellRecords output cell records
+     * @param pinRecords output pin records
+     * @param stringTable the writer of the binary database which adopts the string table
+     */
+    void parseDesignTextFile(std::vector<DesignCellRecord> &cellRecords, std::vector<DesignPinRecord> &pinRecords,
+                             BinaryDBWriter &stringTable);
+
+    /**
+     * @brief create the cells/pins/nets of the design from the cell/pin records
+     *
+     * @tparam StrGetter the type of the function which gets a string by its id in the string table
+     * @param cellRecords
+     * @param cellNum
+     * @param pinRecords
+     * @param strNum the number of strings in the string table
+     * @param getStr
+     */
+    template <typename StrGetter>
+    void loadDesignFromRecords(const DesignCellRecord *cellRecords, size_t cellNum,
+                               const DesignPinRecord *pinRecords, size_t strNum, StrGetter getStr);
 };
 
 std::ostream &operator<<(std::ostream &os, DesignInfo::DesignCell *cell);
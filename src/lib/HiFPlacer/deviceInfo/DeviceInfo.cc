@@ -29,6 +29,13 @@
 #include <algorithm>
 #include <assert.h>
 
+/**
+ * @brief the kind tag of the binary database of device information, which should be updated when the records are
+ * changed
+ *
+ */
+const char deviceBinaryDBKind[] = "AMFDEV01";
+
 bool siteSortCmp(DeviceInfo::DeviceSite *a, DeviceInfo::DeviceSite *b)
 {
     const float eps = 1e-3;
@@ -74,6 +81,66 @@ DeviceInfo::DeviceInfo(std::map<std::string, std::string> &JSONCfg, std::string
     }
     deviceName = _deviceName;
 
+    bool useBinaryDBCache = true;
+    if (JSONCfg.find("BinaryDatabaseCache") != JSONCfg.end())
+        useBinaryDBCache = JSONCfg["BinaryDatabaseCache"] == "true";
+    std::string binaryDBCacheDir = "";
+    if (JSONCfg.find("BinaryDatabaseCacheDir") != JSONCfg.end())
+        binaryDBCacheDir = JSONCfg["BinaryDatabaseCacheDir"];
+
+    uint64_t sourceSignature = getFileSignature(deviceArchievedTextFileName);
+    std::string binaryDBFileName = getBinaryDBFileName(deviceArchievedTextFileName, binaryDBCacheDir);
+    BinaryDB binaryDB;
+    if (useBinaryDBCache && binaryDB.open(binaryDBFileName, deviceBinaryDBKind, sourceSignature))
+    {
+        print_info("load device information from binary database: " + binaryDBFileName);
+        size_t siteNum, BELNum;
+        const DeviceSiteRecord *siteRecords = binaryDB.getSection<DeviceSiteRecord>(0, siteNum);
+        const DeviceBELRecord *BELRecords = binaryDB.getSection<DeviceBELRecord>(1, BELNum);
+        loadDeviceFromRecords(siteRecords, siteNum, BELRecords, binaryDB.getStringNum(),
+                              [&binaryDB](int32_t strId) { return binaryDB.getString(strId); });
+    }
+    else
+    {
+        std::vector<DeviceSiteRecord> siteRecords;
+        std::vector<DeviceBELRecord> BELRecords;
+        BinaryDBWriter binaryDBWriter;
+        parseDeviceTextFile(siteRecords, BELRecords, binaryDBWriter);
+        // a missing source file has no signature and should not be cached
+        if (useBinaryDBCache && sourceSignature)
+        {
+            binaryDBWriter.addSection(siteRecords);
+            binaryDBWriter.addSection(BELRecords);
+            if (binaryDBWriter.write(binaryDBFileName, deviceBinaryDBKind, sourceSignature))
+                print_info("device information is compiled into binary database: " + binaryDBFileName);
+            else
+                print_warning("failed to write the binary database: " + binaryDBFileName);
+        }
+        loadDeviceFromRecords(siteRecords.data(), siteRecords.size(), BELRecords.data(),
+                              binaryDBWriter.getStringNum(),
+                              [&binaryDBWriter](int32_t strId) { return binaryDBWriter.getString(strId); });
+    }
+
+    std::sort(sites.begin(), sites.end(), siteSortCmp);
+
+    std::map<std::string, std::vector<DeviceSite *>>::iterator tmpIt;
+    for (tmpIt = siteType2Sites.begin(); tmpIt != siteType2Sites.end(); tmpIt++)
+    {
+        std::sort(tmpIt->second.begin(), tmpIt->second.end(), siteSortCmp);
+    }
+
+    loadPCIEPinOffset(specialPinOffsetFileName);
+
+    print_info("There are " + std::to_string(clockRegionNumY) + "x" + std::to_string(clockRegionNumX) +
+               "(YxX) clock regions on the device");
+
+    mapClockRegionToArray();
+    print_status("New Device Info Created.");
+}
+
+void DeviceInfo::parseDeviceTextFile(std::vector<DeviceSiteRecord> &siteRecords,
+                                     std::vector<DeviceBELRecord> &BELRecords, BinaryDBWriter &stringTable)
+{
     std::string unzipCmnd = "unzip -p " + deviceArchievedTextFileName;
     FILEbuf sbuf(popen(unzipCmnd.c_str(), "r"));
     std::istream infile(&sbuf);
@@ -105,38 +172,19 @@ DeviceInfo::DeviceInfo(std::map<std::string, std::string> &JSONCfg, std::string
         assert(coordNumbers.size() == 2);
         int clockRegionX = std::stoi(coordNumbers[0]);
         int clockRegionY = std::stoi(coordNumbers[1]);
-        if (clockRegionX + 1 > clockRegionNumX)
-            clockRegionNumX = clockRegionX + 1;
-        if (clockRegionY + 1 > clockRegionNumY)
-            clockRegionNumY = clockRegionY + 1;
-
-        std::pair<int, int> clockRegionCoord(clockRegionX, clockRegionY);
-
-        // print("site=> " + curSite.siteName
-        //       + " tile=> " + curSite.tileName
-        //       + " clockRegionName=> " + curSite.clockRegionName
-        //       + " sitetype=> " + curSite.siteType
-        //       + " tiletype=> " + curSite.tileType
-        //       + " centerx=> " + str(cx)
-        //       + " centery=> " + str(cy)
-        //       + " BELs=> " + str(curSite.BELs).replace(" ", "").replace("\'", ""), file=exportfile)
 
         if (strContains(fill0, "site=>"))
         {
-            addTile(tileName, tileType);
-            DeviceTile *curTile = name2Tile[tileName];
-
-            addSite(siteName, siteType, centerX, centerY, clockRegionX, clockRegionY, curTile);
-            DeviceSite *curSite = name2Site[siteName];
-            if (coord2ClockRegion.find(clockRegionCoord) == coord2ClockRegion.end())
-            {
-                ClockRegion *newCR = new ClockRegion(curSite);
-                coord2ClockRegion[clockRegionCoord] = newCR;
-            }
-            else
-            {
-                coord2ClockRegion[clockRegionCoord]->addSite(curSite);
-            }
+            DeviceSiteRecord siteRecord = {stringTable.internString(siteName),
+                                           stringTable.internString(tileName),
+                                           stringTable.internString(siteType),
+                                           stringTable.internString(tileType),
+                                           centerX,
+                                           centerY,
+                                           clockRegionX,
+                                           clockRegionY,
+                                           (int32_t)BELRecords.size(),
+                                           0};
             strBELs = strBELs.substr(1, strBELs.size() - 2); // remove [] in string
             std::vector<std::string> BELnames;
             strSplit(strBELs, BELnames, ",");
@@ -145,28 +193,66 @@ DeviceInfo::DeviceInfo(std::map<std::string, std::string> &JSONCfg, std::string
             {
                 std::vector<std::string> splitedName;
                 strSplit(BELname, splitedName, "/");
-                addBEL(BELname, splitedName[1], curSite);
+                BELRecords.push_back({stringTable.internString(BELname), stringTable.internString(splitedName[1])});
             }
+            siteRecord.BELEnd = BELRecords.size();
+            siteRecords.push_back(siteRecord);
         }
         else
             assert(false && "Parser Error");
     }
+}
 
-    std::sort(sites.begin(), sites.end(), siteSortCmp);
+template <typename StrGetter>
+void DeviceInfo::loadDeviceFromRecords(const DeviceSiteRecord *siteRecords, size_t siteNum,
+                                       const DeviceBELRecord *BELRecords, size_t strNum, StrGetter getStr)
+{
+    // the tiles are found by the ids of their names in the string table instead of the name map
+    std::vector<DeviceTile *> strId2Tile(strNum, nullptr);
 
-    std::map<std::string, std::vector<DeviceSite *>>::iterator tmpIt;
-    for (tmpIt = siteType2Sites.begin(); tmpIt != siteType2Sites.end(); tmpIt++)
+    std::string siteName, tileName, siteType, tileType, BELName, BELType;
+    for (size_t siteRecordId = 0; siteRecordId < siteNum; siteRecordId++)
     {
-        std::sort(tmpIt->second.begin(), tmpIt->second.end(), siteSortCmp);
-    }
+        const DeviceSiteRecord &siteRecord = siteRecords[siteRecordId];
+        siteName = getStr(siteRecord.nameId);
+        siteType = getStr(siteRecord.siteTypeId);
+        int clockRegionX = siteRecord.clockRegionX;
+        int clockRegionY = siteRecord.clockRegionY;
+        if (clockRegionX + 1 > clockRegionNumX)
+            clockRegionNumX = clockRegionX + 1;
+        if (clockRegionY + 1 > clockRegionNumY)
+            clockRegionNumY = clockRegionY + 1;
 
-    loadPCIEPinOffset(specialPinOffsetFileName);
+        std::pair<int, int> clockRegionCoord(clockRegionX, clockRegionY);
 
-    print_info("There are " + std::to_string(clockRegionNumY) + "x" + std::to_string(clockRegionNumX) +
-               "(YxX) clock regions on the device");
+        DeviceTile *&curTile = strId2Tile[siteRecord.tileNameId];
+        if (!curTile)
+        {
+            tileName = getStr(siteRecord.tileNameId);
+            tileType = getStr(siteRecord.tileTypeId);
+            addTile(tileName, tileType);
+            curTile = name2Tile[tileName];
+        }
 
-    mapClockRegionToArray();
-    print_status("New Device Info Created.");
+        addSite(siteName, siteType, siteRecord.centerX, siteRecord.centerY, clockRegionX, clockRegionY, curTile);
+        DeviceSite *curSite = sites.back();
+        if (coord2ClockRegion.find(clockRegionCoord) == coord2ClockRegion.end())
+        {
+            ClockRegion *newCR = new ClockRegion(curSite);
+            coord2ClockRegion[clockRegionCoord] = newCR;
+        }
+        else
+        {
+            coord2ClockRegion[clockRegionCoord]->addSite(curSite);
+        }
+
+        for (int32_t BELRecordId = siteRecord.BELBegin; BELRecordId < siteRecord.BELEnd; BELRecordId++)
+        {
+            BELName = getStr(BELRecords[BELRecordId].nameId);
+            BELType = getStr(BELRecords[BELRecordId].typeId);
+            addBEL(BELName, BELType, curSite);
+        }
+    }
 }
 
 void DeviceInfo::mapClockRegionToArray()
@@ -519,7 +605,7 @@ void DeviceInfo::addBEL(std::string &BELName, std::string &BELType, DeviceSite *
 {
     assert(name2BEL.find(BELName) == name2BEL.end());
 
-    DeviceBEL *newBEL = new DeviceBEL(BELName, BELType, parent, parent->getChildrenSites().size());
+    DeviceBEL *newBEL = BELArena.create(BELName, BELType, parent, parent->getChildrenSites().size());
     BELs.push_back(newBEL);
     name2BEL[BELName] = newBEL;
 
@@ -537,8 +623,8 @@ void DeviceInfo::addSite(std::string &siteName, std::string &siteType, float loc
 {
     assert(name2Site.find(siteName) == name2Site.end());
 
-    DeviceSite *newSite = new DeviceSite(siteName, siteType, parentTile, locx, locy, clockRegionX, clockRegionY,
-                                         parentTile->getChildrenSites().size());
+    DeviceSite *newSite = siteArena.create(siteName, siteType, parentTile, locx, locy, clockRegionX, clockRegionY,
+                                           parentTile->getChildrenSites().size());
     sites.push_back(newSite);
     name2Site[siteName] = newSite;
 
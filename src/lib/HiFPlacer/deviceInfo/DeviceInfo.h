@@ -25,6 +25,8 @@
 #ifndef _DeviceINFO
 #define _DeviceINFO
 
+#include "binaryDB.h"
+#include "objectArena.h"
 #include "strPrint.h"
 #include <assert.h>
 #include <fstream>
@@ -914,10 +916,7 @@ class DeviceInfo
     DeviceInfo(std::map<std::string, std::string> &JSONCfg, std::string _deviceName);
     ~DeviceInfo()
     {
-        for (auto bel : BELs)
-            delete bel;
-        for (auto site : sites)
-            delete site;
+        // the BELs/sites are freed with their arenas
         for (auto tile : tiles)
             delete tile;
     }
@@ -1269,6 +1268,13 @@ class DeviceInfo
     }
 
   private:
+    /**
+     * @brief the arenas of the BELs/sites, which are bump-allocated in the order of their ids and freed en masse
+     *
+     */
+    ObjectArena<DeviceBEL> BELArena;
+    ObjectArena<DeviceSite> siteArena;
+
     std::string deviceName;
     std::set<std::string> BELTypes;
     std::map<std::string, std::vector<DeviceBEL *>> BELType2BELs;
@@ -1301,6 +1307,55 @@ class DeviceInfo
     float boundaryTolerance = 0.5;
     int clockRegionNumX = 1;
     int clockRegionNumY = 1;
+
+    /**
+     * @brief a site parsed from the device information file, with the ids of its strings in the string table. Its
+     * BELs are BELRecords[BELBegin, BELEnd).
+     *
+     */
+    struct DeviceSiteRecord
+    {
+        int32_t nameId;
+        int32_t tileNameId;
+        int32_t siteTypeId;
+        int32_t tileTypeId;
+        float centerX;
+        float centerY;
+        int32_t clockRegionX;
+        int32_t clockRegionY;
+        int32_t BELBegin;
+        int32_t BELEnd;
+    };
+
+    struct DeviceBELRecord
+    {
+        int32_t nameId;
+        int32_t typeId;
+    };
+
+    /**
+     * @brief parse the archived device information text file into site/BEL records and an interned string table
+     *
+     * @param siteRecords output site records
+     * @param BELRecords output BEL records
+     * @param stringTable the writer of the binary database which interns the strings
+     */
+    void parseDeviceTextFile(std::vector<DeviceSiteRecord> &siteRecords, std::vector<DeviceBELRecord> &BELRecords,
+                             BinaryDBWriter &stringTable);
+
+    /**
+     * @brief create the tiles/sites/BELs/clock regions of the device from the site/BEL records
+     *
+     * @tparam StrGetter the type of the function which gets a string by its id in the string table
+     * @param siteRecords
+     * @param siteNum
+     * @param BELRecords
+     * @param strNum the number of strings in the string table
+     * @param getStr
+     */
+    template <typename StrGetter>
+    void loadDeviceFromRecords(const DeviceSiteRecord *siteRecords, size_t siteNum, const DeviceBELRecord *BELRecords,
+                               size_t strNum, StrGetter getStr);
 };
 
 #endif
\ No newline at end of file
@@ -48,6 +48,8 @@ ClusterPlacer::ClusterPlacer(PlacementInfo *placementInfo, std::map<std::string,
         jobs = 1;
     }
 
+    randomSeed = RandomStream::getSeedFromConfig(JSONCfg);
+
     clockRegionXNum = std::stoi(JSONCfg["clockRegionXNum"]);
     clockRegionYNum = std::stoi(JSONCfg["clockRegionYNum"]);
 
@@ -55,6 +57,20 @@ ClusterPlacer::ClusterPlacer(PlacementInfo *placementInfo, std::map<std::string,
     {
         randomInitialPlacement = JSONCfg["RandomInitialPlacement"] == "true";
     }
+
+    if (JSONCfg.find("HypergraphPartitioner") != JSONCfg.end())
+    {
+        if (JSONCfg["HypergraphPartitioner"] == "PaToH")
+        {
+            useExternalPartitioner = true;
+        }
+        else if (JSONCfg["HypergraphPartitioner"] != "native")
+        {
+            print_error("undefined hypergraph partitioner: " + JSONCfg["HypergraphPartitioner"] +
+                        ". (should be native or PaToH)");
+            assert(false);
+        }
+    }
 }
 
 void ClusterPlacer::ClusterPlacement()
@@ -78,7 +94,7 @@ void ClusterPlacer::ClusterPlacement()
     }
     else
     {
-        srandom(20213654);
+        randomStream.reseed(randomSeed, 0, RandomStream::StreamDomain_ClusterPlacer);
         for (auto curPU : placementInfo->getPlacementUnits())
         {
             if (!curPU->isFixed())
@@ -205,12 +221,12 @@ void ClusterPlacer::createLongPathClusterUnits()
 
                     if (!PUInPath->isFixed())
                     {
-                        if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(PUInPath))
+                        if (auto unpackedCell = PlacementInfo::asUnpackedCell(PUInPath))
                         {
                             int cellId = unpackedCell->getCell()->getCellId();
                             extractedCellIds.insert(cellId);
                         }
-                        else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(PUInPath))
+                        else if (auto curMacro = PlacementInfo::asMacro(PUInPath))
                         {
                             for (auto tmpCell : curMacro->getCells())
                             {
@@ -341,6 +357,8 @@ void ClusterPlacer::basicPartitioning(int minClusterCellNum, int eachClusterDSPN
         new GraphPartitioner<std::vector<PlacementInfo::PlacementUnit *>, std::vector<PlacementInfo::PlacementNet *>>(
             placementInfo->getPlacementUnits(), placementInfo->getPlacementNets(), minClusterCellNum, jobs, verbose);
     basicGraphPartitioner->setMaxCutRate(maxMinCutRate);
+    basicGraphPartitioner->setUseExternalPartitioner(useExternalPartitioner);
+    basicGraphPartitioner->setRandomSeed(randomSeed);
     basicGraphPartitioner->solve(eachClusterDSPNum, eachClusterBRAMNum);
     clusters = basicGraphPartitioner->getClustersPUIdSets();
     delete basicGraphPartitioner;
@@ -366,6 +384,8 @@ void ClusterPlacer::userDefinedClusterBasedPartitioning(int minClusterCellNum, i
         new GraphPartitioner<std::vector<PlacementInfo::ClusterUnit *>, std::vector<PlacementInfo::ClusterNet *>>(
             clusterUnits, clusterNets, minClusterCellNum, jobs, verbose);
     userDefinedClusterBasedGraphPartitioner->setMaxCutRate(maxMinCutRate);
+    userDefinedClusterBasedGraphPartitioner->setUseExternalPartitioner(useExternalPartitioner);
+    userDefinedClusterBasedGraphPartitioner->setRandomSeed(randomSeed);
     userDefinedClusterBasedGraphPartitioner->solve(eachClusterDSPNum, eachClusterBRAMNum);
     clusters = userDefinedClusterBasedGraphPartitioner->getClustersPUIdSets();
     delete userDefinedClusterBasedGraphPartitioner;
@@ -422,6 +442,8 @@ void ClusterPlacer::clockBasedPartitioning(int minClusterCellNum, int eachCluste
         new GraphPartitioner<std::vector<PlacementInfo::ClusterUnit *>, std::vector<PlacementInfo::ClusterNet *>>(
             clusterUnits, clusterNets, minClusterCellNum, jobs, verbose);
     clockBasedGraphPartitioner->setMaxCutRate(maxMinCutRate);
+    clockBasedGraphPartitioner->setUseExternalPartitioner(useExternalPartitioner);
+    clockBasedGraphPartitioner->setRandomSeed(randomSeed);
     clockBasedGraphPartitioner->solve(eachClusterDSPNum, eachClusterBRAMNum);
     clusters = clockBasedGraphPartitioner->getClustersPUIdSets();
     delete clockBasedGraphPartitioner;
@@ -539,7 +561,7 @@ bool ClusterPlacer::isClustersToLarges()
         int cellsinCluster = 0;
         for (int PUId : cluster)
         {
-            if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(PUs[PUId]))
+            if (auto curMacro = PlacementInfo::asMacro(PUs[PUId]))
             {
                 for (auto tmpCell : curMacro->getCells())
                 {
@@ -547,7 +569,7 @@ bool ClusterPlacer::isClustersToLarges()
                     BRAMNum += tmpCell->isBRAM();
                 }
             }
-            else if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(PUs[PUId]))
+            else if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(PUs[PUId]))
             {
                 DSPNum += curUnpackedCell->getCell()->isDSP();
                 BRAMNum += curUnpackedCell->getCell()->isBRAM();
@@ -572,11 +594,11 @@ bool ClusterPlacer::isClustersToLarges()
 
 bool containIOCells(PlacementInfo::PlacementUnit *curPU)
 {
-    if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+    if (auto unpackedCell = PlacementInfo::asUnpackedCell(curPU))
     {
         return unpackedCell->getCell()->isIO();
     }
-    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+    else if (auto curMacro = PlacementInfo::asMacro(curPU))
     {
         for (auto tmpCell : curMacro->getCells())
         {
@@ -727,7 +749,7 @@ void ClusterPlacer::placeClusters()
     // SA-based cluster placement
     saPlacer = new SAPlacer("ClusterSA", clusterAdjMat, clusterCLBCellWeights, cluster2FixedUnitMat, fixedX, fixedY,
                             gridH, gridW, deviceH, deviceW, connectionToFixedFactor, y2xRatio * 0.8, SAIterNum, jobs,
-                            restartNum, verbose);
+                            restartNum, verbose, randomSeed);
     saPlacer->solve();
     cluster2XY = saPlacer->getCluster2XY();
 
@@ -790,16 +812,14 @@ void ClusterPlacer::dumpClusters()
             outfile0 << "highlight -color_index " << (cluster_id) % 20 + 1 << "  [get_cells {";
             for (int id : clusters[cluster_id])
             {
-                if (auto tmpMacro =
-                        dynamic_cast<PlacementInfo::PlacementMacro *>(placementInfo->getPlacementUnits()[id]))
+                if (auto tmpMacro = PlacementInfo::asMacro(placementInfo->getPlacementUnits()[id]))
                 {
                     for (auto cell : tmpMacro->getCells())
                     {
                         outfile0 << cell->getName() << " ";
                     }
                 }
-                else if (auto tmpUnpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(
-                             placementInfo->getPlacementUnits()[id]))
+                else if (auto tmpUnpacked = PlacementInfo::asUnpackedCell(placementInfo->getPlacementUnits()[id]))
                 {
                     outfile0 << tmpUnpacked->getName() << " ";
                 }
@@ -816,16 +836,14 @@ void ClusterPlacer::dumpClusters()
         {
             for (int id : clusters[cluster_id])
             {
-                if (auto tmpMacro =
-                        dynamic_cast<PlacementInfo::PlacementMacro *>(placementInfo->getPlacementUnits()[id]))
+                if (auto tmpMacro = PlacementInfo::asMacro(placementInfo->getPlacementUnits()[id]))
                 {
                     for (auto cell : tmpMacro->getCells())
                     {
                         outfile0 << cell->getName() << " ";
                     }
                 }
-                else if (auto tmpUnpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(
-                             placementInfo->getPlacementUnits()[id]))
+                else if (auto tmpUnpacked = PlacementInfo::asUnpackedCell(placementInfo->getPlacementUnits()[id]))
                 {
                     outfile0 << tmpUnpacked->getName() << " ";
                 }
@@ -32,6 +32,7 @@
 #include "GraphPartitioner.h"
 #include "PlacementInfo.h"
 #include "SAPlacer.h"
+#include "randomStream.h"
 #include "sysInfo.h"
 #include <assert.h>
 #include <fstream>
@@ -130,6 +131,12 @@ class ClusterPlacer
      */
     double maxMinCutRate = 0.0333;
 
+    /**
+     * @brief use the external PaToH-based executable instead of the in-process multilevel partitioner
+     *
+     */
+    bool useExternalPartitioner = false;
+
     /**
      * @brief mapping cluster id to X/Y location in the cluster bin
      *
@@ -167,6 +174,18 @@ class ClusterPlacer
      */
     int jobs;
 
+    /**
+     * @brief the seed of the random streams used by the cluster placement
+     *
+     */
+    uint64_t randomSeed;
+
+    /**
+     * @brief the random stream for the random initial placement
+     *
+     */
+    RandomStream randomStream;
+
     /**
      * @brief simulated-annealing placer for the cluster placement.
      *
@@ -341,13 +360,13 @@ class ClusterPlacer
     {
 
         auto &timingNodes = placementInfo->getTimingInfo()->getSimplePlacementTimingInfo();
-        if (auto unpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+        if (auto unpacked = PlacementInfo::asUnpackedCell(curPU))
         {
             if (unpacked->getCell()->isVirtualCell())
                 return 0;
             return timingNodes[unpacked->getCell()->getCellId()]->getLongestPathLength();
         }
-        else if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+        else if (auto tmpMacro = PlacementInfo::asMacro(curPU))
         {
             int maxLen = 0;
             for (auto tmpCell : tmpMacro->getCells())
@@ -365,7 +384,7 @@ class ClusterPlacer
 
     inline float random_float(float min, float max)
     {
-        return ((float)random() / RAND_MAX) * (max - min) + min;
+        return randomStream.uniformFloat(min, max);
     }
 
     void dumpClusters();
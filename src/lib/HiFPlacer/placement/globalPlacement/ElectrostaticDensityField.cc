@@ -0,0 +1,263 @@
+/**
+ * @file ElectrostaticDensityField.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the ElectrostaticDensityField which solves the
+ * electrostatic field of the placement density with spectral (FFT-based) method.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ElectrostaticDensityField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+ElectrostaticDensityField::ElectrostaticDensityField(float left, float bottom, float right, float top, int binNumX,
+                                                     int binNumY)
+    : left(left), bottom(bottom), right(right), top(top), binNumX(binNumX), binNumY(binNumY)
+{
+    assert(binNumX > 0 && (binNumX & (binNumX - 1)) == 0 && "binNumX should be a power of 2");
+    assert(binNumY > 0 && (binNumY & (binNumY - 1)) == 0 && "binNumY should be a power of 2");
+    assert(right > left && top > bottom);
+    binWidth = (right - left) / binNumX;
+    binHeight = (top - bottom) / binNumY;
+    charges.resize(binNumX * binNumY, 0);
+    fieldX.resize(binNumX * binNumY, 0);
+    fieldY.resize(binNumX * binNumY, 0);
+    coefficients.resize(binNumX * binNumY, 0);
+}
+
+void ElectrostaticDensityField::resetCharge()
+{
+    std::fill(charges.begin(), charges.end(), 0);
+}
+
+void ElectrostaticDensityField::addPointCharge(float x, float y, float amount)
+{
+    int i0, j0;
+    float tx, ty;
+    getBilinearWeights(x, y, i0, j0, tx, ty);
+    int i1 = std::min(i0 + 1, binNumX - 1);
+    int j1 = std::min(j0 + 1, binNumY - 1);
+    charges[j0 * binNumX + i0] += amount * (1 - tx) * (1 - ty);
+    charges[j0 * binNumX + i1] += amount * tx * (1 - ty);
+    charges[j1 * binNumX + i0] += amount * (1 - tx) * ty;
+    charges[j1 * binNumX + i1] += amount * tx * ty;
+}
+
+void ElectrostaticDensityField::addRectangleCharge(float rectLeft, float rectBottom, float rectRight, float rectTop,
+                                                   float amount)
+{
+    rectLeft = std::max(rectLeft, left);
+    rectBottom = std::max(rectBottom, bottom);
+    rectRight = std::min(rectRight, right);
+    rectTop = std::min(rectTop, top);
+    float area = (rectRight - rectLeft) * (rectTop - rectBottom);
+    if (rectRight <= rectLeft || rectTop <= rectBottom || area <= 0)
+        return;
+
+    int iBegin = std::max(0, (int)((rectLeft - left) / binWidth));
+    int iEnd = std::min(binNumX - 1, (int)((rectRight - left) / binWidth));
+    int jBegin = std::max(0, (int)((rectBottom - bottom) / binHeight));
+    int jEnd = std::min(binNumY - 1, (int)((rectTop - bottom) / binHeight));
+    for (int j = jBegin; j <= jEnd; j++)
+    {
+        float binBottom = bottom + j * binHeight;
+        float overlapY = std::min(rectTop, binBottom + binHeight) - std::max(rectBottom, binBottom);
+        if (overlapY <= 0)
+            continue;
+        for (int i = iBegin; i <= iEnd; i++)
+        {
+            float binLeft = left + i * binWidth;
+            float overlapX = std::min(rectRight, binLeft + binWidth) - std::max(rectLeft, binLeft);
+            if (overlapX <= 0)
+                continue;
+            charges[j * binNumX + i] += amount * overlapX * overlapY / area;
+        }
+    }
+}
+
+void ElectrostaticDensityField::FFT(std::vector<std::complex<double>> &data, bool inverse)
+{
+    int n = data.size();
+    assert((n & (n - 1)) == 0);
+    for (int i = 1, j = 0; i < n; i++)
+    {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+    for (int len = 2; len <= n; len <<= 1)
+    {
+        double angle = 2 * M_PI / len * (inverse ? 1 : -1);
+        std::complex<double> wLen(std::cos(angle), std::sin(angle));
+        for (int i = 0; i < n; i += len)
+        {
+            std::complex<double> w(1);
+            for (int k = 0; k < len / 2; k++)
+            {
+                std::complex<double> u = data[i + k];
+                std::complex<double> v = data[i + k + len / 2] * w;
+                data[i + k] = u + v;
+                data[i + k + len / 2] = u - v;
+                w *= wLen;
+            }
+        }
+    }
+}
+
+void ElectrostaticDensityField::DCT(std::vector<double> &x, std::vector<std::complex<double>> &buffer)
+{
+    // Makhoul's method: reorder x into v (v_m = x_2m, v_{N-1-m} = x_2m+1), then
+    // X_k = Re( exp(-i pi k / 2N) * sum_m v_m exp(-2 pi i m k / N) )
+    int n = x.size();
+    buffer.resize(n);
+    for (int m = 0; m < n / 2; m++)
+    {
+        buffer[m] = x[2 * m];
+        buffer[n - 1 - m] = x[2 * m + 1];
+    }
+    if (n == 1)
+        buffer[0] = x[0];
+    FFT(buffer, false);
+    for (int k = 0; k < n; k++)
+        x[k] = (buffer[k] * std::polar(1.0, -M_PI * k / (2 * n))).real();
+}
+
+void ElectrostaticDensityField::synthesize(const std::vector<double> &c, std::vector<double> *cosPart,
+                                           std::vector<double> *sinPart, std::vector<std::complex<double>> &buffer)
+{
+    // with G_m = sum_k (c_k exp(i pi k / 2N)) exp(2 pi i m k / N), the cos part is y_2m = Re(G_m) and
+    // y_2m+1 = Re(G_{N-1-m}), and the sin part is z_2m = Im(G_m) and z_2m+1 = -Im(G_{N-1-m})
+    int n = c.size();
+    buffer.resize(n);
+    for (int k = 0; k < n; k++)
+        buffer[k] = c[k] * std::polar(1.0, M_PI * k / (2 * n));
+    FFT(buffer, true);
+    if (n == 1)
+    {
+        if (cosPart)
+            cosPart->assign(1, buffer[0].real());
+        if (sinPart)
+            sinPart->assign(1, buffer[0].imag());
+        return;
+    }
+    if (cosPart)
+    {
+        cosPart->resize(n);
+        for (int m = 0; m < n / 2; m++)
+        {
+            (*cosPart)[2 * m] = buffer[m].real();
+            (*cosPart)[2 * m + 1] = buffer[n - 1 - m].real();
+        }
+    }
+    if (sinPart)
+    {
+        sinPart->resize(n);
+        for (int m = 0; m < n / 2; m++)
+        {
+            (*sinPart)[2 * m] = buffer[m].imag();
+            (*sinPart)[2 * m + 1] = -buffer[n - 1 - m].imag();
+        }
+    }
+}
+
+void ElectrostaticDensityField::solveField()
+{
+    // charge density rho = sum_{u,v} a_uv cos(w_u x) cos(w_v y), where w_u = pi u / width and w_v = pi v / height.
+    // Poisson's equation (laplacian(psi) = -rho) gives psi = sum a_uv / (w_u^2 + w_v^2) cos(w_u x) cos(w_v y) and
+    // the field E = -grad(psi) is
+    // Ex = sum a_uv w_u / (w_u^2 + w_v^2) sin(w_u x) cos(w_v y)
+    // Ey = sum a_uv w_v / (w_u^2 + w_v^2) cos(w_u x) sin(w_v y)
+
+    double binArea = binWidth * binHeight;
+
+    // DCT along X for each row, then along Y for each column
+#pragma omp parallel
+    {
+        std::vector<double> line;
+        std::vector<std::complex<double>> buffer;
+#pragma omp for
+        for (int j = 0; j < binNumY; j++)
+        {
+            line.assign(charges.begin() + j * binNumX, charges.begin() + (j + 1) * binNumX);
+            DCT(line, buffer);
+            for (int u = 0; u < binNumX; u++)
+                coefficients[j * binNumX + u] = line[u] / binArea * (u == 0 ? 1.0 : 2.0) / binNumX;
+        }
+#pragma omp for
+        for (int u = 0; u < binNumX; u++)
+        {
+            line.resize(binNumY);
+            for (int j = 0; j < binNumY; j++)
+                line[j] = coefficients[j * binNumX + u];
+            DCT(line, buffer);
+            for (int v = 0; v < binNumY; v++)
+                coefficients[v * binNumX + u] = line[v] * (v == 0 ? 1.0 : 2.0) / binNumY;
+        }
+    }
+
+    double width = right - left;
+    double height = top - bottom;
+    std::vector<double> tmpFieldX(binNumX * binNumY), tmpFieldY(binNumX * binNumY);
+
+    // synthesis along Y for each column u, then along X for each row j
+#pragma omp parallel
+    {
+        std::vector<double> coeffX, coeffY, outX, outY;
+        std::vector<std::complex<double>> buffer;
+#pragma omp for
+        for (int u = 0; u < binNumX; u++)
+        {
+            double wu = M_PI * u / width;
+            coeffX.assign(binNumY, 0);
+            coeffY.assign(binNumY, 0);
+            for (int v = 0; v < binNumY; v++)
+            {
+                if (u == 0 && v == 0)
+                    continue;
+                double wv = M_PI * v / height;
+                double a = coefficients[v * binNumX + u] / (wu * wu + wv * wv);
+                coeffX[v] = a * wu;
+                coeffY[v] = a * wv;
+            }
+            synthesize(coeffX, &outX, nullptr, buffer);
+            synthesize(coeffY, nullptr, &outY, buffer);
+            for (int j = 0; j < binNumY; j++)
+            {
+                tmpFieldX[j * binNumX + u] = outX[j];
+                tmpFieldY[j * binNumX + u] = outY[j];
+            }
+        }
+#pragma omp for
+        for (int j = 0; j < binNumY; j++)
+        {
+            coeffX.assign(tmpFieldX.begin() + j * binNumX, tmpFieldX.begin() + (j + 1) * binNumX);
+            coeffY.assign(tmpFieldY.begin() + j * binNumX, tmpFieldY.begin() + (j + 1) * binNumX);
+            synthesize(coeffX, nullptr, &outX, buffer);
+            synthesize(coeffY, &outY, nullptr, buffer);
+            std::copy(outX.begin(), outX.end(), fieldX.begin() + j * binNumX);
+            std::copy(outY.begin(), outY.end(), fieldY.begin() + j * binNumX);
+        }
+    }
+}
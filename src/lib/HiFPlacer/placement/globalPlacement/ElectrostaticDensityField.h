@@ -0,0 +1,205 @@
+/**
+ * @file ElectrostaticDensityField.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of ElectrostaticDensityField class and its internal modules and
+ * APIs which solve the electrostatic field of the placement density with spectral (FFT-based) method.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _ELECTROSTATICDENSITYFIELD
+#define _ELECTROSTATICDENSITYFIELD
+
+#include <assert.h>
+#include <complex>
+#include <vector>
+
+/**
+ * @brief ElectrostaticDensityField models the placement density as electric charges on a regular grid and solves the
+ * electric potential/field by Poisson's equation with Neumann boundary condition (ePlace).
+ *
+ * The charges are spread to the grid with bilinear (cloud-in-cell) weights and the field is sampled with the same
+ * weights, so the gradient of the density energy is consistent with the charges. The Poisson's equation is solved by
+ * DCT/DST, which are computed by radix-2 complex FFT. Therefore, the numbers of bins in both directions should be
+ * powers of 2.
+ *
+ */
+class ElectrostaticDensityField
+{
+  public:
+    /**
+     * @brief Construct a new Electrostatic Density Field object
+     *
+     * @param left left boundary of the grid
+     * @param bottom bottom boundary of the grid
+     * @param right right boundary of the grid
+     * @param top top boundary of the grid
+     * @param binNumX the number of bin columns (power of 2)
+     * @param binNumY the number of bin rows (power of 2)
+     */
+    ElectrostaticDensityField(float left, float bottom, float right, float top, int binNumX, int binNumY);
+    ~ElectrostaticDensityField()
+    {
+    }
+
+    /**
+     * @brief clear the charges on the grid
+     *
+     */
+    void resetCharge();
+
+    /**
+     * @brief spread a point charge to the nearby 4 bins with bilinear weights
+     *
+     * @param x
+     * @param y
+     * @param amount
+     */
+    void addPointCharge(float x, float y, float amount);
+
+    /**
+     * @brief spread the charge of a rectangle to the overlapped bins according to the overlapped areas
+     *
+     * @param left
+     * @param bottom
+     * @param right
+     * @param top
+     * @param amount
+     */
+    void addRectangleCharge(float left, float bottom, float right, float top, float amount);
+
+    /**
+     * @brief solve the electric field according to the current charges
+     *
+     */
+    void solveField();
+
+    /**
+     * @brief Get the electric field at a location with bilinear interpolation
+     *
+     * @param x
+     * @param y
+     * @param Ex output electric field in X-coordinate
+     * @param Ey output electric field in Y-coordinate
+     */
+    inline void getFieldAt(float x, float y, float &Ex, float &Ey) const
+    {
+        int i0, j0;
+        float tx, ty;
+        getBilinearWeights(x, y, i0, j0, tx, ty);
+        int i1 = std::min(i0 + 1, binNumX - 1);
+        int j1 = std::min(j0 + 1, binNumY - 1);
+        float w00 = (1 - tx) * (1 - ty), w10 = tx * (1 - ty), w01 = (1 - tx) * ty, w11 = tx * ty;
+        Ex = w00 * fieldX[j0 * binNumX + i0] + w10 * fieldX[j0 * binNumX + i1] + w01 * fieldX[j1 * binNumX + i0] +
+             w11 * fieldX[j1 * binNumX + i1];
+        Ey = w00 * fieldY[j0 * binNumX + i0] + w10 * fieldY[j0 * binNumX + i1] + w01 * fieldY[j1 * binNumX + i0] +
+             w11 * fieldY[j1 * binNumX + i1];
+    }
+
+    /**
+     * @brief Get the charge map, where the charge of bin (i,j) is stored at [j * binNumX + i]
+     *
+     * @return std::vector<double>&
+     */
+    inline std::vector<double> &getCharges()
+    {
+        return charges;
+    }
+
+    inline int getBinNumX() const
+    {
+        return binNumX;
+    }
+
+    inline int getBinNumY() const
+    {
+        return binNumY;
+    }
+
+    inline float getBinWidth() const
+    {
+        return binWidth;
+    }
+
+    inline float getBinHeight() const
+    {
+        return binHeight;
+    }
+
+    /**
+     * @brief in-place radix-2 complex FFT without normalization
+     *
+     * @param data the sequence, the length of which should be a power of 2
+     * @param inverse if true, use exp(+i...) as the kernel, otherwise exp(-i...)
+     */
+    static void FFT(std::vector<std::complex<double>> &data, bool inverse);
+
+  private:
+    /**
+     * @brief get the bin and the bilinear weights of a location relative to the bin centers
+     *
+     */
+    inline void getBilinearWeights(float x, float y, int &i0, int &j0, float &tx, float &ty) const
+    {
+        float px = (x - left) / binWidth - 0.5;
+        float py = (y - bottom) / binHeight - 0.5;
+        px = std::max(0.0f, std::min(px, (float)binNumX - 1));
+        py = std::max(0.0f, std::min(py, (float)binNumY - 1));
+        i0 = std::min((int)px, binNumX - 1);
+        j0 = std::min((int)py, binNumY - 1);
+        tx = px - i0;
+        ty = py - j0;
+    }
+
+    /**
+     * @brief DCT-II analysis of a real sequence: X_k = sum_n x_n cos(pi k (2n+1) / 2N)
+     *
+     * @param x the real sequence, replaced by X
+     * @param buffer a working buffer
+     */
+    static void DCT(std::vector<double> &x, std::vector<std::complex<double>> &buffer);
+
+    /**
+     * @brief synthesis from coefficients: cos part y_n = sum_k c_k cos(pi k (2n+1) / 2N) and sin part
+     * z_n = sum_k c_k sin(pi k (2n+1) / 2N)
+     *
+     * @param c the coefficients
+     * @param cosPart output cos synthesis (can be nullptr)
+     * @param sinPart output sin synthesis (can be nullptr)
+     * @param buffer a working buffer
+     */
+    static void synthesize(const std::vector<double> &c, std::vector<double> *cosPart, std::vector<double> *sinPart,
+                           std::vector<std::complex<double>> &buffer);
+
+    float left, bottom, right, top;
+    int binNumX, binNumY;
+    float binWidth, binHeight;
+
+    std::vector<double> charges;
+    std::vector<double> fieldX;
+    std::vector<double> fieldY;
+
+    /**
+     * @brief the coefficients of the charge density in the cosine basis, stored at [v * binNumX + u]
+     *
+     */
+    std::vector<double> coefficients;
+};
+
+#endif
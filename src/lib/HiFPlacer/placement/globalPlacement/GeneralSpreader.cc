@@ -25,6 +25,7 @@
  */
 
 #include "GeneralSpreader.h"
+#include "profiler.h"
 
 #include <cmath>
 #include <omp.h>
@@ -47,11 +48,19 @@ GeneralSpreader::GeneralSpreader(PlacementInfo *placementInfo, std::map<std::str
     {
         useSimpleExpland = JSONCfg["SpreaderSimpleExpland"] == "true";
     }
+    if (JSONCfg.find("SpreaderBinarySearchExpand") != JSONCfg.end())
+    {
+        useBinarySearchExpand = JSONCfg["SpreaderBinarySearchExpand"] == "true";
+    }
+    randomStream.reseed(RandomStream::getSeedFromConfig(JSONCfg),
+                        ((uint64_t)currentIteration << 16) + placementInfo->getSharedBELTypeId(sharedCellType),
+                        RandomStream::StreamDomain_GeneralSpreader);
 }
 
 void GeneralSpreader::spreadPlacementUnits(float forgetRatio, bool enableClockRegionAware, float displacementLimit,
                                            unsigned int spreadRegionBinSizeLimit)
 {
+    ProfileZone profileZone("GeneralSpreader");
     if (verbose) // usually commented for debug
         print_status("GeneralSpreader: starts to spreadPlacementUnits for type: [" + sharedCellType + "]");
 
@@ -89,6 +98,7 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, bool enableClockRe
         findOverflowBins(capacityShrinkRatio);
         if (overflowBins.size() == 0)
             break;
+        profileCounter("bins spread", overflowBins.size());
         int totalCellNum = 0;
         for (auto curBin : overflowBins)
             totalCellNum += curBin->getCells().size();
@@ -159,51 +169,20 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, bool enableClockRe
             }
         }
 
-        // we don't need that high parallelism here since regionNum will be small in later iterations
-        // if (nJobs > 4)
-        //     omp_set_num_threads(4);
-#pragma omp parallel sections
+        if (verbose) // usually commented for debug
+            print_status("involved regions cover " + std::to_string(coveredBinSet.size()) + " bins.");
+        if (verbose)
         {
-#pragma omp section
-            {
-
-                if (verbose) // usually commented for debug
-                    print_status("involved regions cover " + std::to_string(coveredBinSet.size()) + " bins.");
-                if (verbose)
-                {
-                    print_status("GeneralSpreader: spreading cells in the regions");
-                }
+            print_status("GeneralSpreader: spreading cells in the regions");
+        }
 
-                int regionNum = expandedRegions.size();
-                if (coveredBinSet.size() > 256 && regionNum > 32)
-                {
-#pragma omp parallel for schedule(dynamic, 4)
-                    for (int regionId = 0; regionId < regionNum; regionId++)
-                    {
-                        GeneralSpreader::SpreadRegion *curRegion = expandedRegions[regionId];
-                        assert(curRegion);
-                        assert(curRegion->getCells().size() > 0);
-                        SpreadRegion::SubBox *newBox =
-                            new SpreadRegion::SubBox(placementInfo, curRegion, binGrid, capacityShrinkRatio, 100, true);
-                        newBox->spreadAndPartition();
-                        delete newBox;
-                    }
-                }
-                else
-                {
-                    for (int regionId = 0; regionId < regionNum; regionId++)
-                    {
-                        GeneralSpreader::SpreadRegion *curRegion = expandedRegions[regionId];
-                        assert(curRegion);
-                        assert(curRegion->getCells().size() > 0);
-                        SpreadRegion::SubBox *newBox =
-                            new SpreadRegion::SubBox(placementInfo, curRegion, binGrid, capacityShrinkRatio, 100, true);
-                        newBox->spreadAndPartition();
-                        delete newBox;
-                    }
-                }
-            }
-#pragma omp section
+        // the regions, the SubBoxes in the recursive bisection of large regions and the sorting of their cells are
+        // executed as tasks by a pool of worker threads, so a few huge regions can still occupy all the threads.
+        int regionNum = expandedRegions.size();
+#pragma omp parallel num_threads(std::max(nJobs, 1))
+#pragma omp single
+        {
+#pragma omp task
             {
                 if (verbose)
                     print_status("GeneralSpreader: loading involved placement units");
@@ -227,6 +206,20 @@ void GeneralSpreader::spreadPlacementUnits(float forgetRatio, bool enableClockRe
                     }
                 }
             }
+
+            for (int regionId = 0; regionId < regionNum; regionId++)
+            {
+#pragma omp task firstprivate(regionId)
+                {
+                    GeneralSpreader::SpreadRegion *curRegion = expandedRegions[regionId];
+                    assert(curRegion);
+                    assert(curRegion->getCells().size() > 0);
+                    SpreadRegion::SubBox *newBox =
+                        new SpreadRegion::SubBox(placementInfo, curRegion, binGrid, capacityShrinkRatio, 100, true);
+                    newBox->spreadAndPartition();
+                    delete newBox;
+                }
+            }
         }
 
         omp_set_num_threads(nJobs);
@@ -268,14 +261,19 @@ void GeneralSpreader::findOverflowBins(float overflowThreshold)
 {
     overflowBins.clear();
     overflowBinSet.clear();
-    for (auto &row : binGrid)
+
+    // the bins are updated independently, so the rows are handled in parallel and the overflow bins are collected in
+    // the row-major order as the serial scanning
+    int numRows = binGrid.size();
+    std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> rowOverflowBins(numRows);
+#pragma omp parallel for schedule(dynamic, 4)
+    for (int binY = 0; binY < numRows; binY++)
     {
-        for (auto curBin : row)
+        for (auto curBin : binGrid[binY])
         {
             if (curBin->isOverflow(overflowThreshold))
             {
-                overflowBins.push_back(curBin);
-                overflowBinSet.insert(curBin);
+                rowOverflowBins[binY].push_back(curBin);
                 curBin->countOverflow();
                 if (curBin->getOverflowCounter() > 5)
                 {
@@ -301,7 +299,50 @@ void GeneralSpreader::findOverflowBins(float overflowThreshold)
             }
         }
     }
+    for (auto &binsInRow : rowOverflowBins)
+    {
+        for (auto curBin : binsInRow)
+        {
+            overflowBins.push_back(curBin);
+            overflowBinSet.insert(curBin);
+        }
+    }
     sort(overflowBins.begin(), overflowBins.end(), siteSortCmp);
+
+    // the capacity of the bins might be shrunk above, so the index is built afterwards
+    densityIndex.build(binGrid);
+}
+
+void GeneralSpreader::BinDensityIndex::build(std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid)
+{
+    numRows = binGrid.size();
+    numCols = numRows ? binGrid[0].size() : 0;
+    const int rowLen = numCols + 1;
+    capacitySum.assign((numRows + 1) * rowLen, 0.0);
+    utilizationSum.assign((numRows + 1) * rowLen, 0.0);
+
+    // prefix sums along the rows and then along the columns
+#pragma omp parallel for
+    for (int binY = 0; binY < numRows; binY++)
+    {
+        assert((int)binGrid[binY].size() == numCols);
+        double *capacityRow = &capacitySum[(binY + 1) * rowLen];
+        double *utilizationRow = &utilizationSum[(binY + 1) * rowLen];
+        for (int binX = 0; binX < numCols; binX++)
+        {
+            capacityRow[binX + 1] = capacityRow[binX] + binGrid[binY][binX]->getCapacity();
+            utilizationRow[binX + 1] = utilizationRow[binX] + binGrid[binY][binX]->getUtilization();
+        }
+    }
+#pragma omp parallel for
+    for (int binX = 1; binX <= numCols; binX++)
+    {
+        for (int binY = 1; binY <= numRows; binY++)
+        {
+            capacitySum[binY * rowLen + binX] += capacitySum[(binY - 1) * rowLen + binX];
+            utilizationSum[binY * rowLen + binX] += utilizationSum[(binY - 1) * rowLen + binX];
+        }
+    }
 }
 
 void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocationsWorker(
@@ -315,7 +356,7 @@ void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocationsWorker(
     {
         assert((unsigned int)curPUID < involvedPUVec.size());
         auto curPU = involvedPUVec[curPUID];
-        if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+        if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
         {
             float cellX = curUnpackedCell->X();
             float cellY = curUnpackedCell->Y();
@@ -340,7 +381,7 @@ void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocationsWorker(
                 cellLoc[curCell->getCellId()].Y = curPU->Y();
             }
         }
-        else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+        else if (auto curMacro = PlacementInfo::asMacro(curPU))
         {
             if (curPU->isFixed() || curPU->isLocked())
             {
@@ -510,7 +551,7 @@ void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocations(
     {
         for (auto curPU : involvedPUVec)
         {
-            if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+            if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
             {
                 float cellX = curUnpackedCell->X();
                 float cellY = curUnpackedCell->Y();
@@ -537,7 +578,7 @@ void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocations(
                     cellLoc[curCell->getCellId()].Y = curPU->Y();
                 }
             }
-            else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+            else if (auto curMacro = PlacementInfo::asMacro(curPU))
             {
                 if (curPU->isFixed() || curPU->isLocked())
                 {
@@ -613,10 +654,12 @@ void GeneralSpreader::updatePlacementUnitsWithSpreadedCellLocations(
 GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::PlacementBinInfo *curBin,
                                                                float capacityShrinkRatio, unsigned int numBinThr)
 { // Our Region Expanding (1.4x faster)
-    GeneralSpreader::SpreadRegion *resRegion =
-        new GeneralSpreader::SpreadRegion(curBin, placementInfo, binGrid, capacityShrinkRatio);
+    GeneralSpreader::SpreadRegion *resRegion = new GeneralSpreader::SpreadRegion(
+        curBin, placementInfo, binGrid, capacityShrinkRatio, densityIndex, randomStream);
 
     float binUnitSize = std::min(curBin->right() - curBin->left(), curBin->top() - curBin->bottom());
+    if (useBinarySearchExpand)
+        binarySearchExpand(resRegion, curBin, capacityShrinkRatio, numBinThr);
     if (!useSimpleExpland)
     {
         while (resRegion->getOverflowRatio() > capacityShrinkRatio &&
@@ -638,6 +681,87 @@ GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::Pl
     return resRegion;
 }
 
+void GeneralSpreader::binarySearchExpand(GeneralSpreader::SpreadRegion *resRegion,
+                                         PlacementInfo::PlacementBinInfo *curBin, float capacityShrinkRatio,
+                                         unsigned int numBinThr)
+{
+    int numRows = binGrid.size();
+    int numCols = binGrid[0].size();
+    int binY = curBin->Y();
+    int binX = curBin->X();
+
+    // the window extended by k bins in the 4 directions, clipped by the boundary of the bin grid
+    auto getWindow = [&](int k, int &topY, int &bottomY, int &leftX, int &rightX) {
+        topY = std::min(binY + k, numRows - 1);
+        bottomY = std::max(binY - k, 0);
+        leftX = std::max(binX - k, 0);
+        rightX = std::min(binX + k, numCols - 1);
+    };
+
+    // a window can be taken if it does not overlap other SpreadRegions and the window before the last extension is
+    // within the bin number limit (the same as the step-by-step expansion)
+    auto isWindowAvailable = [&](int k) -> bool {
+        int topY, bottomY, leftX, rightX;
+        getWindow(k, topY, bottomY, leftX, rightX);
+        for (auto existingRegion : expandedRegions)
+        {
+            if (existingRegion->isRegionOverlap(topY, bottomY, leftX, rightX))
+                return false;
+        }
+        if (k == 0)
+            return true;
+        getWindow(k - 1, topY, bottomY, leftX, rightX);
+        return (unsigned int)((topY - bottomY + 1) * (rightX - leftX + 1)) < numBinThr;
+    };
+
+    auto isWindowResolved = [&](int k) -> bool {
+        int topY, bottomY, leftX, rightX;
+        getWindow(k, topY, bottomY, leftX, rightX);
+        return !(densityIndex.getUtilization(topY, bottomY, leftX, rightX) /
+                     densityIndex.getCapacity(topY, bottomY, leftX, rightX) >
+                 capacityShrinkRatio);
+    };
+
+    // the largest available window (the availability is monotone since the windows are nested)
+    int lowK = 0, highK = std::max(numRows, numCols);
+    assert(isWindowAvailable(0));
+    while (lowK < highK)
+    {
+        int midK = (lowK + highK + 1) / 2;
+        if (isWindowAvailable(midK))
+            lowK = midK;
+        else
+            highK = midK - 1;
+    }
+
+    // the smallest window resolving the overflow, or the largest available window if none resolves it
+    int maxK = lowK;
+    lowK = 0;
+    highK = maxK;
+    while (lowK < highK)
+    {
+        int midK = (lowK + highK) / 2;
+        if (isWindowResolved(midK))
+            highK = midK;
+        else
+            lowK = midK + 1;
+    }
+    if (highK == 0)
+        return;
+
+    // add the window around the initial bin as 4 non-overlapping rectangles
+    int topY, bottomY, leftX, rightX;
+    getWindow(highK, topY, bottomY, leftX, rightX);
+    if (leftX < binX)
+        resRegion->addBinRegion(binY, binY, leftX, binX - 1, coveredBinSet);
+    if (rightX > binX)
+        resRegion->addBinRegion(binY, binY, binX + 1, rightX, coveredBinSet);
+    if (topY > binY)
+        resRegion->addBinRegion(topY, binY + 1, leftX, rightX, coveredBinSet);
+    if (bottomY < binY)
+        resRegion->addBinRegion(binY - 1, bottomY, leftX, rightX, coveredBinSet);
+}
+
 // GeneralSpreader::SpreadRegion *GeneralSpreader::expandFromABin(PlacementInfo::PlacementBinInfo *curBin,
 //                                                                float capacityShrinkRatio)
 // { // RippleFPGA Region Expanding
@@ -689,9 +813,11 @@ void GeneralSpreader::SpreadRegion::addBinRegion(int newRegionTopBinY, int newRe
                 cellsInRegion.insert(curCell);
                 cellsInRegionVec.push_back(curCell);
             }
-            totalCapacity += binGrid[i][j]->getCapacity();
-            totalUtilization += binGrid[i][j]->getUtilization();
         }
+    totalCapacity += densityIndex.getCapacity(newRegionTopBinY, newRegionBottomBinY, newRegionLeftBinX,
+                                              newRegionRightBinX);
+    totalUtilization += densityIndex.getUtilization(newRegionTopBinY, newRegionBottomBinY, newRegionLeftBinX,
+                                                    newRegionRightBinX);
     overflowRatio = totalUtilization / totalCapacity;
 }
 
@@ -735,14 +861,17 @@ void GeneralSpreader::SpreadRegion::SubBox::spreadAndPartition()
             spreadCellsH(&boxA, &boxB);
         }
     }
+    // the SubBoxes have disjoint cells so they can be spread in parallel
     if (boxA)
     {
+#pragma omp task if (boxA->getCellNum() >= parallelCellNumThreshold)
         boxA->spreadAndPartition();
     }
     if (boxB)
     {
         boxB->spreadAndPartition();
     }
+#pragma omp taskwait
     if (boxA)
         delete boxA;
     if (boxB)
@@ -1289,7 +1418,7 @@ void GeneralSpreader::dumpLUTFFCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -1299,7 +1428,7 @@ void GeneralSpreader::dumpLUTFFCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
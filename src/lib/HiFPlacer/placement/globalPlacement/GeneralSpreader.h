@@ -32,6 +32,7 @@
 #include "PlacementInfo.h"
 #include "const.h"
 #include "dumpZip.h"
+#include "randomStream.h"
 #include <assert.h>
 #include <fstream>
 #include <iostream>
@@ -77,6 +78,85 @@ class GeneralSpreader
                               unsigned int spreadRegionBinSizeLimit = 1000000);
     void dumpLUTFFCoordinate();
 
+    /**
+     * @brief BinDensityIndex records the 2D prefix sums (summed-area tables) of the capacity and utilization of the
+     * bins in a bin grid, so the capacity and utilization of any rectangle of bins can be obtained in O(1).
+     *
+     * The index should be rebuilt whenever the capacity or the utilization of the bins is changed, i.e., once per
+     * spreading round.
+     *
+     * The sums are accumulated in double and are differences of prefix sums, so they might differ from the float
+     * summation over the bins in the last bits. Therefore, the comparisons of the density ratios against the thresholds
+     * (and the resultant SpreadRegions) are not guaranteed to be bit-identical to the summation over the bins.
+     */
+    class BinDensityIndex
+    {
+      public:
+        BinDensityIndex()
+        {
+        }
+        ~BinDensityIndex()
+        {
+        }
+
+        /**
+         * @brief build the prefix sums according to the current capacity and utilization of the bins
+         *
+         * @param binGrid the bin grid for cell spreading
+         */
+        void build(std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid);
+
+        /**
+         * @brief get the total capacity of the bins in the rectangle [bottomBinY, topBinY] x [leftBinX, rightBinX]
+         *
+         * @param topBinY
+         * @param bottomBinY
+         * @param leftBinX
+         * @param rightBinX
+         * @return float
+         */
+        inline float getCapacity(int topBinY, int bottomBinY, int leftBinX, int rightBinX)
+        {
+            return getRectSum(capacitySum, topBinY, bottomBinY, leftBinX, rightBinX);
+        }
+
+        /**
+         * @brief get the total utilization of the bins in the rectangle [bottomBinY, topBinY] x [leftBinX, rightBinX]
+         *
+         * @param topBinY
+         * @param bottomBinY
+         * @param leftBinX
+         * @param rightBinX
+         * @return float
+         */
+        inline float getUtilization(int topBinY, int bottomBinY, int leftBinX, int rightBinX)
+        {
+            return getRectSum(utilizationSum, topBinY, bottomBinY, leftBinX, rightBinX);
+        }
+
+      private:
+        inline float getRectSum(std::vector<double> &prefixSum, int topBinY, int bottomBinY, int leftBinX,
+                                int rightBinX)
+        {
+            assert(bottomBinY >= 0 && topBinY < numRows && bottomBinY <= topBinY);
+            assert(leftBinX >= 0 && rightBinX < numCols && leftBinX <= rightBinX);
+            const int rowLen = numCols + 1;
+            return prefixSum[(topBinY + 1) * rowLen + rightBinX + 1] - prefixSum[bottomBinY * rowLen + rightBinX + 1] -
+                   prefixSum[(topBinY + 1) * rowLen + leftBinX] + prefixSum[bottomBinY * rowLen + leftBinX];
+        }
+
+        int numRows = 0;
+        int numCols = 0;
+
+        /**
+         * @brief the prefix sums in (numRows + 1) x (numCols + 1) row-major layout, where prefixSum[y][x] is the sum
+         * of the bins with Y < y and X < x
+         *
+         */
+        std::vector<double> capacitySum;
+        std::vector<double> utilizationSum;
+    };
+
     /**
      * @brief SpreadRegion is an object that record cell spreading region information, including boundaries, cells,
      * bins, and spreading boxes.
@@ -93,10 +173,14 @@ class GeneralSpreader
          * @param binGrid the reference of the binGrid for cell spreading. A bin grid is used to record the density of
          * cells on the device
          * @param capacityShrinkRatio shrink the area supply to a specific ratio
+         * @param densityIndex the prefix sums of the capacity and utilization of the bins in the binGrid
+         * @param randomStream the random stream for the random choices during the expansion
          */
         SpreadRegion(PlacementInfo::PlacementBinInfo *curBin, PlacementInfo *placementInfo,
-                     std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid, float capacityShrinkRatio)
-            : placementInfo(placementInfo), binGrid(binGrid), capacityShrinkRatio(capacityShrinkRatio)
+                     std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid, float capacityShrinkRatio,
+                     BinDensityIndex &densityIndex, RandomStream &randomStream)
+            : placementInfo(placementInfo), binGrid(binGrid), densityIndex(densityIndex), randomStream(randomStream),
+              capacityShrinkRatio(capacityShrinkRatio)
         {
             topBinY = bottomBinY = curBin->Y();
             leftBinX = rightBinX = curBin->X();
@@ -319,44 +403,20 @@ class GeneralSpreader
         inline void getDirCapacityAndUtilization(int newTopBinY, int newBottomBinY, int newLeftBinX, int newRightBinX,
                                                  dirType tmpDir, float &tmpUtilization, float &tmpCapacity)
         {
-            // tmpCapacity = 0.0;
-            // tmpUtilization = 0.0;
+            // the incoming bins form a row/column strip at the expanded side
+            int stripTopBinY = newTopBinY, stripBottomBinY = newBottomBinY;
+            int stripLeftBinX = newLeftBinX, stripRightBinX = newRightBinX;
             if (tmpDir == expandUp)
-            {
-                //  for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
-                for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[newTopBinY][binX]->getCapacity();
-                    tmpUtilization += binGrid[newTopBinY][binX]->getUtilization();
-                }
-            }
+                stripBottomBinY = newTopBinY;
             else if (tmpDir == expandDown)
-            {
-                //  for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
-                for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[newBottomBinY][binX]->getCapacity();
-                    tmpUtilization += binGrid[newBottomBinY][binX]->getUtilization();
-                }
-            }
+                stripTopBinY = newBottomBinY;
             else if (tmpDir == expandLeft)
-            {
-                for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
-                //       for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[binY][newLeftBinX]->getCapacity();
-                    tmpUtilization += binGrid[binY][newLeftBinX]->getUtilization();
-                }
-            }
+                stripRightBinX = newLeftBinX;
             else if (tmpDir == expandRight)
-            {
-                for (int binY = newBottomBinY; binY <= newTopBinY; binY++)
-                //         for (int binX = newLeftBinX; binX <= newRightBinX; binX++)
-                {
-                    tmpCapacity += binGrid[binY][newRightBinX]->getCapacity();
-                    tmpUtilization += binGrid[binY][newRightBinX]->getUtilization();
-                }
-            }
+                stripLeftBinX = newRightBinX;
+            tmpCapacity += densityIndex.getCapacity(stripTopBinY, stripBottomBinY, stripLeftBinX, stripRightBinX);
+            tmpUtilization +=
+                densityIndex.getUtilization(stripTopBinY, stripBottomBinY, stripLeftBinX, stripRightBinX);
             if (tmpCapacity < 1e-5)
                 tmpCapacity = 1e-5;
             if (tmpUtilization < 1e-5)
@@ -502,7 +562,7 @@ class GeneralSpreader
                 ((hUtilization / hCapacity < 0.9 * vUtilization / vCapacity) ||
                  (std::fabs(hUtilization + vUtilization) < 1e-4 && hCapacity > vCapacity)))
             {
-                if (random() % 2)
+                if (randomStream() % 2)
                 {
                     if (expandable(0))
                     {
@@ -583,7 +643,7 @@ class GeneralSpreader
             }
             else
             {
-                if (random() % 2)
+                if (randomStream() % 2)
                 {
                     if (expandable(2))
                     {
@@ -689,7 +749,7 @@ class GeneralSpreader
         inline bool simpleFindExpandDirection(std::set<PlacementInfo::PlacementBinInfo *> &coveredBinSet)
         {
             char failureCnt = 0;
-            curDirectionIndex = random() % 4;
+            curDirectionIndex = randomStream() % 4;
             while (failureCnt < 4)
             {
 
@@ -983,9 +1043,21 @@ class GeneralSpreader
                 if (p < q)
                 {
                     pindex = RandomPivotPartition(cellIds, p, q, Xsort); // randomly choose pivot
-                    // Recursively implementing QuickSort.
-                    quick_sort(cellIds, p, pindex - 1, Xsort);
-                    quick_sort(cellIds, pindex + 1, q, Xsort);
+                    // Recursively implementing QuickSort. The two parts are disjoint so the large ones are sorted by
+                    // parallel tasks, which does not change the result. The small ones are sorted directly without
+                    // creating (undeferred) tasks and waiting for them.
+                    if (pindex - p >= parallelCellNumThreshold)
+                    {
+#pragma omp task shared(cellIds)
+                        quick_sort(cellIds, p, pindex - 1, Xsort);
+                        quick_sort(cellIds, pindex + 1, q, Xsort);
+#pragma omp taskwait
+                    }
+                    else
+                    {
+                        quick_sort(cellIds, p, pindex - 1, Xsort);
+                        quick_sort(cellIds, pindex + 1, q, Xsort);
+                    }
                 }
             }
 
@@ -994,6 +1066,16 @@ class GeneralSpreader
                 return level;
             }
 
+            /**
+             * @brief get the number of cells in this SubBox
+             *
+             * @return int
+             */
+            inline int getCellNum()
+            {
+                return cellIds.size();
+            }
+
             /**
              * @brief split horizontally the SubBox into smaller ones and assign cells to them
              *
@@ -1068,6 +1150,13 @@ class GeneralSpreader
              *
              */
             int minExpandSize = 2;
+
+            /**
+             * @brief the SubBoxes and the sorting ranges with at least this number of cells are processed by parallel
+             * tasks. The smaller ones are processed by the current task to avoid the overhead of task creation.
+             *
+             */
+            static constexpr int parallelCellNumThreshold = 2048;
         };
 
         static constexpr float eps = 1e-4;
@@ -1098,6 +1187,18 @@ class GeneralSpreader
          */
         std::vector<std::vector<PlacementInfo::PlacementBinInfo *>> &binGrid;
 
+        /**
+         * @brief the prefix sums of the capacity and utilization of the bins for the evaluation of expansion
+         *
+         */
+        BinDensityIndex &densityIndex;
+
+        /**
+         * @brief the random stream of the GeneralSpreader. The regions are expanded one by one so they can share it.
+         *
+         */
+        RandomStream &randomStream;
+
         /**
          * @brief the utilization of the four directions (absolute value)
          *
@@ -1245,6 +1346,13 @@ class GeneralSpreader
      */
     bool useSimpleExpland = false;
     bool enforceSimpleExpland = false;
+
+    /**
+     * @brief binary-search expansion will first grow the SpreadRegion as a window around the overflow bin, with the
+     * window size found by binary search on the density index, before the (smart/simple) expansion
+     *
+     */
+    bool useBinarySearchExpand = false;
     int dumpCnt = 0;
 
     /**
@@ -1265,10 +1373,25 @@ class GeneralSpreader
      */
     std::set<PlacementInfo::PlacementBinInfo *> coveredBinSet;
 
+    /**
+     * @brief the prefix sums of the capacity and utilization of the bins, rebuilt by findOverflowBins() in each
+     * spreading round
+     *
+     */
+    BinDensityIndex densityIndex;
+
+    /**
+     * @brief the random stream for the expansion of the SpreadRegions, seeded by the global seed, the iteration and the
+     * BEL type
+     *
+     */
+    RandomStream randomStream;
+
     void dumpSiteGridDensity(std::string dumpFileName);
 
     /**
-     * @brief find the overflow bins in the placement accoridng to a given threshold
+     * @brief find the overflow bins in the placement accoridng to a given threshold and rebuild the density index of
+     * the bin grid
      *
      * @param overflowThreshold a given threshold
      */
@@ -1285,6 +1408,24 @@ class GeneralSpreader
     GeneralSpreader::SpreadRegion *expandFromABin(PlacementInfo::PlacementBinInfo *curBin, float capacityShrinkRatio,
                                                   unsigned int numBinThr = 1000000);
 
+    /**
+     * @brief grow a SpreadRegion containing only its initial bin to the smallest window around the bin which resolves
+     * the overflow
+     *
+     * The window is extended by the same number of bins in the 4 directions (clipped by the boundary of the bin grid).
+     * The largest window which does not overlap the existing SpreadRegions and the smallest window whose density ratio
+     * is below the threshold are both found by binary search, where the density ratio of a window is obtained from
+     * the density index in O(1). If the window is blocked by other SpreadRegions before the overflow is resolved, the
+     * caller continues the expansion step by step.
+     *
+     * @param resRegion the SpreadRegion containing only its initial bin
+     * @param curBin the initial bin for the SpreadRegion construction
+     * @param capacityShrinkRatio shrink the area supply to a specific ratio
+     * @param numBinThr the maximum number of bin in one SpreadRegion
+     */
+    void binarySearchExpand(GeneralSpreader::SpreadRegion *resRegion, PlacementInfo::PlacementBinInfo *curBin,
+                            float capacityShrinkRatio, unsigned int numBinThr);
+
     /**
      * @brief the obtained SpreadRegion s which can be processed in parallel.
      *
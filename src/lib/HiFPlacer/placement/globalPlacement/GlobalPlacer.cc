@@ -24,6 +24,7 @@
  */
 
 #include "GlobalPlacer.h"
+#include "profiler.h"
 
 #include <cmath>
 #include <codecvt>
@@ -40,6 +41,7 @@ GlobalPlacer::GlobalPlacer(PlacementInfo *placementInfo, std::map<std::string, s
         dumpOptTrace = true;
     if (JSONCfg.find("y2xRatio") != JSONCfg.end())
         y2xRatio = std::stof(JSONCfg["y2xRatio"]);
+    randomStream.reseed(RandomStream::getSeedFromConfig(JSONCfg), 0, RandomStream::StreamDomain_GlobalPlacer);
 
     if (JSONCfg.find("disableSpreadingConvergeRatio") != JSONCfg.end())
     {
@@ -69,6 +71,19 @@ GlobalPlacer::GlobalPlacer(PlacementInfo *placementInfo, std::map<std::string, s
 
     clusterPlacer = new ClusterPlacer(placementInfo, JSONCfg, 10.0);
     WLOptimizer = new WirelengthOptimizer(placementInfo, JSONCfg, verbose);
+    if (JSONCfg.find("GlobalPlacerEngine") != JSONCfg.end())
+    {
+        if (JSONCfg["GlobalPlacerEngine"] == "nonlinear")
+        {
+            NLOptimizer = new NonlinearOptimizer(placementInfo, JSONCfg, verbose);
+        }
+        else if (JSONCfg["GlobalPlacerEngine"] != "QP")
+        {
+            print_error("undefined global placer engine: " + JSONCfg["GlobalPlacerEngine"] +
+                        ". (should be QP or nonlinear)");
+            assert(false);
+        }
+    }
 
     std::vector<DesignInfo::DesignCellType> macroTypesToLegalize;
     macroTypesToLegalize.clear();
@@ -121,6 +136,7 @@ GlobalPlacer::GlobalPlacer(PlacementInfo *placementInfo, std::map<std::string, s
 
 void GlobalPlacer::clusterPlacement()
 {
+    ProfileZone profileZone("ClusterPlacement");
     clusterPlacer->ClusterPlacement();
     print_info("ClusterPlacement Total HPWL = " + std::to_string(placementInfo->updateB2BAndGetTotalHPWL()));
 }
@@ -133,6 +149,8 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
     print_status("GlobalPlacer GlobalPlacement_CLBElements started");
 
     WLOptimizer->reloadPlacementInfo();
+    if (NLOptimizer)
+        NLOptimizer->reset();
     for (auto tmpNet : placementInfo->getDesignInfo()->getNets())
         tmpNet->setOverallTimingNetEnhancement(1.0);
 
@@ -190,18 +208,33 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
         // lowerBound: Quadratic Programming based Wirelength Optimization
         lowerBoundIterNum = (placementInfo->getProgress() < 0.965 && !macroCloseToSite) ? 2 : 2;
 
-        for (int j = 0; j < lowerBoundIterNum; j++)
+        if (NLOptimizer)
         {
-            WLOptimizer->GlobalPlacementQPSolve(
-                pseudoNetWeight, j == 0, true, enableMacroPseudoNet2Site, pseudoNetWeightConsiderNetNum,
-                (i > 1 || continuePreviousIteration) && hasUserDefinedClusterInfo, displacementLimit, timingOptimizer);
+            // lowerBound: nonlinear wirelength and density optimization with the pseudo nets of the QP model
+            WLOptimizer->loadPseudoNetsForNonlinearOptimizer(
+                NLOptimizer, pseudoNetWeight, enableMacroPseudoNet2Site, pseudoNetWeightConsiderNetNum,
+                (i > 1 || continuePreviousIteration) && hasUserDefinedClusterInfo, timingOptimizer);
+            NLOptimizer->optimize(displacementLimit);
             if (progressRatio > 0.5)
                 timingOptEnabled = true;
         }
+        else
+        {
+            for (int j = 0; j < lowerBoundIterNum; j++)
+            {
+                WLOptimizer->GlobalPlacementQPSolve(pseudoNetWeight, j == 0, true, enableMacroPseudoNet2Site,
+                                                    pseudoNetWeightConsiderNetNum,
+                                                    (i > 1 || continuePreviousIteration) && hasUserDefinedClusterInfo,
+                                                    displacementLimit, timingOptimizer);
+                if (progressRatio > 0.5)
+                    timingOptEnabled = true;
+            }
+        }
 
         lowerBoundHPWL = placementInfo->updateB2BAndGetTotalHPWL();
-        print_info("HPWL after QP=" + std::to_string(lowerBoundHPWL) +
-                   " pseudoNetWeight=" + std::to_string(pseudoNetWeight));
+        // label the lower-bound HPWL with the engine which is actually used
+        print_info(std::string(NLOptimizer ? "HPWL after nonlinear optimization=" : "HPWL after QP=") +
+                   std::to_string(lowerBoundHPWL) + " pseudoNetWeight=" + std::to_string(pseudoNetWeight));
         print_status("WLOptimizer Iteration#" + to_string_align3(i) + " Done HPWL=" + std::to_string(lowerBoundHPWL));
 
         if (dumpOptTrace)
@@ -331,6 +364,52 @@ void GlobalPlacer::GlobalPlacement_CLBElements(int iterNum, bool continuePreviou
     // macroSpreader->spreadPlacementUnits();
 }
 
+void GlobalPlacer::getCheckpointStates(std::map<std::string, float> &states)
+{
+    states["GlobalPlacer.oriPseudoNetWeight"] = oriPseudoNetWeight;
+    states["GlobalPlacer.macroPseudoNetEnhanceCnt"] = WLOptimizer->getMacroPseudoNetEnhanceCnt();
+    states["GlobalPlacer.macroLegalizationWeight"] = WLOptimizer->getMacroLegalizationWeight();
+    states["GlobalPlacer.neighborDisplacementUpperbound"] = neighborDisplacementUpperbound;
+    states["GlobalPlacer.minHPWL"] = minHPWL;
+    states["GlobalPlacer.averageMacroLegalDisplacement"] = averageMacroLegalDisplacement;
+    states["GlobalPlacer.averageCarryLegalDisplacement"] = averageCarryLegalDisplacement;
+    states["GlobalPlacer.averageMCLBLegalDisplacement"] = averageMCLBLegalDisplacement;
+    states["GlobalPlacer.macrosBindedToSites"] = macrosBindedToSites;
+    states["GlobalPlacer.macroCloseToSite"] = macroCloseToSite;
+    states["GlobalPlacer.macroLocked"] = macroLocked;
+    states["GlobalPlacer.macroLegalizationFixed"] = macroLegalizationFixed;
+    states["GlobalPlacer.macroLockedIterCnt"] = macroLockedIterCnt;
+    states["GlobalPlacer.enableClockRegionAware"] = enableClockRegionAware;
+    states["GlobalPlacer.timingOptEnabled"] = timingOptEnabled;
+}
+
+void GlobalPlacer::setCheckpointStates(std::map<std::string, float> &states)
+{
+    auto getState = [&states](const std::string &stateName) -> float {
+        if (states.find("GlobalPlacer." + stateName) == states.end())
+        {
+            print_error("GlobalPlacer: the checkpoint does not record the state: " + stateName);
+            assert(false);
+        }
+        return states["GlobalPlacer." + stateName];
+    };
+    oriPseudoNetWeight = getState("oriPseudoNetWeight");
+    WLOptimizer->setMacroLegalizationParameters(std::round(getState("macroPseudoNetEnhanceCnt")),
+                                                getState("macroLegalizationWeight"));
+    neighborDisplacementUpperbound = getState("neighborDisplacementUpperbound");
+    minHPWL = getState("minHPWL");
+    averageMacroLegalDisplacement = getState("averageMacroLegalDisplacement");
+    averageCarryLegalDisplacement = getState("averageCarryLegalDisplacement");
+    averageMCLBLegalDisplacement = getState("averageMCLBLegalDisplacement");
+    macrosBindedToSites = getState("macrosBindedToSites") > 0.5;
+    macroCloseToSite = getState("macroCloseToSite") > 0.5;
+    macroLocked = getState("macroLocked") > 0.5;
+    macroLegalizationFixed = getState("macroLegalizationFixed") > 0.5;
+    macroLockedIterCnt = std::round(getState("macroLockedIterCnt"));
+    enableClockRegionAware = getState("enableClockRegionAware") > 0.5;
+    timingOptEnabled = getState("timingOptEnabled") > 0.5;
+}
+
 void GlobalPlacer::GlobalPlacement_fixedCLB(int iterNum, float pseudoNetWeight)
 {
     print_status("GlobalPlacer GlobalPlacement_fixedCLB started");
@@ -419,7 +498,7 @@ void GlobalPlacer::dumpLUTCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -429,7 +508,7 @@ void GlobalPlacer::dumpLUTCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -457,6 +536,7 @@ void GlobalPlacer::dumpLUTCoordinate()
 
 void GlobalPlacer::macroLegalize(int curIteration, bool timingDriven, PlacementTimingOptimizer *timingOptimizer)
 {
+    ProfileZone profileZone("macroLegalize");
     // based on the global placement convergence progress and legalization displacement, select different strategies.
     // TODO: make this part more clean and clear for reader!
     if (macroLegalizationFixed)
@@ -617,6 +697,7 @@ void GlobalPlacer::macroLegalize(int curIteration, bool timingDriven, PlacementT
 
 void GlobalPlacer::spreading(int currentIteration, int spreadRegionSizeLimit, float displacementLimit)
 {
+    ProfileZone profileZone("spreading");
     placementInfo->updateElementBinGrid();
     float supplyRatio = (placementInfo->getBinGridW() < 2.5) ? 0.95 : (0.80 + 0.1 * progressRatio);
 
@@ -777,7 +858,7 @@ void GlobalPlacer::dumpCARRYCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -787,7 +868,7 @@ void GlobalPlacer::dumpCARRYCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -825,7 +906,7 @@ void GlobalPlacer::dumpFFCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -835,7 +916,7 @@ void GlobalPlacer::dumpFFCoordinate()
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -873,14 +954,14 @@ void GlobalPlacer::dumpAllCellsCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
                     DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
                     outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -918,7 +999,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
                 std::stringstream outfile0;
                 for (auto curPU : placementInfo->getPlacementUnits())
                 {
-                    if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                     {
                         float cellX = curUnpackedCell->X();
                         float cellY = curUnpackedCell->Y();
@@ -928,7 +1009,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
                             outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                         }
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                         {
@@ -965,7 +1046,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -975,7 +1056,7 @@ void GlobalPlacer::dumpLUTFFCoordinate(bool enforced)
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -1015,7 +1096,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
                 std::stringstream outfile0;
                 for (auto curPU : placementInfo->getPlacementUnits())
                 {
-                    if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                     {
                         float cellX = curUnpackedCell->X();
                         float cellY = curUnpackedCell->Y();
@@ -1025,7 +1106,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
                             outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                         }
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                         {
@@ -1061,7 +1142,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -1071,7 +1152,7 @@ void GlobalPlacer::dumpDSPCoordinate(bool enforced)
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -1111,7 +1192,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
                 std::stringstream outfile0;
                 for (auto curPU : placementInfo->getPlacementUnits())
                 {
-                    if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                     {
                         float cellX = curUnpackedCell->X();
                         float cellY = curUnpackedCell->Y();
@@ -1121,7 +1202,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
                             outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                         }
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                         {
@@ -1157,7 +1238,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
@@ -1167,7 +1248,7 @@ void GlobalPlacer::dumpBRAMCoordinate(bool enforced)
                         outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                     }
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -1331,7 +1412,7 @@ int GlobalPlacer::timingDrivenDetailedPlacement_shortestPath_intermediate(Placem
                 if (!curPU->isFixed() && !curPU->isLocked() && !curPU->checkHasLUTRAM() && !curPU->checkHasBRAM() &&
                     !curPU->checkHasDSP())
                 {
-                    if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                    if (auto curMacro = PlacementInfo::asMacro(curPU))
                     {
                         float offsetX_InMacro = curMacro->getCellOffsetXInMacro(curCell),
                               offsetY_InMacro = curMacro->getCellOffsetYInMacro(curCell);
@@ -1355,7 +1436,7 @@ int GlobalPlacer::timingDrivenDetailedPlacement_shortestPath_intermediate(Placem
                             cellLoc[curCellInMacro->getCellId()].Y = cellY;
                         }
                     }
-                    else if (auto unpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                    else if (auto unpacked = PlacementInfo::asUnpackedCell(curPU))
                     {
                         placementInfo->legalizeXYInArea(curPU, curCandidates[bestEndChoice].X,
                                                         curCandidates[bestEndChoice].Y);
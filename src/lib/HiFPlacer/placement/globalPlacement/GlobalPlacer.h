@@ -33,10 +33,12 @@
 #include "Eigen/SparseCore"
 #include "GeneralSpreader.h"
 #include "MacroLegalizer.h"
+#include "NonlinearOptimizer.h"
 #include "PlacementInfo.h"
 #include "PlacementTimingOptimizer.h"
 #include "WirelengthOptimizer.h"
 #include "dumpZip.h"
+#include "randomStream.h"
 //#include "osqp++/osqp++.h"
 #include <assert.h>
 #include <fstream>
@@ -74,6 +76,8 @@ class GlobalPlacer
             delete clusterPlacer;
         if (WLOptimizer)
             delete WLOptimizer;
+        if (NLOptimizer)
+            delete NLOptimizer;
         if (generalSpreader)
             delete generalSpreader;
         if (BRAMDSPLegalizer)
@@ -193,6 +197,21 @@ class GlobalPlacer
         neighborDisplacementUpperbound = _threshold;
     }
 
+    /**
+     * @brief record the states of the global placer (weights and macro legalization status) which should be restored
+     * when the placement flow is resumed from a checkpoint
+     *
+     * @param states named states
+     */
+    void getCheckpointStates(std::map<std::string, float> &states);
+
+    /**
+     * @brief restore the states of the global placer recorded in a checkpoint
+     *
+     * @param states named states
+     */
+    void setCheckpointStates(std::map<std::string, float> &states);
+
     /**
      * @brief cell spreading for all types of elements
      *
@@ -221,6 +240,12 @@ class GlobalPlacer
     bool dumpOptTrace = false;
     float y2xRatio = 1.0;
 
+    /**
+     * @brief the random stream of the global placer, seeded by "RandomSeed" in the configuration
+     *
+     */
+    RandomStream randomStream;
+
     /**
      * @brief set adaptive pseudo net weight according to net density
      *
@@ -251,6 +276,13 @@ class GlobalPlacer
      */
     WirelengthOptimizer *WLOptimizer = nullptr;
 
+    /**
+     * @brief nonlinear optimizer is an alternative lower-bound engine which minimizes the smooth wirelength and the
+     * electrostatic density energy (enabled by "GlobalPlacerEngine": "nonlinear", otherwise nullptr and the QP-based
+     * WLOptimizer is used)
+     */
+    NonlinearOptimizer *NLOptimizer = nullptr;
+
     /**
      * @brief a general spreading will spread cells to meet cell density requirements
      *
@@ -309,7 +341,7 @@ class GlobalPlacer
     void dumpCoord();
     inline float random_float(float min, float max)
     {
-        return ((float)random() / RAND_MAX) * (max - min) + min;
+        return randomStream.uniformFloat(min, max);
     }
 
     /*
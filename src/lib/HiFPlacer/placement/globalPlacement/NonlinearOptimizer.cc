@@ -0,0 +1,637 @@
+/**
+ * @file NonlinearOptimizer.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the NonlinearOptimizer which optimizes the
+ * wirelength and the density of the placement with a nonlinear analytical model.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "NonlinearOptimizer.h"
+#include "deterministicParallel.h"
+#include "profiler.h"
+
+#include <cmath>
+#include <omp.h>
+
+NonlinearOptimizer::NonlinearOptimizer(PlacementInfo *placementInfo, std::map<std::string, std::string> &JSONCfg,
+                                       bool verbose)
+    : placementInfo(placementInfo), JSONCfg(JSONCfg), verbose(verbose)
+{
+    if (JSONCfg.find("y2xRatio") != JSONCfg.end())
+        y2xRatio = std::stof(JSONCfg["y2xRatio"]);
+    if (JSONCfg.find("NonlinearWirelengthModel") != JSONCfg.end())
+    {
+        if (JSONCfg["NonlinearWirelengthModel"] == "LSE")
+            useLSEWirelength = true;
+        else if (JSONCfg["NonlinearWirelengthModel"] != "WA")
+        {
+            print_error("undefined nonlinear wirelength model: " + JSONCfg["NonlinearWirelengthModel"] +
+                        ". (should be WA or LSE)");
+            assert(false);
+        }
+    }
+    if (JSONCfg.find("NonlinearIterNum") != JSONCfg.end())
+        iterNum = std::stoi(JSONCfg["NonlinearIterNum"]);
+    if (JSONCfg.find("NonlinearTargetOverflow") != JSONCfg.end())
+        targetOverflow = std::stof(JSONCfg["NonlinearTargetOverflow"]);
+    if (JSONCfg.find("NonlinearInitialDensityWeightRatio") != JSONCfg.end())
+        initialDensityWeightRatio = std::stof(JSONCfg["NonlinearInitialDensityWeightRatio"]);
+    deterministic = isDeterministicMode(JSONCfg);
+}
+
+void NonlinearOptimizer::reset()
+{
+    densityWeight = -1;
+    overflow = 1.0;
+    lastHPWL = -1;
+}
+
+void NonlinearOptimizer::clearDensityFields()
+{
+    for (auto field : densityFields)
+        if (field)
+            delete field;
+    densityFields.clear();
+}
+
+void NonlinearOptimizer::loadDensityObjects()
+{
+    auto &PUs = placementInfo->getPlacementUnits();
+    int numPUs = PUs.size();
+    int numBELTypes = placementInfo->getBinGrid().size();
+
+    densityObjects.clear();
+    objectPUId.clear();
+    PUObjectStart.assign(numPUs + 1, 0);
+    PUDemand.assign(numPUs, 0);
+    BELTypeId2ObjectIds.assign(numBELTypes, std::vector<int>());
+    totalDemand = 0;
+
+    auto addDensityObject = [&](int PUId, DesignInfo::DesignCell *curCell, float offsetX, float offsetY) {
+        auto &BELTypeIds = placementInfo->getPotentialBELTypeIDs(curCell);
+        assert(BELTypeIds.size() > 0);
+        DensityObject newObject;
+        newObject.offsetX = offsetX;
+        newObject.offsetY = offsetY;
+        newObject.demand = placementInfo->getActualOccupation(curCell);
+        newObject.BELTypeId = BELTypeIds[0];
+        BELTypeId2ObjectIds[newObject.BELTypeId].push_back(densityObjects.size());
+        densityObjects.push_back(newObject);
+        objectPUId.push_back(PUId);
+        PUDemand[PUId] += newObject.demand;
+        totalDemand += newObject.demand;
+    };
+
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        auto curPU = PUs[PUId];
+        PUObjectStart[PUId] = densityObjects.size();
+        if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
+        {
+            addDensityObject(PUId, curUnpackedCell->getCell(), 0, 0);
+        }
+        else if (auto curMacro = PlacementInfo::asMacro(curPU))
+        {
+            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
+            {
+                float offsetX_InMacro, offsetY_InMacro;
+                DesignInfo::DesignCellType cellType;
+                curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
+                addDensityObject(PUId, curMacro->getCell(vId), offsetX_InMacro, offsetY_InMacro);
+            }
+        }
+    }
+    PUObjectStart[numPUs] = densityObjects.size();
+
+    // the density fields cover the bin grid with power-of-2 numbers of bins for the FFT-based Poisson solver
+    int binGridRowNum = placementInfo->getBinGrid(0).size();
+    int binGridColNum = placementInfo->getBinGrid(0)[0].size();
+    int binNumX = 1, binNumY = 1;
+    while (binNumX < binGridColNum)
+        binNumX <<= 1;
+    while (binNumY < binGridRowNum)
+        binNumY <<= 1;
+
+    clearDensityFields();
+    densityFields.resize(numBELTypes, nullptr);
+    BELTypeId2Capacities.assign(numBELTypes, std::vector<double>());
+    BELTypeId2SupplyScale.assign(numBELTypes, 0);
+    for (int BELTypeId = 0; BELTypeId < numBELTypes; BELTypeId++)
+    {
+        if (BELTypeId2ObjectIds[BELTypeId].size() == 0)
+            continue;
+        auto curField = new ElectrostaticDensityField(
+            placementInfo->getGlobalBinMinLocX(), placementInfo->getGlobalBinMinLocY(),
+            placementInfo->getGlobalBinMaxLocX(), placementInfo->getGlobalBinMaxLocY(), binNumX, binNumY);
+        densityFields[BELTypeId] = curField;
+
+        double typeDemand = 0, typeCapacity = 0;
+        for (auto objectId : BELTypeId2ObjectIds[BELTypeId])
+            typeDemand += densityObjects[objectId].demand;
+        for (auto &binRow : placementInfo->getBinGrid(BELTypeId))
+        {
+            for (auto curBin : binRow)
+            {
+                if (curBin->getCapacity() <= 0)
+                    continue;
+                curField->addRectangleCharge(curBin->left(), curBin->bottom(), curBin->right(), curBin->top(),
+                                             curBin->getCapacity());
+                typeCapacity += curBin->getCapacity();
+            }
+        }
+        BELTypeId2Capacities[BELTypeId] = curField->getCharges();
+        BELTypeId2SupplyScale[BELTypeId] = (typeCapacity > 0) ? typeDemand / typeCapacity : 0;
+    }
+}
+
+void NonlinearOptimizer::loadWirelengthModel()
+{
+    auto &PUs = placementInfo->getPlacementUnits();
+    auto &placementNets = placementInfo->getPlacementNets();
+    PlacementInfo::PlacementNetPinStore &pinStore = placementInfo->getNetPinStore();
+    int numPUs = PUs.size();
+    int numNets = placementNets.size();
+    int numPins = (numNets > 0) ? pinStore.getPinEnd(numNets - 1) : 0;
+
+    netWeights.resize(numNets);
+    for (int netId = 0; netId < numNets; netId++)
+    {
+        auto designNet = placementNets[netId]->getDesignNet();
+        if (designNet->checkIsPowerNet() || designNet->checkIsGlobalClock())
+            netWeights[netId] = 0; // Power/clock nets are on the entrie device. Ignore them.
+        else
+            netWeights[netId] = designNet->getOverallEnhanceRatio();
+    }
+    pinGradX.assign(numPins, 0);
+    pinGradY.assign(numPins, 0);
+
+    // group the pins by PlacementUnits so the gradients can be reduced without atomic operations
+    PUPinStart.assign(numPUs + 1, 0);
+    for (int pinId = 0; pinId < numPins; pinId++)
+        PUPinStart[pinStore.getPinPUId(pinId) + 1]++;
+    for (int PUId = 0; PUId < numPUs; PUId++)
+        PUPinStart[PUId + 1] += PUPinStart[PUId];
+    PUPinIds.resize(numPins);
+    std::vector<int> PUPinFillPos(PUPinStart.begin(), PUPinStart.end() - 1);
+    for (int pinId = 0; pinId < numPins; pinId++)
+        PUPinIds[PUPinFillPos[pinStore.getPinPUId(pinId)]++] = pinId;
+
+    PUFixed.resize(numPUs);
+    for (int PUId = 0; PUId < numPUs; PUId++)
+        PUFixed[PUId] = PUs[PUId]->isFixed();
+
+    loadPseudoNets();
+}
+
+void NonlinearOptimizer::addPseudoNet(int PUIdA, float offsetAX, float offsetAY, int PUIdB, float offsetBX,
+                                      float offsetBY, float weightX, float weightY)
+{
+    assert(PUIdA >= 0 && PUIdB >= 0);
+    if (PUIdA == PUIdB)
+        return;
+    pseudoNets.push_back(PseudoNet{PUIdA, PUIdB, offsetAX, offsetAY, offsetBX, offsetBY, weightX, weightY});
+}
+
+void NonlinearOptimizer::addPseudoNet2Location(int PUId, float targetX, float targetY, float weightX, float weightY)
+{
+    assert(PUId >= 0);
+    pseudoNets.push_back(PseudoNet{PUId, -1, 0, 0, targetX, targetY, weightX, weightY});
+}
+
+void NonlinearOptimizer::loadPseudoNets()
+{
+    int numPUs = placementInfo->getPlacementUnits().size();
+    int numPseudoNets = pseudoNets.size();
+
+    PUPseudoNetStart.assign(numPUs + 1, 0);
+    PUPseudoNetWeight.assign(numPUs, 0);
+    for (auto &curNet : pseudoNets)
+    {
+        assert(curNet.PUIdA < numPUs && curNet.PUIdB < numPUs);
+        PUPseudoNetStart[curNet.PUIdA + 1]++;
+        PUPseudoNetWeight[curNet.PUIdA] += curNet.weightX;
+        if (curNet.PUIdB >= 0)
+        {
+            PUPseudoNetStart[curNet.PUIdB + 1]++;
+            PUPseudoNetWeight[curNet.PUIdB] += curNet.weightX;
+        }
+    }
+    for (int PUId = 0; PUId < numPUs; PUId++)
+        PUPseudoNetStart[PUId + 1] += PUPseudoNetStart[PUId];
+    PUPseudoNetIds.resize(PUPseudoNetStart[numPUs]);
+    std::vector<int> PUPseudoNetFillPos(PUPseudoNetStart.begin(), PUPseudoNetStart.end() - 1);
+    for (int pseudoNetId = 0; pseudoNetId < numPseudoNets; pseudoNetId++)
+    {
+        PUPseudoNetIds[PUPseudoNetFillPos[pseudoNets[pseudoNetId].PUIdA]++] = pseudoNetId;
+        if (pseudoNets[pseudoNetId].PUIdB >= 0)
+            PUPseudoNetIds[PUPseudoNetFillPos[pseudoNets[pseudoNetId].PUIdB]++] = pseudoNetId;
+    }
+}
+
+/**
+ * @brief accumulate the gradient of the smooth wirelength of a net in one direction to its pins
+ *
+ * @param pos the locations of the pins
+ * @param numPins the number of the pins
+ * @param maxPos the maximum location among the pins
+ * @param minPos the minimum location among the pins
+ * @param gamma the smoothing factor
+ * @param useLSE use log-sum-exp model (otherwise weighted-average model)
+ * @param weight the weight of the net
+ * @param grad output gradient for each pin
+ */
+static inline void getSmoothWirelengthGradient(const float *pos, int numPins, float maxPos, float minPos, float gamma,
+                                               bool useLSE, float weight, float *grad)
+{
+    double sumA = 0, sumAX = 0, sumB = 0, sumBX = 0;
+    for (int i = 0; i < numPins; i++)
+    {
+        double a = std::exp((pos[i] - maxPos) / gamma);
+        double b = std::exp((minPos - pos[i]) / gamma);
+        sumA += a;
+        sumAX += a * pos[i];
+        sumB += b;
+        sumBX += b * pos[i];
+    }
+    if (useLSE)
+    {
+        for (int i = 0; i < numPins; i++)
+        {
+            double a = std::exp((pos[i] - maxPos) / gamma);
+            double b = std::exp((minPos - pos[i]) / gamma);
+            grad[i] = weight * (a / sumA - b / sumB);
+        }
+    }
+    else
+    {
+        double WAMax = sumAX / sumA;
+        double WAMin = sumBX / sumB;
+        for (int i = 0; i < numPins; i++)
+        {
+            double a = std::exp((pos[i] - maxPos) / gamma);
+            double b = std::exp((minPos - pos[i]) / gamma);
+            grad[i] = weight * (a / sumA * (1 + (pos[i] - WAMax) / gamma) - b / sumB * (1 - (pos[i] - WAMin) / gamma));
+        }
+    }
+}
+
+double NonlinearOptimizer::getWirelengthGradient(const std::vector<float> &x, const std::vector<float> &y,
+                                                 std::vector<float> &gradX, std::vector<float> &gradY)
+{
+    ProfileZone profileZone("NLWirelengthGradient");
+    PlacementInfo::PlacementNetPinStore &pinStore = placementInfo->getNetPinStore();
+    int numNets = netWeights.size();
+    int numPUs = x.size();
+    netHPWLs.resize(numNets);
+
+#pragma omp parallel
+    {
+        std::vector<float> posX, posY;
+#pragma omp for schedule(dynamic, 64)
+        for (int netId = 0; netId < numNets; netId++)
+        {
+            int pinBegin = pinStore.getPinBegin(netId);
+            int numPins = pinStore.getPinEnd(netId) - pinBegin;
+            netHPWLs[netId] = 0;
+            if (numPins < 2 || netWeights[netId] <= 0)
+            {
+                std::fill(pinGradX.begin() + pinBegin, pinGradX.begin() + pinBegin + numPins, 0);
+                std::fill(pinGradY.begin() + pinBegin, pinGradY.begin() + pinBegin + numPins, 0);
+                continue;
+            }
+            posX.resize(numPins);
+            posY.resize(numPins);
+            float leftX = 1e10, rightX = -1e10, bottomY = 1e10, topY = -1e10;
+            for (int i = 0; i < numPins; i++)
+            {
+                int pinId = pinBegin + i;
+                int PUId = pinStore.getPinPUId(pinId);
+                posX[i] = x[PUId] + pinStore.getPinOffsetX(pinId);
+                posY[i] = y[PUId] + pinStore.getPinOffsetY(pinId);
+                leftX = std::min(leftX, posX[i]);
+                rightX = std::max(rightX, posX[i]);
+                bottomY = std::min(bottomY, posY[i]);
+                topY = std::max(topY, posY[i]);
+            }
+            netHPWLs[netId] = (rightX - leftX) + y2xRatio * (topY - bottomY);
+            getSmoothWirelengthGradient(posX.data(), numPins, rightX, leftX, wirelengthGamma, useLSEWirelength,
+                                        netWeights[netId], &pinGradX[pinBegin]);
+            getSmoothWirelengthGradient(posY.data(), numPins, topY, bottomY, wirelengthGamma, useLSEWirelength,
+                                        netWeights[netId] * y2xRatio, &pinGradY[pinBegin]);
+        }
+
+#pragma omp for
+        for (int PUId = 0; PUId < numPUs; PUId++)
+        {
+            float sumX = 0, sumY = 0;
+            for (int i = PUPinStart[PUId]; i < PUPinStart[PUId + 1]; i++)
+            {
+                sumX += pinGradX[PUPinIds[i]];
+                sumY += pinGradY[PUPinIds[i]];
+            }
+            for (int i = PUPseudoNetStart[PUId]; i < PUPseudoNetStart[PUId + 1]; i++)
+            {
+                // the gradient of 0.5 * w * (pinA - pinB)^2 is w * (pinA - pinB) for A and its negation for B
+                const PseudoNet &curNet = pseudoNets[PUPseudoNetIds[i]];
+                float pinAX = x[curNet.PUIdA] + curNet.offsetAX;
+                float pinAY = y[curNet.PUIdA] + curNet.offsetAY;
+                float pinBX = curNet.offsetBX;
+                float pinBY = curNet.offsetBY;
+                if (curNet.PUIdB >= 0)
+                {
+                    pinBX += x[curNet.PUIdB];
+                    pinBY += y[curNet.PUIdB];
+                }
+                float sign = (curNet.PUIdA == PUId) ? 1 : -1;
+                sumX += sign * curNet.weightX * (pinAX - pinBX);
+                sumY += sign * curNet.weightY * (pinAY - pinBY);
+            }
+            gradX[PUId] = sumX;
+            gradY[PUId] = sumY;
+        }
+    }
+    return parallelSum(numNets, [&](int netId) -> double { return netHPWLs[netId]; }, deterministic);
+}
+
+void NonlinearOptimizer::getDensityGradient(const std::vector<float> &x, const std::vector<float> &y,
+                                            std::vector<float> &gradX, std::vector<float> &gradY)
+{
+    ProfileZone profileZone("NLDensityGradient");
+    int numBELTypes = densityFields.size();
+    int numPUs = x.size();
+    std::vector<double> BELTypeId2Overflow(numBELTypes, 0);
+
+    // charges = demands - scaled supplies (the total charge of each field is neutral)
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int BELTypeId = 0; BELTypeId < numBELTypes; BELTypeId++)
+    {
+        auto curField = densityFields[BELTypeId];
+        if (!curField)
+            continue;
+        curField->resetCharge();
+        for (auto objectId : BELTypeId2ObjectIds[BELTypeId])
+        {
+            auto &curObject = densityObjects[objectId];
+            int PUId = objectPUId[objectId];
+            curField->addPointCharge(x[PUId] + curObject.offsetX, y[PUId] + curObject.offsetY, curObject.demand);
+        }
+        std::vector<double> &charges = curField->getCharges();
+        std::vector<double> &capacities = BELTypeId2Capacities[BELTypeId];
+        double supplyScale = BELTypeId2SupplyScale[BELTypeId];
+        double typeOverflow = 0;
+        for (unsigned int binId = 0; binId < charges.size(); binId++)
+        {
+            typeOverflow += std::max(0.0, charges[binId] - capacities[binId]);
+            charges[binId] -= supplyScale * capacities[binId];
+        }
+        BELTypeId2Overflow[BELTypeId] = typeOverflow;
+    }
+
+    double totalOverflow = 0;
+    for (int BELTypeId = 0; BELTypeId < numBELTypes; BELTypeId++)
+    {
+        if (!densityFields[BELTypeId])
+            continue;
+        densityFields[BELTypeId]->solveField();
+        totalOverflow += BELTypeId2Overflow[BELTypeId];
+    }
+    overflow = (totalDemand > 0) ? totalOverflow / totalDemand : 0;
+
+    // the gradient of the density energy of a charge is -charge * field
+#pragma omp parallel for
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        float sumX = 0, sumY = 0;
+        for (int objectId = PUObjectStart[PUId]; objectId < PUObjectStart[PUId + 1]; objectId++)
+        {
+            auto &curObject = densityObjects[objectId];
+            float Ex, Ey;
+            densityFields[curObject.BELTypeId]->getFieldAt(x[PUId] + curObject.offsetX, y[PUId] + curObject.offsetY,
+                                                           Ex, Ey);
+            sumX -= curObject.demand * Ex;
+            sumY -= curObject.demand * Ey;
+        }
+        gradX[PUId] = sumX;
+        gradY[PUId] = sumY;
+    }
+}
+
+double NonlinearOptimizer::getObjectiveGradient(const std::vector<float> &x, const std::vector<float> &y,
+                                                std::vector<float> &gradX, std::vector<float> &gradY)
+{
+    int numPUs = x.size();
+    getDensityGradient(x, y, densityGradX, densityGradY);
+    double HPWL = getWirelengthGradient(x, y, gradX, gradY);
+
+    // Jacobi-like preconditioner (ePlace): the number of pins plus the weighted demand of each PlacementUnit
+#pragma omp parallel for
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        if (PUFixed[PUId])
+        {
+            gradX[PUId] = gradY[PUId] = 0;
+            continue;
+        }
+        float precond = (PUPinStart[PUId + 1] - PUPinStart[PUId]) + densityWeight * PUDemand[PUId] +
+                        PUPseudoNetWeight[PUId];
+        precond = std::max(precond, 1.0f);
+        gradX[PUId] = (gradX[PUId] + densityWeight * densityGradX[PUId]) / precond;
+        gradY[PUId] = (gradY[PUId] + densityWeight * densityGradY[PUId]) / precond;
+    }
+    return HPWL;
+}
+
+void NonlinearOptimizer::legalizeXYInArea(std::vector<float> &x, std::vector<float> &y)
+{
+    auto &PUs = placementInfo->getPlacementUnits();
+    int numPUs = PUs.size();
+#pragma omp parallel for
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        if (PUFixed[PUId])
+            continue;
+        placementInfo->legalizeXYInArea(PUs[PUId], x[PUId], y[PUId]);
+    }
+}
+
+void NonlinearOptimizer::updateWirelengthGamma()
+{
+    // gamma = 8 * binSize * 10^(k * overflow + b) (ePlace), which is sharper as the cells are spread
+    float tau = std::max(0.0f, std::min(overflow, 1.0f));
+    float binSize = (placementInfo->getBinGridW() + placementInfo->getBinGridH()) / 2;
+    wirelengthGamma = 8.0 * binSize * std::pow(10.0, 20.0 / 9.0 * tau - 11.0 / 9.0);
+}
+
+void NonlinearOptimizer::optimize(float displacementLimit)
+{
+    ProfileZone profileZone("NonlinearOptimize");
+    if (verbose)
+        print_status("NonlinearOptimizer started.");
+
+    auto &PUs = placementInfo->getPlacementUnits();
+    int numPUs = PUs.size();
+    placementInfo->loadNetPinStore();
+    loadDensityObjects();
+    loadWirelengthModel();
+
+    std::vector<float> uX(numPUs), uY(numPUs);
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        uX[PUId] = PUs[PUId]->X();
+        uY[PUId] = PUs[PUId]->Y();
+    }
+    std::vector<float> vX = uX, vY = uY, lastVX, lastVY;
+    std::vector<float> gradX(numPUs), gradY(numPUs), lastGradX, lastGradY;
+    densityGradX.resize(numPUs);
+    densityGradY.resize(numPUs);
+
+    if (densityWeight < 0)
+    {
+        // initialize the density weight by the ratio between the gradients of the wirelength and the density
+        getDensityGradient(uX, uY, densityGradX, densityGradY);
+        updateWirelengthGamma();
+        getWirelengthGradient(uX, uY, gradX, gradY);
+        double wirelengthGradNorm = 0, densityGradNorm = 0;
+        for (int PUId = 0; PUId < numPUs; PUId++)
+        {
+            if (PUFixed[PUId])
+                continue;
+            wirelengthGradNorm += std::fabs(gradX[PUId]) + std::fabs(gradY[PUId]);
+            densityGradNorm += std::fabs(densityGradX[PUId]) + std::fabs(densityGradY[PUId]);
+        }
+        densityWeight = (densityGradNorm > 0) ? initialDensityWeightRatio * wirelengthGradNorm / densityGradNorm
+                                              : initialDensityWeightRatio;
+    }
+
+    double HPWL = getObjectiveGradient(vX, vY, gradX, gradY);
+    if (lastHPWL < 0)
+        lastHPWL = HPWL;
+
+    // limit the movement in each step to avoid divergence at the beginning
+    float binSize = (placementInfo->getBinGridW() + placementInfo->getBinGridH()) / 2;
+    float maxStepMovement = 2 * binSize;
+    auto getMaxGrad = [&]() {
+        float maxGrad = 0;
+        for (int PUId = 0; PUId < numPUs; PUId++)
+            maxGrad = std::max(maxGrad, std::max(std::fabs(gradX[PUId]), std::fabs(gradY[PUId])));
+        return maxGrad;
+    };
+    float maxGrad = getMaxGrad();
+    float stepSize = (maxGrad > 0) ? 0.1 * binSize / maxGrad : 0;
+
+    double nesterovA = 1;
+    int iter = 0;
+    while (iter < iterNum && stepSize > 0)
+    {
+        iter++;
+        // u_k+1 = v_k - step * grad(v_k); v_k+1 = u_k+1 + (a_k - 1) / a_k+1 * (u_k+1 - u_k)
+        double nextNesterovA = (1 + std::sqrt(4 * nesterovA * nesterovA + 1)) / 2;
+        float momentum = (nesterovA - 1) / nextNesterovA;
+        nesterovA = nextNesterovA;
+        lastVX = vX;
+        lastVY = vY;
+        lastGradX = gradX;
+        lastGradY = gradY;
+
+#pragma omp parallel for
+        for (int PUId = 0; PUId < numPUs; PUId++)
+        {
+            float nextUX = vX[PUId] - stepSize * gradX[PUId];
+            float nextUY = vY[PUId] - stepSize * gradY[PUId];
+            vX[PUId] = nextUX + momentum * (nextUX - uX[PUId]);
+            vY[PUId] = nextUY + momentum * (nextUY - uY[PUId]);
+            uX[PUId] = nextUX;
+            uY[PUId] = nextUY;
+        }
+        legalizeXYInArea(uX, uY);
+        legalizeXYInArea(vX, vY);
+
+        HPWL = getObjectiveGradient(vX, vY, gradX, gradY);
+
+        // Barzilai-Borwein step size
+        double deltaV = parallelSum(
+            numPUs,
+            [&](int PUId) -> double {
+                return (vX[PUId] - lastVX[PUId]) * (vX[PUId] - lastVX[PUId]) +
+                       (vY[PUId] - lastVY[PUId]) * (vY[PUId] - lastVY[PUId]);
+            },
+            deterministic);
+        double deltaGrad = parallelSum(
+            numPUs,
+            [&](int PUId) -> double {
+                return (gradX[PUId] - lastGradX[PUId]) * (gradX[PUId] - lastGradX[PUId]) +
+                       (gradY[PUId] - lastGradY[PUId]) * (gradY[PUId] - lastGradY[PUId]);
+            },
+            deterministic);
+        if (deltaV > 0 && deltaGrad > 0)
+            stepSize = std::sqrt(deltaV / deltaGrad);
+        maxGrad = getMaxGrad();
+        if (maxGrad > 0 && stepSize * maxGrad > maxStepMovement)
+            stepSize = maxStepMovement / maxGrad;
+
+        // increase the density weight faster if the HPWL is not increased significantly (DREAMPlace)
+        float densityWeightFactor = 1.05;
+        if (lastHPWL > 0)
+            densityWeightFactor = std::pow(1.05, 1 - (HPWL - lastHPWL) / (0.01 * lastHPWL));
+        densityWeightFactor = std::max(0.95f, std::min(densityWeightFactor, 1.05f));
+        densityWeight *= densityWeightFactor;
+        lastHPWL = HPWL;
+        updateWirelengthGamma();
+
+        if (verbose)
+            print_info("NonlinearOptimizer iteration#" + std::to_string(iter) + " HPWL=" + std::to_string(HPWL) +
+                       " overflow=" + std::to_string(overflow) + " densityWeight=" + std::to_string(densityWeight) +
+                       " gamma=" + std::to_string(wirelengthGamma) + " stepSize=" + std::to_string(stepSize));
+
+        if (overflow < targetOverflow)
+            break;
+    }
+
+    profileCounter("Nesterov iterations", iter);
+
+    bool displacementLimitEnable = displacementLimit > 0;
+#pragma omp parallel for
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        auto tmpPU = PUs[PUId];
+        if (tmpPU->isFixed())
+            continue;
+        float fX = uX[PUId];
+        float fY = uY[PUId];
+        if (displacementLimitEnable)
+        {
+            float disX = std::fabs(fX - tmpPU->X());
+            float disY = std::fabs(fY - tmpPU->Y());
+            float dis = std::sqrt(disX * disX + disY * disY);
+            float disRatio = displacementLimit / dis;
+            if (disRatio < 1)
+            {
+                fX = tmpPU->X() + (fX - tmpPU->X()) * disRatio;
+                fY = tmpPU->Y() + (fY - tmpPU->Y()) * disRatio;
+            }
+        }
+        placementInfo->legalizeXYInArea(tmpPU, fX, fY);
+        tmpPU->setAnchorLocation(fX, fY);
+    }
+
+    print_info("NonlinearOptimizer: #iterations=" + std::to_string(iter) + " HPWL=" + std::to_string(HPWL) +
+               " overflow=" + std::to_string(overflow) + " densityWeight=" + std::to_string(densityWeight) +
+               " gamma=" + std::to_string(wirelengthGamma));
+}
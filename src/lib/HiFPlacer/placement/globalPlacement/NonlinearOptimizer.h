@@ -0,0 +1,372 @@
+/**
+ * @file NonlinearOptimizer.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of NonlinearOptimizer class and its internal modules and APIs which
+ * optimize the wirelength and the density of the placement with a nonlinear analytical model.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _NONLINEAROPTIMIZER
+#define _NONLINEAROPTIMIZER
+
+#include "ElectrostaticDensityField.h"
+#include "PlacementInfo.h"
+#include "strPrint.h"
+#include <assert.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @brief NonlinearOptimizer is an alternative lower-bound engine of global placement, which minimizes the smooth
+ * wirelength (weighted-average or log-sum-exp) plus the electrostatic density energy of each BEL type with Nesterov's
+ * accelerated gradient method (ePlace/DREAMPlace-like).
+ *
+ * The charges of each BEL type are the resource demands of the cells minus the scaled resource supplies of the bins,
+ * so the cells are pushed towards the bins where the corresponding sites are available. The density weight and the
+ * wirelength smoothing factor are updated according to the HPWL change and the overflow. The optimizer works on the
+ * same PlacementUnits/PlacementNets as WirelengthOptimizer, so the spreader and the legalizers can be applied after it.
+ *
+ * The pseudo nets of the QP model (macro legalization, timing-driven, user-defined cluster and clock region) are loaded
+ * by WirelengthOptimizer::loadPseudoNetsForNonlinearOptimizer() as quadratic terms of the objective, with the same
+ * weights as those in the QP problem.
+ *
+ */
+class NonlinearOptimizer
+{
+  public:
+    /**
+     * @brief Construct a new Nonlinear Optimizer object
+     *
+     * @param placementInfo the PlacementInfo for this placer to handle
+     * @param JSONCfg the user-defined placement configuration
+     * @param verbose whether dump information in a verbose way
+     */
+    NonlinearOptimizer(PlacementInfo *placementInfo, std::map<std::string, std::string> &JSONCfg, bool verbose);
+    ~NonlinearOptimizer()
+    {
+        clearDensityFields();
+    }
+
+    /**
+     * @brief reset the density weight and the smoothing schedule, e.g., at the beginning of a global placement round
+     *
+     */
+    void reset();
+
+    /**
+     * @brief conduct Nesterov's iterations for the wirelength, density and pseudo net objective and write back the
+     * locations of PlacementUnits
+     *
+     * @param displacementLimit the upperbound of the displacement of each PlacementUnit (disabled if negative)
+     */
+    void optimize(float displacementLimit);
+
+    /**
+     * @brief remove the quadratic pseudo nets loaded for the optimization
+     *
+     */
+    inline void clearPseudoNets()
+    {
+        pseudoNets.clear();
+    }
+
+    /**
+     * @brief add a quadratic pseudo net between two pins, i.e., 0.5 * w * (distance between the pins)^2 in each
+     * dimension
+     *
+     * @param PUIdA the id of the PlacementUnit of pin A
+     * @param offsetAX the offset of pin A in its PlacementUnit
+     * @param offsetAY the offset of pin A in its PlacementUnit
+     * @param PUIdB the id of the PlacementUnit of pin B
+     * @param offsetBX the offset of pin B in its PlacementUnit
+     * @param offsetBY the offset of pin B in its PlacementUnit
+     * @param weightX the weight of the pseudo net in X-coordinate
+     * @param weightY the weight of the pseudo net in Y-coordinate
+     */
+    void addPseudoNet(int PUIdA, float offsetAX, float offsetAY, int PUIdB, float offsetBX, float offsetBY,
+                      float weightX, float weightY);
+
+    /**
+     * @brief add a quadratic pseudo net between a PlacementUnit and a fixed location
+     *
+     * @param PUId the id of the PlacementUnit
+     * @param targetX
+     * @param targetY
+     * @param weightX the weight of the pseudo net in X-coordinate (0 if the pseudo net is only in Y-coordinate)
+     * @param weightY the weight of the pseudo net in Y-coordinate (0 if the pseudo net is only in X-coordinate)
+     */
+    void addPseudoNet2Location(int PUId, float targetX, float targetY, float weightX, float weightY);
+
+    /**
+     * @brief Get the overflow ratio of the latest iteration
+     *
+     * @return float
+     */
+    inline float getOverflow()
+    {
+        return overflow;
+    }
+
+    /**
+     * @brief Get the density weight (lambda) of the latest iteration
+     *
+     * @return float
+     */
+    inline float getDensityWeight()
+    {
+        return densityWeight;
+    }
+
+  private:
+    /**
+     * @brief a cell in a PlacementUnit which contributes resource demand to the density field of its BEL type
+     *
+     */
+    struct DensityObject
+    {
+        float offsetX;
+        float offsetY;
+        float demand;
+        int BELTypeId;
+    };
+
+    /**
+     * @brief a quadratic pseudo net between pin A and pin B. If PUIdB is negative, pin B is a fixed location
+     * (offsetBX, offsetBY).
+     *
+     */
+    struct PseudoNet
+    {
+        int PUIdA;
+        int PUIdB;
+        float offsetAX;
+        float offsetAY;
+        float offsetBX;
+        float offsetBY;
+        float weightX;
+        float weightY;
+    };
+
+    /**
+     * @brief load the cells of PlacementUnits as density objects and the bin capacities as the supplies in the density
+     * fields
+     *
+     */
+    void loadDensityObjects();
+
+    /**
+     * @brief load the pins of PlacementUnits, net weights and pseudo nets for the wirelength model
+     *
+     */
+    void loadWirelengthModel();
+
+    /**
+     * @brief group the loaded pseudo nets by PlacementUnits so their gradients can be reduced without atomic operations
+     *
+     */
+    void loadPseudoNets();
+
+    /**
+     * @brief evaluate the gradient of the smooth wirelength (and the pseudo nets) for each PlacementUnit
+     *
+     * @param x locations of PlacementUnits
+     * @param y locations of PlacementUnits
+     * @param gradX output gradient
+     * @param gradY output gradient
+     * @return double the HPWL of the given locations
+     */
+    double getWirelengthGradient(const std::vector<float> &x, const std::vector<float> &y, std::vector<float> &gradX,
+                                 std::vector<float> &gradY);
+
+    /**
+     * @brief evaluate the gradient of the electrostatic density energy for each PlacementUnit and update the overflow
+     *
+     * @param x locations of PlacementUnits
+     * @param y locations of PlacementUnits
+     * @param gradX output gradient
+     * @param gradY output gradient
+     */
+    void getDensityGradient(const std::vector<float> &x, const std::vector<float> &y, std::vector<float> &gradX,
+                            std::vector<float> &gradY);
+
+    /**
+     * @brief evaluate the preconditioned gradient of the overall objective
+     *
+     * @param x locations of PlacementUnits
+     * @param y locations of PlacementUnits
+     * @param gradX output gradient
+     * @param gradY output gradient
+     * @return double the HPWL of the given locations
+     */
+    double getObjectiveGradient(const std::vector<float> &x, const std::vector<float> &y, std::vector<float> &gradX,
+                                std::vector<float> &gradY);
+
+    /**
+     * @brief move the PlacementUnits into the device area
+     *
+     * @param x
+     * @param y
+     */
+    void legalizeXYInArea(std::vector<float> &x, std::vector<float> &y);
+
+    /**
+     * @brief update the smoothing factor of the wirelength model according to the overflow
+     *
+     */
+    void updateWirelengthGamma();
+
+    void clearDensityFields();
+
+    PlacementInfo *placementInfo;
+    std::map<std::string, std::string> &JSONCfg;
+    bool verbose = false;
+    float y2xRatio = 1.0;
+
+    /**
+     * @brief use log-sum-exp (instead of weighted-average) wirelength model
+     *
+     */
+    bool useLSEWirelength = false;
+
+    /**
+     * @brief the number of Nesterov's iterations in each optimize() call
+     *
+     */
+    int iterNum = 30;
+
+    /**
+     * @brief the deterministic mode, in which the reductions are conducted in an order independent of the number of
+     * threads
+     *
+     */
+    bool deterministic = false;
+
+    /**
+     * @brief the optimization stops once the overflow ratio is lower than the target
+     *
+     */
+    float targetOverflow = 0.1;
+
+    /**
+     * @brief the initial density weight is initialDensityWeightRatio * |gradient of wirelength| / |gradient of density|
+     *
+     */
+    float initialDensityWeightRatio = 8e-5;
+
+    /**
+     * @brief the density weight (lambda) for the density energy, which will be increased along the iterations. (it is
+     * negative if it is not initialized yet)
+     *
+     */
+    float densityWeight = -1;
+
+    /**
+     * @brief the smoothing factor (gamma) of the wirelength model
+     *
+     */
+    float wirelengthGamma = 1.0;
+
+    /**
+     * @brief the overflow ratio (total overflowed demand / total demand) of the latest iteration
+     *
+     */
+    float overflow = 1.0;
+
+    /**
+     * @brief the HPWL of the latest iteration, used to adjust the growth of the density weight
+     *
+     */
+    double lastHPWL = -1;
+
+    /**
+     * @brief the density objects of PlacementUnit i are densityObjects[PUObjectStart[i], PUObjectStart[i+1])
+     *
+     */
+    std::vector<DensityObject> densityObjects;
+    std::vector<int> PUObjectStart;
+    std::vector<int> objectPUId;
+
+    /**
+     * @brief the ids of the density objects for each BEL type
+     *
+     */
+    std::vector<std::vector<int>> BELTypeId2ObjectIds;
+
+    /**
+     * @brief the density field of each BEL type (nullptr if there is no demand for the type)
+     *
+     */
+    std::vector<ElectrostaticDensityField *> densityFields;
+
+    /**
+     * @brief the supplies of each BEL type on the grid of the density field
+     *
+     */
+    std::vector<std::vector<double>> BELTypeId2Capacities;
+
+    /**
+     * @brief the ratio to scale the supplies of each BEL type to neutralize the demands
+     *
+     */
+    std::vector<double> BELTypeId2SupplyScale;
+
+    double totalDemand = 0;
+
+    /**
+     * @brief the pins of PlacementUnit i are PUPinIds[PUPinStart[i], PUPinStart[i+1]) in the flat pin store
+     *
+     */
+    std::vector<int> PUPinStart;
+    std::vector<int> PUPinIds;
+
+    std::vector<float> netWeights;
+    std::vector<float> pinGradX;
+    std::vector<float> pinGradY;
+
+    /**
+     * @brief the HPWL of each net, which are summed up after the gradient evaluation
+     *
+     */
+    std::vector<float> netHPWLs;
+
+    /**
+     * @brief the total demand of each PlacementUnit
+     *
+     */
+    std::vector<float> PUDemand;
+    std::vector<unsigned char> PUFixed;
+
+    /**
+     * @brief the quadratic pseudo nets loaded by WirelengthOptimizer. The pseudo nets of PlacementUnit i are
+     * pseudoNets[PUPseudoNetIds[PUPseudoNetStart[i], PUPseudoNetStart[i+1])] and PUPseudoNetWeight[i] is the sum of
+     * their weights, which is used in the preconditioner.
+     *
+     */
+    std::vector<PseudoNet> pseudoNets;
+    std::vector<int> PUPseudoNetStart;
+    std::vector<int> PUPseudoNetIds;
+    std::vector<float> PUPseudoNetWeight;
+
+    std::vector<float> densityGradX;
+    std::vector<float> densityGradY;
+};
+
+#endif
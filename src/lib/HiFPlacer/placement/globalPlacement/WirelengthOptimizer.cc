@@ -24,6 +24,8 @@
  */
 
 #include "WirelengthOptimizer.h"
+#include "deterministicParallel.h"
+#include "profiler.h"
 
 #include <cmath>
 #include <omp.h>
@@ -40,6 +42,18 @@ WirelengthOptimizer::WirelengthOptimizer(PlacementInfo *placementInfo, std::map<
     {
         useUnconstrainedCG = JSONCfg["useUnconstrainedCG"] == "true";
     }
+    if (JSONCfg.find("QPSolverBackend") != JSONCfg.end())
+    {
+        linearSolverBackend = JSONCfg["QPSolverBackend"];
+    }
+    if (JSONCfg.find("QPSolverMaxIters") != JSONCfg.end())
+    {
+        QPSolverMaxIters = std::stoi(JSONCfg["QPSolverMaxIters"]);
+    }
+    if (JSONCfg.find("QPSolverTolerence") != JSONCfg.end())
+    {
+        QPSolverTolerence = std::stof(JSONCfg["QPSolverTolerence"]);
+    }
     if (JSONCfg.find("pin2pinEnhance") != JSONCfg.end())
     {
         pin2pinEnhance = std::stof(JSONCfg["pin2pinEnhance"]);
@@ -48,6 +62,7 @@ WirelengthOptimizer::WirelengthOptimizer(PlacementInfo *placementInfo, std::map<
         DSPCritical = JSONCfg["DSPCritical"] == "true";
     if (JSONCfg.find("y2xRatio") != JSONCfg.end())
         y2xRatio = std::stof(JSONCfg["y2xRatio"]);
+    deterministic = isDeterministicMode(JSONCfg);
     float leftBound = placementInfo->getGlobalMinX() - 0.5;
     float rightBound = placementInfo->getGlobalMaxX() + 0.5;
     float bottomBound = placementInfo->getGlobalMinY() - 0.5;
@@ -56,6 +71,13 @@ WirelengthOptimizer::WirelengthOptimizer(PlacementInfo *placementInfo, std::map<
                                   placementInfo->getPlacementUnits().size(), verbose);
     ySolver = new QPSolverWrapper(useUnconstrainedCG, MKLorNot, bottomBound, topBound,
                                   placementInfo->getPlacementUnits().size(), verbose);
+    for (auto solver : {xSolver, ySolver})
+    {
+        solver->solverSettings.linearSolverBackend = linearSolverBackend;
+        solver->solverSettings.maxIters = QPSolverMaxIters;
+        solver->solverSettings.tolerence = QPSolverTolerence;
+        solver->solverSettings.deterministic = deterministic;
+    }
     if (JSONCfg.find("DirectMacroLegalize") != JSONCfg.end())
     {
         directMacroLegalize = JSONCfg["DirectMacroLegalize"] == "true";
@@ -80,14 +102,22 @@ void WirelengthOptimizer::reloadPlacementInfo()
                                   placementInfo->getPlacementUnits().size(), verbose);
     ySolver = new QPSolverWrapper(useUnconstrainedCG, MKLorNot, bottomBound, topBound,
                                   placementInfo->getPlacementUnits().size(), verbose);
+    for (auto solver : {xSolver, ySolver})
+    {
+        solver->solverSettings.linearSolverBackend = linearSolverBackend;
+        solver->solverSettings.maxIters = QPSolverMaxIters;
+        solver->solverSettings.tolerence = QPSolverTolerence;
+        solver->solverSettings.deterministic = deterministic;
+    }
 
     netPinEnhanceRate.clear();
+    netPinEnhanceRate.resize(placementInfo->getDesignInfo()->getNets().size());
     for (auto pNet : placementInfo->getPlacementNets())
     {
         auto designNet = pNet->getDesignNet();
         if (!designNet->checkIsPowerNet() && !designNet->checkIsGlobalClock())
         {
-            netPinEnhanceRate[designNet] = std::vector<float>(designNet->getPins().size(), -1);
+            netPinEnhanceRate[designNet->getElementIdInType()].assign(designNet->getPins().size(), -1);
         }
     }
 
@@ -102,6 +132,7 @@ void WirelengthOptimizer::GlobalPlacementQPSolve(float pesudoNetWeight, bool fir
                                                  bool considerNetNum, bool enableUserDefinedClusterOpt,
                                                  float displacementLimit, PlacementTimingOptimizer *timingOptimizer)
 {
+    ProfileZone profileZone("GlobalPlacementQPSolve");
     if (verbose)
         print_status("A QP Iteration Started.");
 
@@ -130,7 +161,11 @@ void WirelengthOptimizer::GlobalPlacementQPSolve(float pesudoNetWeight, bool fir
     t1.join();
     t2.join();
     if (verbose)
-        print_status("Solver Done.");
+        print_status("Solver Done. (" + linearSolverBackend +
+                     ") X: #iterations=" + std::to_string(xSolver->solverData.iterations) +
+                     " residual=" + std::to_string(xSolver->solverData.residual) +
+                     " Y: #iterations=" + std::to_string(ySolver->solverData.iterations) +
+                     " residual=" + std::to_string(ySolver->solverData.residual));
 
     // solverLoadFixedData();
     solverWriteBackData(displacementLimit);
@@ -272,17 +307,14 @@ void WirelengthOptimizer::updateB2BNetWeight(float pesudoNetWeight, bool enableM
     if (verbose)
         print_status("update B2B Net Weight Start.");
 
-    bool updateTrue = true, updateFalse = false;
-    std::thread t1(updateB2BNetWeightWorker, std::ref(placementInfo),
-                   std::ref(xSolver->solverData.objectiveMatrixTripletList),
-                   std::ref(xSolver->solverData.objectiveMatrixDiag), std::ref(xSolver->solverData.objectiveVector),
-                   std::ref(generalNetWeight), std::ref(y2xRatio), std::ref(updateTrue), std::ref(updateFalse));
-    std::thread t2(updateB2BNetWeightWorker, std::ref(placementInfo),
-                   std::ref(ySolver->solverData.objectiveMatrixTripletList),
-                   std::ref(ySolver->solverData.objectiveMatrixDiag), std::ref(ySolver->solverData.objectiveVector),
-                   std::ref(generalNetWeight), std::ref(y2xRatio), std::ref(updateFalse), std::ref(updateTrue));
-    t1.join();
-    t2.join();
+    // the worker reads the PU locations from the flat pin store, so load them before the B2B net model is updated
+    placementInfo->loadNetPinStore();
+    updateB2BNetWeightWorker(placementInfo, xSolver->solverData.objectiveMatrixTripletList,
+                             xSolver->solverData.objectiveMatrixDiag, xSolver->solverData.objectiveVector,
+                             generalNetWeight, y2xRatio, true, false, deterministic);
+    updateB2BNetWeightWorker(placementInfo, ySolver->solverData.objectiveMatrixTripletList,
+                             ySolver->solverData.objectiveMatrixDiag, ySolver->solverData.objectiveVector,
+                             generalNetWeight, y2xRatio, false, true, deterministic);
 
     if (enableMacroPseudoNet2Site && !directMacroLegalize)
     {
@@ -331,32 +363,165 @@ void WirelengthOptimizer::updateB2BNetWeight(float pesudoNetWeight, bool enableM
     }
 }
 
+void WirelengthOptimizer::loadPseudoNetsForNonlinearOptimizer(NonlinearOptimizer *NLOptimizer, float pesudoNetWeight,
+                                                              bool enableMacroPseudoNet2Site, bool considerNetNum,
+                                                              bool enableUserDefinedClusterOpt,
+                                                              PlacementTimingOptimizer *timingOptimizer)
+{
+    assert(NLOptimizer);
+    NLOptimizer->clearPseudoNets();
+    pseudoNetNLOptimizer = NLOptimizer;
+
+    if (enableMacroPseudoNet2Site && !directMacroLegalize)
+    {
+        addPseudoNetForMacros(pesudoNetWeight, considerNetNum);
+    }
+
+    // the same timing-oriented pseudo nets as the first QP iteration in GlobalPlacementQPSolve()
+    if (timingOptimizer)
+    {
+        slackThr = timingOptimizer->getSlackThr();
+        addPseudoNet_SlackBased((0.2 * timingOptimizer->getEffectFactor()) * generalTimingNetWeight, slackPowerFactor,
+                                timingOptimizer, true);
+        addPseudoNet_SlackBased((0.25 * timingOptimizer->getEffectFactor()) * generalTimingNetWeight, slackPowerFactor,
+                                timingOptimizer);
+        if (timingOptimizer->getEffectFactor() > 0.5)
+            LUTLUTPairing_TimingDriven((0.25 * timingOptimizer->getEffectFactor()) * generalTimingNetWeight,
+                                       pin2pinEnhance, timingOptimizer);
+    }
+
+    if (enableUserDefinedClusterOpt)
+    {
+        updatePseudoNetForUserDefinedClusters(pesudoNetWeight);
+    }
+
+    updatePseudoNetForClockRegion(0.2 * pesudoNetWeight);
+
+    pseudoNetNLOptimizer = nullptr;
+}
+
+void WirelengthOptimizer::addPseudoNet_Pin2Pin(PlacementInfo::PlacementNet *curNet, float weight, int PUIdA, int PUIdB,
+                                               int pinIdA_net, int pinIdB_net)
+{
+    if (pseudoNetNLOptimizer)
+    {
+        auto &pinOffsetsInUnit = curNet->getPinOffsetsInUnit();
+        pseudoNetNLOptimizer->addPseudoNet(PUIdA, pinOffsetsInUnit[pinIdA_net].x, pinOffsetsInUnit[pinIdA_net].y, PUIdB,
+                                           pinOffsetsInUnit[pinIdB_net].x, pinOffsetsInUnit[pinIdB_net].y, weight,
+                                           weight * y2xRatio);
+        return;
+    }
+    curNet->addPseudoNet_enhancePin2Pin(xSolver->solverData.objectiveMatrixTripletList,
+                                        xSolver->solverData.objectiveMatrixDiag, xSolver->solverData.objectiveVector,
+                                        weight, y2xRatio, true, false, PUIdA, PUIdB, pinIdA_net, pinIdB_net);
+    curNet->addPseudoNet_enhancePin2Pin(ySolver->solverData.objectiveMatrixTripletList,
+                                        ySolver->solverData.objectiveMatrixDiag, ySolver->solverData.objectiveVector,
+                                        weight, y2xRatio, false, true, PUIdA, PUIdB, pinIdA_net, pinIdB_net);
+}
+
+void WirelengthOptimizer::addPseudoNet_PU2Location(PlacementInfo::PlacementUnit *curPU, float targetLoc, float weight,
+                                                   bool updateX)
+{
+    if (pseudoNetNLOptimizer)
+    {
+        if (curPU->isFixed())
+            return;
+        if (updateX)
+            pseudoNetNLOptimizer->addPseudoNet2Location(curPU->getId(), targetLoc, 0, weight, 0);
+        else
+            pseudoNetNLOptimizer->addPseudoNet2Location(curPU->getId(), 0, targetLoc, 0, weight * y2xRatio);
+        return;
+    }
+    if (updateX)
+        placementInfo->addPseudoNetsInPlacementInfo(
+            xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
+            xSolver->solverData.objectiveVector, curPU, targetLoc, weight, y2xRatio, true, false);
+    else
+        placementInfo->addPseudoNetsInPlacementInfo(
+            ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
+            ySolver->solverData.objectiveVector, curPU, targetLoc, weight, y2xRatio, false, true);
+}
+
 void WirelengthOptimizer::updateB2BNetWeightWorker(PlacementInfo *placementInfo,
                                                    std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList,
                                                    std::vector<float> &objectiveMatrixDiag,
                                                    Eigen::VectorXd &objectiveVector, float generalNetWeight,
-                                                   float y2xRatio, bool updateX, bool updateY)
+                                                   float y2xRatio, bool updateX, bool updateY, bool deterministic)
 {
+    int numPUs = placementInfo->getPlacementUnits().size();
+    auto &pinStore = placementInfo->getNetPinStore();
+    auto &placementNets = placementInfo->getPlacementNets();
+    int numNets = placementNets.size();
+    int numChunks = getParallelChunkNum(numNets, deterministic);
+
+    // partition the nets into contiguous chunks with similar numbers of pins. Each chunk is handled by a thread with
+    // its own buffers, which are merged in the chunk order, so the result does not depend on the thread scheduling.
+    std::vector<int> chunkNetBegin(numChunks + 1, numNets);
+    chunkNetBegin[0] = 0;
+    int numPins = numNets ? pinStore.getPinEnd(numNets - 1) : 0;
+    for (int chunkId = 1, netId = 0; chunkId < numChunks; chunkId++)
+    {
+        long long pinThr = (long long)numPins * chunkId / numChunks;
+        while (netId < numNets && pinStore.getPinBegin(netId) < pinThr)
+            netId++;
+        chunkNetBegin[chunkId] = netId;
+    }
+
+    std::vector<std::vector<Eigen::Triplet<float>>> chunkTriplets(numChunks);
+    std::vector<std::vector<float>> chunkDiag(numChunks);
+    std::vector<Eigen::VectorXd> chunkVector(numChunks);
+
+#pragma omp parallel for schedule(static, 1)
+    for (int chunkId = 0; chunkId < numChunks; chunkId++)
+    {
+        chunkDiag[chunkId].resize(numPUs, 0);
+        chunkVector[chunkId] = Eigen::VectorXd::Zero(numPUs);
+        for (int netId = chunkNetBegin[chunkId]; netId < chunkNetBegin[chunkId + 1]; netId++)
+        {
+            auto net = placementNets[netId];
+            if (net->getDesignNet()->checkIsPowerNet()) // Power nets are on the entrie device. Ignore them.
+                continue;
+
+            if (net->updateNetBounds(pinStore, updateX, updateY))
+            {
+                net->updateBound2BoundNetWeight(pinStore, chunkTriplets[chunkId], chunkDiag[chunkId],
+                                                chunkVector[chunkId], generalNetWeight, y2xRatio, updateX, updateY);
+            }
+        }
+    }
+
+    std::vector<unsigned int> chunkTripletBegin(numChunks + 1, 0);
+    for (int chunkId = 0; chunkId < numChunks; chunkId++)
+        chunkTripletBegin[chunkId + 1] = chunkTripletBegin[chunkId] + chunkTriplets[chunkId].size();
+
     objectiveMatrixTripletList.clear();
+    objectiveMatrixTripletList.resize(chunkTripletBegin[numChunks], Eigen::Triplet<float>(0, 0, 0));
     objectiveMatrixDiag.clear();
-    objectiveMatrixDiag.resize(placementInfo->getPlacementUnits().size(), 0);
-    objectiveVector = Eigen::VectorXd::Zero(placementInfo->getPlacementUnits().size());
-    for (auto net : placementInfo->getPlacementNets())
+    objectiveMatrixDiag.resize(numPUs, 0);
+    objectiveVector = Eigen::VectorXd::Zero(numPUs);
+
+#pragma omp parallel for schedule(static, 1)
+    for (int chunkId = 0; chunkId < numChunks; chunkId++)
     {
-        if (net->getDesignNet()->checkIsPowerNet()) // Power nets are on the entrie device. Ignore them.
-            continue;
+        std::copy(chunkTriplets[chunkId].begin(), chunkTriplets[chunkId].end(),
+                  objectiveMatrixTripletList.begin() + chunkTripletBegin[chunkId]);
+    }
 
-        if (net->updateNetBounds(updateX, updateY))
+#pragma omp parallel for
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        for (int chunkId = 0; chunkId < numChunks; chunkId++)
         {
-            net->updateBound2BoundNetWeight(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector,
-                                            generalNetWeight, y2xRatio, updateX, updateY);
+            objectiveMatrixDiag[PUId] += chunkDiag[chunkId][PUId];
+            objectiveVector[PUId] += chunkVector[chunkId][PUId];
         }
     }
 }
+
 void WirelengthOptimizer::addPseudoNetForMacros(float pesudoNetWeight, bool considerNetNum)
 {
-    std::map<PlacementInfo::PlacementUnit *, float> &PUX = placementInfo->getPULegalXY().first;
-    std::map<PlacementInfo::PlacementUnit *, float> &PUY = placementInfo->getPULegalXY().second;
+    IdIndexedMap<PlacementInfo::PlacementUnit, float> &PUX = placementInfo->getPULegalXY().first;
+    IdIndexedMap<PlacementInfo::PlacementUnit, float> &PUY = placementInfo->getPULegalXY().second;
     macroPseudoNetCnt++;
 
     if (placementInfo->getProgress() > 0.8)
@@ -372,61 +537,49 @@ void WirelengthOptimizer::addPseudoNetForMacros(float pesudoNetWeight, bool cons
         for (auto pairPUX : PUX)
         {
             if (!pairPUX.first->checkHasBRAM() && !pairPUX.first->checkHasDSP() && !pairPUX.first->checkHasCARRY())
-                placementInfo->addPseudoNetsInPlacementInfo(
-                    xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                    xSolver->solverData.objectiveVector, pairPUX.first, pairPUX.second,
-                    macroPseudoNetFactor * pesudoNetWeight * pairPUX.first->getNetsSetPtr()->size() / 3, y2xRatio, true,
-                    false); // CLB-like element
+                addPseudoNet_PU2Location(
+                    pairPUX.first, pairPUX.second,
+                    macroPseudoNetFactor * pesudoNetWeight * pairPUX.first->getNetsSetPtr()->size() / 3,
+                    true); // CLB-like element
             else if (pairPUX.first->checkHasCARRY())
-                placementInfo->addPseudoNetsInPlacementInfo(
-                    xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                    xSolver->solverData.objectiveVector, pairPUX.first, pairPUX.second,
-                    macroPseudoNetFactor * pesudoNetWeight * pairPUX.first->getNetsSetPtr()->size() / 5, y2xRatio, true,
-                    false); // CARRY-CHAIN-like element
+                addPseudoNet_PU2Location(
+                    pairPUX.first, pairPUX.second,
+                    macroPseudoNetFactor * pesudoNetWeight * pairPUX.first->getNetsSetPtr()->size() / 5,
+                    true); // CARRY-CHAIN-like element
             else
-                placementInfo->addPseudoNetsInPlacementInfo(
-                    xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                    xSolver->solverData.objectiveVector, pairPUX.first, pairPUX.second,
-                    macroPseudoNetFactor * pesudoNetWeight * pairPUX.first->getNetsSetPtr()->size(), y2xRatio, true,
-                    false); // DSP-BRAM-like element
+                addPseudoNet_PU2Location(
+                    pairPUX.first, pairPUX.second,
+                    macroPseudoNetFactor * pesudoNetWeight * pairPUX.first->getNetsSetPtr()->size(),
+                    true); // DSP-BRAM-like element
         }
         for (auto pairPUY : PUY)
         {
             if (!pairPUY.first->checkHasBRAM() && !pairPUY.first->checkHasDSP() && !pairPUY.first->checkHasCARRY())
-                placementInfo->addPseudoNetsInPlacementInfo(
-                    ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                    ySolver->solverData.objectiveVector, pairPUY.first, pairPUY.second,
-                    macroPseudoNetFactor * pesudoNetWeight * pairPUY.first->getNetsSetPtr()->size() / 3, y2xRatio,
-                    false, true); // CLB-like element
+                addPseudoNet_PU2Location(
+                    pairPUY.first, pairPUY.second,
+                    macroPseudoNetFactor * pesudoNetWeight * pairPUY.first->getNetsSetPtr()->size() / 3,
+                    false); // CLB-like element
             else if (pairPUY.first->checkHasCARRY())
-                placementInfo->addPseudoNetsInPlacementInfo(
-                    ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                    ySolver->solverData.objectiveVector, pairPUY.first, pairPUY.second,
-                    macroPseudoNetFactor * pesudoNetWeight * pairPUY.first->getNetsSetPtr()->size() / 5, y2xRatio,
-                    false, true); // CARRY-CHAIN-like element
+                addPseudoNet_PU2Location(
+                    pairPUY.first, pairPUY.second,
+                    macroPseudoNetFactor * pesudoNetWeight * pairPUY.first->getNetsSetPtr()->size() / 5,
+                    false); // CARRY-CHAIN-like element
             else
-                placementInfo->addPseudoNetsInPlacementInfo(
-                    ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                    ySolver->solverData.objectiveVector, pairPUY.first, pairPUY.second,
-                    macroPseudoNetFactor * pesudoNetWeight * pairPUY.first->getNetsSetPtr()->size(), y2xRatio, false,
-                    true); // DSP-BRAM-like element
+                addPseudoNet_PU2Location(
+                    pairPUY.first, pairPUY.second,
+                    macroPseudoNetFactor * pesudoNetWeight * pairPUY.first->getNetsSetPtr()->size(),
+                    false); // DSP-BRAM-like element
         }
     }
     else
     {
         for (auto pairPUX : PUX)
         {
-            placementInfo->addPseudoNetsInPlacementInfo(
-                xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                xSolver->solverData.objectiveVector, pairPUX.first, pairPUX.second,
-                macroPseudoNetFactor * pesudoNetWeight, y2xRatio, true, false);
+            addPseudoNet_PU2Location(pairPUX.first, pairPUX.second, macroPseudoNetFactor * pesudoNetWeight, true);
         }
         for (auto pairPUY : PUY)
         {
-            placementInfo->addPseudoNetsInPlacementInfo(
-                ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                ySolver->solverData.objectiveVector, pairPUY.first, pairPUY.second,
-                macroPseudoNetFactor * pesudoNetWeight, y2xRatio, false, true);
+            addPseudoNet_PU2Location(pairPUY.first, pairPUY.second, macroPseudoNetFactor * pesudoNetWeight, false);
         }
     }
 }
@@ -519,7 +672,7 @@ void WirelengthOptimizer::addPseudoNet_SlackBased(float timingWeight, double sla
             {
                 std::cout << "driver: " << targetCellName << " x: " << srcLoc.X << " y: " << srcLoc.Y << "\n";
             }
-            auto &pinEnhanceRate = netPinEnhanceRate[designNet];
+            auto &pinEnhanceRate = netPinEnhanceRate[designNet->getElementIdInType()];
             // iterate the sinkPin for evaluation and enhancement
             float timingEffect = timingOptimizer->getEffectFactor();
             for (int pinBeDriven = 0; pinBeDriven < pinNum; pinBeDriven++)
@@ -646,15 +799,8 @@ void WirelengthOptimizer::addPseudoNet_SlackBased(float timingWeight, double sla
             auto curNet = placementInfo->getPlacementNets()[PNetId];
             for (auto enhanceTuple : *PNetId2SlackEnhanceTuples[PNetId])
             {
-                curNet->addPseudoNet_enhancePin2Pin(
-                    xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                    xSolver->solverData.objectiveVector, enhanceTuple.weight, y2xRatio, true, false, enhanceTuple.PUAId,
-                    enhanceTuple.PUBId, enhanceTuple.PinAId, enhanceTuple.PinBId);
-
-                curNet->addPseudoNet_enhancePin2Pin(
-                    ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                    ySolver->solverData.objectiveVector, enhanceTuple.weight, y2xRatio, false, true, enhanceTuple.PUAId,
-                    enhanceTuple.PUBId, enhanceTuple.PinAId, enhanceTuple.PinBId);
+                addPseudoNet_Pin2Pin(curNet, enhanceTuple.weight, enhanceTuple.PUAId, enhanceTuple.PUBId,
+                                     enhanceTuple.PinAId, enhanceTuple.PinBId);
             }
         }
     }
@@ -687,8 +833,7 @@ void WirelengthOptimizer::LUTLUTPairing_TimingDriven(float timingWeight, float d
     // int targetCellId = placementInfo->getDesignInfo()->getCell(targetCellName)->getCellId();
     for (auto curCell : placementInfo->getDesignInfo()->getCells())
     {
-        auto predLUTPU =
-            dynamic_cast<PlacementInfo::PlacementUnit *>(placementInfo->getPlacementUnitByCellId(curCell->getCellId()));
+        auto predLUTPU = placementInfo->getPlacementUnitByCellId(curCell->getCellId());
         if ((curCell->isLUT() || curCell->isMux() || curCell->isCarry()) && !curCell->isVirtualCell())
         {
             assert(curCell->getOutputPins().size() > 0);
@@ -798,15 +943,8 @@ void WirelengthOptimizer::LUTLUTPairing_TimingDriven(float timingWeight, float d
                                       << " y: " << srcLoc.Y << " netDelay: " << netDelay << " slack: " << slack
                                       << " w: " << w << " enhanceRatio: " << enhanceRatio << "\n";
                         }
-                        curPNet->addPseudoNet_enhancePin2Pin(
-                            xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                            xSolver->solverData.objectiveVector, w * enhanceRatio, y2xRatio, true, false,
-                            predLUTPU->getId(), succLUTPU->getId(), driverPinInNet, pinBeDriven);
-
-                        curPNet->addPseudoNet_enhancePin2Pin(
-                            ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                            ySolver->solverData.objectiveVector, w * enhanceRatio, y2xRatio, false, true,
-                            predLUTPU->getId(), succLUTPU->getId(), driverPinInNet, pinBeDriven);
+                        addPseudoNet_Pin2Pin(curPNet, w * enhanceRatio, predLUTPU->getId(), succLUTPU->getId(),
+                                             driverPinInNet, pinBeDriven);
                     }
                 }
             }
@@ -1015,16 +1153,12 @@ void WirelengthOptimizer::updatePseudoNetForUserDefinedClusters(float pesudoNetW
                     float fY = avgY;
                     placementInfo->legalizeXYInArea(tmpPU, fX, fY);
 
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, tmpPU, fX,
-                        userDefinedClusterFadeOutFactor * clusterFactor * pesudoNetWeight, y2xRatio, true, false);
+                    addPseudoNet_PU2Location(tmpPU, fX,
+                                             userDefinedClusterFadeOutFactor * clusterFactor * pesudoNetWeight, true);
 
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        ySolver->solverData.objectiveMatrixTripletList, ySolver->solverData.objectiveMatrixDiag,
-                        ySolver->solverData.objectiveVector, tmpPU, fY,
-                        1.0 / y2xRatio * userDefinedClusterFadeOutFactor * clusterFactor * pesudoNetWeight, y2xRatio,
-                        false, true);
+                    addPseudoNet_PU2Location(
+                        tmpPU, fY, 1.0 / y2xRatio * userDefinedClusterFadeOutFactor * clusterFactor * pesudoNetWeight,
+                        false);
 
                     if (reallocatedPUs.find(tmpPU) == reallocatedPUs.end())
                     {
@@ -1062,21 +1196,14 @@ void WirelengthOptimizer::updatePseudoNetForClockRegion(float pesudoNetWeight)
             if (clockRegionX == 2)
             {
                 if (std::fabs(curPU->X() - cX) > 6)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        pesudoNetWeight * std::pow(curPU->getNetsSetPtr()->size(), 1.1), y2xRatio, true, false);
+                    addPseudoNet_PU2Location(curPU, cX, pesudoNetWeight * std::pow(curPU->getNetsSetPtr()->size(), 1.1),
+                                             true);
                 else if (std::fabs(curPU->X() - cX) > 3 && !DSPCritical)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        pesudoNetWeight * curPU->getNetsSetPtr()->size(), y2xRatio, true, false);
+                    addPseudoNet_PU2Location(curPU, cX, pesudoNetWeight * curPU->getNetsSetPtr()->size(), true);
                 else if (!DSPCritical)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        std::fabs(curPU->X() - cX) / 3 * pesudoNetWeight * curPU->getNetsSetPtr()->size(), y2xRatio,
-                        true, false);
+                    addPseudoNet_PU2Location(
+                        curPU, cX, std::fabs(curPU->X() - cX) / 3 * pesudoNetWeight * curPU->getNetsSetPtr()->size(),
+                        true);
             }
             else if (clockRegionX < 2)
             {
@@ -1085,21 +1212,14 @@ void WirelengthOptimizer::updatePseudoNetForClockRegion(float pesudoNetWeight)
                 float rRight = clockRegions[0][1]->getRight();
                 cX = (rLeft + rRight) / 2;
                 if ((curPU->X() - cX) > 6)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        pesudoNetWeight * std::pow(curPU->getNetsSetPtr()->size(), 1.1), y2xRatio, true, false);
+                    addPseudoNet_PU2Location(curPU, cX, pesudoNetWeight * std::pow(curPU->getNetsSetPtr()->size(), 1.1),
+                                             true);
                 else if ((curPU->X() - cX) > 3 && !DSPCritical)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        pesudoNetWeight * curPU->getNetsSetPtr()->size(), y2xRatio, true, false);
+                    addPseudoNet_PU2Location(curPU, cX, pesudoNetWeight * curPU->getNetsSetPtr()->size(), true);
                 else if ((curPU->X() - cX) > 0 && !DSPCritical)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        (curPU->X() - cX) / 3 * pesudoNetWeight * curPU->getNetsSetPtr()->size(), y2xRatio, true,
-                        false);
+                    addPseudoNet_PU2Location(curPU, cX,
+                                             (curPU->X() - cX) / 3 * pesudoNetWeight * curPU->getNetsSetPtr()->size(),
+                                             true);
             }
             else if (clockRegionX > 2)
             {
@@ -1107,21 +1227,14 @@ void WirelengthOptimizer::updatePseudoNetForClockRegion(float pesudoNetWeight)
                 float rRight = clockRegions[0][3]->getRight();
                 cX = (rLeft + rRight) / 2;
                 if ((curPU->X() - cX) < -6)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        pesudoNetWeight * std::pow(curPU->getNetsSetPtr()->size(), 1.1), y2xRatio, true, false);
+                    addPseudoNet_PU2Location(curPU, cX, pesudoNetWeight * std::pow(curPU->getNetsSetPtr()->size(), 1.1),
+                                             true);
                 else if ((curPU->X() - cX) < -3 && !DSPCritical)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        pesudoNetWeight * curPU->getNetsSetPtr()->size(), y2xRatio, true, false);
+                    addPseudoNet_PU2Location(curPU, cX, pesudoNetWeight * curPU->getNetsSetPtr()->size(), true);
                 else if ((curPU->X() - cX) < 0 && !DSPCritical)
-                    placementInfo->addPseudoNetsInPlacementInfo(
-                        xSolver->solverData.objectiveMatrixTripletList, xSolver->solverData.objectiveMatrixDiag,
-                        xSolver->solverData.objectiveVector, curPU, cX,
-                        (cX - curPU->X()) / 3 * pesudoNetWeight * curPU->getNetsSetPtr()->size(), y2xRatio, true,
-                        false);
+                    addPseudoNet_PU2Location(curPU, cX,
+                                             (cX - curPU->X()) / 3 * pesudoNetWeight * curPU->getNetsSetPtr()->size(),
+                                             true);
             }
         }
 
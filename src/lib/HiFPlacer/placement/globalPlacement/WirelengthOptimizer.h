@@ -30,9 +30,11 @@
 #include "DeviceInfo.h"
 #include "Eigen/Eigen"
 #include "Eigen/SparseCore"
+#include "NonlinearOptimizer.h"
 #include "PlacementInfo.h"
 #include "PlacementTimingOptimizer.h"
 #include "QPSolverWrapper.h"
+#include <algorithm>
 #include <assert.h>
 #include <fstream>
 #include <iostream>
@@ -111,9 +113,32 @@ class WirelengthOptimizer
                             bool enableUserDefinedClusterOpt = false,
                             PlacementTimingOptimizer *timingOptimizer = nullptr);
 
+    /**
+     * @brief load the legalization, timing-oriented, user-defined cluster and clock region pseudo nets into the
+     * nonlinear optimizer
+     *
+     * The pseudo nets are the same as those added to the QP problem by GlobalPlacementQPSolve(), so the macro
+     * legalization, timing and clock region optimizations are not lost when the nonlinear lower-bound engine is used.
+     *
+     * @param NLOptimizer the nonlinear optimizer to load the pseudo nets
+     * @param pesudoNetWeight the common weight factor for pseudo nets
+     * @param enableMacroPseudoNet2Site enable the legalization pseudo net to force macros move to the legal site
+     * @param considerNetNum whether add the interconnection-density-aware factor to pseudo net weights
+     * @param enableUserDefinedClusterOpt whether check user-defined cluster information to add pseudo nets
+     * @param timingOptimizer the handler of timing-related analysis (nullptr to disable the timing-oriented pseudo
+     * nets)
+     */
+    void loadPseudoNetsForNonlinearOptimizer(NonlinearOptimizer *NLOptimizer, float pesudoNetWeight,
+                                             bool enableMacroPseudoNet2Site, bool considerNetNum,
+                                             bool enableUserDefinedClusterOpt,
+                                             PlacementTimingOptimizer *timingOptimizer);
+
     /**
      * @brief a worker funtion for multi-threading net weight updating
      *
+     * The nets are partitioned into chunks with similar pin counts and the chunks are processed by OpenMP threads with
+     * thread-local buffers, which are merged in a fixed order afterwards.
+     *
      *  min_x 0.5 * x'Px + q'x
      *  s.t.  l <= Ax <= u
      *
@@ -128,11 +153,14 @@ class WirelengthOptimizer
      * X-coordinate
      * @param updateX update the X-coordinate term in the quadratic problem
      * @param updateY update the X-coordinate term in the quadratic problem
+     * @param deterministic split the nets into a fixed number of chunks so the accumulated weights are the same for
+     * any number of threads
      */
     static void updateB2BNetWeightWorker(PlacementInfo *placementInfo,
                                          std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList,
                                          std::vector<float> &objectiveMatrixDiag, Eigen::VectorXd &objectiveVector,
-                                         float generalNetWeight, float y2xRatio, bool updateX, bool updateY);
+                                         float generalNetWeight, float y2xRatio, bool updateX, bool updateY,
+                                         bool deterministic);
 
     /**
      * @brief re-initialize some parameters and optimizer configuration according to the PlacementInfo
@@ -180,7 +208,8 @@ class WirelengthOptimizer
 
     inline void clearNetPinEnhanceRate()
     {
-        netPinEnhanceRate.clear();
+        for (auto &pinEnhanceRate : netPinEnhanceRate)
+            std::fill(pinEnhanceRate.begin(), pinEnhanceRate.end(), -1);
     }
 
     inline void setGeneralTimingNetWeight(float _generalTimingNetWeight)
@@ -289,6 +318,38 @@ class WirelengthOptimizer
      */
     void updatePseudoNetForClockRegion(float pesudoNetWeight);
 
+    /**
+     * @brief add a pseudo net between two pins of a PlacementNet to the QP problem, or to the nonlinear optimizer when
+     * the pseudo nets are loaded for it
+     *
+     * @param curNet the PlacementNet of the pins
+     * @param weight the weight of the pseudo net
+     * @param PUIdA the id of the PlacementUnit of pin A
+     * @param PUIdB the id of the PlacementUnit of pin B
+     * @param pinIdA_net the index of pin A in the net
+     * @param pinIdB_net the index of pin B in the net
+     */
+    void addPseudoNet_Pin2Pin(PlacementInfo::PlacementNet *curNet, float weight, int PUIdA, int PUIdB, int pinIdA_net,
+                              int pinIdB_net);
+
+    /**
+     * @brief add a pseudo net between a PlacementUnit and a location in one dimension to the QP problem, or to the
+     * nonlinear optimizer when the pseudo nets are loaded for it
+     *
+     * @param curPU the PlacementUnit
+     * @param targetLoc the location in the dimension
+     * @param weight the weight of the pseudo net
+     * @param updateX whether the pseudo net is in X-coordinate (otherwise Y-coordinate)
+     */
+    void addPseudoNet_PU2Location(PlacementInfo::PlacementUnit *curPU, float targetLoc, float weight, bool updateX);
+
+    /**
+     * @brief the nonlinear optimizer which receives the pseudo nets during loadPseudoNetsForNonlinearOptimizer()
+     * (nullptr if the pseudo nets are added to the QP problem)
+     *
+     */
+    NonlinearOptimizer *pseudoNetNLOptimizer = nullptr;
+
     /**
      * @brief evaluate the Mahattan distance between two locations
      *
@@ -363,6 +424,26 @@ class WirelengthOptimizer
      */
     bool MKLorNot = false;
 
+    /**
+     * @brief the linear solver backend for the unconstrained QP problem (see LinearSolverBackend::createBackend)
+     *
+     */
+    std::string linearSolverBackend = "CG";
+
+    /**
+     * @brief the maximum number of iterations and the tolerence of the relative residual of the linear solver
+     *
+     */
+    int QPSolverMaxIters = 500;
+    float QPSolverTolerence = 0.001;
+
+    /**
+     * @brief the deterministic mode, in which the QP problems and their solutions are the same for any number of
+     * threads
+     *
+     */
+    bool deterministic = false;
+
     /**
      * @brief indicate whether we use direct macro legalization instread of the progressive legalization (2-phase
      * legalization)
@@ -398,7 +479,11 @@ class WirelengthOptimizer
      */
     int macroPseudoNetCnt = 0;
 
-    std::map<DesignInfo::DesignNet *, std::vector<float>> netPinEnhanceRate;
+    /**
+     * @brief the timing enhancement rates of the pins of each design net, indexed by the ids of the design nets
+     *
+     */
+    std::vector<std::vector<float>> netPinEnhanceRate;
 
     float slackThr = 0;
 
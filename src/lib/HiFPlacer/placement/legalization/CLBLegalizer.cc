@@ -24,6 +24,7 @@
  */
 
 #include "CLBLegalizer.h"
+#include "profiler.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -32,12 +33,11 @@
 
 CLBLegalizer::CLBLegalizer(std::string legalizerName, PlacementInfo *placementInfo, DeviceInfo *deviceInfo,
                            std::vector<std::string> &siteTypesToLegalize, std::map<std::string, std::string> &JSONCfg)
-    : legalizerName(legalizerName), placementInfo(placementInfo), deviceInfo(deviceInfo),
+    : legalizerName(legalizerName), placementInfo(placementInfo), deviceInfo(deviceInfo), HPWLTracker(placementInfo),
       compatiblePlacementTable(placementInfo->getCompatiblePlacementTable()), siteTypesToLegalize(siteTypesToLegalize),
       cellLoc(placementInfo->getCellId2location()), JSONCfg(JSONCfg)
 {
     PUsToLegalize.clear();
-    PU2Site2HPWLIncrease.clear();
     PU2X.clear();
     PU2Y.clear();
     PU2LegalSites.clear();
@@ -73,13 +73,22 @@ CLBLegalizer::CLBLegalizer(std::string legalizerName, PlacementInfo *placementIn
     {
         nJobs = std::stoi(JSONCfg["jobs"]);
     }
+    randomStream.reseed(RandomStream::getSeedFromConfig(JSONCfg), 0, RandomStream::StreamDomain_CLBLegalizer);
+
+    if (JSONCfg.find("LegalizationMatcher") != JSONCfg.end())
+    {
+        if (JSONCfg["LegalizationMatcher"] == "Auction")
+            matcherAlgorithm = MinCostBipartiteMatcher::MatcherAlgorithm_Auction;
+        else
+            assert(JSONCfg["LegalizationMatcher"] == "MinCostFlow");
+    }
 }
 
 void CLBLegalizer::legalize(bool exactLegalization)
 {
+    ProfileZone profileZone("CLBLegalizer");
     if (verbose)
         print_status("CLBLegalizer Started Legalization.");
-    PU2Site2HPWLIncrease.clear();
     resetSettings();
     findSiteType2AvailableSites();
     getPUsToLegalize();
@@ -113,6 +122,7 @@ void CLBLegalizer::legalize(bool exactLegalization)
 
 void CLBLegalizer::roughlyLegalize()
 {
+    HPWLTracker.build(y2xRatio);
     while (PUsToLegalize.size())
     {
         findPU2SitesInDistance();
@@ -120,8 +130,7 @@ void CLBLegalizer::roughlyLegalize()
         resetPU2SitesInDistance();
 
         createBipartiteGraph();
-        minCostBipartiteMatcher =
-            new MinCostBipartiteMatcher(PU2Sites.size(), rightSiteIds.size(), PU2Sites.size(), adjList, nJobs, verbose);
+        createMatcher();
 
         minCostBipartiteMatcher->solve();
         updateMatchingAndUnmatchedPUs();
@@ -142,6 +151,7 @@ void CLBLegalizer::fixedColumnLegalize()
     resolveOverflowColumns();
 
     PUsToLegalize = initialPUsToLegalize;
+    HPWLTracker.build(y2xRatio);
 
     while (PUsToLegalize.size())
     {
@@ -149,8 +159,7 @@ void CLBLegalizer::fixedColumnLegalize()
         findPossibleLegalLocation(true);
         resetPU2SitesInDistance();
         createBipartiteGraph();
-        minCostBipartiteMatcher =
-            new MinCostBipartiteMatcher(PU2Sites.size(), rightSiteIds.size(), PU2Sites.size(), adjList, nJobs, verbose);
+        createMatcher();
 
         minCostBipartiteMatcher->solve();
         updateMatchingAndUnmatchedPUs();
@@ -171,6 +180,7 @@ void CLBLegalizer::finalLegalizeBasedOnDP()
     PU2Y.clear();
     resetSettings();
     PU2LegalSites.clear();
+    HPWLTracker.build(y2xRatio);
 
     float tmpAverageDisplacement = 0.0;
     tmpAverageDisplacement += DPForMinHPWL(MCLBColumnNum, MCLBColumn2Sites, MCLBColumn2PUs);
@@ -199,13 +209,13 @@ float CLBLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo:
     // std::stringstream outfile0;
 
     float tmpTotalDisplacement = 0.0;
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
     PU2Sites.clear();
     for (auto &PUDeque : Column2PUs)
     {
         for (auto tmpPU : PUDeque)
         {
-            assert(PU2Sites.find(tmpPU) == PU2Sites.end());
+            assert(!PU2Sites.count(tmpPU));
             PU2Sites[tmpPU] = std::vector<DeviceInfo::DeviceSite *>();
         }
     }
@@ -316,10 +326,10 @@ float CLBLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo:
     {
         for (auto tmpPU : PUDeque)
         {
-            assert(PU2Sites.find(tmpPU) != PU2Sites.end());
+            assert(PU2Sites.count(tmpPU));
             auto curSite = PU2Sites[tmpPU][0];
             assert(curSite);
-            assert(PU2X.find(tmpPU) == PU2X.end());
+            assert(!PU2X.count(tmpPU));
             PU2X[tmpPU] = curSite->X();
             PU2Y[tmpPU] = curSite->Y();
             PU2LegalSites[tmpPU] = PU2Sites[tmpPU];
@@ -365,10 +375,6 @@ void CLBLegalizer::getPUsToLegalize()
         }
     }
     initialPUsToLegalize = PUsToLegalize;
-    for (auto curPU : PUsToLegalize)
-    {
-        PU2Site2HPWLIncrease[curPU] = std::map<DeviceInfo::DeviceSite *, float>();
-    }
 }
 
 void CLBLegalizer::findSiteType2AvailableSites()
@@ -597,8 +603,49 @@ void CLBLegalizer::createBipartiteGraph()
     }
 }
 
+void CLBLegalizer::createMatcher()
+{
+    minCostBipartiteMatcher = new MinCostBipartiteMatcher(PUsToLegalize.size(), rightSiteIds.size(),
+                                                          PUsToLegalize.size(), adjList, nJobs, verbose,
+                                                          matcherAlgorithm);
+    if (matcherAlgorithm != MinCostBipartiteMatcher::MatcherAlgorithm_Auction)
+        return;
+
+    // the matching and the prices of the sites in the previous legalization are used as the initial solution
+    std::vector<int> initialLeft2Right(PUsToLegalize.size(), -1);
+    std::vector<float> initialRightPrices(siteList.size(), 0);
+    for (unsigned int leftCellId = 0; leftCellId < PUsToLegalize.size(); leftCellId++)
+    {
+        auto it = PU2LastMatchedSite.find(PUsToLegalize[leftCellId]);
+        if (it == PU2LastMatchedSite.end())
+            continue;
+        auto siteIt = rightSiteIds.find(it->second);
+        if (siteIt != rightSiteIds.end())
+            initialLeft2Right[leftCellId] = siteIt->second;
+    }
+    for (unsigned int rightNode = 0; rightNode < siteList.size(); rightNode++)
+    {
+        auto it = site2MatchingPrice.find(siteList[rightNode]);
+        if (it != site2MatchingPrice.end())
+            initialRightPrices[rightNode] = it->second;
+    }
+    minCostBipartiteMatcher->setWarmStart(initialLeft2Right, initialRightPrices);
+}
+
 void CLBLegalizer::updateMatchingAndUnmatchedPUs()
 {
+    if (matcherAlgorithm == MinCostBipartiteMatcher::MatcherAlgorithm_Auction)
+    {
+        for (unsigned int leftCellId = 0; leftCellId < PUsToLegalize.size(); leftCellId++)
+        {
+            int rightNode = minCostBipartiteMatcher->getMatchedRightNode(leftCellId);
+            if (rightNode >= 0)
+                PU2LastMatchedSite[PUsToLegalize[leftCellId]] = siteList[rightNode];
+        }
+        for (unsigned int rightNode = 0; rightNode < siteList.size(); rightNode++)
+            site2MatchingPrice[siteList[rightNode]] = minCostBipartiteMatcher->getRightNodePrice(rightNode);
+    }
+
     for (unsigned int leftCellId = 0; leftCellId < PUsToLegalize.size(); leftCellId++)
     {
         int rightNode = minCostBipartiteMatcher->getMatchedRightNode(leftCellId);
@@ -742,7 +789,7 @@ void CLBLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool updat
         auto matchedSite = matchedPair.second;
         auto curPU = matchedPair.first;
 
-        if (PU2Y.find(curPU) == PU2Y.end())
+        if (!PU2Y.count(curPU))
         {
             PU2SiteX[curPU] = -1;
             PU2Y[curPU] = 0.0;
@@ -988,10 +1035,13 @@ void CLBLegalizer::mapPUsToColumns()
 
 void CLBLegalizer::setSitesMapped()
 {
-    for (auto matchedPair : PULevelMatching)
+    if (PULevelMatching.empty())
+        return;
+    // PU2LegalSites holds the sites of the PUs in PULevelMatching. Iterate it directly because the ids of the PUs
+    // might have been renewed (e.g., by BEL pairing) since the legalization.
+    for (auto &PUSitesPair : PU2LegalSites)
     {
-        auto targetPU = matchedPair.first;
-        for (auto curSite : PU2LegalSites[targetPU])
+        for (auto curSite : PUSitesPair.second)
         {
             assert(!curSite->isMapped());
             curSite->setMapped();
@@ -1001,11 +1051,13 @@ void CLBLegalizer::setSitesMapped()
 
 void CLBLegalizer::resetSitesMapped()
 {
-
-    for (auto matchedPair : PULevelMatching)
+    if (PULevelMatching.empty())
+        return;
+    // PU2LegalSites holds the sites of the PUs in PULevelMatching. Iterate it directly because the ids of the PUs
+    // might have been renewed (e.g., by BEL pairing) since the legalization.
+    for (auto &PUSitesPair : PU2LegalSites)
     {
-        auto targetPU = matchedPair.first;
-        for (auto curSite : PU2LegalSites[targetPU])
+        for (auto curSite : PUSitesPair.second)
         {
             assert(curSite->isMapped());
             curSite->resetMapped();
@@ -28,9 +28,11 @@
 
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
+#include "IncrementalHPWLTracker.h"
 #include "MinCostBipartiteMatcher.h"
 #include "PlacementInfo.h"
 #include "dumpZip.h"
+#include "randomStream.h"
 #include "sysInfo.h"
 #include <assert.h>
 #include <fstream>
@@ -155,6 +157,12 @@ class CLBLegalizer
     PlacementInfo *placementInfo;
     DeviceInfo *deviceInfo;
 
+    /**
+     * @brief the tracker of the net bounding boxes, which evaluates the HPWL changes of the candidate sites
+     *
+     */
+    IncrementalHPWLTracker HPWLTracker;
+
     /**
      * @brief compatiblePlacementTable describes the type mapping from design to device, where a cell can be placed
      * (which BEL in which site)
@@ -182,6 +190,24 @@ class CLBLegalizer
      */
     MinCostBipartiteMatcher *minCostBipartiteMatcher = nullptr;
 
+    /**
+     * @brief the algorithm used by the bipartite matching solver, which can be set by "LegalizationMatcher"
+     *
+     */
+    MinCostBipartiteMatcher::MatcherAlgorithm matcherAlgorithm = MinCostBipartiteMatcher::MatcherAlgorithm_MinCostFlow;
+
+    /**
+     * @brief the sites matched to the PlacementUnits in the previous auction-based matchings, used for warm start
+     *
+     */
+    std::map<PlacementInfo::PlacementUnit *, DeviceInfo::DeviceSite *> PU2LastMatchedSite;
+
+    /**
+     * @brief the prices of the sites in the previous auction-based matchings, used for warm start
+     *
+     */
+    std::map<DeviceInfo::DeviceSite *, float> site2MatchingPrice;
+
     /**
      * @brief a vector storing the PlacementUnits which have NOT been legalized
      *
@@ -212,7 +238,7 @@ class CLBLegalizer
      * Please be aware that a PlacementUnit (i.e., PlacementMacro) might be binded of multiple sites.
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
 
     /**
      * @brief map sites to temperary indexes for bipartite matching
@@ -232,12 +258,6 @@ class CLBLegalizer
      */
     std::vector<std::vector<std::pair<int, float>>> adjList;
 
-    /**
-     * @brief a map of map recording the HPWL overhead when binding a PlacementUnit to a specific site
-     *
-     */
-    std::map<PlacementInfo::PlacementUnit *, std::map<DeviceInfo::DeviceSite *, float>> PU2Site2HPWLIncrease;
-
     /**
      * @brief a set of PlacementUnits binded to corresponding DeviceSites
      *
@@ -283,6 +303,12 @@ class CLBLegalizer
      */
     int nJobs = 1;
 
+    /**
+     * @brief the random stream for the randomized sorting, seeded by "RandomSeed" in the configuration
+     *
+     */
+    RandomStream randomStream;
+
     /**
      * @brief the number of SLICEM columns on the target device
      *
@@ -371,18 +397,18 @@ class CLBLegalizer
      * @brief record the mapping from PlacementUnits to exact DeviceSites
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
 
     /**
      * @brief record the mapping from PlacementUnits to exact DeviceSite location X
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, float> PU2X;
+    IdIndexedMap<PlacementInfo::PlacementUnit, float> PU2X;
     /**
      * @brief record the mapping from PlacementUnits to exact DeviceSite location Y
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, float> PU2Y;
+    IdIndexedMap<PlacementInfo::PlacementUnit, float> PU2Y;
 
     /**
      * @brief record the exact site X (column id) of involved PlacementUnits
@@ -417,7 +443,7 @@ class CLBLegalizer
      * @brief a cache record the candidate sites within a given displacement threshold  for each PlacementUnit
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *> *> PU2SitesInDisplacementThreshold;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *> *> PU2SitesInDisplacementThreshold;
 
     bool enableMCLBLegalization = false;
     bool enableLCLBLegalization = false;
@@ -543,6 +569,13 @@ class CLBLegalizer
     float DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo::DeviceSite *>> &Column2Sites,
                        std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs);
 
+    /**
+     * @brief create the bipartite matching solver for the current bipartite graph and warm-start it with the previous
+     * matching if the auction algorithm is used
+     *
+     */
+    void createMatcher();
+
     /**
      * @brief record the matching in private list and update the list of PlacementUnits which are not matched by the
      * bi-partite matching
@@ -613,11 +646,11 @@ class CLBLegalizer
         {
             PlacementInfo::PlacementUnit *curPU = PUsToLegalize[i];
             DesignInfo::DesignCell *curCell = nullptr;
-            if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+            if (auto unpackedCell = PlacementInfo::asUnpackedCell(curPU))
             {
                 curCell = unpackedCell->getCell();
             }
-            else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+            else if (auto curMacro = PlacementInfo::asMacro(curPU))
             {
                 assert(curMacro->getCells().size() > 0);
                 curCell = curMacro->getCells()[0];
@@ -681,27 +714,7 @@ class CLBLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *curPU, DeviceInfo::DeviceSite *curSite)
     {
-        assert(PU2Site2HPWLIncrease.find(curPU) != PU2Site2HPWLIncrease.end());
-        if (PU2Site2HPWLIncrease[curPU].find(curSite) != PU2Site2HPWLIncrease[curPU].end())
-        {
-            return PU2Site2HPWLIncrease[curPU][curSite];
-        }
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        float PUX = curSite->X();
-        float PUY = curSite->Y();
-        auto nets = placementInfo->getPlacementUnitId2Nets()[curPU->getId()];
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 10000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(curPU, PUX, PUY, y2xRatio);
-        }
-
-        PU2Site2HPWLIncrease[curPU][curSite] = (newHPWL - oriHPWL);
-        return (newHPWL - oriHPWL);
+        return HPWLTracker.getHPWLChange(curPU, curSite->X(), curSite->Y());
     }
 
     /**
@@ -714,20 +727,7 @@ class CLBLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *tmpPU, float PUX, float PUY)
     {
-
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 10000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-
-        return (newHPWL - oriHPWL);
+        return HPWLTracker.getHPWLChange(tmpPU, PUX, PUY);
     }
 
     inline void swapSitePtr(DeviceInfo::DeviceSite **siteA, DeviceInfo::DeviceSite **siteB)
@@ -810,7 +810,7 @@ class CLBLegalizer
     {
         // Random selection of pivot.
         int pvt, n;
-        n = random();
+        n = randomStream.randomInt();
         pvt = low + n % (high - low + 1); // Randomizing the pivot value from sub-array.
         swapPUs(&PUs[high], &PUs[pvt]);
         return sortPartition(PUs, low, high);
@@ -24,6 +24,7 @@
  */
 
 #include "MacroLegalizer.h"
+#include "profiler.h"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -33,7 +34,7 @@
 MacroLegalizer::MacroLegalizer(std::string legalizerName, PlacementInfo *placementInfo, DeviceInfo *deviceInfo,
                                std::vector<DesignInfo::DesignCellType> &macroTypesToLegalize,
                                std::map<std::string, std::string> &JSONCfg)
-    : legalizerName(legalizerName), placementInfo(placementInfo), deviceInfo(deviceInfo),
+    : legalizerName(legalizerName), placementInfo(placementInfo), deviceInfo(deviceInfo), HPWLTracker(placementInfo),
       compatiblePlacementTable(placementInfo->getCompatiblePlacementTable()),
       macroTypesToLegalize(macroTypesToLegalize), cellLoc(placementInfo->getCellId2location()), JSONCfg(JSONCfg)
 {
@@ -56,12 +57,22 @@ MacroLegalizer::MacroLegalizer(std::string legalizerName, PlacementInfo *placeme
     {
         nJobs = std::stoi(JSONCfg["jobs"]);
     }
+    randomStream.reseed(RandomStream::getSeedFromConfig(JSONCfg), 0, RandomStream::StreamDomain_MacroLegalizer);
+
+    if (JSONCfg.find("LegalizationMatcher") != JSONCfg.end())
+    {
+        if (JSONCfg["LegalizationMatcher"] == "Auction")
+            matcherAlgorithm = MinCostBipartiteMatcher::MatcherAlgorithm_Auction;
+        else
+            assert(JSONCfg["LegalizationMatcher"] == "MinCostFlow");
+    }
 
     clockRegionAware = false;
 }
 
 void MacroLegalizer::legalize(bool exactLegalization, bool directLegalization, bool _timingDrivenLegalize)
 {
+    ProfileZone profileZone("MacroLegalizer");
     if (verbose)
         print_status("MacroLegalizer[" + legalizerName + "] Started Legalization.");
 
@@ -103,6 +114,8 @@ void MacroLegalizer::legalize(bool exactLegalization, bool directLegalization, b
 
 void MacroLegalizer::roughlyLegalize()
 {
+    if (!timingDrivenLegalize)
+        HPWLTracker.build(y2xRatio);
     while (macroCellsToLegalize.size())
     {
         findMacroCell2SitesInDistance(clockRegionAware);
@@ -110,8 +123,7 @@ void MacroLegalizer::roughlyLegalize()
         resetMacroCell2SitesInDistance();
 
         createBipartiteGraph();
-        minCostBipartiteMatcher = new MinCostBipartiteMatcher(macro2Sites.size(), rightSiteIds.size(),
-                                                              macro2Sites.size(), adjList, nJobs, verbose);
+        createMatcher();
 
         minCostBipartiteMatcher->solve();
         updateMatchingAndUnmatchedMacroCells();
@@ -132,6 +144,8 @@ void MacroLegalizer::fixedColumnLegalize(bool directLegalization)
     resolveOverflowColumns();
 
     macroCellsToLegalize = initialMacrosToLegalize;
+    if (!timingDrivenLegalize)
+        HPWLTracker.build(y2xRatio);
 
     while (macroCellsToLegalize.size())
     {
@@ -139,8 +153,7 @@ void MacroLegalizer::fixedColumnLegalize(bool directLegalization)
         findPossibleLegalLocation(true);
         resetMacroCell2SitesInDistance();
         createBipartiteGraph();
-        minCostBipartiteMatcher = new MinCostBipartiteMatcher(macro2Sites.size(), rightSiteIds.size(),
-                                                              macro2Sites.size(), adjList, nJobs, verbose);
+        createMatcher();
 
         minCostBipartiteMatcher->solve();
         updateMatchingAndUnmatchedMacroCells();
@@ -164,6 +177,8 @@ void MacroLegalizer::finalLegalizeBasedOnDP()
     PU2Y.clear();
     PU2LegalSites.clear();
     resetSettings();
+    if (!timingDrivenLegalize)
+        HPWLTracker.build(y2xRatio);
     float tmpAverageDisplacement = 0.0;
     if (verbose)
         print_status("MacroLegalizer[" + legalizerName + "] Start finalLegalizeBasedOnDP");
@@ -195,13 +210,13 @@ float MacroLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInf
     // std::stringstream outfile0;
 
     float tmpTotalDisplacement = 0.0;
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
     PU2Sites.clear();
     for (auto &PUDeque : Column2PUs)
     {
         for (auto tmpPU : PUDeque)
         {
-            assert(PU2Sites.find(tmpPU) == PU2Sites.end());
+            assert(!PU2Sites.count(tmpPU));
             PU2Sites[tmpPU] = std::vector<DeviceInfo::DeviceSite *>();
         }
     }
@@ -238,7 +253,7 @@ float MacroLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInf
                 // we need to ensure that there is no occpupied sites in this range
                 curHPWLChange = 1100000000.0;
             }
-            if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curColPU[0]))
+            if (auto curMacro = PlacementInfo::asMacro(curColPU[0]))
             {
                 if (curMacro->getMacroType() != PlacementInfo::PlacementMacro::PlacementMacroType_CARRY &&
                     curColSites[j]->getClockRegionY() != curColSites[j - heightPURow + 1]->getClockRegionY())
@@ -282,7 +297,7 @@ float MacroLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInf
                     // we need to ensure that there is no occpupied sites in this range
                     curHPWLChange = 1100000000.0;
                 }
-                if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curColPU[i]))
+                if (auto curMacro = PlacementInfo::asMacro(curColPU[i]))
                 {
                     if (curMacro->getMacroType() != PlacementInfo::PlacementMacro::PlacementMacroType_CARRY &&
                         curColSites[j]->getClockRegionY() != curColSites[j - heightPURow + 1]->getClockRegionY())
@@ -371,10 +386,10 @@ float MacroLegalizer::DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInf
     {
         for (auto tmpPU : PUDeque)
         {
-            assert(PU2Sites.find(tmpPU) != PU2Sites.end());
+            assert(PU2Sites.count(tmpPU));
             auto &curSites = PU2Sites[tmpPU];
             assert(curSites.size());
-            assert(PU2X.find(tmpPU) == PU2X.end());
+            assert(!PU2X.count(tmpPU));
             auto curSite = curSites[0];
             PU2LegalSites[tmpPU] = curSites;
             PU2X[tmpPU] = curSite->X();
@@ -422,7 +437,7 @@ bool MacroLegalizer::macroCanBeFitIn(int colId, std::vector<std::vector<DeviceIn
             // we need to ensure that there is no occpupied sites in this range
             curHPWLChange = 1100000000.0;
         }
-        if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curColPU[0]))
+        if (auto curMacro = PlacementInfo::asMacro(curColPU[0]))
         {
             if (curMacro->getMacroType() != PlacementInfo::PlacementMacro::PlacementMacroType_CARRY &&
                 curColSites[j]->getClockRegionY() != curColSites[j - heightPURow + 1]->getClockRegionY())
@@ -466,7 +481,7 @@ bool MacroLegalizer::macroCanBeFitIn(int colId, std::vector<std::vector<DeviceIn
                 // we need to ensure that there is no occpupied sites in this range
                 curHPWLChange = 1100000000.0;
             }
-            if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curColPU[i]))
+            if (auto curMacro = PlacementInfo::asMacro(curColPU[i]))
             {
                 if (curMacro->getMacroType() != PlacementInfo::PlacementMacro::PlacementMacroType_CARRY &&
                     curColSites[j]->getClockRegionY() != curColSites[j - heightPURow + 1]->getClockRegionY())
@@ -723,11 +738,11 @@ void MacroLegalizer::findPossibleLegalLocation(bool fixedColumn)
         if (DesignInfo::isDSP(curCellType) || DesignInfo::isBRAM(curCellType))
         {
             auto tmpPU = placementInfo->getPlacementUnitByCellId(curCell->getCellId());
-            if (dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+            if (PlacementInfo::asUnpackedCell(tmpPU))
             {
                 macroLength = cellOffset = 1;
             }
-            else if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+            else if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
             {
 
                 for (cellOffset = 0; cellOffset < (int)(tmpMacro->getCells().size()); cellOffset++)
@@ -890,8 +905,49 @@ void MacroLegalizer::createBipartiteGraph()
     }
 }
 
+void MacroLegalizer::createMatcher()
+{
+    minCostBipartiteMatcher = new MinCostBipartiteMatcher(macroCellsToLegalize.size(), rightSiteIds.size(),
+                                                          macroCellsToLegalize.size(), adjList, nJobs, verbose,
+                                                          matcherAlgorithm);
+    if (matcherAlgorithm != MinCostBipartiteMatcher::MatcherAlgorithm_Auction)
+        return;
+
+    // the matching and the prices of the sites in the previous legalization are used as the initial solution
+    std::vector<int> initialLeft2Right(macroCellsToLegalize.size(), -1);
+    std::vector<float> initialRightPrices(siteList.size(), 0);
+    for (unsigned int leftCellId = 0; leftCellId < macroCellsToLegalize.size(); leftCellId++)
+    {
+        auto it = cell2LastMatchedSite.find(macroCellsToLegalize[leftCellId]);
+        if (it == cell2LastMatchedSite.end())
+            continue;
+        auto siteIt = rightSiteIds.find(it->second);
+        if (siteIt != rightSiteIds.end())
+            initialLeft2Right[leftCellId] = siteIt->second;
+    }
+    for (unsigned int rightNode = 0; rightNode < siteList.size(); rightNode++)
+    {
+        auto it = site2MatchingPrice.find(siteList[rightNode]);
+        if (it != site2MatchingPrice.end())
+            initialRightPrices[rightNode] = it->second;
+    }
+    minCostBipartiteMatcher->setWarmStart(initialLeft2Right, initialRightPrices);
+}
+
 void MacroLegalizer::updateMatchingAndUnmatchedMacroCells()
 {
+    if (matcherAlgorithm == MinCostBipartiteMatcher::MatcherAlgorithm_Auction)
+    {
+        for (unsigned int leftCellId = 0; leftCellId < macroCellsToLegalize.size(); leftCellId++)
+        {
+            int rightNode = minCostBipartiteMatcher->getMatchedRightNode(leftCellId);
+            if (rightNode >= 0)
+                cell2LastMatchedSite[macroCellsToLegalize[leftCellId]] = siteList[rightNode];
+        }
+        for (unsigned int rightNode = 0; rightNode < siteList.size(); rightNode++)
+            site2MatchingPrice[siteList[rightNode]] = minCostBipartiteMatcher->getRightNodePrice(rightNode);
+    }
+
 
     for (unsigned int leftCellId = 0; leftCellId < macroCellsToLegalize.size(); leftCellId++)
     {
@@ -1018,11 +1074,11 @@ void MacroLegalizer::dumpMatching(bool fixedColumn, bool enforce)
 
 int MacroLegalizer::getMarcroCellNum(PlacementInfo::PlacementUnit *tmpMacroUnit)
 {
-    if (dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpMacroUnit))
+    if (PlacementInfo::asUnpackedCell(tmpMacroUnit))
     {
         return 1;
     }
-    else if (auto macroPU = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpMacroUnit))
+    else if (auto macroPU = PlacementInfo::asMacro(tmpMacroUnit))
     {
         if (macroPU->checkHasBRAM())
             return macroPU->getBRAMNum();
@@ -1102,7 +1158,7 @@ void MacroLegalizer::updatePUMatchingLocation(bool isRoughLegalization, bool upd
 
         auto curPU = placementInfo->getPlacementUnitByCell(curCell);
 
-        if (PU2Y.find(curPU) == PU2Y.end())
+        if (!PU2Y.count(curPU))
         {
             PU2SiteX[curPU] = -1;
             PU2Y[curPU] = 0.0;
@@ -1296,12 +1352,12 @@ void MacroLegalizer::spreadMacros(int columnNum, std::vector<int> &columnUntiliz
         auto PUs = column2PUs[colId];
         for (auto curPU : PUs)
         {
-            if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+            if (auto unpackedCell = PlacementInfo::asUnpackedCell(curPU))
             {
                 auto curCell = unpackedCell->getCell();
                 cell2Column[curCell] = colId;
             }
-            else if (auto macroPU = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+            else if (auto macroPU = PlacementInfo::asMacro(curPU))
             {
                 for (auto curCell : macroPU->getCells())
                 {
@@ -1492,10 +1548,11 @@ void MacroLegalizer::setSitesMapped()
     }
     else
     {
-        for (auto matchedPair : PULevelMatching)
+        // PU2LegalSites holds the sites of the PUs in PULevelMatching. Iterate it directly because the ids of the PUs
+        // might have been renewed (e.g., by BEL pairing) since the legalization.
+        for (auto &PUSitesPair : PU2LegalSites)
         {
-            auto targetPU = matchedPair.first;
-            for (auto curSite : PU2LegalSites[targetPU])
+            for (auto curSite : PUSitesPair.second)
             {
                 assert(!curSite->isMapped());
                 curSite->setMapped();
@@ -1517,10 +1574,11 @@ void MacroLegalizer::resetSitesMapped()
     }
     else
     {
-        for (auto matchedPair : PULevelMatching)
+        // PU2LegalSites holds the sites of the PUs in PULevelMatching. Iterate it directly because the ids of the PUs
+        // might have been renewed (e.g., by BEL pairing) since the legalization.
+        for (auto &PUSitesPair : PU2LegalSites)
         {
-            auto targetPU = matchedPair.first;
-            for (auto curSite : PU2LegalSites[targetPU])
+            for (auto curSite : PUSitesPair.second)
             {
                 assert(curSite->isMapped());
                 curSite->resetMapped();
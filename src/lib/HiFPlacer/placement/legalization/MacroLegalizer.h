@@ -28,9 +28,11 @@
 
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
+#include "IncrementalHPWLTracker.h"
 #include "MinCostBipartiteMatcher.h"
 #include "PlacementInfo.h"
 #include "dumpZip.h"
+#include "randomStream.h"
 #include "sysInfo.h"
 #include <assert.h>
 #include <fstream>
@@ -166,6 +168,12 @@ class MacroLegalizer
     PlacementInfo *placementInfo;
     DeviceInfo *deviceInfo;
 
+    /**
+     * @brief the tracker of the net bounding boxes, which evaluates the HPWL changes of the candidate sites
+     *
+     */
+    IncrementalHPWLTracker HPWLTracker;
+
     /**
      * @brief compatiblePlacementTable describes the type mapping from design to device, where a cell can be placed
      * (which BEL in which site)
@@ -193,6 +201,24 @@ class MacroLegalizer
      */
     MinCostBipartiteMatcher *minCostBipartiteMatcher = nullptr;
 
+    /**
+     * @brief the algorithm used by the bipartite matching solver, which can be set by "LegalizationMatcher"
+     *
+     */
+    MinCostBipartiteMatcher::MatcherAlgorithm matcherAlgorithm = MinCostBipartiteMatcher::MatcherAlgorithm_MinCostFlow;
+
+    /**
+     * @brief the sites matched to the macro cells in the previous auction-based matchings, used for warm start
+     *
+     */
+    std::map<DesignInfo::DesignCell *, DeviceInfo::DeviceSite *> cell2LastMatchedSite;
+
+    /**
+     * @brief the prices of the sites in the previous auction-based matchings, used for warm start
+     *
+     */
+    std::map<DeviceInfo::DeviceSite *, float> site2MatchingPrice;
+
     /**
      * @brief a vector storing the Design cells which have NOT been legalized
      *
@@ -413,19 +439,19 @@ class MacroLegalizer
      */
     std::map<DesignInfo::DesignCell *, int> CARRYCell2Column;
 
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
 
     /**
      * @brief record the mapping from PlacementUnits to exact DeviceSite location X
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, float> PU2X;
+    IdIndexedMap<PlacementInfo::PlacementUnit, float> PU2X;
 
     /**
      * @brief record the mapping from PlacementUnits to exact DeviceSite location Y
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, float> PU2Y;
+    IdIndexedMap<PlacementInfo::PlacementUnit, float> PU2Y;
 
     /**
      * @brief record the exact site X (column id) of involved PlacementUnits
@@ -513,6 +539,12 @@ class MacroLegalizer
      */
     int nJobs = 1;
 
+    /**
+     * @brief the random stream for the randomized sorting, seeded by "RandomSeed" in the configuration
+     *
+     */
+    RandomStream randomStream;
+
     /**
      * @brief we are allowed to detect a excessive number (>candidateNum) of initial candidates. candidateFactor is to
      * control the excessive ratio.
@@ -615,6 +647,13 @@ class MacroLegalizer
     float DPForMinHPWL(int colNum, std::vector<std::vector<DeviceInfo::DeviceSite *>> &Column2Sites,
                        std::vector<std::deque<PlacementInfo::PlacementUnit *>> &Column2PUs);
 
+    /**
+     * @brief create the bipartite matching solver for the current bipartite graph and warm-start it with the previous
+     * matching if the auction algorithm is used
+     *
+     */
+    void createMatcher();
+
     /**
      * @brief record the matching in private list and update the list of cells which are not matched by the
      * bi-partite matching
@@ -756,18 +795,15 @@ class MacroLegalizer
      */
     inline float getHPWLChange(DesignInfo::DesignCell *curCell, DeviceInfo::DeviceSite *curSite)
     {
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
         auto tmpPU = placementInfo->getPlacementUnitByCell(curCell);
         float PUX = 0.0, PUY = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
         float numCellsInMacro = 1.0;
-        if (dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+        if (PlacementInfo::asUnpackedCell(tmpPU))
         {
             PUX = curSite->X();
             PUY = curSite->Y();
         }
-        else if (PlacementInfo::PlacementMacro *tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+        else if (PlacementInfo::PlacementMacro *tmpMacro = PlacementInfo::asMacro(tmpPU))
         {
 
             PUX = curSite->X() - tmpMacro->getCellOffsetXInMacro(curCell);
@@ -778,14 +814,7 @@ class MacroLegalizer
         if (timingDrivenLegalize)
             return (std::fabs(PUX - tmpPU->X()) + y2xRatio * std::fabs(PUY - tmpPU->Y())) / numCellsInMacro;
 
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 10000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-        return (newHPWL - oriHPWL) / numCellsInMacro;
+        return HPWLTracker.getHPWLChange(tmpPU, PUX, PUY) / numCellsInMacro;
         // return std::fabs(macroLoc.X - curSite->X()) + std::fabs(macroLoc.Y - curSite->Y());
         // placementInfo->getPlacementUnitByCell(curCell);
     }
@@ -799,26 +828,13 @@ class MacroLegalizer
      */
     inline float getHPWLChange(PlacementInfo::PlacementUnit *tmpPU, DeviceInfo::DeviceSite *curSite)
     {
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        float PUX = 0.0, PUY = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
-
-        PUX = curSite->X();
-        PUY = curSite->Y();
+        float PUX = curSite->X();
+        float PUY = curSite->Y();
 
         if (timingDrivenLegalize)
             return std::fabs(PUX - tmpPU->X()) + y2xRatio * std::fabs(PUY - tmpPU->Y());
 
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 10000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
-
-        return (newHPWL - oriHPWL);
+        return HPWLTracker.getHPWLChange(tmpPU, PUX, PUY);
     }
 
     /**
@@ -834,19 +850,8 @@ class MacroLegalizer
 
         if (timingDrivenLegalize)
             return std::fabs(PUX - tmpPU->X()) + y2xRatio * std::fabs(PUY - tmpPU->Y());
-        float oriHPWL = 0.0;
-        float newHPWL = 0.0;
-        auto nets = placementInfo->getPlacementUnitId2Nets()[tmpPU->getId()];
-
-        for (auto curNet : nets)
-        {
-            if (curNet->getDesignNet()->getPins().size() > 10000) // it could be clock
-                continue;
-            oriHPWL += curNet->getHPWL(y2xRatio);
-            newHPWL += curNet->getNewHPWLByTrying(tmpPU, PUX, PUY, y2xRatio);
-        }
 
-        return (newHPWL - oriHPWL);
+        return HPWLTracker.getHPWLChange(tmpPU, PUX, PUY);
     }
 
     inline void swapSitePtr(DeviceInfo::DeviceSite **siteA, DeviceInfo::DeviceSite **siteB)
@@ -930,7 +935,7 @@ class MacroLegalizer
     {
         // Random selection of pivot.
         int pvt, n;
-        n = random();
+        n = randomStream.randomInt();
         pvt = low + n % (high - low + 1); // Randomizing the pivot value from sub-array.
         swapPUs(&PUs[high], &PUs[pvt]);
         return sortPartition(PUs, low, high);
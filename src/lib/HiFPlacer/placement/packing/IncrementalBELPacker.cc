@@ -25,6 +25,7 @@
 
 #include "IncrementalBELPacker.h"
 #include "dumpZip.h"
+#include "profiler.h"
 #include "readZip.h"
 #include "strPrint.h"
 #include "stringCheck.h"
@@ -43,6 +44,7 @@ void IncrementalBELPacker::isLUTsPackable(PlacementInfo::PlacementUnpackedCell *
 
 void IncrementalBELPacker::LUTFFPairing(float disThreshold)
 {
+    ProfileZone profileZone("LUTFFPairing");
     print_status("IncrementalBELPacker Pairing LUTs and FFs.");
     std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
     LUTFFPairs.clear();
@@ -82,7 +84,7 @@ void IncrementalBELPacker::LUTFFPairing(float disThreshold)
                             FFPU->setPacked();
                             unpackedCell->setPacked();
 
-                            PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+                            PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
                                 curCell->getName(), placementUnits.size(),
                                 PlacementInfo::PlacementMacro::PlacementMacroType_LUTFFPair);
 
@@ -154,7 +156,7 @@ void IncrementalBELPacker::LUTFFPairing(float disThreshold)
                                 FFPU->setPacked();
                                 unpackedCell->setPacked();
 
-                                PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+                                PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
                                     curCell->getName(), placementUnits.size(),
                                     PlacementInfo::PlacementMacro::PlacementMacroType_LUTFFPair);
 
@@ -210,7 +212,7 @@ void IncrementalBELPacker::LUTFFPairing(float disThreshold)
         }
         else
         {
-            delete unpackedCell;
+            placementInfo->destroyPlacementUnit(unpackedCell);
         }
     }
 
@@ -252,6 +254,7 @@ void IncrementalBELPacker::LUTFFPairing(float disThreshold)
 
 void IncrementalBELPacker::FFPairing(float disThreshold)
 {
+    ProfileZone profileZone("FFPairing");
     print_status("IncrementalBELPacker Pairing FFs.");
     std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
     FF_FFPairs.clear();
@@ -263,41 +266,50 @@ void IncrementalBELPacker::FFPairing(float disThreshold)
     int FFPairedCnt = 0;
     int FFCouldBePackedCnt = 0;
 
-    for (auto CS : designInfo->getControlSets())
+    // the FFs of all the control sets are indexed at once and each control set is a key of the spatial index, so the
+    // neighbors of an FF are only searched within its own control set
+    auto &controlSets = designInfo->getControlSets();
+    std::vector<FFLocation> FFpoints;
+    std::vector<int> CSFFBegin;
+    std::vector<float> FFX, FFY;
+    std::vector<int> FFCSId;
+    for (unsigned int CSId = 0; CSId < controlSets.size(); CSId++)
     {
-        auto &FFs = CS->getFFs();
-        std::vector<FFLocation> FFpoints;
-        FFpoints.clear();
-
-        for (auto curFF : FFs)
+        CSFFBegin.push_back(FFpoints.size());
+        for (auto curFF : controlSets[CSId]->getFFs())
         {
             auto tmpPU = cellId2PlacementUnit[curFF->getCellId()];
-            if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+            if (auto unpackedCell = PlacementInfo::asUnpackedCell(tmpPU))
             {
                 FFpoints.emplace_back(unpackedCell);
+                FFX.push_back(FFpoints.back()[0]);
+                FFY.push_back(FFpoints.back()[1]);
+                FFCSId.push_back(CSId);
                 FFCouldBePackedCnt++;
             }
         }
+    }
+    CSFFBegin.push_back(FFpoints.size());
+    SpatialGridIndex FFIndex(y2xRatio);
+    FFIndex.build(FFX, FFY, FFCSId);
 
-        // build k-d tree
-        kdt::KDTree<FFLocation> kdtree(FFpoints, y2xRatio);
-
-        for (auto &FFTmpPoint : FFpoints)
+    for (unsigned int CSId = 0; CSId < controlSets.size(); CSId++)
+    {
+        for (int FFInd = CSFFBegin[CSId]; FFInd < CSFFBegin[CSId + 1]; FFInd++)
         {
-            auto FF0 = FFTmpPoint.getUnpackedCell();
+            auto FF0 = FFpoints[FFInd].getUnpackedCell();
 
             if (packedCells.find(FF0) != packedCells.end())
                 continue;
             // K-nearest neighbor search (gets indices to neighbors)
             int k = 10;
-            FFLocation query(FF0);
-            std::vector<int> indices = kdtree.knnSearch(query, k);
+            std::vector<int> indices = FFIndex.knnSearch(FFpoints[FFInd][0], FFpoints[FFInd][1], k, CSId);
             int closestInd = -1;
             float closetDis = 10000000;
             for (auto tmpInd : indices)
             {
                 auto tmpPU1 = FFpoints[tmpInd].getUnpackedCell();
-                if (auto FF1 = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU1))
+                if (auto FF1 = PlacementInfo::asUnpackedCell(tmpPU1))
                 {
                     if (packedCells.find(FF1) != packedCells.end())
                         continue;
@@ -326,7 +338,7 @@ void IncrementalBELPacker::FFPairing(float disThreshold)
                 FF0->setPacked();
                 FF1->setPacked();
 
-                PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+                PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
                     FF0->getName(), placementUnits.size(), PlacementInfo::PlacementMacro::PlacementMacroType_FFFFPair);
 
                 curMacro->addOccupiedSite(0.0, 0.0625);
@@ -376,7 +388,7 @@ void IncrementalBELPacker::FFPairing(float disThreshold)
         }
         else
         {
-            delete unpackedCell;
+            placementInfo->destroyPlacementUnit(unpackedCell);
         }
     }
 
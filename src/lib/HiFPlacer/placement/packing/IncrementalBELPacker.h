@@ -29,9 +29,10 @@
 
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
-#include "KDTree/KDTree.h"
 #include "PlacementInfo.h"
 #include "PlacementTimingOptimizer.h"
+#include "spatialGridIndex.h"
+#include <array>
 #include <assert.h>
 #include <fstream>
 #include <iostream>
@@ -106,15 +107,13 @@ class IncrementalBELPacker
     }
 
     /**
-     * @brief FFLocation records the FF cell pointer and the location of the FF cell for kdt::KDTree construction which
-     * can help to find neighbors for cells
+     * @brief FFLocation records the FF cell pointer and the location of the FF cell for the SpatialGridIndex which can
+     * help to find neighbors for cells
      *
      */
     class FFLocation : public std::array<float, 2>
     {
       public:
-        // dimension of the Point
-        static const int DIM = 2;
         FFLocation()
         {
             assert(false);
@@ -260,7 +260,7 @@ void InitialPacker::findDSPMacros()
         if (curMacroCores.size() <= 1)
             continue;
 
-        PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+        PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
             curMacroCores[0]->getName(), placementUnits.size(), PlacementInfo::PlacementMacro::PlacementMacroType_DSP);
 
         float coreOffset = 0;
@@ -375,7 +375,7 @@ void InitialPacker::findLUTRAMMacros()
         if (cellInMacros.find(curCell) != cellInMacros.end())
             continue;
 
-        PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+        PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
             curCell->getName(), placementUnits.size(), PlacementInfo::PlacementMacro::PlacementMacroType_MCLB);
 
         curMacro->addOccupiedSite(0, 1);
@@ -445,7 +445,7 @@ void InitialPacker::findBRAMMacros()
             curCell->getCellType() != DesignInfo::CellType_FIFO36E2)
             continue;
 
-        PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+        PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
             curMacroCores[0]->getName(), placementUnits.size(), PlacementInfo::PlacementMacro::PlacementMacroType_BRAM);
 
         float coreOffset = 0;
@@ -856,8 +856,8 @@ void InitialPacker::findCARRYMacros()
 
         // expand CARRY MACRO with input LUT / output FF / external input occupying
         PlacementInfo::PlacementMacro *curMacro =
-            new PlacementInfo::PlacementMacro(curMacroCores[0]->getName(), placementUnits.size(),
-                                              PlacementInfo::PlacementMacro::PlacementMacroType_CARRY);
+            placementInfo->createPlacementMacro(curMacroCores[0]->getName(), placementUnits.size(),
+                                                PlacementInfo::PlacementMacro::PlacementMacroType_CARRY);
 
         std::vector<std::string> checkLUTRefPins{"S["}; //"DI[",
         std::vector<std::string> checkFFRefPins{"O[", "CO["};
@@ -1220,7 +1220,7 @@ void InitialPacker::findMuxMacros()
         curMacroCores.clear();
         curMacroCores.push_back(curCell);
 
-        PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+        PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
             curMacroCores[0]->getName(), placementUnits.size(), PlacementInfo::PlacementMacro::PlacementMacroType_MUX8);
 
         curMacro->addCell(curCell, curCell->getCellType(), 0, 0);
@@ -1371,7 +1371,7 @@ void InitialPacker::findMuxMacros()
         std::vector<DesignInfo::DesignCell *> curMacroCores;
         curMacroCores.clear();
         curMacroCores.push_back(curCell);
-        PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+        PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
             curMacroCores[0]->getName(), placementUnits.size(), PlacementInfo::PlacementMacro::PlacementMacroType_MUX7);
         curMacro->addOccupiedSite(0.0, 0.25);
         curMacro->addCell(curCell, curCell->getCellType(), 0, 0);
@@ -1497,8 +1497,8 @@ void InitialPacker::loadOtherCLBMacros(std::string RAMMacroListFromVivadoFileNam
 
         if (curSite->getSiteType() == "SLICEM") // is LUTRAM macro
         {
-            curMacro = new PlacementInfo::PlacementMacro((*macroCells.begin())->getName(), placementUnits.size(),
-                                                         PlacementInfo::PlacementMacro::PlacementMacroType_MCLB);
+            curMacro = placementInfo->createPlacementMacro((*macroCells.begin())->getName(), placementUnits.size(),
+                                                           PlacementInfo::PlacementMacro::PlacementMacroType_MCLB);
             curMacro->addOccupiedSite(0.0, 1.0);
             for (DesignInfo::DesignCell *cell : macroCells)
             {
@@ -1523,8 +1523,8 @@ void InitialPacker::loadOtherCLBMacros(std::string RAMMacroListFromVivadoFileNam
         }
         else
         {
-            curMacro = new PlacementInfo::PlacementMacro((*macroCells.begin())->getName(), placementUnits.size(),
-                                                         PlacementInfo::PlacementMacro::PlacementMacroType_LCLB);
+            curMacro = placementInfo->createPlacementMacro((*macroCells.begin())->getName(), placementUnits.size(),
+                                                           PlacementInfo::PlacementMacro::PlacementMacroType_LCLB);
             curMacro->addOccupiedSite(0.0, 1.0);
             for (DesignInfo::DesignCell *cell : macroCells)
             {
@@ -1601,7 +1601,7 @@ void InitialPacker::LUTFFPairing()
                     {
                         LUTFFPairs.emplace_back(curCell, FFBeDriven);
 
-                        PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+                        PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
                             curCell->getName(), placementUnits.size(),
                             PlacementInfo::PlacementMacro::PlacementMacroType_LUTFFPair);
 
@@ -1646,7 +1646,7 @@ void InitialPacker::findUnpackedUnits()
         {
             assert(!cell->isVirtualCell());
             PlacementInfo::PlacementUnpackedCell *curUnpackedCell =
-                new PlacementInfo::PlacementUnpackedCell(cell->getName(), placementUnits.size(), cell);
+                placementInfo->createPlacementUnpackedCell(cell->getName(), placementUnits.size(), cell);
             curUnpackedCell->setWeight(compatiblePlacementTable->cellType2sharedBELTypeOccupation[cell->getCellType()]);
 
             cellId2PlacementUnit[cell->getElementIdInType()] = curUnpackedCell;
@@ -1694,13 +1694,13 @@ void InitialPacker::loadFixedPlacementUnits(std::string fixedPlacementUnitsFromV
                     tmpPin->getNet()->setContainFixedPins();
                 }
             }
-            if (PlacementInfo::PlacementUnpackedCell *unpackedPU = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(
+            if (PlacementInfo::PlacementUnpackedCell *unpackedPU = PlacementInfo::asUnpackedCell(
                     cellId2PlacementUnit[curCell->getElementIdInType()]))
             {
                 unpackedPU->setLockedAt(siteName, BELName, deviceInfo);
                 fixedPlacementUnits.push_back(unpackedPU);
             }
-            else if (PlacementInfo::PlacementMacro *curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(
+            else if (PlacementInfo::PlacementMacro *curMacro = PlacementInfo::asMacro(
                          cellId2PlacementUnit[curCell->getElementIdInType()]))
             {
                 // We can only handle BRAM36 currently
@@ -24,15 +24,16 @@
  */
 
 #include "ParallelCLBPacker.h"
+#include "profiler.h"
 #define TIMINGDP
 
 void ParallelCLBPacker::prePackLegalizedMacros(PlacementInfo::PlacementMacro *tmpMacro)
 {
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> &PULegalSite =
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> &PULegalSite =
         placementInfo->getPULegalSite();
     if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY)
     {
-        assert(PULegalSite.find(tmpMacro) != PULegalSite.end());
+        assert(PULegalSite.count(tmpMacro));
         std::vector<DeviceInfo::DeviceSite *> &legalSites = PULegalSite[tmpMacro];
         for (unsigned int i = 0; i < legalSites.size(); i++)
         {
@@ -43,7 +44,7 @@ void ParallelCLBPacker::prePackLegalizedMacros(PlacementInfo::PlacementMacro *tm
     }
     else if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MCLB)
     {
-        assert(PULegalSite.find(tmpMacro) != PULegalSite.end());
+        assert(PULegalSite.count(tmpMacro));
         std::vector<DeviceInfo::DeviceSite *> &legalSites = PULegalSite[tmpMacro];
         for (unsigned int i = 0; i < legalSites.size(); i++)
         {
@@ -60,9 +61,10 @@ ParallelCLBPacker::ParallelCLBPacker(DesignInfo *designInfo, DeviceInfo *deviceI
                                      float HPWLWeight, std::string packerName,
                                      PlacementTimingOptimizer *timingOptimizer, WirelengthOptimizer *WLOptimizer)
     : designInfo(designInfo), deviceInfo(deviceInfo), placementInfo(placementInfo), JSONCfg(JSONCfg),
-      unchangedIterationThr(unchangedIterationThr), numNeighbor(numNeighbor), deltaD(deltaD), curD(curD), maxD(maxD),
-      PQSize(PQSize), HPWLWeight(HPWLWeight), packerName(packerName), timingOptimizer(timingOptimizer),
-      WLOptimizer(WLOptimizer), PUId2PackingCLBSite(placementInfo->getPlacementUnits().size(), nullptr),
+      HPWLTracker(placementInfo, 64), unchangedIterationThr(unchangedIterationThr), numNeighbor(numNeighbor),
+      deltaD(deltaD), curD(curD), maxD(maxD), PQSize(PQSize), HPWLWeight(HPWLWeight), packerName(packerName),
+      timingOptimizer(timingOptimizer), WLOptimizer(WLOptimizer),
+      PUId2PackingCLBSite(placementInfo->getPlacementUnits().size(), nullptr),
       PUId2PackingCLBSiteCandidate(placementInfo->getPlacementUnits().size(), nullptr),
       placementUnits(placementInfo->getPlacementUnits()),
       placementUnpackedCells(placementInfo->getPlacementUnpackedCells()),
@@ -73,6 +75,7 @@ ParallelCLBPacker::ParallelCLBPacker(DesignInfo *designInfo, DeviceInfo *deviceI
     {
         y2xRatio = std::stof(JSONCfg["y2xRatio"]);
     }
+    randomSeed = RandomStream::getSeedFromConfig(JSONCfg);
     // PlacementInfo *placementInfo, DeviceInfo::DeviceSite *CLBSite, int unchangedIterationThr,
     //                        int numNeighbor, float deltaD, float curD, float maxD, int PQSize, float y2xRatio,
     //                        std::vector<PackingCLBSite *> &PUId2PackingCLBSite
@@ -89,7 +92,7 @@ ParallelCLBPacker::ParallelCLBPacker(DesignInfo *designInfo, DeviceInfo *deviceI
             continue;
         PackingCLBSite *tmpPackingSite =
             new PackingCLBSite(placementInfo, curSite, unchangedIterationThr, numNeighbor, deltaD, curD, maxD, PQSize,
-                               y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                               y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
         deviceSite2PackingSite[curSite] = tmpPackingSite;
         packingSites.push_back(tmpPackingSite);
         clockColumns2PackingSites[curSite->getClockHalfColumn()->getId()].push_back(tmpPackingSite);
@@ -101,7 +104,7 @@ ParallelCLBPacker::ParallelCLBPacker(DesignInfo *designInfo, DeviceInfo *deviceI
             continue;
         PackingCLBSite *tmpPackingSite =
             new PackingCLBSite(placementInfo, curSite, unchangedIterationThr, numNeighbor, deltaD, curD, maxD, PQSize,
-                               y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                               y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
         deviceSite2PackingSite[curSite] = tmpPackingSite;
         packingSites.push_back(tmpPackingSite);
         clockColumns2PackingSites[curSite->getClockHalfColumn()->getId()].push_back(tmpPackingSite);
@@ -128,16 +131,20 @@ ParallelCLBPacker::ParallelCLBPacker(DesignInfo *designInfo, DeviceInfo *deviceI
 
 void ParallelCLBPacker::packCLBsIteration(bool initial, bool debug)
 {
+    ProfileZone profileZone("packCLBsIteration");
     int numClockCols = clockColumns2PackingSites.size();
-#pragma omp parallel for schedule(dynamic, 16)
+    long long evaluatedClusterNum = 0;
+#pragma omp parallel for schedule(dynamic, 16) reduction(+ : evaluatedClusterNum)
     for (int i = 0; i < numClockCols; i++)
     {
         for (unsigned int j = 0; j < clockColumns2PackingSites[i].size(); j++)
         {
             auto tmpPackingSite = clockColumns2PackingSites[i][j];
             tmpPackingSite->updateStep(initial, debug);
+            evaluatedClusterNum += tmpPackingSite->getEvaluatedClusterNum();
         }
     }
+    profileCounter("clusters evaluated", evaluatedClusterNum);
 
     //     int numPackingSites = packingSites.size();
     // #pragma omp parallel for schedule(dynamic, 16)
@@ -287,6 +294,7 @@ void ParallelCLBPacker::packCLBsIteration(bool initial, bool debug)
 
 void ParallelCLBPacker::packCLBs(int packIterNum, bool doExceptionHandling, bool debug)
 {
+    ProfileZone profileZone("packCLBs");
     placementInfo->updateB2BAndGetTotalHPWL();
     placementInfo->updateElementBinGrid(); // we don't need utilization information here, we can update LUT/FF
                                            // utilization when needed.
@@ -339,7 +347,7 @@ void ParallelCLBPacker::packCLBs(int packIterNum, bool doExceptionHandling, bool
                         {
                             if (tmpPU->getType() == PlacementInfo::PlacementUnitType_Macro)
                             {
-                                if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                                if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                                 {
                                     tmpSize += tmpPU->getWeight();
                                     assert((unsigned int)tmpPU->getWeight() >= curMacro->getCells().size());
@@ -1050,8 +1058,7 @@ int ParallelCLBPacker::timingDrivenDetailedPlacement_LUTFFPairReloacationAfterSl
 
         bool shouldRelocateLUTFFPair = false;
         PackingCLBSite *srcSite = nullptr;
-        auto LUTFFPair = dynamic_cast<PlacementInfo::PlacementMacro *>(
-            placementInfo->getPlacementUnitByCellId(oriCellIdsInCriticalPath[0]));
+        auto LUTFFPair = PlacementInfo::asMacro(placementInfo->getPlacementUnitByCellId(oriCellIdsInCriticalPath[0]));
         DesignInfo::DesignCell *targetLUT = nullptr;
         DesignInfo::DesignCell *targetFF = nullptr;
         if (LUTFFPair)
@@ -1550,7 +1557,7 @@ int ParallelCLBPacker::timingDrivenDetailedPlacement_swap(int iterId)
                     {
                         if (tmpPU->isLocked() || PUsDontTouch.find(tmpPU) != PUsDontTouch.end())
                             continue;
-                        if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                        if (auto unpackedCell = PlacementInfo::asUnpackedCell(tmpPU))
                         {
                             auto targetCell = unpackedCell->getCell();
 
@@ -1598,9 +1605,8 @@ int ParallelCLBPacker::timingDrivenDetailedPlacement_swap(int iterId)
                     auto trialCurrentCluster = PUId2PackingCLBSite[curPU->getId()]->getDeterminedClusterInSite();
                     trialCurrentCluster->removePUToConstructDetCluster(curPU);
                     assert(trialCurrentCluster->addPU(bestSwapCandidatePU));
-                    auto unpackedCell_curPU = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU);
-                    auto unpackedCell_bestSwapCandidatePU =
-                        dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(bestSwapCandidatePU);
+                    auto unpackedCell_curPU = PlacementInfo::asUnpackedCell(curPU);
+                    auto unpackedCell_bestSwapCandidatePU = PlacementInfo::asUnpackedCell(bestSwapCandidatePU);
                     cellId2PackingSite[unpackedCell_curPU->getCell()->getCellId()] = bestCandidatePackingSite;
                     cellId2PackingSite[unpackedCell_bestSwapCandidatePU->getCell()->getCellId()] =
                         PUId2PackingCLBSite[curPU->getId()];
@@ -1746,7 +1752,7 @@ void ParallelCLBPacker::checkPackedPUsAndUnpackedPUs()
             auto tmpPU = placementInfo->getPlacementUnitByCell(tmpCell);
             if (packedPUs.find(tmpPU) != packedPUs.end())
                 continue;
-            if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+            if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
             {
                 if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY ||
                     tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MCLB)
@@ -1770,6 +1776,9 @@ void ParallelCLBPacker::exceptionHandling(bool verbose)
 
     std::vector<bool> isLegalizedPU(placementUnits.size(), false);
 
+    // the PlacementUnits are not moved during the exception handling, so the net bounding boxes are built only once
+    HPWLTracker.build(y2xRatio);
+
     float Dc = maxD * 0.5;
 
     auto inputUnpackedPUsVec = unpackedPUsVec;
@@ -1784,11 +1793,23 @@ void ParallelCLBPacker::exceptionHandling(bool verbose)
             PUPoints.emplace_back(PU);
     }
 
+    // the spatial index of the PUs to be legalized is indexed by PU ids and built only once. The legalized PUs are
+    // removed from it instead of rebuilding it for the remaining PUs.
+    std::vector<float> PUIndexX(placementUnits.size(), 0), PUIndexY(placementUnits.size(), 0);
+    std::vector<int> PUIndexKey(placementUnits.size(), -1);
+    for (auto &tmpPUPoint : PUPoints)
+    {
+        int PUId = tmpPUPoint.getPU()->getId();
+        PUIndexX[PUId] = tmpPUPoint[0];
+        PUIndexY[PUId] = tmpPUPoint[1];
+        PUIndexKey[PUId] = 0;
+    }
+    SpatialGridIndex PUIndex(y2xRatio);
+    PUIndex.build(PUIndexX, PUIndexY, PUIndexKey);
+
     while (PUPoints.size())
     {
         timingOptimizer->getPUId2Slack(true); // update PU slack information
-        // build k-d tree
-        kdt::KDTree<PULocation> kdtree(PUPoints, y2xRatio);
         processedPUs.clear();
         print_status("ParallelCLBPacker: starting parallel ripping up for " + std::to_string(PUPoints.size()) +
                      " PUs and current displacement threshold for ripping up is " + std::to_string(Dc));
@@ -1814,13 +1835,13 @@ void ParallelCLBPacker::exceptionHandling(bool verbose)
                 noRipUpOverlapPUs.push_back(tmpPUPoint.getPU());
                 coveredPUs.insert(tmpPUPoint.getPU());
                 processedPUs.insert(tmpPUPoint.getPU());
-                std::vector<int> indices = kdtree.radiusSearch(tmpPUPoint, 4 * Dc + 2);
-                for (auto tmpInd : indices)
+                std::vector<int> PUIds = PUIndex.radiusSearch(tmpPUPoint[0], tmpPUPoint[1], 4 * Dc + 2);
+                for (auto PUId : PUIds)
                 {
-                    assert(std::fabs(PUPoints[tmpInd].getPU()->X() - tmpPUPoint.getPU()->X()) +
-                               y2xRatio * std::fabs(PUPoints[tmpInd].getPU()->Y() - tmpPUPoint.getPU()->Y()) <=
+                    assert(std::fabs(placementUnits[PUId]->X() - tmpPUPoint.getPU()->X()) +
+                               y2xRatio * std::fabs(placementUnits[PUId]->Y() - tmpPUPoint.getPU()->Y()) <=
                            4 * Dc + 2);
-                    coveredPUs.insert(PUPoints[tmpInd].getPU());
+                    coveredPUs.insert(placementUnits[PUId]);
                 }
             }
 
@@ -1854,6 +1875,10 @@ void ParallelCLBPacker::exceptionHandling(bool verbose)
                 PUPoints[unprocessedCnt] = PUPoints[i];
                 unprocessedCnt++;
             }
+            else
+            {
+                PUIndex.remove(PUPoints[i].getPU()->getId());
+            }
         }
         PUPoints.resize(unprocessedCnt);
         Dc += 0.3 * maxD;
@@ -1881,7 +1906,7 @@ void ParallelCLBPacker::exceptionHandling(bool verbose)
         for (unsigned int i = 0; i < PUPoints.size(); i++)
         {
             auto tmpPU = PUPoints[i].getPU();
-            if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+            if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
             {
                 if (unpackCell->getCell()->isFF())
                 {
@@ -1894,7 +1919,7 @@ void ParallelCLBPacker::exceptionHandling(bool verbose)
                     avgLUTWeight += placementInfo->getActualOccupation(unpackCell->getCell());
                 }
             }
-            else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+            else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
             {
                 assert(curMacro->getMacroType() != PlacementInfo::PlacementMacro::PlacementMacroType_CARRY &&
                        curMacro->getMacroType() != PlacementInfo::PlacementMacro::PlacementMacroType_MCLB);
@@ -1966,15 +1991,8 @@ bool ParallelCLBPacker::exceptionPULegalize(PlacementInfo::PlacementUnit *curPU,
 
         // involvedPackingSite2PU[packingSite] = curPU;
 
-        float changeHPWL = 0;
-        for (auto tmpNet : *(curPU->getNetsSetPtr()))
-        {
-            if (tmpNet->getUnits().size() > 64) // ignore large net
-                continue;
-            changeHPWL += tmpNet->getNewHPWLByTrying(curPU, tmpSite->X(), tmpSite->Y(), y2xRatio);
-            changeHPWL -= tmpNet->getHPWL(y2xRatio);
-            assert(!std::isnan(changeHPWL));
-        }
+        float changeHPWL = HPWLTracker.getHPWLChange(curPU, tmpSite->X(), tmpSite->Y());
+        assert(!std::isnan(changeHPWL));
 
         float packedScore = 0;
         float score = -lambda1 * changeHPWL;
@@ -2105,7 +2123,7 @@ bool ParallelCLBPacker::ripUpAndLegalizae(
         if (backup_determinedCluster)
         {
 
-            std::set<PlacementInfo::PlacementUnit *, Packing_PUcompare> evictedPUs = backup_determinedCluster->getPUs();
+            auto evictedPUs = backup_determinedCluster->getPUs();
             std::set<PlacementInfo::PlacementUnit *, Packing_PUcompare> notEvictedPUs;
             notEvictedPUs.clear();
 
@@ -2563,6 +2581,8 @@ void ParallelCLBPacker::updatePackedMacro(bool setPUPseudoNetToCLBSite, bool set
 {
     std::vector<PlacementInfo::PlacementUnit *> packedPUs;
     std::vector<PlacementInfo::Location> &cellLoc = placementInfo->getCellId2location();
+    // the macros created here get their ids only after the PlacementUnits are re-indexed, so they are mapped by
+    // pointers before they are set as the legalization information of PlacementInfo
     std::map<PlacementInfo::PlacementUnit *, float> PU2X, PU2Y;
     std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2Sites;
     PU2Sites.clear();
@@ -2580,12 +2600,12 @@ void ParallelCLBPacker::updatePackedMacro(bool setPUPseudoNetToCLBSite, bool set
                     std::vector<DesignInfo::DesignCell *> cellsToAdd(0);
                     for (auto tmpPU : packingSite->getDeterminedClusterInSite()->getPUs())
                     {
-                        if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                        if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
                         {
                             cellsToAdd.push_back(unpackCell->getCell());
                             cellsToAdd_cellType.push_back(unpackCell->getCell()->getCellType());
                         }
-                        else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                        else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                         {
                             assert(curMacro->getMacroType() !=
                                        PlacementInfo::PlacementMacro::PlacementMacroType_CARRY &&
@@ -2601,10 +2621,10 @@ void ParallelCLBPacker::updatePackedMacro(bool setPUPseudoNetToCLBSite, bool set
                         }
                         placementUnits[tmpPU->getId()] = nullptr;
                         placementInfo->deleteLegalizationInfoFor(tmpPU);
-                        delete tmpPU;
+                        placementInfo->destroyPlacementUnit(tmpPU);
                     }
                     assert(cellsToAdd.size() >= 1);
-                    PlacementInfo::PlacementMacro *curMacro = new PlacementInfo::PlacementMacro(
+                    PlacementInfo::PlacementMacro *curMacro = placementInfo->createPlacementMacro(
                         cellsToAdd[0]->getName(), -1, PlacementInfo::PlacementMacro::PlacementMacroType_LCLB);
                     curMacro->setAnchorLocationAndForgetTheOriginalOne(packingSite->getCLBSite()->X(),
                                                                        packingSite->getCLBSite()->Y());
@@ -2667,11 +2687,11 @@ void ParallelCLBPacker::updatePackedMacro(bool setPUPseudoNetToCLBSite, bool set
         {
             placementUnits[validCnt] = placementUnits[tmpPUId];
             placementUnits[validCnt]->renewId(validCnt);
-            if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(placementUnits[validCnt]))
+            if (auto unpackCell = PlacementInfo::asUnpackedCell(placementUnits[validCnt]))
             {
                 placementUnpackedCells.push_back(unpackCell);
             }
-            else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(placementUnits[validCnt]))
+            else if (auto curMacro = PlacementInfo::asMacro(placementUnits[validCnt]))
             {
                 placementMacros.push_back(curMacro);
                 assert((unsigned int)curMacro->getWeight() >= curMacro->getCells().size());
@@ -2744,7 +2764,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
 {
     for (auto &DSPBRAM_LegalSitePair : placementInfo->getPULegalSite())
     {
-        if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(DSPBRAM_LegalSitePair.first))
+        if (auto tmpMacro = PlacementInfo::asMacro(DSPBRAM_LegalSitePair.first))
         {
             if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_BRAM)
             {
@@ -2761,7 +2781,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
                             assert(targetSite->getSiteY() % 2 == 0);
                             PackingCLBSite *tmpPackingSite = new PackingCLBSite(
                                 placementInfo, targetSite, unchangedIterationThr, numNeighbor, deltaD, curD, maxD,
-                                PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                                PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
                             tmpPackingSite->setNonCLBCell(curCell);
                             deviceSite2PackingSite[targetSite] = tmpPackingSite;
                             packingSites.push_back(tmpPackingSite);
@@ -2771,7 +2791,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
                         {
                             PackingCLBSite *tmpPackingSite = new PackingCLBSite(
                                 placementInfo, targetSite, unchangedIterationThr, numNeighbor, deltaD, curD, maxD,
-                                PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                                PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
                             tmpPackingSite->setNonCLBCell(curCell);
                             deviceSite2PackingSite[targetSite] = tmpPackingSite;
                             packingSites.push_back(tmpPackingSite);
@@ -2796,9 +2816,9 @@ void ParallelCLBPacker::addNonCLBPackingSites()
                     auto targetSite = DSPBRAM_LegalSitePair.second[i];
                     if (!curCell->isVirtualCell())
                     {
-                        PackingCLBSite *tmpPackingSite =
-                            new PackingCLBSite(placementInfo, targetSite, unchangedIterationThr, numNeighbor, deltaD,
-                                               curD, maxD, PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                        PackingCLBSite *tmpPackingSite = new PackingCLBSite(
+                            placementInfo, targetSite, unchangedIterationThr, numNeighbor, deltaD, curD, maxD, PQSize,
+                            y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
                         tmpPackingSite->setNonCLBCell(curCell);
                         deviceSite2PackingSite[targetSite] = tmpPackingSite;
                         packingSites.push_back(tmpPackingSite);
@@ -2814,8 +2834,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
                 // assert(false && "undefined situtation");
             }
         }
-        else if (auto tmpUnppackedCell =
-                     dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(DSPBRAM_LegalSitePair.first))
+        else if (auto tmpUnppackedCell = PlacementInfo::asUnpackedCell(DSPBRAM_LegalSitePair.first))
         {
             assert(1 == DSPBRAM_LegalSitePair.second.size());
             auto curCell = tmpUnppackedCell->getCell();
@@ -2824,7 +2843,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
             {
                 PackingCLBSite *tmpPackingSite =
                     new PackingCLBSite(placementInfo, targetSite, unchangedIterationThr, numNeighbor, deltaD, curD,
-                                       maxD, PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                                       maxD, PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
                 tmpPackingSite->setNonCLBCell(curCell);
                 deviceSite2PackingSite[targetSite] = tmpPackingSite;
                 packingSites.push_back(tmpPackingSite);
@@ -2833,7 +2852,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
             {
                 PackingCLBSite *tmpPackingSite =
                     new PackingCLBSite(placementInfo, targetSite, unchangedIterationThr, numNeighbor, deltaD, curD,
-                                       maxD, PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                                       maxD, PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
                 tmpPackingSite->setNonCLBCell(curCell);
                 deviceSite2PackingSite[targetSite] = tmpPackingSite;
                 packingSites.push_back(tmpPackingSite);
@@ -2854,7 +2873,7 @@ void ParallelCLBPacker::addNonCLBPackingSites()
             assert(lockedSite);
             PackingCLBSite *tmpPackingSite =
                 new PackingCLBSite(placementInfo, lockedSite, unchangedIterationThr, numNeighbor, deltaD, curD, maxD,
-                                   PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite);
+                                   PQSize, y2xRatio, HPWLWeight, PUId2PackingCLBSite, randomSeed);
             tmpPackingSite->setNonCLBCell(curCell);
             deviceSite2PackingSite[lockedSite] = tmpPackingSite;
             packingSites.push_back(tmpPackingSite);
@@ -2867,7 +2886,7 @@ void ParallelCLBPacker::dumpDSPBRAMPlacementTcl(std::ofstream &outfileTcl)
     for (auto &DSPBRAM_LegalSitePair : placementInfo->getPULegalSite())
     {
         std::string placementStr = "";
-        if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(DSPBRAM_LegalSitePair.first))
+        if (auto tmpMacro = PlacementInfo::asMacro(DSPBRAM_LegalSitePair.first))
         {
             if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_BRAM)
             {
@@ -2933,8 +2952,7 @@ void ParallelCLBPacker::dumpDSPBRAMPlacementTcl(std::ofstream &outfileTcl)
                 // assert(false && "undefined situtation");
             }
         }
-        else if (auto tmpUnppackedCell =
-                     dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(DSPBRAM_LegalSitePair.first))
+        else if (auto tmpUnppackedCell = PlacementInfo::asUnpackedCell(DSPBRAM_LegalSitePair.first))
         {
             assert(1 == DSPBRAM_LegalSitePair.second.size());
             auto curCell = tmpUnppackedCell->getCell();
@@ -2982,11 +3000,11 @@ void ParallelCLBPacker::dumpDSPBRAMPlacementTcl(std::ofstream &outfileTcl)
 
 bool containLUTRAMCells(PlacementInfo::PlacementUnit *curPU)
 {
-    if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+    if (auto unpackedCell = PlacementInfo::asUnpackedCell(curPU))
     {
         return unpackedCell->getCell()->originallyIsLUTRAM();
     }
-    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+    else if (auto curMacro = PlacementInfo::asMacro(curPU))
     {
         for (auto tmpCell : curMacro->getCells())
         {
@@ -3122,7 +3140,7 @@ void ParallelCLBPacker::dumpCLBPlacementTcl(std::ofstream &outfileTcl, bool pack
                                 continue;
                             assert(slotMapping.FFs[i][j][k]->isFF());
                             auto PU = placementInfo->getPlacementUnitByCell(slotMapping.FFs[i][j][k]);
-                            if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(PU))
+                            if (auto tmpMacro = PlacementInfo::asMacro(PU))
                             {
                                 if (tmpMacro->getMacroType() ==
                                     PlacementInfo::PlacementMacro::
@@ -3347,7 +3365,7 @@ void ParallelCLBPacker::dumpFinalPacking()
                 auto tmpPU = placementInfo->getPlacementUnitByCell(tmpCell);
                 if (tmpPU->isPacked())
                     continue;
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY ||
                         tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MCLB)
@@ -3430,14 +3448,14 @@ void ParallelCLBPacker::dumpAllCellsCoordinate()
             std::stringstream outfile0;
             for (auto curPU : placementInfo->getPlacementUnits())
             {
-                if (auto curUnpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
                 {
                     float cellX = curUnpackedCell->X();
                     float cellY = curUnpackedCell->Y();
                     DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
                     outfile0 << cellX << " " << cellY << " " << curCell->getName() << "\n";
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                 {
                     for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
                     {
@@ -28,16 +28,22 @@
 
 #include "DesignInfo.h"
 #include "DeviceInfo.h"
-#include "KDTree/KDTree.h"
+#include "IncrementalHPWLTracker.h"
 #include "MaximalCardinalityMatching/MaximalCardinalityMatching.h"
 #include "PlacementInfo.h"
 #include "PlacementTimingOptimizer.h"
 #include "WirelengthOptimizer.h"
 #include "const.h"
 #include "dumpZip.h"
+#include "fixedCapacityVector.h"
+#include "randomStream.h"
 #include "readZip.h"
+#include "smallSortedSet.h"
+#include "spatialGridIndex.h"
 #include "strPrint.h"
 #include "stringCheck.h"
+#include "threadLocalPool.h"
+#include <array>
 #include <assert.h>
 #include <cmath>
 #include <fstream>
@@ -131,6 +137,14 @@ class ParallelCLBPacker
     class PackedControlSet
     {
       public:
+        /**
+         * @brief the FFs of a PackedControlSet are stored inline, so copying a PackingCLBCluster does not allocate
+         * memory for its control sets. A control set holds at most 4 FFs (MaxNum_FFinControlSet of PackingCLBCluster),
+         * i.e., the FFs sharing a clock enable in a quarter of a CLB site.
+         *
+         */
+        typedef FixedCapacityVector<DesignInfo::DesignCell *, 4> FFList;
+
         PackedControlSet()
         {
             FFs.clear();
@@ -207,9 +221,9 @@ class ParallelCLBPacker
         /**
          * @brief get the FFs in this PackedControlSet
          *
-         * @return const std::vector<DesignInfo::DesignCell *>&
+         * @return const FFList&
          */
-        inline const std::vector<DesignInfo::DesignCell *> &getFFs() const
+        inline const FFList &getFFs() const
         {
             return FFs;
         }
@@ -387,7 +401,7 @@ class ParallelCLBPacker
         DesignInfo::DesignNet *SR = nullptr;
         DesignInfo::DesignNet *CE = nullptr;
         DesignInfo::DesignCellType FFType;
-        std::vector<DesignInfo::DesignCell *> FFs;
+        FFList FFs;
         bool mustMainSlots = false;
     };
 
@@ -416,13 +430,16 @@ class ParallelCLBPacker
          * @param HPWLWeight the factor of HPWL overhead in packing evaluation for a cell
          * @param PUId2PackingCLBSite the reference of a map (actually a vector) recording the mapping of PlacementUnits
          * to the PackingCLBSites
+         * @param randomSeed the seed of the random stream of the site, which is identified by the site location
          */
         PackingCLBSite(PlacementInfo *placementInfo, DeviceInfo::DeviceSite *CLBSite, int unchangedIterationThr,
                        int numNeighbor, float deltaD, float curD, float maxD, unsigned int PQSize, float y2xRatio,
-                       float HPWLWeight, std::vector<PackingCLBSite *> &PUId2PackingCLBSite)
+                       float HPWLWeight, std::vector<PackingCLBSite *> &PUId2PackingCLBSite, uint64_t randomSeed)
             : placementInfo(placementInfo), CLBSite(CLBSite), unchangedIterationThr(unchangedIterationThr),
               numNeighbor(numNeighbor), deltaD(deltaD), curD(curD), maxD(maxD), PQSize(PQSize), y2xRatio(y2xRatio),
-              HPWLWeight(HPWLWeight), PUId2PackingCLBSite(PUId2PackingCLBSite), determinedClusterInSite(nullptr)
+              HPWLWeight(HPWLWeight), PUId2PackingCLBSite(PUId2PackingCLBSite), determinedClusterInSite(nullptr),
+              randomStream(randomSeed, ((uint64_t)CLBSite->getSiteY() << 32) + CLBSite->getSiteX(),
+                           RandomStream::StreamDomain_PackingCLBSite)
         {
             neighborPUs.clear();
             seedClusters.clear();
@@ -452,6 +469,15 @@ class ParallelCLBPacker
         class PackingCLBCluster
         {
           public:
+            /**
+             * @brief the containers of the PlacementUnits and LUTs in a cluster, sized to the slots of a CLB site so
+             * copying a candidate cluster does not allocate memory
+             *
+             */
+            typedef SmallSortedSet<PlacementInfo::PlacementUnit *, 32, Packing_PUcompare> PUSet;
+            typedef SmallSortedSet<DesignInfo::DesignCell *, 16> LUTSet;
+            typedef SmallSortedSet<std::pair<DesignInfo::DesignCell *, DesignInfo::DesignCell *>, 8> LUTPairSet;
+
             /**
              * @brief Construct a new Packing CLB Cluster object (it should not be called.)
              *
@@ -464,16 +490,29 @@ class ParallelCLBPacker
             PackingCLBCluster(PackingCLBSite *parentPackingCLB) : parentPackingCLB(parentPackingCLB)
             {
                 placementInfo = parentPackingCLB->getPlacementInfo();
-                id = random();
+                id = parentPackingCLB->getRandomStream().randomInt();
                 PUs.clear();
-                FFControlSets.clear();
-                FFControlSets.resize(4);
                 singleLUTs.clear();
                 pairedLUTs.clear();
                 // nets.clear();
             }
             ~PackingCLBCluster(){};
 
+            /**
+             * @brief the candidate clusters are frequently created and destroyed by the packing threads, so their
+             * memory is recycled by a per-thread pool
+             *
+             */
+            static inline void *operator new(size_t size)
+            {
+                return ThreadLocalPool<PackingCLBCluster>::allocate(size);
+            }
+
+            static inline void operator delete(void *ptr)
+            {
+                ThreadLocalPool<PackingCLBCluster>::deallocate(ptr);
+            }
+
             PackingCLBCluster(PackingCLBCluster *anotherPackingCLBCluster)
             {
                 id = anotherPackingCLBCluster->getId();
@@ -509,7 +548,7 @@ class ParallelCLBPacker
              */
             inline void refreshId()
             {
-                id = random();
+                id = parentPackingCLB->getRandomStream().randomInt();
             }
 
             /**
@@ -668,7 +707,7 @@ class ParallelCLBPacker
                 if (!cell)
                     return false;
                 auto tmpPU = placementInfo->getPlacementUnitByCell(cell);
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     return (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7 ||
                             tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX8);
@@ -681,7 +720,7 @@ class ParallelCLBPacker
                 if (!cell)
                     return false;
                 auto tmpPU = placementInfo->getPlacementUnitByCell(cell);
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     return (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY);
                 }
@@ -894,11 +933,11 @@ class ParallelCLBPacker
             {
                 assert(PUs.find(tmpPU) != PUs.end());
                 std::vector<DesignInfo::DesignCell *> cellsToRemove(0);
-                if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
                 {
                     cellsToRemove.push_back(unpackCell->getCell());
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     for (auto tmpCell : curMacro->getCells())
                         cellsToRemove.push_back(tmpCell);
@@ -921,7 +960,7 @@ class ParallelCLBPacker
                     }
                 }
                 PUs.erase(tmpPU);
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7 ||
                         tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX8)
@@ -942,7 +981,7 @@ class ParallelCLBPacker
              */
             inline bool isPUTypeCompatibleWithSiteType(PlacementInfo::PlacementUnit *tmpPU)
             {
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_LCLB)
                     {
@@ -1029,7 +1068,7 @@ class ParallelCLBPacker
                 return PUs.find(tmpPU) != PUs.end();
             }
 
-            inline const std::set<PlacementInfo::PlacementUnit *, Packing_PUcompare> &getPUs() const
+            inline const PUSet &getPUs() const
             {
                 return PUs;
             }
@@ -1078,7 +1117,7 @@ class ParallelCLBPacker
                 {
                     // if (PU->checkHasMUX())
                     // {
-                    //     if (auto muxMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(PU))
+                    //     if (auto muxMacro = PlacementInfo::asMacro(PU))
                     //     {
                     //         for (auto cell : muxMacro->getCells())
                     //         {
@@ -1086,7 +1125,7 @@ class ParallelCLBPacker
                     //         }
                     //     }
                     // }
-                    if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(PU))
+                    if (auto tmpMacro = PlacementInfo::asMacro(PU))
                     {
                         if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7)
                         {
@@ -1132,7 +1171,7 @@ class ParallelCLBPacker
                 return res;
             }
 
-            inline const std::vector<PackedControlSet> &getFFControlSets() const
+            inline const std::array<PackedControlSet, 4> &getFFControlSets() const
             {
                 return FFControlSets;
             }
@@ -1140,9 +1179,9 @@ class ParallelCLBPacker
             /**
              * @brief Get the set of single LUTs in this cluster (some other LUTs have been paired for packing)
              *
-             * @return const std::set<DesignInfo::DesignCell *>&
+             * @return const LUTSet&
              */
-            inline const std::set<DesignInfo::DesignCell *> &getSingleLUTs() const
+            inline const LUTSet &getSingleLUTs() const
             {
                 return singleLUTs;
             }
@@ -1253,9 +1292,9 @@ class ParallelCLBPacker
             /**
              * @brief Get the set of the paired LUTs
              *
-             * @return const std::set<std::pair<DesignInfo::DesignCell *, DesignInfo::DesignCell *>>&
+             * @return const LUTPairSet&
              */
-            inline const std::set<std::pair<DesignInfo::DesignCell *, DesignInfo::DesignCell *>> &getPairedLUTs() const
+            inline const LUTPairSet &getPairedLUTs() const
             {
                 return pairedLUTs;
             }
@@ -1367,13 +1406,13 @@ class ParallelCLBPacker
                 }
                 for (auto tmpPU : PUs)
                 {
-                    if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                    if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
                     {
                         hashId += HiFPlacer_hashprimes[(unsigned char)(~(unpackCell->getCell()->getCellId()) & 0xff)] *
                                   unpackCell->getCell()->getCellId();
                         hashId %= 10001777;
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                     {
                         for (auto tmpCell : curMacro->getCells())
                         {
@@ -1398,14 +1437,14 @@ class ParallelCLBPacker
 
                 int clusterHashId = getHash();
 
-                if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
                 {
                     clusterHashId +=
                         HiFPlacer_hashprimes[(unsigned char)(~(unpackCell->getCell()->getCellId()) & 0xff)] *
                         unpackCell->getCell()->getCellId();
                     clusterHashId %= 10001777;
                 }
-                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                 {
                     for (auto tmpCell : curMacro->getCells())
                     {
@@ -1441,12 +1480,12 @@ class ParallelCLBPacker
                 std::vector<DesignInfo::DesignCell *> cellsToCheck(0);
                 for (auto tmpPU : PUs)
                 {
-                    if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                    if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
                     {
                         hashId += 28901 * unpackCell->getCell()->getCellId();
                         hashId %= 10001777;
                     }
-                    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                    else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                     {
                         for (auto tmpCell : curMacro->getCells())
                         {
@@ -1621,13 +1660,13 @@ class ParallelCLBPacker
 
                 auto &timingNodes =
                     parentPackingCLB->getPlacementInfo()->getTimingInfo()->getSimplePlacementTimingInfo();
-                if (auto unpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto unpacked = PlacementInfo::asUnpackedCell(curPU))
                 {
                     if (unpacked->getCell()->isVirtualCell())
                         return 0;
                     return timingNodes[unpacked->getCell()->getCellId()]->getLongestPathLength();
                 }
-                else if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto tmpMacro = PlacementInfo::asMacro(curPU))
                 {
                     int maxLen = 0;
                     for (auto tmpCell : tmpMacro->getCells())
@@ -1657,7 +1696,7 @@ class ParallelCLBPacker
 
                 auto &timingNodes =
                     parentPackingCLB->getPlacementInfo()->getTimingInfo()->getSimplePlacementTimingInfo();
-                if (auto unpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                if (auto unpacked = PlacementInfo::asUnpackedCell(curPU))
                 {
                     if (unpacked->getCell()->isVirtualCell() ||
                         timingNodes[unpacked->getCell()->getCellId()]->checkIsRegister())
@@ -1665,7 +1704,7 @@ class ParallelCLBPacker
                     return (timingNodes[unpacked->getCell()->getCellId()]->getLatestInputArrival() -
                             timingNodes[unpacked->getCell()->getCellId()]->getRequiredArrivalTime());
                 }
-                else if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                else if (auto tmpMacro = PlacementInfo::asMacro(curPU))
                 {
                     float maxNegativeSlack = 0;
                     for (auto tmpCell : tmpMacro->getCells())
@@ -1729,7 +1768,7 @@ class ParallelCLBPacker
              *
              */
             int id = -1;
-            std::set<PlacementInfo::PlacementUnit *, Packing_PUcompare> PUs;
+            PUSet PUs;
 
             /**
              * @brief the connectivity score for this cluster
@@ -1783,20 +1822,20 @@ class ParallelCLBPacker
              * please note that some of these LUT/FFs are belong to CARRY chain, which is not shown in PUs
              *
              */
-            std::vector<PackedControlSet> FFControlSets;
-            std::vector<PackedControlSet> FFControlSets_backup;
+            std::array<PackedControlSet, 4> FFControlSets;
+            std::array<PackedControlSet, 4> FFControlSets_backup;
 
             /**
              * @brief the set of LUTs have not been paired with other LUTs in the clutser
              *
              */
-            std::set<DesignInfo::DesignCell *> singleLUTs;
+            LUTSet singleLUTs;
 
             /**
              * @brief the paired LUTs in the cluster
              *
              */
-            std::set<std::pair<DesignInfo::DesignCell *, DesignInfo::DesignCell *>> pairedLUTs;
+            LUTPairSet pairedLUTs;
         };
 
         /**
@@ -1850,6 +1889,16 @@ class ParallelCLBPacker
             return neighborPUs;
         }
 
+        /**
+         * @brief get the number of the candidate clusters evaluated in the latest update step
+         *
+         * @return int
+         */
+        inline int getEvaluatedClusterNum()
+        {
+            return evaluatedClusterNum;
+        }
+
         /**
          * @brief sort the elements in the priority queue
          *
@@ -1987,6 +2036,16 @@ class ParallelCLBPacker
             return placementInfo;
         }
 
+        /**
+         * @brief Get the random stream of the site, which is only accessed by the thread handling the site
+         *
+         * @return RandomStream&
+         */
+        inline RandomStream &getRandomStream()
+        {
+            return randomStream;
+        }
+
         /**
          * @brief add CARRY-related PlacementUnit into this CLB site
          *
@@ -2479,7 +2538,7 @@ class ParallelCLBPacker
             if (!cell)
                 return false;
             auto tmpPU = placementInfo->getPlacementUnitByCell(cell);
-            if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+            if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
             {
                 return (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7 ||
                         tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX8);
@@ -2492,7 +2551,7 @@ class ParallelCLBPacker
             if (!cell)
                 return false;
             auto tmpPU = placementInfo->getPlacementUnitByCell(cell);
-            if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+            if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
             {
                 return (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY);
             }
@@ -2739,6 +2798,7 @@ class ParallelCLBPacker
         bool clockRegionAware = true;
 
         int unchangeIterationCnt = 0;
+        int evaluatedClusterNum = 0;
         std::set<PlacementInfo::PlacementUnit *, Packing_PUcompare> neighborPUs;
         // std::map<PlacementInfo::PlacementUnit *, float> PU2HPWLChange;
         std::vector<PackingCLBCluster *> seedClusters;
@@ -2748,6 +2808,12 @@ class ParallelCLBPacker
         PackingCLBCluster *determinedClusterInSite = nullptr;
         float detScore = 0;
 
+        /**
+         * @brief the random stream for the ids of the clusters in the site
+         *
+         */
+        RandomStream randomStream;
+
         bool isCarrySite = false;
         bool isLUTRAMSite = false;
         bool isNonCLBSite = false;
@@ -2803,14 +2869,13 @@ class ParallelCLBPacker
     } PUWithScore;
 
     /**
-     * @brief PULocation is a helper class to find the neighbor PlacementUnits with KD-Tree
+     * @brief PULocation records the PlacementUnit pointer and its location when the neighbor PlacementUnits are
+     * searched with the SpatialGridIndex
      *
      */
     class PULocation : public std::array<float, 2>
     {
       public:
-        // dimension of the Point
-        static const int DIM = 2;
         PULocation()
         {
             assert(false);
@@ -2970,6 +3035,14 @@ class ParallelCLBPacker
     DeviceInfo *deviceInfo;
     PlacementInfo *placementInfo;
     std::map<std::string, std::string> &JSONCfg;
+
+    /**
+     * @brief the tracker of the bounding boxes of the small nets, which evaluates the HPWL changes of the candidate
+     * sites during the exception handling
+     *
+     */
+    IncrementalHPWLTracker HPWLTracker;
+
     /**
      * @brief specify how many iterations a PlacementUnit should stay at the top priority of a
      * site before we finally map it to the site
@@ -3014,6 +3087,12 @@ class ParallelCLBPacker
     float HPWLWeight;
     std::string packerName;
 
+    /**
+     * @brief the seed of the random streams of the PackingCLBSites
+     *
+     */
+    uint64_t randomSeed;
+
     PlacementTimingOptimizer *timingOptimizer = nullptr;
     WirelengthOptimizer *WLOptimizer = nullptr;
 
@@ -295,8 +295,7 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::checkNumMuxCompatible
     {
         if (!tmpFF->isVirtualCell())
             continue;
-        if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(
-                parentPackingCLB->getPlacementInfo()->getPlacementUnitByCell(tmpFF)))
+        if (auto tmpMacro = PlacementInfo::asMacro(parentPackingCLB->getPlacementInfo()->getPlacementUnitByCell(tmpFF)))
         {
             if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7 ||
                 tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX8)
@@ -396,11 +395,11 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::addFFGroup(std::vecto
 void ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::addPUFailReason(PlacementInfo::PlacementUnit *tmpPU)
 {
     std::vector<DesignInfo::DesignCell *> cellsToAdd(0);
-    if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+    if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
     {
         cellsToAdd.push_back(unpackCell->getCell());
     }
-    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+    else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
     {
         for (auto tmpCell : curMacro->getCells())
             cellsToAdd.push_back(tmpCell);
@@ -636,7 +635,7 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::addPU(PlacementInfo::
 
     bool enforceMainFF = false;
     bool isMUXMacro = false;
-    auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU);
+    auto tmpMacro = PlacementInfo::asMacro(tmpPU);
     if (tmpMacro)
     {
         if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7 ||
@@ -666,13 +665,13 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::addPU(PlacementInfo::
 
     std::vector<DesignInfo::DesignCell *> cellsToAdd(0);
     std::vector<DesignInfo::DesignCell *> FFsToAdd(0);
-    if (auto unpackCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+    if (auto unpackCell = PlacementInfo::asUnpackedCell(tmpPU))
     {
         cellsToAdd.push_back(unpackCell->getCell());
         if (isMUXMacro && unpackCell->getCell()->isFF())
             FFsToAdd.push_back(unpackCell->getCell());
     }
-    else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+    else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
     {
         for (auto tmpCell : curMacro->getCells())
         {
@@ -780,7 +779,7 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::checkCellCorrectness(
             bool Bok = false;
             if (PUs.find(tmpPUA) == PUs.end())
             {
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPUA))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPUA))
                 {
                     if (tmpMacro->checkHasCARRY())
                     {
@@ -798,7 +797,7 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::checkCellCorrectness(
             }
             if (PUs.find(tmpPUB) == PUs.end())
             {
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPUB))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPUB))
                 {
                     if (tmpMacro->checkHasCARRY())
                     {
@@ -839,7 +838,7 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::checkCellCorrectness(
             bool Aok = false;
             if (PUs.find(tmpPUA) == PUs.end())
             {
-                if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPUA))
+                if (auto tmpMacro = PlacementInfo::asMacro(tmpPUA))
                 {
                     if (tmpMacro->checkHasCARRY())
                     {
@@ -883,7 +882,7 @@ bool ParallelCLBPacker::PackingCLBSite::PackingCLBCluster::checkCellCorrectness(
                 bool Aok = false;
                 if (PUs.find(tmpPUA) == PUs.end())
                 {
-                    if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPUA))
+                    if (auto tmpMacro = PlacementInfo::asMacro(tmpPUA))
                     {
                         if (tmpMacro->checkHasCARRY())
                         {
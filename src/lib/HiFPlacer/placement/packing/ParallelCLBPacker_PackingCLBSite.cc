@@ -262,6 +262,7 @@ void ParallelCLBPacker::PackingCLBSite::findNewClustersWithNeighborPUs()
     {
         hashIdSet.insert(tmpSeedCluster->getHash());
     }
+    evaluatedClusterNum = 0;
     for (auto tmpSeedCluster : seedClusters)
     {
         for (auto tmpPU : neighborPUs)
@@ -269,6 +270,7 @@ void ParallelCLBPacker::PackingCLBSite::findNewClustersWithNeighborPUs()
             // if (hashIdSet.find(tmpSeedCluster->clusterHashWithAdditionalPU(tmpPU)) != hashIdSet.end())
             //     continue;
             PackingCLBCluster *tmpCluster = new PackingCLBCluster(tmpSeedCluster);
+            evaluatedClusterNum++;
 
             if (tmpCluster->addPU(tmpPU))
             {
@@ -359,7 +361,7 @@ ParallelCLBPacker::PackingCLBSite::findNeiborPUsFromBinGrid(
 
                     if (tmpPU->isFixed() || tmpPU->isPacked())
                         continue;
-                    if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                    if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
                     {
                         if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_CARRY ||
                             tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MCLB)
@@ -655,7 +657,7 @@ void ParallelCLBPacker::PackingCLBSite::finalMapToSlotsForCarrySite(int FFContro
         for (auto curFF : FFSet.getFFs())
         {
             PlacementInfo::PlacementMacro *pairMacro =
-                dynamic_cast<PlacementInfo::PlacementMacro *>(placementInfo->getPlacementUnitByCell(curFF));
+                PlacementInfo::asMacro(placementInfo->getPlacementUnitByCell(curFF));
             if (pairMacro)
             {
                 if (pairMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_LUTFFPair)
@@ -1239,7 +1241,7 @@ void ParallelCLBPacker::PackingCLBSite::finalMapToSlotsForCommonLUTFFInSite(int
         for (auto curFF : FFSet.getFFs())
         {
             PlacementInfo::PlacementMacro *pairMacro =
-                dynamic_cast<PlacementInfo::PlacementMacro *>(placementInfo->getPlacementUnitByCell(curFF));
+                PlacementInfo::asMacro(placementInfo->getPlacementUnitByCell(curFF));
             if (pairMacro)
             {
                 if (pairMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_LUTFFPair)
@@ -2135,7 +2137,7 @@ void ParallelCLBPacker::PackingCLBSite::greedyMapMuxForCommonLUTFFInSite(int FFC
         for (auto curFF : FFSet.getFFs())
         {
             PlacementInfo::PlacementMacro *pairMacro =
-                dynamic_cast<PlacementInfo::PlacementMacro *>(placementInfo->getPlacementUnitByCell(curFF));
+                PlacementInfo::asMacro(placementInfo->getPlacementUnitByCell(curFF));
             if (pairMacro)
             {
                 if (pairMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_LUTFFPair)
@@ -2154,7 +2156,7 @@ void ParallelCLBPacker::PackingCLBSite::greedyMapMuxForCommonLUTFFInSite(int FFC
     std::vector<PlacementInfo::PlacementMacro *> MUXF8Macros;
     for (auto tmpPU : determinedClusterInSite->getPUs())
     {
-        if (auto tmpMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+        if (auto tmpMacro = PlacementInfo::asMacro(tmpPU))
         {
             if (tmpMacro->getMacroType() == PlacementInfo::PlacementMacro::PlacementMacroType_MUX7)
             {
@@ -0,0 +1,125 @@
+/**
+ * @file IncrementalHPWLTracker.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the IncrementalHPWLTracker which maintains the
+ * bounding boxes of the PlacementNets for the evaluation of the HPWL changes of local moves.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "IncrementalHPWLTracker.h"
+
+void IncrementalHPWLTracker::build(float _y2xRatio)
+{
+    y2xRatio = _y2xRatio;
+    auto &placementNets = placementInfo->getPlacementNets();
+    auto &placementUnits = placementInfo->getPlacementUnits();
+    int netNum = placementNets.size();
+    int PUNum = placementUnits.size();
+
+    netTermBegin.clear();
+    termNetId.clear();
+    termPUId.clear();
+    termOffLoX.clear();
+    termOffHiX.clear();
+    termOffLoY.clear();
+    termOffHiY.clear();
+    netTermBegin.reserve(netNum + 1);
+
+    // merge the pins of a net on the same PlacementUnit into a terminal. PUId2LastTermId records the latest terminal
+    // of each PlacementUnit, which belongs to the current net only if it is not before the first terminal of the net.
+    std::vector<int> PUId2LastTermId(PUNum, -1);
+    netTermBegin.push_back(0);
+    for (int netId = 0; netId < netNum; netId++)
+    {
+        auto curNet = placementNets[netId];
+        assert(curNet->getId() == netId);
+        auto &unitsOfNetPins = curNet->getUnits();
+        auto &pinOffsetsInUnit = curNet->getPinOffsetsInUnit();
+        int curNetTermBegin = termPUId.size();
+        if ((int)unitsOfNetPins.size() <= maxNetPinNum)
+        {
+            for (unsigned int pinId_net = 0; pinId_net < unitsOfNetPins.size(); pinId_net++)
+            {
+                int PUId = unitsOfNetPins[pinId_net]->getId();
+                auto &tmpPinOffset = pinOffsetsInUnit[pinId_net];
+                int termId = PUId2LastTermId[PUId];
+                if (termId < curNetTermBegin)
+                {
+                    termId = termPUId.size();
+                    PUId2LastTermId[PUId] = termId;
+                    termNetId.push_back(netId);
+                    termPUId.push_back(PUId);
+                    termOffLoX.push_back(tmpPinOffset.x);
+                    termOffHiX.push_back(tmpPinOffset.x);
+                    termOffLoY.push_back(tmpPinOffset.y);
+                    termOffHiY.push_back(tmpPinOffset.y);
+                }
+                else
+                {
+                    termOffLoX[termId] = std::min(termOffLoX[termId], tmpPinOffset.x);
+                    termOffHiX[termId] = std::max(termOffHiX[termId], tmpPinOffset.x);
+                    termOffLoY[termId] = std::min(termOffLoY[termId], tmpPinOffset.y);
+                    termOffHiY[termId] = std::max(termOffHiY[termId], tmpPinOffset.y);
+                }
+            }
+        }
+        netTermBegin.push_back(termPUId.size());
+    }
+
+    // the terminals of each PlacementUnit are collected in the order of the net ids
+    int termNum = termPUId.size();
+    PUTermBegin.assign(PUNum + 1, 0);
+    for (int termId = 0; termId < termNum; termId++)
+        PUTermBegin[termPUId[termId] + 1]++;
+    for (int PUId = 0; PUId < PUNum; PUId++)
+        PUTermBegin[PUId + 1] += PUTermBegin[PUId];
+    PUTermIds.resize(termNum);
+    std::vector<int> PUTermFillPos(PUTermBegin.begin(), PUTermBegin.end() - 1);
+    for (int termId = 0; termId < termNum; termId++)
+        PUTermIds[PUTermFillPos[termPUId[termId]]++] = termId;
+
+    PUX.resize(PUNum);
+    PUY.resize(PUNum);
+#pragma omp parallel for
+    for (int PUId = 0; PUId < PUNum; PUId++)
+    {
+        assert((int)placementUnits[PUId]->getId() == PUId);
+        PUX[PUId] = placementUnits[PUId]->X();
+        PUY[PUId] = placementUnits[PUId]->Y();
+    }
+
+    netBounds.resize(netNum);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int netId = 0; netId < netNum; netId++)
+        updateNetBound(netId);
+}
+
+void IncrementalHPWLTracker::updateNetBound(int netId)
+{
+    NetBound &bound = netBounds[netId];
+    resetAxisBound(bound.x);
+    resetAxisBound(bound.y);
+    for (int termId = netTermBegin[netId]; termId < netTermBegin[netId + 1]; termId++)
+    {
+        const int PUId = termPUId[termId];
+        addToAxisBound(bound.x, PUX[PUId] + termOffLoX[termId], PUX[PUId] + termOffHiX[termId]);
+        addToAxisBound(bound.y, PUY[PUId] + termOffLoY[termId], PUY[PUId] + termOffHiY[termId]);
+    }
+}
@@ -0,0 +1,226 @@
+/**
+ * @file IncrementalHPWLTracker.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of IncrementalHPWLTracker class and its internal modules and APIs
+ * which maintain the bounding boxes of the PlacementNets for the evaluation of the HPWL changes of local moves.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _INCREMENTALHPWLTRACKER
+#define _INCREMENTALHPWLTRACKER
+
+#include "PlacementInfo.h"
+#include <algorithm>
+#include <assert.h>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief IncrementalHPWLTracker maintains the bounding box of each PlacementNet with the second extremes and the
+ * numbers of the terminals at the extremes, so the HPWL change of moving a PlacementUnit can be evaluated in
+ * O(#nets of the PlacementUnit) without scanning the pins of the nets.
+ *
+ * The pins of a net on the same PlacementUnit always move together, so they are merged into a terminal with the range
+ * of their offsets and a net has at most one terminal for each PlacementUnit. When a terminal is removed from a net,
+ * the remaining extreme of the net is either the current extreme or the second extreme, depending on whether the
+ * terminal is the only one at the extreme.
+ *
+ * The tracker keeps its own copy of the PlacementUnit locations, which is loaded by build(). The queries are read-only
+ * and can be called by multiple threads in parallel. The locations of the PlacementUnits themselves are not changed by
+ * the tracker, so it should be rebuilt after the PlacementUnits are moved.
+ */
+class IncrementalHPWLTracker
+{
+  public:
+    /**
+     * @brief Construct a new Incremental HPWL Tracker object
+     *
+     * @param placementInfo the PlacementInfo containing the PlacementNets and PlacementUnits
+     * @param maxNetPinNum the nets with more pins (e.g., clock nets) are ignored by the tracker
+     */
+    IncrementalHPWLTracker(PlacementInfo *placementInfo, int maxNetPinNum = 10000)
+        : placementInfo(placementInfo), maxNetPinNum(maxNetPinNum)
+    {
+    }
+    ~IncrementalHPWLTracker()
+    {
+    }
+
+    /**
+     * @brief build the terminals of the nets according to the current PlacementNets and load the current locations of
+     * the PlacementUnits to initialize the bounding boxes.
+     *
+     * @param _y2xRatio a factor to tune the weights of the net spanning in Y-coordinate relative to the net spanning in
+     * X-coordinate
+     */
+    void build(float _y2xRatio);
+
+    /**
+     * @brief get the HPWL change if the given PlacementUnit is moved to the given location
+     *
+     * @param curPU the PlacementUnit to be moved
+     * @param targetPUX
+     * @param targetPUY
+     * @return float
+     */
+    inline float getHPWLChange(PlacementInfo::PlacementUnit *curPU, float targetPUX, float targetPUY) const
+    {
+        const int PUId = curPU->getId();
+        assert(PUId >= 0 && PUId < (int)PUX.size());
+        float HPWLChange = 0;
+        for (int i = PUTermBegin[PUId]; i < PUTermBegin[PUId + 1]; i++)
+        {
+            const int termId = PUTermIds[i];
+            const NetBound &bound = netBounds[termNetId[termId]];
+            const float newSpanX =
+                getSpanAfterMove(bound.x, PUX[PUId] + termOffLoX[termId], PUX[PUId] + termOffHiX[termId],
+                                 targetPUX + termOffLoX[termId], targetPUX + termOffHiX[termId]);
+            const float newSpanY =
+                getSpanAfterMove(bound.y, PUY[PUId] + termOffLoY[termId], PUY[PUId] + termOffHiY[termId],
+                                 targetPUY + termOffLoY[termId], targetPUY + termOffHiY[termId]);
+            HPWLChange += (newSpanX - (bound.x.hi - bound.x.lo)) + y2xRatio * (newSpanY - (bound.y.hi - bound.y.lo));
+        }
+        return HPWLChange;
+    }
+
+    inline bool isBuilt() const
+    {
+        return netBounds.size() > 0;
+    }
+
+  private:
+    /**
+     * @brief the extremes of the terminals of a net in one dimension
+     *
+     * lo/hi are the extremes, loCnt/hiCnt are the numbers of terminals at the extremes and secondLo/secondHi are the
+     * extremes of the other terminals.
+     */
+    struct AxisBound
+    {
+        float lo, secondLo, hi, secondHi;
+        int loCnt, hiCnt;
+    };
+
+    struct NetBound
+    {
+        AxisBound x, y;
+    };
+
+    /**
+     * @brief get the span of a net in one dimension if one of its terminals is moved
+     *
+     * @param bound the current extremes of the net
+     * @param oldLo the current lower end of the terminal
+     * @param oldHi the current upper end of the terminal
+     * @param newLo the lower end of the terminal after the move
+     * @param newHi the upper end of the terminal after the move
+     * @return float
+     */
+    static inline float getSpanAfterMove(const AxisBound &bound, float oldLo, float oldHi, float newLo, float newHi)
+    {
+        float remainLo = (oldLo == bound.lo && bound.loCnt == 1) ? bound.secondLo : bound.lo;
+        float remainHi = (oldHi == bound.hi && bound.hiCnt == 1) ? bound.secondHi : bound.hi;
+        return std::max(remainHi, newHi) - std::min(remainLo, newLo);
+    }
+
+    static inline void resetAxisBound(AxisBound &bound)
+    {
+        bound.lo = bound.secondLo = std::numeric_limits<float>::max();
+        bound.hi = bound.secondHi = std::numeric_limits<float>::lowest();
+        bound.loCnt = bound.hiCnt = 0;
+    }
+
+    static inline void addToAxisBound(AxisBound &bound, float termLo, float termHi)
+    {
+        if (termLo < bound.lo)
+        {
+            bound.secondLo = bound.lo;
+            bound.lo = termLo;
+            bound.loCnt = 1;
+        }
+        else if (termLo == bound.lo)
+        {
+            bound.loCnt++;
+        }
+        else if (termLo < bound.secondLo)
+        {
+            bound.secondLo = termLo;
+        }
+
+        if (termHi > bound.hi)
+        {
+            bound.secondHi = bound.hi;
+            bound.hi = termHi;
+            bound.hiCnt = 1;
+        }
+        else if (termHi == bound.hi)
+        {
+            bound.hiCnt++;
+        }
+        else if (termHi > bound.secondHi)
+        {
+            bound.secondHi = termHi;
+        }
+    }
+
+    /**
+     * @brief recompute the bounding box of a net by scanning its terminals
+     *
+     * @param netId
+     */
+    void updateNetBound(int netId);
+
+    PlacementInfo *placementInfo;
+    int maxNetPinNum;
+    float y2xRatio = 1.0;
+
+    /**
+     * @brief the terminals of the net with id i are in [netTermBegin[i], netTermBegin[i+1]). The nets ignored by the
+     * tracker have no terminals.
+     *
+     */
+    std::vector<int> netTermBegin;
+    std::vector<int> termNetId;
+    std::vector<int> termPUId;
+
+    /**
+     * @brief the ranges of the pin offsets of the terminals
+     *
+     */
+    std::vector<float> termOffLoX, termOffHiX, termOffLoY, termOffHiY;
+
+    /**
+     * @brief the terminals of the PlacementUnit with id i are PUTermIds[PUTermBegin[i], PUTermBegin[i+1]), in the
+     * order of the net ids
+     *
+     */
+    std::vector<int> PUTermBegin;
+    std::vector<int> PUTermIds;
+
+    /**
+     * @brief the locations of the PlacementUnits tracked by the tracker
+     *
+     */
+    std::vector<float> PUX, PUY;
+
+    std::vector<NetBound> netBounds;
+};
+
+#endif
@@ -24,12 +24,15 @@
  */
 
 #include "PlacementInfo.h"
+#include "binaryDB.h"
+#include "randomStream.h"
 #include "readZip.h"
 #include "strPrint.h"
 #include "stringCheck.h"
 #include <assert.h>
 #include <cmath>
 #include <iomanip>
+#include <omp.h>
 #include <queue>
 #include <sys/stat.h>
 
@@ -504,21 +507,37 @@ void PlacementInfo::createGridBins(float _binWidth, float _binHeight)
     print_status("Bin Grid for Density Control Created");
 }
 
+void PlacementInfo::destroyAllPlacementUnits()
+{
+    for (auto tmpPU : placementUnits)
+    {
+        if (tmpPU)
+            destroyPlacementUnit(tmpPU);
+    }
+    if (!placementMacroArena.getLiveNum())
+        placementMacroArena.clear();
+    if (!placementUnpackedCellArena.getLiveNum())
+        placementUnpackedCellArena.clear();
+}
+
 void PlacementInfo::reloadNets()
 {
     if (!placementNets.empty())
     {
         for (auto net : placementNets)
         {
-            delete net;
+            placementNetArena.destroy(net);
         }
     }
+    // reset the arena when all the nets are destroyed, so the new nets are laid out in the order of their ids
+    if (!placementNetArena.getLiveNum())
+        placementNetArena.clear();
     placementNets.clear();
     clockNets.clear();
     designNetId2PlacementNet.resize(designInfo->getNets().size(), nullptr);
     for (DesignInfo::DesignNet *net : designInfo->getNets())
     {
-        PlacementNet *newPNet = new PlacementNet(net, placementNets.size(), cellId2PlacementUnitVec, this);
+        PlacementNet *newPNet = placementNetArena.create(net, placementNets.size(), cellId2PlacementUnitVec, this);
         PlacementUnit *PUInNet = nullptr;
         bool isInternalNet = true;
         for (auto tmpPU : newPNet->getUnits())
@@ -535,7 +554,7 @@ void PlacementInfo::reloadNets()
         }
         if (isInternalNet)
         {
-            delete newPNet;
+            placementNetArena.destroy(newPNet);
             continue;
         }
         designNetId2PlacementNet[net->getElementIdInType()] = newPNet;
@@ -567,6 +586,8 @@ void PlacementInfo::reloadNets()
         curPU->setNetsSetPtr(&placementUnitId2Nets[curPU->getId()]);
     }
 
+    netPinStore.build(placementNets, placementUnits);
+
     PUSetContainingFF.clear();
     PUsContainingFF.clear();
 
@@ -632,6 +653,52 @@ void PlacementInfo::reloadNets()
     print_status("reload placementNets and #register-related PU=" + std::to_string(PUsContainingFF.size()));
 }
 
+void PlacementInfo::PlacementNetPinStore::build(std::vector<PlacementNet *> &placementNets,
+                                                std::vector<PlacementUnit *> &placementUnits)
+{
+    netPinStart.clear();
+    pinPUId.clear();
+    pinOffsetX.clear();
+    pinOffsetY.clear();
+    netPinStart.reserve(placementNets.size() + 1);
+
+    netPinStart.push_back(0);
+    for (unsigned int netId = 0; netId < placementNets.size(); netId++)
+    {
+        auto curNet = placementNets[netId];
+        assert(curNet->getId() == (int)netId);
+        auto &unitsOfNetPins = curNet->getUnits();
+        auto &pinOffsetsInUnit = curNet->getPinOffsetsInUnit();
+        assert(unitsOfNetPins.size() == pinOffsetsInUnit.size());
+        for (unsigned int pinId_net = 0; pinId_net < unitsOfNetPins.size(); pinId_net++)
+        {
+            pinPUId.push_back(unitsOfNetPins[pinId_net]->getId());
+            pinOffsetX.push_back(pinOffsetsInUnit[pinId_net].x);
+            pinOffsetY.push_back(pinOffsetsInUnit[pinId_net].y);
+        }
+        netPinStart.push_back(pinPUId.size());
+    }
+
+    PUX.resize(placementUnits.size());
+    PUY.resize(placementUnits.size());
+    PUFixed.resize(placementUnits.size());
+    loadPULocations(placementUnits);
+}
+
+void PlacementInfo::PlacementNetPinStore::loadPULocations(std::vector<PlacementUnit *> &placementUnits)
+{
+    assert(PUX.size() == placementUnits.size());
+    int numPUs = placementUnits.size();
+#pragma omp parallel for
+    for (int PUId = 0; PUId < numPUs; PUId++)
+    {
+        auto curPU = placementUnits[PUId];
+        PUX[PUId] = curPU->X();
+        PUY[PUId] = curPU->Y();
+        PUFixed[PUId] = curPU->isFixed();
+    }
+}
+
 void PlacementInfo::updateLongPaths()
 {
     print_status("updating long paths and #PUsContainingFF=" + std::to_string(PUsContainingFF.size()));
@@ -642,6 +709,7 @@ void PlacementInfo::updateLongPaths()
 
     int restartNum = 1000000;
     int pathMexLen = 100;
+    RandomStream randomStream(RandomStream::getSeedFromConfig(JSONCfg), 0, RandomStream::StreamDomain_LongPathUpdate);
 
     for (int restartIter = 0; restartIter < restartNum; restartIter++)
     {
@@ -675,10 +743,10 @@ void PlacementInfo::updateLongPaths()
                 int tryCnt = 40;
                 while (tryCnt--)
                 {
-                    auto selectedNet = outputNets[random() % outputNets.size()];
+                    auto selectedNet = outputNets[randomStream.uniformInt(outputNets.size())];
 
-                    nextPU =
-                        selectedNet->getUnitsBeDriven()[random() * random() % selectedNet->getUnitsBeDriven().size()];
+                    nextPU = selectedNet->getUnitsBeDriven()[randomStream.uniformInt(
+                        selectedNet->getUnitsBeDriven().size())];
 
                     if (curPU == nextPU || !nextPU->hasLogic() || visitedPUs.find(nextPU) != visitedPUs.end())
                     {
@@ -886,9 +954,9 @@ std::ostream &operator<<(std::ostream &os, PlacementInfo::PlacementUnpackedCell
 
 std::ostream &operator<<(std::ostream &os, PlacementInfo::PlacementUnit *curPU)
 {
-    if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+    if (auto curMacro = PlacementInfo::asMacro(curPU))
         os << curMacro;
-    else if (auto curCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+    else if (auto curCell = PlacementInfo::asUnpackedCell(curPU))
         os << curCell;
     else
         assert(false && "placement unit type error.");
@@ -906,167 +974,183 @@ void PlacementInfo::resetElementBinGrid()
 void PlacementInfo::updateElementBinGrid()
 {
     resetElementBinGrid();
-    cellId2location.resize(designInfo->getNumCells());
-
-    for (auto curPU : placementUnits)
+    for (auto &tmpRow : globalBinGrid)
     {
-        if (auto curUnpackedCell = dynamic_cast<PlacementUnpackedCell *>(curPU))
+        for (auto &curBin : tmpRow)
         {
-            int binIdX, binIdY;
-            float cellX = curUnpackedCell->X();
-            float cellY = curUnpackedCell->Y();
-            DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
-            cellId2location[curCell->getCellId()].X = cellX;
-            cellId2location[curCell->getCellId()].Y = cellY;
-
-            getGridXY(cellX, cellY, binIdX, binIdY);
-
-            float num_cellOccupationBELs = getActualOccupation(curCell);
-            assert(num_cellOccupationBELs >= 0);
+            assert(curBin);
+            curBin->reset();
+        }
+    }
+    cellId2location.resize(designInfo->getNumCells());
 
-            bool nonOverflow = false;
-            for (int SharedBELID : getPotentialBELTypeIDs(curCell))
+    assert(globalBinGrid.size() > 0 && globalBinGrid[0].size() > 0);
+    int binNumY = globalBinGrid.size();
+    int binNumX = globalBinGrid[0].size();
+    int binNum = binNumX * binNumY;
+    int PUNum = placementUnits.size();
+
+    // flatten the cells of the PlacementUnits: the cells of the i-th PlacementUnit are in
+    // [PUId2FlatCellBegin[i], PUId2FlatCellBegin[i+1])
+    std::vector<int> PUId2FlatCellBegin(PUNum + 1, 0);
+#pragma omp parallel for
+    for (int PUId = 0; PUId < PUNum; PUId++)
+    {
+        PUId2FlatCellBegin[PUId + 1] = visitPlacementUnit(placementUnits[PUId], [](auto curPU) -> int {
+            if constexpr (std::is_same<decltype(curPU), PlacementMacro *>::value)
+                return curPU->getNumOfCells();
+            else
+                return 1;
+        });
+    }
+    for (int PUId = 0; PUId < PUNum; PUId++)
+        PUId2FlatCellBegin[PUId + 1] += PUId2FlatCellBegin[PUId];
+    int flatCellNum = PUId2FlatCellBegin[PUNum];
+
+    // pass 1: find the bin location and the occupation of each cell in parallel
+    std::vector<DesignInfo::DesignCell *> flatCells(flatCellNum);
+    std::vector<int> flatCellBinIds(flatCellNum);
+    std::vector<float> flatCellOccupations(flatCellNum);
+    auto locateCell = [&](int flatId, DesignInfo::DesignCell *curCell, float cellX, float cellY) {
+        cellId2location[curCell->getCellId()].X = cellX;
+        cellId2location[curCell->getCellId()].Y = cellY;
+
+        int binIdX, binIdY;
+        getGridXY(cellX, cellY, binIdX, binIdY);
+        assert(binIdY >= 0);
+        assert(binIdX >= 0);
+        assert(binIdY < binNumY);
+        assert(binIdX < binNumX);
+        if (!globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY))
+        {
+            std::cout << "cellX=" << cellX << "\n";
+            std::cout << "cellY=" << cellY << "\n";
+            std::cout << "left=" << globalBinGrid[binIdY][binIdX]->left() << "\n";
+            std::cout << "right=" << globalBinGrid[binIdY][binIdX]->right() << "\n";
+            std::cout << "top=" << globalBinGrid[binIdY][binIdX]->top() << "\n";
+            std::cout << "bottom=" << globalBinGrid[binIdY][binIdX]->bottom() << "\n";
+            std::cout.flush();
+        }
+        assert(globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY));
+
+        flatCells[flatId] = curCell;
+        flatCellBinIds[flatId] = binIdY * binNumX + binIdX;
+        flatCellOccupations[flatId] = getActualOccupation(curCell);
+        assert(flatCellOccupations[flatId] >= 0);
+    };
+
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int PUId = 0; PUId < PUNum; PUId++)
+    {
+        int flatId = PUId2FlatCellBegin[PUId];
+        // the kernel is instantiated for each kind of PlacementUnit, so there is no type check in the cell loop
+        visitPlacementUnit(placementUnits[PUId], [&](auto curPU) {
+            if constexpr (std::is_same<decltype(curPU), PlacementMacro *>::value)
             {
-                assert(binIdY >= 0);
-                assert(binIdX >= 0);
-                assert((unsigned int)binIdY < getBinGrid(SharedBELID).size());
-                assert((unsigned int)binIdX < getBinGrid(SharedBELID)[binIdY].size());
-                if (!getBinGrid(SharedBELID)[binIdY][binIdX]->inRange(cellX, cellY))
+                for (int vId = 0; vId < curPU->getNumOfCells(); vId++)
                 {
-                    std::cout << "cellX=" << cellX << "\n";
-                    std::cout << "cellY=" << cellY << "\n";
-                    std::cout << "left=" << getBinGrid(SharedBELID)[binIdY][binIdX]->left() << "\n";
-                    std::cout << "right=" << getBinGrid(SharedBELID)[binIdY][binIdX]->right() << "\n";
-                    std::cout << "top=" << getBinGrid(SharedBELID)[binIdY][binIdX]->top() << "\n";
-                    std::cout << "bottom=" << getBinGrid(SharedBELID)[binIdY][binIdX]->bottom() << "\n";
-                    std::cout.flush();
-                }
-                assert(getBinGrid(SharedBELID)[binIdY][binIdX]->inRange(cellX, cellY));
-                if (getBinGrid(SharedBELID)[binIdY][binIdX]->canAddMore(num_cellOccupationBELs))
-                {
-                    getBinGrid(SharedBELID)[binIdY][binIdX]->addCell(curCell, num_cellOccupationBELs);
-                    setCellBinInfo(curCell->getCellId(), SharedBELID, binIdX, binIdY, num_cellOccupationBELs);
-                    nonOverflow = true;
-                    break;
+                    float offsetX_InMacro, offsetY_InMacro;
+                    DesignInfo::DesignCellType cellType;
+                    curPU->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
+                    locateCell(flatId + vId, curPU->getCell(vId), curPU->X() + offsetX_InMacro,
+                               curPU->Y() + offsetY_InMacro);
                 }
             }
-            if (!nonOverflow)
+            else
             {
-                getBinGrid(getPotentialBELTypeIDs(curCell)[0])[binIdY][binIdX]->addCell(curCell,
-                                                                                        num_cellOccupationBELs);
-                setCellBinInfo(curCell->getCellId(), getPotentialBELTypeIDs(curCell)[0], binIdX, binIdY,
-                               num_cellOccupationBELs);
+                locateCell(flatId, curPU->getCell(), curPU->X(), curPU->Y());
             }
-        }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
-        {
-            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
-            {
-                float offsetX_InMacro, offsetY_InMacro;
-                DesignInfo::DesignCellType cellType;
-                curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-                DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-
-                int binIdX, binIdY;
-                float cellX = curMacro->X() + offsetX_InMacro;
-                float cellY = curMacro->Y() + offsetY_InMacro;
-
-                getGridXY(cellX, cellY, binIdX, binIdY);
-
-                float num_cellOccupationBELs = getActualOccupation(curCell);
-                assert(num_cellOccupationBELs >= 0);
-                bool nonOverflow = false;
-
-                cellId2location[curCell->getCellId()].X = cellX;
-                cellId2location[curCell->getCellId()].Y = cellY;
-
-                for (int SharedBELID : getPotentialBELTypeIDs(curCell))
-                {
-                    assert(binIdY >= 0);
-                    assert(binIdX >= 0);
-                    assert((unsigned int)binIdY < getBinGrid(SharedBELID).size());
-                    assert((unsigned int)binIdX < getBinGrid(SharedBELID)[binIdY].size());
-                    assert(getBinGrid(SharedBELID)[binIdY][binIdX]->inRange(cellX, cellY));
-                    if (getBinGrid(SharedBELID)[binIdY][binIdX]->canAddMore(num_cellOccupationBELs))
-                    {
-
-                        getBinGrid(SharedBELID)[binIdY][binIdX]->addCell(curCell, num_cellOccupationBELs);
-                        setCellBinInfo(curCell->getCellId(), SharedBELID, binIdX, binIdY, num_cellOccupationBELs);
-                        nonOverflow = true;
-                        break;
-                    }
-                }
-
-                if (!nonOverflow)
-                {
-                    getBinGrid(getPotentialBELTypeIDs(curCell)[0])[binIdY][binIdX]->addCell(curCell,
-                                                                                            num_cellOccupationBELs);
-                    setCellBinInfo(curCell->getCellId(), getPotentialBELTypeIDs(curCell)[0], binIdX, binIdY,
-                                   num_cellOccupationBELs);
-                }
-            }
-        }
+        });
     }
 
-    if (guiEnable)
+    // pass 2: group the cells by their bin locations with a stable counting sort, based on the prefix sums of the
+    // per-thread histograms over contiguous chunks of the flattened cells
+    int threadNum = omp_get_max_threads();
+    std::vector<std::vector<int>> threadBinOffsets(threadNum, std::vector<int>(binNum, 0));
+#pragma omp parallel for schedule(static, 1)
+    for (int threadId = 0; threadId < threadNum; threadId++)
     {
-        transferPaintData();
+        int flatBegin = (long long)flatCellNum * threadId / threadNum;
+        int flatEnd = (long long)flatCellNum * (threadId + 1) / threadNum;
+        std::vector<int> &binCnts = threadBinOffsets[threadId];
+        for (int flatId = flatBegin; flatId < flatEnd; flatId++)
+            binCnts[flatCellBinIds[flatId]]++;
     }
-
-    for (auto &tmpRow : globalBinGrid)
+    std::vector<int> binSortedBegin(binNum + 1, 0);
+    int sortedOffset = 0;
+    for (int binId = 0; binId < binNum; binId++)
     {
-        for (auto &curBin : tmpRow)
+        binSortedBegin[binId] = sortedOffset;
+        for (int threadId = 0; threadId < threadNum; threadId++)
         {
-            assert(curBin);
-            curBin->reset();
+            int binCnt = threadBinOffsets[threadId][binId];
+            threadBinOffsets[threadId][binId] = sortedOffset;
+            sortedOffset += binCnt;
         }
     }
+    binSortedBegin[binNum] = sortedOffset;
+    assert(sortedOffset == flatCellNum);
+    std::vector<int> binSortedFlatIds(flatCellNum);
+#pragma omp parallel for schedule(static, 1)
+    for (int threadId = 0; threadId < threadNum; threadId++)
+    {
+        int flatBegin = (long long)flatCellNum * threadId / threadNum;
+        int flatEnd = (long long)flatCellNum * (threadId + 1) / threadNum;
+        std::vector<int> &binOffsets = threadBinOffsets[threadId];
+        for (int flatId = flatBegin; flatId < flatEnd; flatId++)
+            binSortedFlatIds[binOffsets[flatCellBinIds[flatId]]++] = flatId;
+    }
 
-    for (auto curPU : placementUnits)
+    // pass 3: fill the bins location by location in parallel. The bins at a location are only accessed by one thread
+    // and the cells at a location are assigned in their original order.
+#pragma omp parallel for schedule(dynamic, 16)
+    for (int binId = 0; binId < binNum; binId++)
     {
-        if (auto curUnpackedCell = dynamic_cast<PlacementUnpackedCell *>(curPU))
+        if (binSortedBegin[binId] == binSortedBegin[binId + 1])
+            continue;
+        int binIdY = binId / binNumX;
+        int binIdX = binId % binNumX;
+        std::vector<PlacementBinInfo *> filledBins;
+        for (int sortedId = binSortedBegin[binId]; sortedId < binSortedBegin[binId + 1]; sortedId++)
         {
-            int binIdX, binIdY;
-            float cellX = curUnpackedCell->X();
-            float cellY = curUnpackedCell->Y();
-            DesignInfo::DesignCell *curCell = curUnpackedCell->getCell();
+            int flatId = binSortedFlatIds[sortedId];
+            DesignInfo::DesignCell *curCell = flatCells[flatId];
+            float num_cellOccupationBELs = flatCellOccupations[flatId];
 
-            if (curCell->isLUT() || curCell->isFF()) // currently we only resize LUT/FF
-            {
-                getGridXY(cellX, cellY, binIdX, binIdY);
-                assert(globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY));
-                assert(binIdY >= 0);
-                assert(binIdX >= 0);
-                assert((unsigned int)binIdY < globalBinGrid.size());
-                assert((unsigned int)binIdX < globalBinGrid[binIdY].size());
-                globalBinGrid[binIdY][binIdX]->addCell(curCell, 0);
-            }
-        }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
-        {
-            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
+            PlacementBinInfo *targetBin = nullptr;
+            int targetSharedBELID = -1;
+            for (int SharedBELID : getPotentialBELTypeIDs(curCell))
             {
-                float offsetX_InMacro, offsetY_InMacro;
-                DesignInfo::DesignCellType cellType;
-                curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
-                DesignInfo::DesignCell *curCell = curMacro->getCell(vId);
-                if (curCell->isLUT() || curCell->isFF()) // currently we only resize LUT/FF
+                assert((unsigned int)binIdY < getBinGrid(SharedBELID).size());
+                assert((unsigned int)binIdX < getBinGrid(SharedBELID)[binIdY].size());
+                if (getBinGrid(SharedBELID)[binIdY][binIdX]->canAddMore(num_cellOccupationBELs))
                 {
-                    int binIdX, binIdY;
-                    float cellX = curMacro->X() + offsetX_InMacro;
-                    float cellY = curMacro->Y() + offsetY_InMacro;
-
-                    getGridXY(cellX, cellY, binIdX, binIdY);
-                    assert(globalBinGrid[binIdY][binIdX]->inRange(cellX, cellY));
-
-                    assert(binIdY >= 0);
-                    assert(binIdX >= 0);
-                    assert((unsigned int)binIdY < globalBinGrid.size());
-                    assert((unsigned int)binIdX < globalBinGrid[binIdY].size());
-                    globalBinGrid[binIdY][binIdX]->addCell(curCell, 0);
+                    targetBin = getBinGrid(SharedBELID)[binIdY][binIdX];
+                    targetSharedBELID = SharedBELID;
+                    break;
                 }
             }
+            if (!targetBin) // overflow, put the cell into the bin of its first potential BEL type
+            {
+                targetSharedBELID = getPotentialBELTypeIDs(curCell)[0];
+                targetBin = getBinGrid(targetSharedBELID)[binIdY][binIdX];
+            }
+            targetBin->appendCellWithoutLock(curCell, num_cellOccupationBELs);
+            setCellBinInfo(curCell->getCellId(), targetSharedBELID, binIdX, binIdY, num_cellOccupationBELs);
+            if (std::find(filledBins.begin(), filledBins.end(), targetBin) == filledBins.end())
+                filledBins.push_back(targetBin);
+
+            if (curCell->isLUT() || curCell->isFF()) // currently we only resize LUT/FF
+                globalBinGrid[binIdY][binIdX]->appendCellWithoutLock(curCell, 0);
         }
+        for (auto filledBin : filledBins)
+            filledBin->sortCells();
+        globalBinGrid[binIdY][binIdX]->sortCells();
+    }
+
+    if (guiEnable)
+    {
+        transferPaintData();
     }
 }
 
@@ -1095,7 +1179,7 @@ void PlacementInfo::adjustLUTFFUtilization_Packablity(float neighborDisplacement
     // assign LUT/FF to bin grid to find their neighbors easily
     for (auto curPU : placementUnits)
     {
-        if (auto curUnpackedCell = dynamic_cast<PlacementUnpackedCell *>(curPU))
+        if (auto curUnpackedCell = asUnpackedCell(curPU))
         {
             int binIdX, binIdY;
             float cellX = curUnpackedCell->X();
@@ -1116,7 +1200,7 @@ void PlacementInfo::adjustLUTFFUtilization_Packablity(float neighborDisplacement
                 cellId2location[curCell->getCellId()].Y = cellY;
             }
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
             {
@@ -1689,6 +1773,9 @@ void PlacementInfo::updateCells2PlacementUnits()
         assert(cellId2PlacementUnit[i]);
         cellId2PlacementUnitVec[i] = cellId2PlacementUnit[i];
     }
+    PULegalXY.first.remapIds();
+    PULegalXY.second.remapIds();
+    PU2LegalSites.remapIds();
 
     macroRatio = (float)(cellInMacros.size()) / (float)designInfo->getNumCells();
 }
@@ -1748,7 +1835,6 @@ void PlacementInfo::dumpPlacementUnitInformation(std::string dumpFile)
     }
 }
 
-// TODO: implement a checkpoint mechanism here
 void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
 {
     print_status("loading PU coordinate archieve from: " + locFile);
@@ -1776,10 +1862,7 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
     unsigned int PUId, numCells, cellId;
     float X, Y;
 
-    for (auto tmpPU : placementUnits)
-    {
-        delete tmpPU;
-    }
+    destroyAllPlacementUnits();
 
     placementUnits.clear();
     fixedPlacementUnits.clear();
@@ -1850,12 +1933,12 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
                 macroType = PlacementMacro::PlacementMacroType_MUX7;
             else if (macroTypeStr == "PlacementMacroType_MUX8")
                 macroType = PlacementMacro::PlacementMacroType_MUX8;
-            if (macroTypeStr == "PlacementMacroType_LUTLUTSeires")
+            else if (macroTypeStr == "PlacementMacroType_LUTLUTSeires")
                 macroType = PlacementMacro::PlacementMacroType_LUTLUTSeires;
             else
                 assert(false && "undefined macro type.");
 
-            PlacementMacro *tmpPU = new PlacementMacro(PUName, PUId, macroType);
+            PlacementMacro *tmpPU = createPlacementMacro(PUName, PUId, macroType);
             placementUnits.push_back(tmpPU);
             placementMacros.push_back(tmpPU);
 
@@ -1940,7 +2023,7 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
             iss >> fill0 >> cellId >> fill1 >> cellName;
             assert(cellId < cellId2PlacementUnitVec.size());
             assert(getCells()[cellId]->getName() == cellName);
-            PlacementUnpackedCell *tmpPU = new PlacementUnpackedCell(PUName, PUId, getCells()[cellId]);
+            PlacementUnpackedCell *tmpPU = createPlacementUnpackedCell(PUName, PUId, getCells()[cellId]);
             tmpPU->setWeight(
                 getCompatiblePlacementTable()->cellType2sharedBELTypeOccupation[getCells()[cellId]->getCellType()]);
             placementUnits.push_back(tmpPU);
@@ -2016,6 +2099,437 @@ void PlacementInfo::loadPlacementUnitInformation(std::string locFile)
     reloadNets();
 }
 
+namespace
+{
+/**
+ * @brief the kind tag of the binary checkpoint files, which should be updated when the layout of the records changes
+ *
+ */
+const char checkpointKind[] = "AMFCKP01";
+
+enum CheckpointSection
+{
+    CheckpointSection_Header = 0,
+    CheckpointSection_PUs,
+    CheckpointSection_MacroCells,
+    CheckpointSection_FixedCells,
+    CheckpointSection_LegalInfo,
+    CheckpointSection_LegalSites,
+    CheckpointSection_ClockRegionCenters,
+    CheckpointSection_ClockRegionColumns,
+    CheckpointSection_CellOccupation,
+    CheckpointSection_CellInflateRatio,
+    CheckpointSection_PlacerStates,
+    CheckpointSection_Num
+};
+
+struct CheckpointHeaderRecord
+{
+    int32_t stageNameId;
+    int32_t cellNum;
+    float binWidth;
+    float binHeight;
+    float progress;
+    float minHPWL;
+    float oriPseudoNetWeight;
+    int32_t macroPseudoNetEnhanceCnt;
+    float macroLegalizationWeight;
+    float lastProgressWhenLUTFFUtilAdjust;
+    int32_t LUTFFUtilizationAdjusted;
+    int32_t clockLegalizationRisky;
+};
+
+/**
+ * @brief a PlacementUnit in the checkpoint. For a macro, its cells are macroCells[cellBegin, cellEnd) and its fixed
+ * cells are fixedCells[fixedCellBegin, fixedCellEnd). For an unpacked cell, macroType is -1 and cellId is its cell.
+ *
+ */
+struct CheckpointPURecord
+{
+    int32_t nameId;
+    int32_t macroType;
+    int32_t cellId;
+    int32_t cellBegin;
+    int32_t cellEnd;
+    int32_t fixedCellBegin;
+    int32_t fixedCellEnd;
+    int32_t fixedSiteNameId;
+    int32_t fixedBELNameId;
+    int32_t weight;
+    float X;
+    float Y;
+    uint8_t placed;
+    uint8_t fixed;
+    uint8_t locked;
+    uint8_t packed;
+};
+
+struct CheckpointMacroCellRecord
+{
+    int32_t cellId;
+    int32_t cellType;
+    float offsetX;
+    float offsetY;
+};
+
+struct CheckpointFixedCellRecord
+{
+    int32_t cellId;
+    int32_t siteNameId;
+    int32_t BELNameId;
+};
+
+/**
+ * @brief the legalization result of a PU. Its legal sites are legalSites[siteBegin, siteEnd).
+ *
+ */
+struct CheckpointLegalRecord
+{
+    int32_t PUId;
+    float X;
+    float Y;
+    int32_t siteBegin;
+    int32_t siteEnd;
+};
+
+struct CheckpointClockRegionCenterRecord
+{
+    int32_t PUId;
+    float X;
+    float Y;
+};
+
+struct CheckpointClockRegionColumnRecord
+{
+    int32_t PUId;
+    int32_t column;
+};
+
+struct CheckpointStateRecord
+{
+    int32_t nameId;
+    float value;
+};
+} // namespace
+
+bool PlacementInfo::dumpCheckpoint(std::string checkpointFile, std::string stageName,
+                                   const std::map<std::string, float> &placerStates)
+{
+    print_status("PlacementInfo: dumping checkpoint of stage [" + stageName + "] to: " + checkpointFile);
+
+    BinaryDBWriter writer;
+    std::vector<CheckpointHeaderRecord> headerRecords(1);
+    CheckpointHeaderRecord &header = headerRecords[0];
+    header.stageNameId = writer.internString(stageName);
+    header.cellNum = getCells().size();
+    header.binWidth = binWidth;
+    header.binHeight = binHeight;
+    header.progress = placementProressRatio;
+    header.minHPWL = minHPWL;
+    header.oriPseudoNetWeight = oriPseudoNetWeight;
+    header.macroPseudoNetEnhanceCnt = macroPseudoNetEnhanceCnt;
+    header.macroLegalizationWeight = macroLegalizationWeight;
+    header.lastProgressWhenLUTFFUtilAdjust = lastProgressWhenLUTFFUtilAdjust;
+    header.LUTFFUtilizationAdjusted = LUTFFUtilizationAdjusted;
+    header.clockLegalizationRisky = clockLegalizationRisky;
+
+    std::vector<CheckpointPURecord> PURecords;
+    std::vector<CheckpointMacroCellRecord> macroCellRecords;
+    std::vector<CheckpointFixedCellRecord> fixedCellRecords;
+    std::vector<CheckpointLegalRecord> legalRecords;
+    std::vector<int32_t> legalSiteNameIds;
+    std::vector<CheckpointClockRegionCenterRecord> clockRegionCenterRecords;
+    std::vector<CheckpointClockRegionColumnRecord> clockRegionColumnRecords;
+    PURecords.reserve(placementUnits.size());
+
+    for (unsigned int PUId = 0; PUId < placementUnits.size(); PUId++)
+    {
+        PlacementUnit *curPU = placementUnits[PUId];
+        assert(curPU->getId() == PUId && "PlacementUnit should be stored according to the PU id order.");
+        CheckpointPURecord PURecord;
+        PURecord.nameId = writer.internString(curPU->getName());
+        PURecord.macroType = -1;
+        PURecord.cellId = -1;
+        PURecord.cellBegin = PURecord.cellEnd = macroCellRecords.size();
+        PURecord.fixedCellBegin = PURecord.fixedCellEnd = fixedCellRecords.size();
+        PURecord.fixedSiteNameId = PURecord.fixedBELNameId = -1;
+        PURecord.weight = curPU->getWeight();
+        PURecord.X = curPU->X();
+        PURecord.Y = curPU->Y();
+        PURecord.placed = curPU->isPlaced();
+        PURecord.fixed = curPU->isFixed();
+        PURecord.locked = curPU->isLocked();
+        PURecord.packed = curPU->isPacked();
+
+        if (auto curMacro = asMacro(curPU))
+        {
+            PURecord.macroType = curMacro->getMacroType();
+            for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
+            {
+                CheckpointMacroCellRecord cellRecord;
+                float offsetX, offsetY;
+                DesignInfo::DesignCellType cellType;
+                curMacro->getVirtualCellInfo(vId, offsetX, offsetY, cellType);
+                cellRecord.cellId = curMacro->getCell(vId)->getCellId();
+                cellRecord.cellType = cellType;
+                cellRecord.offsetX = offsetX;
+                cellRecord.offsetY = offsetY;
+                macroCellRecords.push_back(cellRecord);
+            }
+            for (auto &fixedCellInfo : curMacro->getFixedCellInfoVec())
+            {
+                CheckpointFixedCellRecord fixedCellRecord;
+                fixedCellRecord.cellId = fixedCellInfo.cell->getCellId();
+                fixedCellRecord.siteNameId = writer.internString(fixedCellInfo.siteName);
+                fixedCellRecord.BELNameId = writer.internString(fixedCellInfo.BELName);
+                fixedCellRecords.push_back(fixedCellRecord);
+            }
+            PURecord.cellEnd = macroCellRecords.size();
+            PURecord.fixedCellEnd = fixedCellRecords.size();
+        }
+        else if (auto curUnpackedCell = asUnpackedCell(curPU))
+        {
+            PURecord.cellId = curUnpackedCell->getCell()->getCellId();
+            if (curUnpackedCell->getLockedSite())
+            {
+                PURecord.fixedSiteNameId = writer.internString(curUnpackedCell->getFixedSiteName());
+                PURecord.fixedBELNameId = writer.internString(curUnpackedCell->getFixedBELName());
+            }
+        }
+        PURecords.push_back(PURecord);
+
+        bool hasLegalXY = PULegalXY.first.count(curPU);
+        bool hasLegalSites = PU2LegalSites.count(curPU);
+        if (hasLegalXY || hasLegalSites)
+        {
+            CheckpointLegalRecord legalRecord;
+            legalRecord.PUId = PUId;
+            legalRecord.X = hasLegalXY ? PULegalXY.first.at(curPU) : curPU->X();
+            legalRecord.Y = hasLegalXY ? PULegalXY.second.at(curPU) : curPU->Y();
+            legalRecord.siteBegin = legalSiteNameIds.size();
+            if (hasLegalSites)
+            {
+                for (auto tmpSite : PU2LegalSites.at(curPU))
+                    legalSiteNameIds.push_back(writer.internString(tmpSite->getName()));
+            }
+            legalRecord.siteEnd = legalSiteNameIds.size();
+            legalRecords.push_back(legalRecord);
+        }
+
+        auto centerIt = PU2ClockRegionCenters.find(curPU);
+        if (centerIt != PU2ClockRegionCenters.end())
+            clockRegionCenterRecords.push_back({(int32_t)PUId, centerIt->second.first, centerIt->second.second});
+        auto columnIt = PU2ClockRegionColumn.find(curPU);
+        if (columnIt != PU2ClockRegionColumn.end())
+            clockRegionColumnRecords.push_back({(int32_t)PUId, columnIt->second});
+    }
+
+    std::vector<CheckpointStateRecord> stateRecords;
+    for (auto &state : placerStates)
+        stateRecords.push_back({writer.internString(state.first), state.second});
+
+    // the order of sections should be consistent with CheckpointSection
+    writer.addSection(headerRecords);
+    writer.addSection(PURecords);
+    writer.addSection(macroCellRecords);
+    writer.addSection(fixedCellRecords);
+    writer.addSection(legalRecords);
+    writer.addSection(legalSiteNameIds);
+    writer.addSection(clockRegionCenterRecords);
+    writer.addSection(clockRegionColumnRecords);
+    writer.addSection(compatiblePlacementTable->getcellId2Occupation());
+    writer.addSection(compatiblePlacementTable->getcellId2InfationRatio());
+    writer.addSection(stateRecords);
+
+    if (!writer.write(checkpointFile, checkpointKind,
+                      getFileSignature(JSONCfg["vivado extracted design information file"])))
+    {
+        print_warning("PlacementInfo: failed to dump checkpoint to: " + checkpointFile);
+        return false;
+    }
+    print_status("PlacementInfo: dumped checkpoint of stage [" + stageName + "] to: " + checkpointFile);
+    return true;
+}
+
+bool PlacementInfo::loadCheckpoint(std::string checkpointFile, std::string stageName,
+                                   std::map<std::string, float> &placerStates)
+{
+    print_status("PlacementInfo: loading checkpoint of stage [" + stageName + "] from: " + checkpointFile);
+
+    BinaryDB checkpoint;
+    if (!checkpoint.open(checkpointFile, checkpointKind,
+                         getFileSignature(JSONCfg["vivado extracted design information file"])) ||
+        checkpoint.getSectionNum() != CheckpointSection_Num)
+    {
+        print_warning("PlacementInfo: checkpoint " + checkpointFile +
+                      " does not exist or does not match the design and the placer version.");
+        return false;
+    }
+
+    size_t headerNum, PUNum, macroCellNum, fixedCellNum, legalNum, legalSiteNum, centerNum, columnNum, occupationNum,
+        inflateRatioNum, stateNum;
+    const CheckpointHeaderRecord *header =
+        checkpoint.getSection<CheckpointHeaderRecord>(CheckpointSection_Header, headerNum);
+    auto PURecords = checkpoint.getSection<CheckpointPURecord>(CheckpointSection_PUs, PUNum);
+    auto macroCellRecords =
+        checkpoint.getSection<CheckpointMacroCellRecord>(CheckpointSection_MacroCells, macroCellNum);
+    auto fixedCellRecords =
+        checkpoint.getSection<CheckpointFixedCellRecord>(CheckpointSection_FixedCells, fixedCellNum);
+    auto legalRecords = checkpoint.getSection<CheckpointLegalRecord>(CheckpointSection_LegalInfo, legalNum);
+    auto legalSiteNameIds = checkpoint.getSection<int32_t>(CheckpointSection_LegalSites, legalSiteNum);
+    auto centerRecords =
+        checkpoint.getSection<CheckpointClockRegionCenterRecord>(CheckpointSection_ClockRegionCenters, centerNum);
+    auto columnRecords =
+        checkpoint.getSection<CheckpointClockRegionColumnRecord>(CheckpointSection_ClockRegionColumns, columnNum);
+    auto cellOccupation = checkpoint.getSection<float>(CheckpointSection_CellOccupation, occupationNum);
+    auto cellInflateRatio = checkpoint.getSection<float>(CheckpointSection_CellInflateRatio, inflateRatioNum);
+    auto stateRecords = checkpoint.getSection<CheckpointStateRecord>(CheckpointSection_PlacerStates, stateNum);
+
+    if (headerNum != 1 || checkpoint.getString(header->stageNameId) != stageName ||
+        header->cellNum != (int)getCells().size() ||
+        occupationNum != compatiblePlacementTable->getcellId2Occupation().size() ||
+        inflateRatioNum != compatiblePlacementTable->getcellId2InfationRatio().size())
+    {
+        print_warning("PlacementInfo: checkpoint " + checkpointFile +
+                      " is not dumped after the stage or not compatible with the current initial packing.");
+        return false;
+    }
+
+    destroyAllPlacementUnits();
+    placementUnits.clear();
+    fixedPlacementUnits.clear();
+    placementMacros.clear();
+    cellInMacros.clear();
+    placementUnpackedCells.clear();
+    cellId2PlacementUnit.clear();
+    PU2LegalSites.clear();
+    PULegalXY.first.clear();
+    PULegalXY.second.clear();
+    PU2ClockRegionCenters.clear();
+    PU2ClockRegionColumn.clear();
+
+    placementUnits.reserve(PUNum);
+    for (unsigned int PUId = 0; PUId < PUNum; PUId++)
+    {
+        const CheckpointPURecord &PURecord = PURecords[PUId];
+        std::string PUName = checkpoint.getString(PURecord.nameId);
+        PlacementUnit *curPU = nullptr;
+        if (PURecord.macroType >= 0)
+        {
+            PlacementMacro *tmpMacro = createPlacementMacro(
+                PUName, PUId, static_cast<PlacementMacro::PlacementMacroType>(PURecord.macroType));
+            for (int recordId = PURecord.cellBegin; recordId < PURecord.cellEnd; recordId++)
+            {
+                const CheckpointMacroCellRecord &cellRecord = macroCellRecords[recordId];
+                DesignInfo::DesignCell *curCell = getCells()[cellRecord.cellId];
+                tmpMacro->addCell(curCell, static_cast<DesignInfo::DesignCellType>(cellRecord.cellType),
+                                  cellRecord.offsetX, cellRecord.offsetY);
+                cellId2PlacementUnit[cellRecord.cellId] = tmpMacro;
+                cellInMacros.insert(curCell);
+            }
+            for (int recordId = PURecord.fixedCellBegin; recordId < PURecord.fixedCellEnd; recordId++)
+            {
+                const CheckpointFixedCellRecord &fixedCellRecord = fixedCellRecords[recordId];
+                tmpMacro->addFixedCellInfo(getCells()[fixedCellRecord.cellId],
+                                           checkpoint.getString(fixedCellRecord.siteNameId),
+                                           checkpoint.getString(fixedCellRecord.BELNameId));
+            }
+            tmpMacro->setAnchorLocationAndForgetTheOriginalOne(PURecord.X, PURecord.Y);
+            if (PURecord.placed)
+                tmpMacro->setPlaced();
+            if (PURecord.fixed)
+                tmpMacro->setFixed();
+            placementMacros.push_back(tmpMacro);
+            curPU = tmpMacro;
+        }
+        else
+        {
+            assert(PURecord.cellId >= 0 && PURecord.cellId < (int)getCells().size());
+            PlacementUnpackedCell *tmpUnpackedCell =
+                createPlacementUnpackedCell(PUName, PUId, getCells()[PURecord.cellId]);
+            if (PURecord.fixedSiteNameId >= 0)
+            {
+                std::string siteName = checkpoint.getString(PURecord.fixedSiteNameId);
+                std::string BELName = checkpoint.getString(PURecord.fixedBELNameId);
+                // cannot set locked before the location is restored
+                tmpUnpackedCell->setLockedAt(siteName, BELName, deviceInfo, false);
+            }
+            tmpUnpackedCell->setAnchorLocationAndForgetTheOriginalOne(PURecord.X, PURecord.Y);
+            if (PURecord.placed)
+                tmpUnpackedCell->setPlaced();
+            if (PURecord.fixed)
+                tmpUnpackedCell->setFixed();
+            else if (tmpUnpackedCell->isFixed())
+                tmpUnpackedCell->setUnfixed();
+            cellId2PlacementUnit[PURecord.cellId] = tmpUnpackedCell;
+            placementUnpackedCells.push_back(tmpUnpackedCell);
+            curPU = tmpUnpackedCell;
+        }
+        curPU->setWeight(PURecord.weight);
+        if (PURecord.fixed)
+            fixedPlacementUnits.push_back(curPU);
+        if (PURecord.locked)
+            curPU->setLocked();
+        if (PURecord.packed)
+            curPU->setPacked();
+        placementUnits.push_back(curPU);
+    }
+    updateCells2PlacementUnits();
+
+    // the sites of the legalized PUs are mapped so later packing or legalization will bypass them
+    deviceInfo->resetAllSiteMapping();
+    for (unsigned int recordId = 0; recordId < legalNum; recordId++)
+    {
+        const CheckpointLegalRecord &legalRecord = legalRecords[recordId];
+        assert((size_t)legalRecord.PUId < placementUnits.size());
+        PlacementUnit *curPU = placementUnits[legalRecord.PUId];
+        PULegalXY.first[curPU] = legalRecord.X;
+        PULegalXY.second[curPU] = legalRecord.Y;
+        if (legalRecord.siteEnd > legalRecord.siteBegin)
+        {
+            std::vector<DeviceInfo::DeviceSite *> &legalSites = PU2LegalSites[curPU];
+            for (int siteRecordId = legalRecord.siteBegin; siteRecordId < legalRecord.siteEnd; siteRecordId++)
+            {
+                std::string siteName = checkpoint.getString(legalSiteNameIds[siteRecordId]);
+                DeviceInfo::DeviceSite *tmpSite = deviceInfo->getSiteWithName(siteName);
+                tmpSite->setMapped();
+                legalSites.push_back(tmpSite);
+            }
+        }
+    }
+    for (unsigned int recordId = 0; recordId < centerNum; recordId++)
+        PU2ClockRegionCenters[placementUnits[centerRecords[recordId].PUId]] =
+            std::pair<float, float>(centerRecords[recordId].X, centerRecords[recordId].Y);
+    for (unsigned int recordId = 0; recordId < columnNum; recordId++)
+        PU2ClockRegionColumn[placementUnits[columnRecords[recordId].PUId]] = columnRecords[recordId].column;
+
+    std::copy(cellOccupation, cellOccupation + occupationNum, compatiblePlacementTable->getcellId2Occupation().begin());
+    std::copy(cellInflateRatio, cellInflateRatio + inflateRatioNum,
+              compatiblePlacementTable->getcellId2InfationRatio().begin());
+
+    placementProressRatio = header->progress;
+    minHPWL = header->minHPWL;
+    oriPseudoNetWeight = header->oriPseudoNetWeight;
+    macroPseudoNetEnhanceCnt = header->macroPseudoNetEnhanceCnt;
+    macroLegalizationWeight = header->macroLegalizationWeight;
+    lastProgressWhenLUTFFUtilAdjust = header->lastProgressWhenLUTFFUtilAdjust;
+    LUTFFUtilizationAdjusted = header->LUTFFUtilizationAdjusted;
+    clockLegalizationRisky = header->clockLegalizationRisky;
+
+    placerStates.clear();
+    for (unsigned int recordId = 0; recordId < stateNum; recordId++)
+        placerStates[checkpoint.getString(stateRecords[recordId].nameId)] = stateRecords[recordId].value;
+
+    if (binWidth != header->binWidth || binHeight != header->binHeight)
+        createGridBins(header->binWidth, header->binHeight);
+    updateElementBinGrid();
+    reloadNets();
+
+    print_status("PlacementInfo: loaded checkpoint of stage [" + stageName + "] with #PU=" +
+                 std::to_string(placementUnits.size()));
+    return true;
+}
+
 void PlacementInfo::enhanceHighFanoutNet()
 {
     for (auto curPNet : placementNets)
@@ -2282,11 +2796,11 @@ void PlacementInfo::transferPaintData()
                     break;
                 }
                 auto PU = getPlacementUnitByCellId(cellId);
-                if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(PU))
+                if (auto unpackedCell = PlacementInfo::asUnpackedCell(PU))
                 {
                     isCovered[unpackedCell->getCell()->getCellId()]++;
                 }
-                else if (auto macro = dynamic_cast<PlacementInfo::PlacementMacro *>(PU))
+                else if (auto macro = PlacementInfo::asMacro(PU))
                 {
                     for (auto cell : macro->getCells())
                     {
@@ -32,6 +32,9 @@
 #include "PlacementTimingInfo.h"
 #include "Rendering/paintDB.h"
 #include "dumpZip.h"
+#include "idIndexedMap.h"
+#include "objectArena.h"
+#include <algorithm>
 #include <assert.h>
 #include <fstream>
 #include <iostream>
@@ -42,6 +45,7 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 /**
@@ -74,6 +78,7 @@ class PlacementInfo
     class PlacementBinInfo;
     class CompatiblePlacementTable;
     class PlacementNet;
+    class PlacementNetPinStore;
 
     /**
      * @brief describes the type mapping from design to device, where a cell can be placed (which BEL in which site)
@@ -460,7 +465,7 @@ class PlacementInfo
          * @brief add a design cell into the bin
          *
          * we have to set the mutex locked during the process since we enable multi-threading
-         * in the placer.
+         * in the placer. The cells in the bin are kept sorted by their ids.
          *
          * @param cell
          * @param occupationAdded how many slots will the cell occupy
@@ -469,13 +474,41 @@ class PlacementInfo
         inline void addCell(DesignInfo::DesignCell *cell, int occupationAdded)
         {
             mtx.lock();
-            assert(cells.find(cell) == cells.end());
-            cells.insert(cell);
+            auto insertPos = findCellPos(cell);
+            assert(insertPos == cells.end() || *insertPos != cell);
+            cells.insert(insertPos, cell);
             assert(occupationAdded >= 0);
             utilization += occupationAdded;
             mtx.unlock();
         }
 
+        /**
+         * @brief append a design cell to the bin without locking the mutex or keeping the cells sorted
+         *
+         * It is only used when a single thread is filling the bin, e.g., in the parallel rebuild of the bin grid, and
+         * sortCells() should be called after the bin is filled.
+         *
+         * @param cell
+         * @param occupationAdded how many slots will the cell occupy
+         */
+        inline void appendCellWithoutLock(DesignInfo::DesignCell *cell, int occupationAdded)
+        {
+            cells.push_back(cell);
+            assert(occupationAdded >= 0);
+            utilization += occupationAdded;
+        }
+
+        /**
+         * @brief sort the cells in the bin by their ids after they are appended by appendCellWithoutLock()
+         *
+         */
+        inline void sortCells()
+        {
+            std::sort(cells.begin(), cells.end(), [](DesignInfo::DesignCell *a, DesignInfo::DesignCell *b) -> bool {
+                return a->getCellId() < b->getCellId();
+            });
+        }
+
         /**
          * @brief remove a design cell from the bin
          *
@@ -489,8 +522,9 @@ class PlacementInfo
         {
             // if (cell)
             mtx.lock();
-            assert(cells.find(cell) != cells.end());
-            cells.erase(cell);
+            auto cellPos = findCellPos(cell);
+            assert(cellPos != cells.end() && *cellPos == cell);
+            cells.erase(cellPos);
             utilization -= occupationAdded;
             assert(utilization >= 0);
             mtx.unlock();
@@ -499,7 +533,8 @@ class PlacementInfo
         inline bool contains(DesignInfo::DesignCell *cell)
         {
             // if (cell)
-            return cells.find(cell) != cells.end();
+            auto cellPos = findCellPos(cell);
+            return cellPos != cells.end() && *cellPos == cell;
         }
 
         inline void reset()
@@ -556,11 +591,11 @@ class PlacementInfo
         }
 
         /**
-         * @brief Get the reference of the set of cells in the bin
+         * @brief Get the reference of the cells in the bin, which are sorted by their ids
          *
-         * @return std::set<DesignInfo::DesignCell *>&
+         * @return std::vector<DesignInfo::DesignCell *>&
          */
-        inline std::set<DesignInfo::DesignCell *> &getCells()
+        inline std::vector<DesignInfo::DesignCell *> &getCells()
         {
             return cells;
         }
@@ -821,10 +856,29 @@ class PlacementInfo
         }
 
       private:
+        /**
+         * @brief find the first cell in the bin whose id is not smaller than the id of the given cell
+         *
+         * @param cell
+         * @return std::vector<DesignInfo::DesignCell *>::iterator
+         */
+        inline std::vector<DesignInfo::DesignCell *>::iterator findCellPos(DesignInfo::DesignCell *cell)
+        {
+            return std::lower_bound(cells.begin(), cells.end(), cell,
+                                    [](DesignInfo::DesignCell *a, DesignInfo::DesignCell *b) -> bool {
+                                        return a->getCellId() < b->getCellId();
+                                    });
+        }
+
         std::string sharedCellType;
         std::vector<DeviceInfo::DeviceSite *> correspondingSites;
         CompatiblePlacementTable *compatiblePlacementTable;
-        std::set<DesignInfo::DesignCell *> cells;
+
+        /**
+         * @brief the cells in the bin, sorted by their ids so the iteration order is deterministic
+         *
+         */
+        std::vector<DesignInfo::DesignCell *> cells;
 
         int capacity = 0;
         int utilization = 0;
@@ -1635,7 +1689,7 @@ class PlacementInfo
                                                       DesignInfo::DesignCellType cellType, float x, float y)
         {
             DesignInfo::DesignCell *vCell =
-                new DesignInfo::DesignCell(true, virtualCellName, cellType, designInfo->getNumCells());
+                designInfo->createCell(true, virtualCellName, cellType, designInfo->getNumCells());
             designInfo->addCell(vCell); // add the virtual cell to design info for later processing
             cells_Type.push_back(cellType);
             cellsInMacro.push_back(vCell);
@@ -1684,7 +1738,7 @@ class PlacementInfo
          */
         inline void addVirtualCell(DesignInfo *designInfo, DesignInfo::DesignCellType cellType, float x, float y)
         {
-            DesignInfo::DesignCell *vCell = new DesignInfo::DesignCell(true, cellType, designInfo->getNumCells());
+            DesignInfo::DesignCell *vCell = designInfo->createCell(true, cellType, designInfo->getNumCells());
             designInfo->addCell(vCell); // add the virtual cell to design info for later processing
             cells_Type.push_back(cellType);
             cellsInMacro.push_back(vCell);
@@ -1864,6 +1918,179 @@ class PlacementInfo
         PlacementMacroType macroType;
     };
 
+    /**
+     * @brief cast a PlacementUnit to PlacementUnpackedCell according to its type tag, which avoids the RTTI lookup of
+     * dynamic_cast
+     *
+     * @param curPU
+     * @return PlacementUnpackedCell* nullptr if curPU is not a PlacementUnpackedCell
+     */
+    static inline PlacementUnpackedCell *asUnpackedCell(PlacementUnit *curPU)
+    {
+        if (curPU && curPU->getType() == PlacementUnitType_UnpackedCell)
+            return static_cast<PlacementUnpackedCell *>(curPU);
+        return nullptr;
+    }
+
+    /**
+     * @brief cast a PlacementUnit to PlacementMacro according to its type tag, which avoids the RTTI lookup of
+     * dynamic_cast
+     *
+     * @param curPU
+     * @return PlacementMacro* nullptr if curPU is not a PlacementMacro
+     */
+    static inline PlacementMacro *asMacro(PlacementUnit *curPU)
+    {
+        if (curPU && curPU->getType() == PlacementUnitType_Macro)
+            return static_cast<PlacementMacro *>(curPU);
+        return nullptr;
+    }
+
+    /**
+     * @brief call a visitor with the PlacementUnit cast to its actual type according to its type tag
+     *
+     * A generic visitor, e.g., a lambda with an auto parameter, is instantiated for PlacementUnpackedCell and
+     * PlacementMacro separately, so the code for each kind of PlacementUnit is specialized at compile time.
+     *
+     * @tparam Visitor
+     * @param curPU
+     * @param visitor
+     * @return decltype(auto) the return value of the visitor
+     */
+    template <typename Visitor> static inline decltype(auto) visitPlacementUnit(PlacementUnit *curPU, Visitor &&visitor)
+    {
+        assert(curPU);
+        if (curPU->getType() == PlacementUnitType_UnpackedCell)
+            return visitor(static_cast<PlacementUnpackedCell *>(curPU));
+        assert(curPU->getType() == PlacementUnitType_Macro);
+        return visitor(static_cast<PlacementMacro *>(curPU));
+    }
+
+    /**
+     * @brief a flat, structure-of-arrays view of the pins of all the PlacementNets
+     *
+     * The pins of the net with id i occupy the range [netPinStart[i], netPinStart[i+1]) of the pin arrays, in the same
+     * order as PlacementNet::getUnits(). Each pin records the id of its PlacementUnit and its offset in the unit. The
+     * locations and fixed flags of the PlacementUnits are kept in contiguous arrays indexed by PlacementUnit id, so
+     * the wirelength evaluation loops stream through memory instead of dereferencing a PlacementUnit per pin.
+     *
+     * The net/pin arrays are rebuilt when PlacementNets are reloaded while the PlacementUnit arrays should be
+     * refreshed by loadPULocations() before each evaluation since PlacementUnits move between evaluations.
+     */
+    class PlacementNetPinStore
+    {
+      public:
+        PlacementNetPinStore()
+        {
+        }
+        ~PlacementNetPinStore()
+        {
+        }
+
+        /**
+         * @brief rebuild the net/pin arrays according to the given PlacementNets
+         *
+         * @param placementNets the PlacementNets, where placementNets[i]->getId() == i
+         * @param placementUnits the PlacementUnits, where placementUnits[i]->getId() == i
+         */
+        void build(std::vector<PlacementNet *> &placementNets, std::vector<PlacementUnit *> &placementUnits);
+
+        /**
+         * @brief load the current locations and fixed flags of the PlacementUnits into the contiguous arrays
+         *
+         * @param placementUnits the PlacementUnits, where placementUnits[i]->getId() == i
+         */
+        void loadPULocations(std::vector<PlacementUnit *> &placementUnits);
+
+        /**
+         * @brief check whether the store is built for the given amounts of nets and PlacementUnits
+         *
+         * @param numNets
+         * @param numPUs
+         * @return true if the store can be used for these nets and PlacementUnits
+         */
+        inline bool isBuiltFor(unsigned int numNets, unsigned int numPUs) const
+        {
+            return netPinStart.size() == numNets + 1 && PUX.size() == numPUs;
+        }
+
+        inline int getPinBegin(int netId) const
+        {
+            return netPinStart[netId];
+        }
+
+        inline int getPinEnd(int netId) const
+        {
+            return netPinStart[netId + 1];
+        }
+
+        inline int getPinPUId(int pinId) const
+        {
+            return pinPUId[pinId];
+        }
+
+        inline float getPinOffsetX(int pinId) const
+        {
+            return pinOffsetX[pinId];
+        }
+
+        inline float getPinOffsetY(int pinId) const
+        {
+            return pinOffsetY[pinId];
+        }
+
+        inline float getPUX(int PUId) const
+        {
+            return PUX[PUId];
+        }
+
+        inline float getPUY(int PUId) const
+        {
+            return PUY[PUId];
+        }
+
+        inline bool isPUFixed(int PUId) const
+        {
+            return PUFixed[PUId];
+        }
+
+        /**
+         * @brief get the HPWL of a net according to the PlacementUnit locations loaded in the store
+         *
+         * The bounding box cached in the PlacementNet object is not touched.
+         *
+         * @param netId
+         * @param y2xRatio a factor to tune the weights of the net spanning in Y-coordinate relative to the net
+         * spanning in X-coordinate
+         * @return float
+         */
+        inline float getNetHPWL(int netId, float y2xRatio) const
+        {
+            float leftX = 1e5, rightX = -1e5, bottomY = 1e5, topY = -1e5;
+            const int pinEnd = netPinStart[netId + 1];
+            for (int pinId = netPinStart[netId]; pinId < pinEnd; pinId++)
+            {
+                const int PUId = pinPUId[pinId];
+                const float pinX = PUX[PUId] + pinOffsetX[pinId];
+                const float pinY = PUY[PUId] + pinOffsetY[pinId];
+                leftX = std::min(leftX, pinX);
+                rightX = std::max(rightX, pinX);
+                bottomY = std::min(bottomY, pinY);
+                topY = std::max(topY, pinY);
+            }
+            return std::fabs(rightX - leftX) + y2xRatio * std::fabs(topY - bottomY);
+        }
+
+      private:
+        std::vector<int> netPinStart;
+        std::vector<int> pinPUId;
+        std::vector<float> pinOffsetX;
+        std::vector<float> pinOffsetY;
+        std::vector<float> PUX;
+        std::vector<float> PUY;
+        std::vector<unsigned char> PUFixed;
+    };
+
     /**
      * @brief Placement net, compared to design net, includes information related to placement.
      *
@@ -1913,7 +2140,7 @@ class PlacementInfo
                 }
                 else if (tmpPU->getType() == PlacementUnitType_Macro)
                 {
-                    PlacementMacro *tmpM = dynamic_cast<PlacementMacro *>(tmpPU);
+                    PlacementMacro *tmpM = asMacro(tmpPU);
                     assert(tmpM);
                     pinOffset tmpPinOffset =
                         pinOffset(curPin->getOffsetXInCell() + tmpM->getCellOffsetXInMacro(curPin->getCell()),
@@ -2066,6 +2293,79 @@ class PlacementInfo
             return (updateX && (leftPuId != rightPuId)) || (updateY && (topPuId != bottomPuId));
         }
 
+        /**
+         * @brief update the bounding box of the net according to the flat pin store
+         *
+         * It is equivalent to updateNetBounds(updateX, updateY) but reads the pin offsets and the PlacementUnit
+         * locations from the contiguous arrays in the store, which should be loaded before the call.
+         *
+         * @param pinStore the flat pin store built for the current PlacementNets
+         * @param updateX if true, update the bounding box of the net in X coordinate
+         * @param updateY if true, update the bounding box of the net in Y coordinate
+         * @return true if the pins of the net is not at the same location
+         * @return false if all pins of the net is at the same location
+         */
+        inline bool updateNetBounds(const PlacementNetPinStore &pinStore, bool updateX, bool updateY)
+        {
+            const int pinBegin = pinStore.getPinBegin(id);
+            const int pinEnd = pinStore.getPinEnd(id);
+            if (updateX)
+            {
+                leftPUX = 1e5;
+                rightPUX = -1e5;
+                leftPinX = 1e5;
+                rightPinX = -1e5;
+                for (int pinId = pinBegin; pinId < pinEnd; pinId++)
+                {
+                    const int tmpPUId = pinStore.getPinPUId(pinId);
+                    const float cellX = pinStore.getPUX(tmpPUId);
+                    const float pinX = cellX + pinStore.getPinOffsetX(pinId);
+                    if (pinX < leftPinX)
+                    {
+                        leftPinX = pinX;
+                        leftPUX = cellX;
+                        leftPuId = tmpPUId;
+                        leftPinId_net = pinId - pinBegin;
+                    }
+                    if (pinX > rightPinX)
+                    {
+                        rightPinX = pinX;
+                        rightPUX = cellX;
+                        rightPuId = tmpPUId;
+                        rightPinId_net = pinId - pinBegin;
+                    }
+                }
+            }
+            if (updateY)
+            {
+                topPUY = -1e5;
+                bottomPUY = 1e5;
+                topPinY = -1e5;
+                bottomPinY = 1e5;
+                for (int pinId = pinBegin; pinId < pinEnd; pinId++)
+                {
+                    const int tmpPUId = pinStore.getPinPUId(pinId);
+                    const float cellY = pinStore.getPUY(tmpPUId);
+                    const float pinY = cellY + pinStore.getPinOffsetY(pinId);
+                    if (pinY < bottomPinY)
+                    {
+                        bottomPinY = pinY;
+                        bottomPUY = cellY;
+                        bottomPuId = tmpPUId;
+                        bottomPinId_net = pinId - pinBegin;
+                    }
+                    if (pinY > topPinY)
+                    {
+                        topPinY = pinY;
+                        topPUY = cellY;
+                        topPuId = tmpPUId;
+                        topPinId_net = pinId - pinBegin;
+                    }
+                }
+            }
+            return (updateX && (leftPuId != rightPuId)) || (updateY && (topPuId != bottomPuId));
+        }
+
         /**
          * @brief get current HPWL of the net
          *
@@ -2169,6 +2469,8 @@ class PlacementInfo
          * In the quadratic placement, the wirelength(HPWL) can be modeled into a quadratic equation based on
          * Bound2Bound net model. The equation can be represented by matrix operation (XQX^T+PX)
          *
+         * @param pinStore the flat pin store, from which the locations of the pins are read. The bounding box should be
+         * updated by updateNetBounds(pinStore, ...) in advance.
          * @param objectiveMatrixTripletList The non-Diag elements in matrix Q, stored in the vector of Eigen Triplet
          * (i,j,val)
          * @param objectiveMatrixDiag The Diag elements in matrix Q, stored in a 1-D vector
@@ -2181,7 +2483,8 @@ class PlacementInfo
          * @param updateX update the X-coordinate term in the quadratic problem
          * @param updateY update the X-coordinate term in the quadratic problem
          */
-        inline void updateBound2BoundNetWeight(std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList,
+        inline void updateBound2BoundNetWeight(const PlacementNetPinStore &pinStore,
+                                               std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList,
                                                std::vector<float> &objectiveMatrixDiag,
                                                Eigen::VectorXd &objectiveVector, float generalWeight, float y2xRatio,
                                                bool updateX, bool updateY, bool checkClockRegion = false)
@@ -2220,6 +2523,8 @@ class PlacementInfo
             std::pair<int, int> B_ClockLocYX(B_cellClockRegionY, B_cellClockRegionX);
 
             float clockRegionW = 0;
+            const int pinBegin = pinStore.getPinBegin(id);
+            const int pinEnd = pinStore.getPinEnd(id);
 
             w *= designNet->getOverallEnhanceRatio();
             if (updateX)
@@ -2236,30 +2541,32 @@ class PlacementInfo
                 // add net between left node and right node
                 addB2BNet(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector, leftPuId, rightPuId,
                           leftPUX, rightPUX, pinOffsetsInUnit[leftPinId_net].x, pinOffsetsInUnit[rightPinId_net].x,
-                          !unitsOfNetPins[leftPinId_net]->isFixed(), !unitsOfNetPins[rightPinId_net]->isFixed(),
+                          !pinStore.isPUFixed(leftPuId), !pinStore.isPUFixed(rightPuId),
                           designNet->getPinPairEnhanceRatio(leftPinId_net, rightPinId_net) * w /
                               std::max(minDist, rightPinX - leftPinX));
 
                 // add net between internal node and left/right node
-                for (unsigned int pinId_net = 0; pinId_net < unitsOfNetPins.size(); pinId_net++)
+                const bool leftMovable = !pinStore.isPUFixed(leftPuId);
+                const bool rightMovable = !pinStore.isPUFixed(rightPuId);
+                for (int pinId = pinBegin; pinId < pinEnd; pinId++)
                 {
-                    auto tmpPU = unitsOfNetPins[pinId_net];
-                    auto tmpPUId = tmpPU->getId();
-                    auto tmpPinOffset = pinOffsetsInUnit[pinId_net];
-                    float curX = tmpPU->X();
-                    bool movable = !tmpPU->isFixed();
+                    unsigned int pinId_net = pinId - pinBegin;
+                    int tmpPUId = pinStore.getPinPUId(pinId);
+                    float tmpPinOffsetX = pinStore.getPinOffsetX(pinId);
+                    float curX = pinStore.getPUX(tmpPUId);
+                    bool movable = !pinStore.isPUFixed(tmpPUId);
                     if (pinId_net != leftPinId_net && pinId_net != rightPinId_net)
                     {
                         addB2BNet(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector, tmpPUId, leftPuId,
-                                  curX, leftPUX, tmpPinOffset.x, pinOffsetsInUnit[leftPinId_net].x, movable,
-                                  !unitsOfNetPins[leftPinId_net]->isFixed(),
+                                  curX, leftPUX, tmpPinOffsetX, pinOffsetsInUnit[leftPinId_net].x, movable,
+                                  leftMovable,
                                   designNet->getPinPairEnhanceRatio(pinId_net, leftPinId_net) * w /
-                                      std::max(minDist, (curX + tmpPinOffset.x) - leftPinX));
+                                      std::max(minDist, (curX + tmpPinOffsetX) - leftPinX));
                         addB2BNet(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector, tmpPUId, rightPuId,
-                                  curX, rightPUX, tmpPinOffset.x, pinOffsetsInUnit[rightPinId_net].x, movable,
-                                  !unitsOfNetPins[rightPinId_net]->isFixed(),
+                                  curX, rightPUX, tmpPinOffsetX, pinOffsetsInUnit[rightPinId_net].x, movable,
+                                  rightMovable,
                                   designNet->getPinPairEnhanceRatio(pinId_net, rightPinId_net) * w /
-                                      std::max(minDist, rightPinX - (curX + tmpPinOffset.x)));
+                                      std::max(minDist, rightPinX - (curX + tmpPinOffsetX)));
                     }
                 }
             }
@@ -2271,30 +2578,32 @@ class PlacementInfo
                 // add net between top node and bottom node
                 addB2BNet(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector, bottomPuId, topPuId,
                           bottomPUY, topPUY, pinOffsetsInUnit[bottomPinId_net].y, pinOffsetsInUnit[topPinId_net].y,
-                          !unitsOfNetPins[bottomPinId_net]->isFixed(), !unitsOfNetPins[topPinId_net]->isFixed(),
+                          !pinStore.isPUFixed(bottomPuId), !pinStore.isPUFixed(topPuId),
                           designNet->getPinPairEnhanceRatio(topPinId_net, bottomPinId_net) * w /
                               std::max(minDist, topPinY - bottomPinY));
 
                 // add net between internal node and top/bottom node
-                for (unsigned int pinId_net = 0; pinId_net < unitsOfNetPins.size(); pinId_net++)
+                const bool bottomMovable = !pinStore.isPUFixed(bottomPuId);
+                const bool topMovable = !pinStore.isPUFixed(topPuId);
+                for (int pinId = pinBegin; pinId < pinEnd; pinId++)
                 {
-                    auto tmpPU = unitsOfNetPins[pinId_net];
-                    auto tmpPUId = tmpPU->getId();
-                    auto tmpPinOffset = pinOffsetsInUnit[pinId_net];
-                    float curY = tmpPU->Y();
-                    bool movable = !tmpPU->isFixed();
+                    unsigned int pinId_net = pinId - pinBegin;
+                    int tmpPUId = pinStore.getPinPUId(pinId);
+                    float tmpPinOffsetY = pinStore.getPinOffsetY(pinId);
+                    float curY = pinStore.getPUY(tmpPUId);
+                    bool movable = !pinStore.isPUFixed(tmpPUId);
                     if (pinId_net != topPinId_net && pinId_net != bottomPinId_net)
                     {
                         addB2BNet(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector, tmpPUId, bottomPuId,
-                                  curY, bottomPUY, tmpPinOffset.y, pinOffsetsInUnit[bottomPinId_net].y, movable,
-                                  !unitsOfNetPins[bottomPinId_net]->isFixed(),
+                                  curY, bottomPUY, tmpPinOffsetY, pinOffsetsInUnit[bottomPinId_net].y, movable,
+                                  bottomMovable,
                                   designNet->getPinPairEnhanceRatio(pinId_net, bottomPinId_net) * w /
-                                      std::max(minDist, (curY + tmpPinOffset.y) - bottomPinY));
+                                      std::max(minDist, (curY + tmpPinOffsetY) - bottomPinY));
                         addB2BNet(objectiveMatrixTripletList, objectiveMatrixDiag, objectiveVector, tmpPUId, topPuId,
-                                  curY, topPUY, tmpPinOffset.y, pinOffsetsInUnit[topPinId_net].y, movable,
-                                  !unitsOfNetPins[topPinId_net]->isFixed(),
+                                  curY, topPUY, tmpPinOffsetY, pinOffsetsInUnit[topPinId_net].y, movable,
+                                  topMovable,
                                   designNet->getPinPairEnhanceRatio(pinId_net, topPinId_net) * w /
-                                      std::max(minDist, topPinY - (curY + tmpPinOffset.y)));
+                                      std::max(minDist, topPinY - (curY + tmpPinOffsetY)));
                     }
                 }
             }
@@ -2704,8 +3013,7 @@ class PlacementInfo
         for (auto curRow : siteGridForMacros)
             for (auto curBin : curRow)
                 delete curBin;
-        for (auto pn : placementNets)
-            delete pn;
+        // the PlacementUnits/PlacementNets are freed with their arenas
     }
 
     void printStat(bool verbose = false);
@@ -3246,12 +3554,20 @@ class PlacementInfo
     /**
      * @brief update the mapping from Cells to PlacementUnits, since sometime, PlacementUnits might change
      *
+     * The legalization information indexed by the ids of PlacementUnits is remapped as well since the ids of
+     * PlacementUnits might be renewed.
+     *
      */
     void updateCells2PlacementUnits();
 
     /**
      * @brief map design cells to the bins in the bin grid.
      *
+     * The bins of the cells are found in parallel and the cells are grouped by their bin locations with a counting
+     * sort, so the bins at different locations are filled by different threads without locks. Within a location, the
+     * cells are assigned in the order of the PlacementUnits, so a cell falls back to its first potential BEL type
+     * if all the bins of its potential types cannot hold it, the same as a sequential assignment.
+     *
      */
     void updateElementBinGrid();
 
@@ -3368,7 +3684,7 @@ class PlacementInfo
             fX = std::max(globalMinX + eps, (std::min(fX, globalMaxX - eps)));
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             if (fY + curMacro->getTopOffset() > globalMaxY - eps)
             {
@@ -3408,7 +3724,7 @@ class PlacementInfo
             fX = std::max(globalMinX + eps, (std::min(fX, globalMaxX - eps)));
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             if (fY + curMacro->getTopOffset() > globalMaxY - eps)
             {
@@ -3461,7 +3777,7 @@ class PlacementInfo
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
             return (std::fabs(fX - targetX) + std::fabs(fY - targetY)) < eps;
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             float offsetX = curMacro->getCellOffsetXInMacro(curCell);
             float offsetY = curMacro->getCellOffsetYInMacro(curCell);
@@ -3513,7 +3829,7 @@ class PlacementInfo
             fY = std::max(globalMinY + eps, (std::min(fY, globalMaxY - eps)));
             return (std::fabs(fX - targetX) + std::fabs(fY - targetY)) < eps;
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             float fX = targetX;
             float fY = targetY;
@@ -3557,7 +3873,7 @@ class PlacementInfo
             PUX = fX;
             PUY = fY;
         }
-        else if (auto curMacro = dynamic_cast<PlacementMacro *>(curPU))
+        else if (auto curMacro = asMacro(curPU))
         {
             float offsetX = curMacro->getCellOffsetXInMacro(curCell);
             float offsetY = curMacro->getCellOffsetYInMacro(curCell);
@@ -3642,11 +3958,11 @@ class PlacementInfo
     /**
      * @brief set the legalization of some PlacementUnit objects
      *
+     * @tparam PU2FloatMap std::map or IdIndexedMap from PlacementUnits to float
      * @param PU2X X of PlacementUnits
      * @param PU2Y Y of PlacementUnits
      */
-    inline void setPULegalXY(std::map<PlacementInfo::PlacementUnit *, float> &PU2X,
-                             std::map<PlacementInfo::PlacementUnit *, float> &PU2Y)
+    template <typename PU2FloatMap> inline void setPULegalXY(PU2FloatMap &PU2X, PU2FloatMap &PU2Y)
     {
         for (auto tmpPair : PU2X) // only update elements in PU2X and PU2Y
         {
@@ -3662,10 +3978,10 @@ class PlacementInfo
     /**
      * @brief set the sites occupied by the PlacementUnit objects
      *
+     * @tparam PU2SitesMap std::map or IdIndexedMap from PlacementUnits to vectors of device sites
      * @param PU2Sites a mapping from PlaceuementUnit objects to device sites
      */
-    inline void
-    setPULegalSite(std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> &PU2Sites)
+    template <typename PU2SitesMap> inline void setPULegalSite(PU2SitesMap &PU2Sites)
     {
         for (auto tmpPair : PU2Sites) // only update elements in PU2X and PU2Y
         {
@@ -3676,9 +3992,9 @@ class PlacementInfo
     /**
      * @brief get the sites occupied by the legalized PlacementUnit objects
      *
-     * @return std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>>&
+     * @return IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>>&
      */
-    inline std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> &getPULegalSite()
+    inline IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> &getPULegalSite()
     {
         return PU2LegalSites;
     }
@@ -3686,10 +4002,11 @@ class PlacementInfo
     /**
      * @brief get the locations (pair of X,Y) of the legalized PlacementUnit objects
      *
-     * @return std::pair<std::map<PlacementInfo::PlacementUnit *, float>, std::map<PlacementInfo::PlacementUnit *,
+     * @return std::pair<IdIndexedMap<PlacementInfo::PlacementUnit, float>, IdIndexedMap<PlacementInfo::PlacementUnit,
      * float>>&
      */
-    inline std::pair<std::map<PlacementInfo::PlacementUnit *, float>, std::map<PlacementInfo::PlacementUnit *, float>> &
+    inline std::pair<IdIndexedMap<PlacementInfo::PlacementUnit, float>,
+                     IdIndexedMap<PlacementInfo::PlacementUnit, float>> &
     getPULegalXY()
     {
         return PULegalXY;
@@ -3701,11 +4018,62 @@ class PlacementInfo
      */
     void resetPULegalInformation()
     {
-        PULegalXY.first = std::map<PlacementInfo::PlacementUnit *, float>();
-        PULegalXY.second = std::map<PlacementInfo::PlacementUnit *, float>();
+        PULegalXY.first.clear();
+        PULegalXY.second.clear();
         PU2LegalSites.clear();
     }
 
+    /**
+     * @brief create a PlacementMacro in the macro arena, so the PlacementUnits created in the order of their ids are
+     * laid out sequentially. It should be destroyed by destroyPlacementUnit().
+     *
+     * @tparam Args
+     * @param args the arguments of the constructor of PlacementMacro
+     * @return PlacementMacro*
+     */
+    template <typename... Args> inline PlacementMacro *createPlacementMacro(Args &&...args)
+    {
+        return placementMacroArena.create(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief create a PlacementUnpackedCell in the unpacked cell arena. It should be destroyed by
+     * destroyPlacementUnit().
+     *
+     * @tparam Args
+     * @param args the arguments of the constructor of PlacementUnpackedCell
+     * @return PlacementUnpackedCell*
+     */
+    template <typename... Args> inline PlacementUnpackedCell *createPlacementUnpackedCell(Args &&...args)
+    {
+        return placementUnpackedCellArena.create(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief destroy a PlacementUnit created by createPlacementMacro() or createPlacementUnpackedCell(). Its
+     * legalization information is removed as well, so no dangling PlacementUnit is left in the legalization mappings.
+     *
+     * @param curPU
+     */
+    inline void destroyPlacementUnit(PlacementUnit *curPU)
+    {
+        deleteLegalizationInfoFor(curPU);
+        if (auto curMacro = asMacro(curPU))
+            placementMacroArena.destroy(curMacro);
+        else if (auto curUnpackedCell = asUnpackedCell(curPU))
+            placementUnpackedCellArena.destroy(curUnpackedCell);
+        else
+            assert(false && "undefined PlacementUnit type.");
+    }
+
+    /**
+     * @brief destroy all the PlacementUnits in the placement. The arenas are reset if no PlacementUnit is left in
+     * them, so the PlacementUnits created later are laid out from the beginning of the arenas in the order of their
+     * ids.
+     *
+     */
+    void destroyAllPlacementUnits();
+
     /**
      * @brief remove the legalization information of a PlacementUnit object
      *
@@ -3713,12 +4081,9 @@ class PlacementInfo
      */
     inline void deleteLegalizationInfoFor(PlacementInfo::PlacementUnit *curPU)
     {
-        if (PU2LegalSites.find(curPU) != PU2LegalSites.end())
-            PU2LegalSites.erase(curPU);
-        if (PULegalXY.first.find(curPU) != PULegalXY.first.end())
-            PULegalXY.first.erase(curPU);
-        if (PULegalXY.second.find(curPU) != PULegalXY.second.end())
-            PULegalXY.second.erase(curPU);
+        PU2LegalSites.erase(curPU);
+        PULegalXY.first.erase(curPU);
+        PULegalXY.second.erase(curPU);
     }
 
     /**
@@ -3905,6 +4270,30 @@ class PlacementInfo
         return placementUnitId2Nets;
     }
 
+    /**
+     * @brief Get the flat pin store of the PlacementNets
+     *
+     * @return PlacementNetPinStore&
+     */
+    inline PlacementNetPinStore &getNetPinStore()
+    {
+        return netPinStore;
+    }
+
+    /**
+     * @brief load the current locations of PlacementUnits into the flat pin store (and rebuild the store if the
+     * PlacementNets/PlacementUnits are changed since last build)
+     *
+     * @return PlacementNetPinStore&
+     */
+    inline PlacementNetPinStore &loadNetPinStore()
+    {
+        if (!netPinStore.isBuiltFor(placementNets.size(), placementUnits.size()))
+            netPinStore.build(placementNets, placementUnits);
+        netPinStore.loadPULocations(placementUnits);
+        return netPinStore;
+    }
+
     /**
      * @brief update the B2B net model for the placement and get the total HPWL of all the nets in the design
      *
@@ -3914,12 +4303,13 @@ class PlacementInfo
     {
         double totalHPWL = 0.0;
         int numNet = placementNets.size();
+        PlacementNetPinStore &pinStore = loadNetPinStore();
 
 #pragma omp parallel for
         for (int netId = 0; netId < numNet; netId++)
         {
             auto net = placementNets[netId];
-            net->updateNetBounds(true, true);
+            net->updateNetBounds(pinStore, true, true);
         }
 
         //#pragma omp parallel for reduction(+ : totalHPWL)
@@ -3934,17 +4324,26 @@ class PlacementInfo
     /**
      * @brief get the total HPWL of all the nets in the design without updating the B2B net model for the placement
      *
+     * The HPWL is evaluated with the current locations of PlacementUnits in the flat pin store and the bounding boxes
+     * cached in the PlacementNets are not touched.
+     *
      * @return double
      */
     double getTotalHPWL()
     {
-        double totalHPWL = 0.0;
         int numNet = placementNets.size();
-        //#pragma omp parallel for reduction(+ : totalHPWL)
+        PlacementNetPinStore &pinStore = loadNetPinStore();
+        std::vector<float> netHPWL(numNet, 0.0);
+#pragma omp parallel for
         for (int netId = 0; netId < numNet; netId++)
         {
-            auto net = placementNets[netId];
-            totalHPWL += net->getHPWL(y2xRatio);
+            netHPWL[netId] = pinStore.getNetHPWL(netId, y2xRatio);
+        }
+        // accumulate serially so the result does not depend on the number of threads
+        double totalHPWL = 0.0;
+        for (int netId = 0; netId < numNet; netId++)
+        {
+            totalHPWL += netHPWL[netId];
         }
         return totalHPWL;
     }
@@ -4004,6 +4403,35 @@ class PlacementInfo
      */
     void loadPlacementUnitInformation(std::string locationFile);
 
+    /**
+     * @brief dump the placement state into a binary checkpoint file, so the placement flow can be resumed from the
+     * following stage.
+     *
+     * The checkpoint includes the PlacementUnit objects (pairing decisions, locations and fixed/placed/locked/packed
+     * status), legalization results (PULegalXY and PU2LegalSites), clock region constraints of PUs, the bin grid size,
+     * the adjusted resource demand of cells and the placement parameters.
+     *
+     * @param checkpointFile
+     * @param stageName the name of the stage after which the checkpoint is dumped
+     * @param placerStates named states of the other placer modules (e.g., GlobalPlacer) to be recorded
+     * @return true if the checkpoint is dumped successfully
+     */
+    bool dumpCheckpoint(std::string checkpointFile, std::string stageName,
+                        const std::map<std::string, float> &placerStates);
+
+    /**
+     * @brief load the placement state from a binary checkpoint file dumped by dumpCheckpoint()
+     *
+     * The initial packing, which creates virtual cells, should be done before loading. The current PlacementUnit
+     * objects will be replaced by the ones in the checkpoint.
+     *
+     * @param checkpointFile
+     * @param stageName the expected name of the stage after which the checkpoint was dumped
+     * @param placerStates output named states of the other placer modules
+     * @return true if the checkpoint exists, matches the design and is loaded successfully
+     */
+    bool loadCheckpoint(std::string checkpointFile, std::string stageName, std::map<std::string, float> &placerStates);
+
     /**
      * @brief Set the Pseudo Net Weight according to a given value
      *
@@ -4429,6 +4857,15 @@ class PlacementInfo
     void transferPaintData();
 
   private:
+    /**
+     * @brief the arenas of the PlacementUnits/PlacementNets, which are bump-allocated in the order of their creation
+     * and freed en masse
+     *
+     */
+    ObjectArena<PlacementMacro> placementMacroArena;
+    ObjectArena<PlacementUnpackedCell> placementUnpackedCellArena;
+    ObjectArena<PlacementNet> placementNetArena;
+
     CompatiblePlacementTable *compatiblePlacementTable = nullptr;
     std::vector<PlacementUnit *> placementUnits;
     std::vector<PlacementUnpackedCell *> placementUnpackedCells;
@@ -4444,16 +4881,16 @@ class PlacementInfo
     DeviceInfo *deviceInfo;
     PlacementTimingInfo *simplePlacementTimingInfo = nullptr;
     /**
-     * @brief a mapping from PlaceuementUnit objects to legalized locations
+     * @brief a mapping from PlaceuementUnit objects to legalized locations, indexed by the ids of the PlacementUnits
      *
      */
-    std::pair<std::map<PlacementInfo::PlacementUnit *, float>, std::map<PlacementInfo::PlacementUnit *, float>>
+    std::pair<IdIndexedMap<PlacementInfo::PlacementUnit, float>, IdIndexedMap<PlacementInfo::PlacementUnit, float>>
         PULegalXY;
     /**
-     * @brief a mapping from PlaceuementUnit objects to device sites
+     * @brief a mapping from PlaceuementUnit objects to device sites, indexed by the ids of the PlacementUnits
      *
      */
-    std::map<PlacementInfo::PlacementUnit *, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
+    IdIndexedMap<PlacementInfo::PlacementUnit, std::vector<DeviceInfo::DeviceSite *>> PU2LegalSites;
 
     /**
      * @brief left boundary of the device
@@ -4522,6 +4959,7 @@ class PlacementInfo
     float binHeight;
 
     std::vector<PlacementNet *> placementNets;
+    PlacementNetPinStore netPinStore;
     std::vector<std::vector<PlacementNet *>> placementUnitId2Nets;
     std::vector<PlacementNet *> designNetId2PlacementNet;
 
@@ -85,6 +85,7 @@ void PlacementTimingInfo::setDSPInnerDelay()
             newNode->setInnerDelay(1.3);
         }
     }
+    simpleTimingGraph->resetPropogationStatus();
 
     print_status("PlacementTimingInfo: set DSP inner delay");
 }
@@ -187,6 +188,8 @@ template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::fo
 {
     print_status("PlacementTimingInfo: Timing graph starts forward levalization");
     forwardlevel2NodeIds.clear();
+    arrivalTimePropogated = false;
+    compactGraphBuilt = false;
 
     std::vector<int> curLevelIds;
     curLevelIds.clear();
@@ -310,6 +313,8 @@ template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::ba
 {
     print_status("PlacementTimingInfo: Timing graph starts backward levalization");
     backwardlevel2NodeIds.clear();
+    requiredArrivalTimePropogated = false;
+    compactGraphBuilt = false;
 
     std::vector<int> curLevelIds;
     curLevelIds.clear();
@@ -592,27 +597,7 @@ template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::pr
 #pragma omp parallel for
         for (int j = 0; j < numNodeInLayer; j++)
         {
-            auto curNodeId = forwardlevel2NodeIds[i][j];
-            auto curNode = nodes[curNodeId];
-            for (auto inEdge : curNode->getInEdges())
-            {
-                int predId = inEdge->getSource()->getId();
-                float predDelay = inEdge->getSource()->getLatestInputArrival();
-                float edgeDelay = inEdge->getDelay();
-                float newDelay;
-
-                if (inEdge->getSource()->getInnerDelay() < 1.0 || inEdge->getSource()->getForwardLevel() > 0)
-                    newDelay = predDelay + edgeDelay + inEdge->getSource()->getInnerDelay();
-                else
-                    newDelay = predDelay + edgeDelay;
-                if (newDelay > curNode->getLatestInputArrival())
-                {
-                    curNode->setLatestInputArrival(newDelay);
-                    curNode->setSlowestPredecessorId(predId);
-                    // curNode->setLatestOutputArrival(newDelay + curNode->getInnerDelay());
-                    curNode->setLatestOutputArrival(newDelay);
-                }
-            }
+            updateArrivalTimeOfNode(nodes[forwardlevel2NodeIds[i][j]]);
         }
     }
 
@@ -622,29 +607,11 @@ template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::pr
     {
         auto curNodeId = forwardlevel2NodeIds[0][j];
         assert(curNodeId < nodes.size());
-        auto curNode = nodes[curNodeId];
-        if (curNode->getDesignNode()->isVirtualCell())
-            continue;
-
-        for (auto inEdge : curNode->getInEdges())
-        {
-            if (inEdge->getSource())
-            {
-                if (inEdge->getSource()->getForwardLevel() > 0)
-                {
-                    int predId = inEdge->getSource()->getId();
-                    float predDelay = inEdge->getSource()->getLatestInputArrival();
-                    float edgeDelay = inEdge->getDelay();
-                    float newDelay = predDelay + edgeDelay + inEdge->getSource()->getInnerDelay();
-                    if (newDelay > curNode->getLatestInputArrival())
-                    {
-                        curNode->setLatestInputArrival(newDelay);
-                        curNode->setSlowestPredecessorId(predId);
-                    }
-                }
-            }
-        }
+        updateArrivalTimeOfEndpoint(nodes[curNodeId]);
     }
+    arrivalTimePropogated = true;
+    criticalPathUpdated = false;
+    compactGraphSynchronized = false;
 }
 
 template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::backPropogateRequiredArrivalTime()
@@ -663,22 +630,402 @@ template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::ba
 #pragma omp parallel for
         for (int j = 0; j < numNodeInLayer; j++)
         {
-            auto curNodeId = backwardlevel2NodeIds[i][j];
+            updateRequiredArrivalTimeOfNode(nodes[backwardlevel2NodeIds[i][j]]);
+        }
+    }
+    requiredArrivalTimePropogated = true;
+    compactGraphSynchronized = false;
+}
+
+template <typename nodeType>
+int PlacementTimingInfo::TimingGraph<nodeType>::incrementalPropogateTiming(std::vector<int> &changedEdgeIds)
+{
+    assert(canPropogateIncrementally());
+    compactGraphSynchronized = false;
+    int nodeNum = nodes.size();
+    int forwardLevelNum = forwardlevel2NodeIds.size();
+    int backwardLevelNum = backwardlevel2NodeIds.size();
+    if (nodeInQueue.size() != (unsigned int)nodeNum)
+        nodeInQueue.assign(nodeNum, 0);
+    levelQueues.resize(std::max(forwardLevelNum, backwardLevelNum));
+
+    auto enqueueNode = [&](int nodeId, int level) {
+        if (level < 0 || nodeInQueue[nodeId])
+            return;
+        nodeInQueue[nodeId] = 1;
+        levelQueues[level].push_back(nodeId);
+    };
+
+    int evaluatedNodeNum = 0;
+
+    // forward: the sinks of the changed edges and their fan-out cones. Nodes in level i only affect nodes in higher
+    // levels or the endpoints (level 0), which are evaluated at last.
+    bool rescanCriticalPath = !criticalPathUpdated;
+    for (auto edgeId : changedEdgeIds)
+    {
+        auto sinkNode = edges[edgeId]->getSink();
+        enqueueNode(sinkNode->getId(), sinkNode->getForwardLevel());
+    }
+    for (int i = 1; i <= forwardLevelNum; i++)
+    {
+        int level = (i == forwardLevelNum) ? 0 : i;
+        for (unsigned int j = 0; j < levelQueues[level].size(); j++)
+        {
+            int curNodeId = levelQueues[level][j];
+            nodeInQueue[curNodeId] = 0;
+            auto curNode = nodes[curNodeId];
+            float oriArrival = curNode->getLatestInputArrival();
+            if (level == 0)
+                updateArrivalTimeOfEndpoint(curNode);
+            else
+                updateArrivalTimeOfNode(curNode);
+            evaluatedNodeNum++;
+
+            float newArrival = curNode->getLatestInputArrival();
+            if (!rescanCriticalPath)
+            {
+                if (newArrival > maxDelay)
+                {
+                    maxDelay = newArrival;
+                    maxDelayId = curNodeId;
+                }
+                else if (curNodeId == maxDelayId && newArrival < oriArrival)
+                {
+                    rescanCriticalPath = true;
+                }
+            }
+
+            // the arrival time of an endpoint is not propogated further
+            if (level == 0 || newArrival == oriArrival)
+                continue;
+            for (auto outEdge : curNode->getOutEdges())
+            {
+                auto sinkNode = outEdge->getSink();
+                enqueueNode(sinkNode->getId(), sinkNode->getForwardLevel());
+            }
+        }
+        levelQueues[level].clear();
+    }
+    if (rescanCriticalPath)
+        updateCriticalPath();
+
+    // backward: the sources of the changed edges and their fan-in cones. Registers (level 0) keep their initial
+    // required arrival time.
+    for (auto edgeId : changedEdgeIds)
+    {
+        auto srcNode = edges[edgeId]->getSource();
+        if (srcNode->getBackwardLevel() > 0)
+            enqueueNode(srcNode->getId(), srcNode->getBackwardLevel());
+    }
+    for (int level = 1; level < backwardLevelNum; level++)
+    {
+        for (unsigned int j = 0; j < levelQueues[level].size(); j++)
+        {
+            int curNodeId = levelQueues[level][j];
+            nodeInQueue[curNodeId] = 0;
             auto curNode = nodes[curNodeId];
+            float oriRequiredArrival = curNode->getRequiredArrivalTime();
+            updateRequiredArrivalTimeOfNode(curNode);
+            evaluatedNodeNum++;
+
+            if (curNode->getRequiredArrivalTime() == oriRequiredArrival)
+                continue;
+            for (auto inEdge : curNode->getInEdges())
+            {
+                auto predNode = inEdge->getSource();
+                if (predNode->getBackwardLevel() > 0)
+                    enqueueNode(predNode->getId(), predNode->getBackwardLevel());
+            }
+        }
+        levelQueues[level].clear();
+    }
+
+    return evaluatedNodeNum;
+}
+
+template <typename nodeType> void PlacementTimingInfo::TimingGraph<nodeType>::buildCompactGraph()
+{
+    int nodeNum = nodes.size();
+    int forwardLevelNum = forwardlevel2NodeIds.size();
+    int backwardLevelNum = backwardlevel2NodeIds.size();
+
+    // renumber the TimingNodes in the order of propogation: forward level 1, 2, ..., max, and then level 0
+    compactId2NodeId.clear();
+    compactId2NodeId.reserve(nodeNum);
+    compactForwardLevelBegin.clear();
+    for (int i = 1; i <= forwardLevelNum; i++)
+    {
+        int level = (i == forwardLevelNum) ? 0 : i;
+        compactForwardLevelBegin.push_back(compactId2NodeId.size());
+        for (auto id : forwardlevel2NodeIds[level])
+            compactId2NodeId.push_back(id);
+    }
+    compactForwardLevelBegin.push_back(compactId2NodeId.size());
+
+    nodeId2CompactId.assign(nodeNum, -1);
+    for (unsigned int compactId = 0; compactId < compactId2NodeId.size(); compactId++)
+        nodeId2CompactId[compactId2NodeId[compactId]] = compactId;
+    for (int i = 0; i < nodeNum; i++)
+    {
+        if (nodeId2CompactId[i] < 0)
+        {
+            nodeId2CompactId[i] = compactId2NodeId.size();
+            compactId2NodeId.push_back(i);
+        }
+    }
+
+    compactBackwardOrder.clear();
+    compactBackwardLevelBegin.clear();
+    for (int level = 1; level < backwardLevelNum; level++)
+    {
+        compactBackwardLevelBegin.push_back(compactBackwardOrder.size());
+        for (auto id : backwardlevel2NodeIds[level])
+            compactBackwardOrder.push_back(nodeId2CompactId[id]);
+    }
+    compactBackwardLevelBegin.push_back(compactBackwardOrder.size());
+
+    // the edges are kept in the original order of inEdges/outEdges so the ties are broken in the same way as the
+    // propogation on TimingNodes
+    int edgeNum = edges.size();
+    compactInEdgeBegin.resize(nodeNum + 1);
+    compactInEdgeSrc.clear();
+    compactOutEdgeBegin.resize(nodeNum + 1);
+    compactOutEdgeSink.clear();
+    edgeId2CompactInEdge.assign(edgeNum, -1);
+    edgeId2CompactOutEdge.assign(edgeNum, -1);
+    for (int compactId = 0; compactId < nodeNum; compactId++)
+    {
+        auto curNode = nodes[compactId2NodeId[compactId]];
+        compactInEdgeBegin[compactId] = compactInEdgeSrc.size();
+        if (curNode->getForwardLevel() > 0)
+        {
+            for (auto inEdge : curNode->getInEdges())
+            {
+                edgeId2CompactInEdge[inEdge->getId()] = compactInEdgeSrc.size();
+                compactInEdgeSrc.push_back(nodeId2CompactId[inEdge->getSource()->getId()]);
+            }
+        }
+        else if (curNode->getForwardLevel() == 0 && !curNode->getDesignNode()->isVirtualCell())
+        {
+            for (auto inEdge : curNode->getInEdges())
+            {
+                if (inEdge->getSource()->getForwardLevel() > 0)
+                {
+                    edgeId2CompactInEdge[inEdge->getId()] = compactInEdgeSrc.size();
+                    compactInEdgeSrc.push_back(nodeId2CompactId[inEdge->getSource()->getId()]);
+                }
+            }
+        }
+
+        compactOutEdgeBegin[compactId] = compactOutEdgeSink.size();
+        if (curNode->getBackwardLevel() > 0)
+        {
             for (auto outEdge : curNode->getOutEdges())
             {
-                int succId = outEdge->getSink()->getId();
-                float succRequiredArrival = outEdge->getSink()->getRequiredArrivalTime();
-                float edgeDelay = outEdge->getDelay();
-                float newRequiredArrival = succRequiredArrival - edgeDelay - outEdge->getSink()->getInnerDelay();
-                if (newRequiredArrival < curNode->getRequiredArrivalTime())
+                edgeId2CompactOutEdge[outEdge->getId()] = compactOutEdgeSink.size();
+                compactOutEdgeSink.push_back(nodeId2CompactId[outEdge->getSink()->getId()]);
+            }
+        }
+    }
+    compactInEdgeBegin[nodeNum] = compactInEdgeSrc.size();
+    compactOutEdgeBegin[nodeNum] = compactOutEdgeSink.size();
+
+    compactInEdgeDelay.resize(compactInEdgeSrc.size());
+    compactOutEdgeDelay.resize(compactOutEdgeSink.size());
+    compactLaunchInnerDelay.resize(nodeNum);
+    compactInnerDelay.resize(nodeNum);
+    compactInitialRequiredArrival.resize(nodeNum);
+    compactArrival.resize(nodeNum);
+    compactRequiredArrival.resize(nodeNum);
+    compactSlowestPredecessor.resize(nodeNum);
+    compactEarliestSuccessor.resize(nodeNum);
+
+    compactGraphBuilt = true;
+    compactGraphSynchronized = false;
+    print_info("PlacementTimingInfo: built compact timing graph with " + std::to_string(compactInEdgeSrc.size()) +
+               " forward edges and " + std::to_string(compactOutEdgeSink.size()) + " backward edges");
+}
+
+template <typename nodeType>
+void PlacementTimingInfo::TimingGraph<nodeType>::propogateTimingWithCompactGraph(std::vector<int> *changedEdgeIds)
+{
+    if (!compactGraphBuilt)
+        buildCompactGraph();
+
+    int nodeNum = nodes.size();
+    int edgeNum = edges.size();
+
+    auto loadEdgeDelay = [&](int edgeId) {
+        float delay = edges[edgeId]->getDelay();
+        if (edgeId2CompactInEdge[edgeId] >= 0)
+            compactInEdgeDelay[edgeId2CompactInEdge[edgeId]] = delay;
+        if (edgeId2CompactOutEdge[edgeId] >= 0)
+            compactOutEdgeDelay[edgeId2CompactOutEdge[edgeId]] = delay;
+    };
+
+    if (compactGraphSynchronized && changedEdgeIds)
+    {
+        for (auto edgeId : *changedEdgeIds)
+            loadEdgeDelay(edgeId);
+#pragma omp parallel for
+        for (int compactId = 0; compactId < nodeNum; compactId++)
+        {
+            compactArrival[compactId] = 0.0;
+            compactRequiredArrival[compactId] = compactInitialRequiredArrival[compactId];
+            compactSlowestPredecessor[compactId] = -1;
+            compactEarliestSuccessor[compactId] = -1;
+        }
+    }
+    else
+    {
+        // load the delays, the inner delays and the clock periods, which might be changed since the compact graph is
+        // built. The TimingEdges/TimingNodes are visited in their original order to access their objects sequentially.
+#pragma omp parallel
+        {
+#pragma omp for nowait
+            for (int edgeId = 0; edgeId < edgeNum; edgeId++)
+                loadEdgeDelay(edgeId);
+#pragma omp for
+            for (int nodeId = 0; nodeId < nodeNum; nodeId++)
+            {
+                auto curNode = nodes[nodeId];
+                int compactId = nodeId2CompactId[nodeId];
+                float innerDelay = curNode->getInnerDelay();
+                compactInnerDelay[compactId] = innerDelay;
+                compactLaunchInnerDelay[compactId] =
+                    (innerDelay < 1.0 || curNode->getForwardLevel() > 0) ? innerDelay : 0.0;
+                float nodeClockPeriod = curNode->getClockPeriod();
+                compactInitialRequiredArrival[compactId] = (nodeClockPeriod > 0) ? nodeClockPeriod : clockPeriod;
+                compactArrival[compactId] = 0.0;
+                compactRequiredArrival[compactId] = compactInitialRequiredArrival[compactId];
+                compactSlowestPredecessor[compactId] = -1;
+                compactEarliestSuccessor[compactId] = -1;
+            }
+        }
+    }
+
+    const int *inEdgeBegin = compactInEdgeBegin.data();
+    const int *inEdgeSrc = compactInEdgeSrc.data();
+    const float *inEdgeDelay = compactInEdgeDelay.data();
+    const float *launchInnerDelay = compactLaunchInnerDelay.data();
+    float *arrival = compactArrival.data();
+
+    // forward: the arrival times of the level-0 TimingNodes are 0 until the last range (endpoints) is evaluated, so
+    // the launch time of the registers is 0.
+    for (unsigned int r = 0; r + 1 < compactForwardLevelBegin.size(); r++)
+    {
+        int rangeBegin = compactForwardLevelBegin[r];
+        int rangeEnd = compactForwardLevelBegin[r + 1];
+#pragma omp parallel for schedule(static) if (rangeEnd - rangeBegin > 256)
+        for (int compactId = rangeBegin; compactId < rangeEnd; compactId++)
+        {
+            int edgeBegin = inEdgeBegin[compactId];
+            int edgeEnd = inEdgeBegin[compactId + 1];
+            float latestArrival = 0.0;
+#pragma omp simd reduction(max : latestArrival)
+            for (int k = edgeBegin; k < edgeEnd; k++)
+            {
+                int src = inEdgeSrc[k];
+                float newDelay = arrival[src] + inEdgeDelay[k] + launchInnerDelay[src];
+                latestArrival = (newDelay > latestArrival) ? newDelay : latestArrival;
+            }
+            if (latestArrival > 0)
+            {
+                for (int k = edgeBegin; k < edgeEnd; k++)
+                {
+                    int src = inEdgeSrc[k];
+                    if (arrival[src] + inEdgeDelay[k] + launchInnerDelay[src] == latestArrival)
+                    {
+                        compactSlowestPredecessor[compactId] = src;
+                        break;
+                    }
+                }
+            }
+            arrival[compactId] = latestArrival;
+        }
+    }
+
+    const int *outEdgeBegin = compactOutEdgeBegin.data();
+    const int *outEdgeSink = compactOutEdgeSink.data();
+    const float *outEdgeDelay = compactOutEdgeDelay.data();
+    const float *innerDelay = compactInnerDelay.data();
+    float *requiredArrival = compactRequiredArrival.data();
+
+    // backward: registers (backward level 0) keep their initial required arrival times
+    for (unsigned int r = 0; r + 1 < compactBackwardLevelBegin.size(); r++)
+    {
+        int rangeBegin = compactBackwardLevelBegin[r];
+        int rangeEnd = compactBackwardLevelBegin[r + 1];
+#pragma omp parallel for schedule(static) if (rangeEnd - rangeBegin > 256)
+        for (int j = rangeBegin; j < rangeEnd; j++)
+        {
+            int compactId = compactBackwardOrder[j];
+            int edgeBegin = outEdgeBegin[compactId];
+            int edgeEnd = outEdgeBegin[compactId + 1];
+            float initialRequiredArrival = requiredArrival[compactId];
+            float earliestRequiredArrival = initialRequiredArrival;
+#pragma omp simd reduction(min : earliestRequiredArrival)
+            for (int k = edgeBegin; k < edgeEnd; k++)
+            {
+                int sink = outEdgeSink[k];
+                float newRequiredArrival = requiredArrival[sink] - outEdgeDelay[k] - innerDelay[sink];
+                earliestRequiredArrival =
+                    (newRequiredArrival < earliestRequiredArrival) ? newRequiredArrival : earliestRequiredArrival;
+            }
+            if (earliestRequiredArrival < initialRequiredArrival)
+            {
+                for (int k = edgeBegin; k < edgeEnd; k++)
                 {
-                    curNode->setRequiredArrivalTime(newRequiredArrival);
-                    curNode->setEarlestSuccessorId(succId);
+                    int sink = outEdgeSink[k];
+                    if (requiredArrival[sink] - outEdgeDelay[k] - innerDelay[sink] == earliestRequiredArrival)
+                    {
+                        compactEarliestSuccessor[compactId] = sink;
+                        break;
+                    }
                 }
+                requiredArrival[compactId] = earliestRequiredArrival;
+            }
+        }
+    }
+
+    // write back to the TimingNodes and find the critical endpoint (the first node with the latest arrival)
+    int rangeNum = compactForwardLevelBegin.size() - 1;
+    int endpointBegin = (rangeNum > 0) ? compactForwardLevelBegin[rangeNum - 1] : 0;
+    float latestArrival = 0.0;
+#pragma omp parallel for reduction(max : latestArrival)
+    for (int nodeId = 0; nodeId < nodeNum; nodeId++)
+    {
+        auto curNode = nodes[nodeId];
+        int compactId = nodeId2CompactId[nodeId];
+        int slowestPredecessor = compactSlowestPredecessor[compactId];
+        int earliestSuccessor = compactEarliestSuccessor[compactId];
+        curNode->setLatestInputArrival(arrival[compactId]);
+        curNode->setLatestOutputArrival((compactId < endpointBegin) ? arrival[compactId] : 0.0);
+        curNode->setSlowestPredecessorId((slowestPredecessor >= 0) ? compactId2NodeId[slowestPredecessor] : -1);
+        curNode->setRequiredArrivalTime(requiredArrival[compactId]);
+        curNode->setEarlestSuccessorId((earliestSuccessor >= 0) ? compactId2NodeId[earliestSuccessor] : -1);
+        latestArrival = std::max(latestArrival, arrival[compactId]);
+    }
+
+    int criticalEndPoint = -1;
+    if (latestArrival > 0)
+    {
+        for (int nodeId = 0; nodeId < nodeNum; nodeId++)
+        {
+            if (arrival[nodeId2CompactId[nodeId]] == latestArrival)
+            {
+                criticalEndPoint = nodeId;
+                break;
             }
         }
     }
+    maxDelay = latestArrival;
+    maxDelayId = criticalEndPoint;
+
+    arrivalTimePropogated = true;
+    requiredArrivalTimePropogated = true;
+    criticalPathUpdated = true;
+    compactGraphSynchronized = true;
 }
 
 template <typename nodeType>
@@ -560,6 +560,7 @@ class PlacementTimingInfo
             auto newEdge = new TimingEdge(nodes[idA], nodes[idB], srcPin, sinkPin, net, edges.size());
             newEdge->setDelay(delay);
             edges.push_back(newEdge);
+            compactGraphBuilt = false;
 
             nodes[idB]->addInEdge(newEdge);
             nodes[idA]->addOutEdge(newEdge);
@@ -625,6 +626,59 @@ class PlacementTimingInfo
          */
         void backPropogateRequiredArrivalTime();
 
+        /**
+         * @brief check whether the arrival times and the required arrival times have been propogated with the current
+         * levelization and clock period, so they can be updated incrementally
+         *
+         * @return true if incrementalPropogateTiming() can be applied
+         */
+        inline bool canPropogateIncrementally()
+        {
+            return arrivalTimePropogated && requiredArrivalTimePropogated;
+        }
+
+        /**
+         * @brief incrementally update the arrival times and the required arrival times after the delays of some
+         * TimingEdges are changed
+         *
+         * The arrival times are re-propogated forward only through the fan-out cone of the changed edges and the
+         * required arrival times are back-propogated only through the fan-in cone, level by level. The propogation
+         * stops at the TimingNodes whose values are not changed. The results are identical to propogateArrivalTime()
+         * + backPropogateRequiredArrivalTime() and the critical path is updated as well.
+         *
+         * @param changedEdgeIds the ids of the TimingEdges whose delays are changed
+         * @return int the number of TimingNodes re-evaluated
+         */
+        int incrementalPropogateTiming(std::vector<int> &changedEdgeIds);
+
+        /**
+         * @brief propogate the arrival times and the required arrival times with the compact (CSR) copy of the
+         * TimingGraph and update the critical path
+         *
+         * The TimingNodes are renumbered in level order and the TimingEdges are stored in CSR arrays, so each level is
+         * evaluated with contiguous memory accesses and vectorized max/min reductions. The results are written back
+         * to the TimingNodes and are identical to propogateArrivalTime() + backPropogateRequiredArrivalTime() +
+         * updateCriticalPath(). The compact graph is built at the first call after levelization.
+         *
+         * @param changedEdgeIds the ids of the TimingEdges whose delays are changed since the latest call. If it is
+         * given and no other propogation is conducted in between, only the delays of these TimingEdges are reloaded
+         * into the compact graph. Otherwise, all the delays are reloaded.
+         */
+        void propogateTimingWithCompactGraph(std::vector<int> *changedEdgeIds = nullptr);
+
+        /**
+         * @brief invalidate the propogated timing information, e.g., when the inner delays of TimingNodes are changed,
+         * so the next propogation will go through the entire TimingGraph
+         *
+         */
+        inline void resetPropogationStatus()
+        {
+            arrivalTimePropogated = false;
+            requiredArrivalTimePropogated = false;
+            criticalPathUpdated = false;
+            compactGraphSynchronized = false;
+        }
+
         void updateCriticalPath()
         {
             maxDelay = 0;
@@ -637,6 +691,7 @@ class PlacementTimingInfo
                     maxDelayId = i;
                 }
             }
+            criticalPathUpdated = true;
         }
 
         inline int getCriticalEndPoint()
@@ -789,9 +844,96 @@ class PlacementTimingInfo
         inline void setClockPeriod(float _clockPeriod)
         {
             clockPeriod = _clockPeriod;
+            requiredArrivalTimePropogated = false;
+            compactGraphSynchronized = false;
         }
 
       private:
+        /**
+         * @brief evaluate the latest arrival time of a TimingNode (forward level > 0) from its predecessors
+         *
+         * the predecessors at level 0 (registers) launch at time 0
+         *
+         * @param curNode
+         */
+        inline void updateArrivalTimeOfNode(TimingNode *curNode)
+        {
+            float latestArrival = 0.0;
+            int slowestPredecessorId = -1;
+            for (auto inEdge : curNode->getInEdges())
+            {
+                auto predNode = inEdge->getSource();
+                float predDelay = (predNode->getForwardLevel() > 0) ? predNode->getLatestInputArrival() : 0.0;
+                float innerDelay = (predNode->getInnerDelay() < 1.0 || predNode->getForwardLevel() > 0)
+                                       ? predNode->getInnerDelay()
+                                       : 0.0;
+                float newDelay = predDelay + inEdge->getDelay() + innerDelay;
+                if (newDelay > latestArrival)
+                {
+                    latestArrival = newDelay;
+                    slowestPredecessorId = predNode->getId();
+                }
+            }
+            curNode->setLatestInputArrival(latestArrival);
+            curNode->setSlowestPredecessorId(slowestPredecessorId);
+            curNode->setLatestOutputArrival(latestArrival);
+        }
+
+        /**
+         * @brief evaluate the latest arrival time of a timing endpoint (forward level == 0) from its combinational
+         * predecessors
+         *
+         * @param curNode
+         */
+        inline void updateArrivalTimeOfEndpoint(TimingNode *curNode)
+        {
+            float latestArrival = 0.0;
+            int slowestPredecessorId = -1;
+            if (!curNode->getDesignNode()->isVirtualCell())
+            {
+                for (auto inEdge : curNode->getInEdges())
+                {
+                    auto predNode = inEdge->getSource();
+                    if (predNode && predNode->getForwardLevel() > 0)
+                    {
+                        float newDelay =
+                            predNode->getLatestInputArrival() + inEdge->getDelay() + predNode->getInnerDelay();
+                        if (newDelay > latestArrival)
+                        {
+                            latestArrival = newDelay;
+                            slowestPredecessorId = predNode->getId();
+                        }
+                    }
+                }
+            }
+            curNode->setLatestInputArrival(latestArrival);
+            curNode->setSlowestPredecessorId(slowestPredecessorId);
+            curNode->setLatestOutputArrival(0.0);
+        }
+
+        /**
+         * @brief evaluate the required arrival time of a TimingNode (backward level > 0) from its successors
+         *
+         * @param curNode
+         */
+        inline void updateRequiredArrivalTimeOfNode(TimingNode *curNode)
+        {
+            curNode->setInitialRequiredArrivalTime(clockPeriod);
+            int earliestSuccessorId = -1;
+            for (auto outEdge : curNode->getOutEdges())
+            {
+                auto succNode = outEdge->getSink();
+                float newRequiredArrival =
+                    succNode->getRequiredArrivalTime() - outEdge->getDelay() - succNode->getInnerDelay();
+                if (newRequiredArrival < curNode->getRequiredArrivalTime())
+                {
+                    curNode->setRequiredArrivalTime(newRequiredArrival);
+                    earliestSuccessorId = succNode->getId();
+                }
+            }
+            curNode->setEarlestSuccessorId(earliestSuccessorId);
+        }
+
         PlacementTimingInfo *timingInfo = nullptr;
         std::vector<TimingNode *> nodes;
         std::vector<TimingNode *> pathLenSortedNodes;
@@ -819,6 +961,98 @@ class PlacementTimingInfo
 
         float maxDelay = 0;
         int maxDelayId = -1;
+
+        /**
+         * @brief indicate whether the timing information of the TimingNodes is consistent with the edge delays, i.e.,
+         * it has been propogated after the latest levelization (and clock period setting)
+         *
+         */
+        bool arrivalTimePropogated = false;
+        bool requiredArrivalTimePropogated = false;
+        bool criticalPathUpdated = false;
+
+        /**
+         * @brief the TimingNodes to be re-evaluated in each level during incremental propogation
+         *
+         */
+        std::vector<std::vector<int>> levelQueues;
+        std::vector<unsigned char> nodeInQueue;
+
+        /**
+         * @brief build the compact (CSR) copy of the TimingGraph according to the current levelization
+         *
+         */
+        void buildCompactGraph();
+
+        /**
+         * @brief indicate whether the compact graph is consistent with the topology and the levelization
+         *
+         */
+        bool compactGraphBuilt = false;
+
+        /**
+         * @brief indicate whether the delays in the compact graph are consistent with the latest propogation
+         *
+         */
+        bool compactGraphSynchronized = false;
+
+        /**
+         * @brief the TimingNodes in the compact graph are ordered by forward level: 1, 2, ..., max, then the
+         * endpoints (level 0) and the TimingNodes which are not levelized.
+         *
+         * The compact node ids in [compactForwardLevelBegin[i], compactForwardLevelBegin[i+1]) are in forward level
+         * i+1, where the last range is for the endpoints.
+         */
+        std::vector<int> compactId2NodeId;
+        std::vector<int> nodeId2CompactId;
+        std::vector<int> compactForwardLevelBegin;
+
+        /**
+         * @brief the compact node ids in backward level 1, 2, ..., max. Those in backward level i are
+         * compactBackwardOrder[compactBackwardLevelBegin[i-1], compactBackwardLevelBegin[i])
+         *
+         */
+        std::vector<int> compactBackwardOrder;
+        std::vector<int> compactBackwardLevelBegin;
+
+        /**
+         * @brief the in-edges of compact node i are [compactInEdgeBegin[i], compactInEdgeBegin[i+1]) with the source
+         * compact node ids and the delays. The in-edges from the TimingNodes in level 0 to the endpoints are ignored,
+         * as in propogateArrivalTime().
+         *
+         */
+        std::vector<int> compactInEdgeBegin;
+        std::vector<int> compactInEdgeSrc;
+        std::vector<float> compactInEdgeDelay;
+
+        /**
+         * @brief the out-edges of compact node i are [compactOutEdgeBegin[i], compactOutEdgeBegin[i+1]) with the sink
+         * compact node ids and the delays
+         *
+         */
+        std::vector<int> compactOutEdgeBegin;
+        std::vector<int> compactOutEdgeSink;
+        std::vector<float> compactOutEdgeDelay;
+
+        /**
+         * @brief the positions of the TimingEdges in the in-edge/out-edge arrays of the compact graph (-1 if ignored)
+         *
+         */
+        std::vector<int> edgeId2CompactInEdge;
+        std::vector<int> edgeId2CompactOutEdge;
+
+        /**
+         * @brief the inner delay of the compact nodes as predecessors in forward propogation (the inner delay of a
+         * level-0 TimingNode is ignored if it is not lower than 1.0)
+         *
+         */
+        std::vector<float> compactLaunchInnerDelay;
+        std::vector<float> compactInnerDelay;
+        std::vector<float> compactInitialRequiredArrival;
+        std::vector<float> compactArrival;
+        std::vector<float> compactRequiredArrival;
+        std::vector<int> compactSlowestPredecessor;
+        std::vector<int> compactEarliestSuccessor;
     };
 
     /**
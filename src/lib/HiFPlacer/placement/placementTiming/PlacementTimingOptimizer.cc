@@ -23,6 +23,7 @@
  */
 
 #include "PlacementTimingOptimizer.h"
+#include "profiler.h"
 
 #include <cmath>
 #include <codecvt>
@@ -37,6 +38,8 @@ PlacementTimingOptimizer::PlacementTimingOptimizer(PlacementInfo *placementInfo,
         y2xRatio = std::stof(JSONCfg["y2xRatio"]);
     if (JSONCfg.find("DSPCritical") != JSONCfg.end())
         DSPCritical = JSONCfg["DSPCritical"] == "true";
+    if (JSONCfg.find("CompactTimingGraph") != JSONCfg.end())
+        useCompactTimingGraph = JSONCfg["CompactTimingGraph"] == "true";
 
     designInfo = placementInfo->getDesignInfo();
     deviceInfo = placementInfo->getDeviceInfo();
@@ -146,11 +149,11 @@ std::vector<std::vector<int>> PlacementTimingOptimizer::findCriticalPaths(float
                 for (auto cellId : resPath)
                 {
                     auto PU = placementInfo->getPlacementUnitByCellId(cellId);
-                    if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(PU))
+                    if (auto unpackedCell = PlacementInfo::asUnpackedCell(PU))
                     {
                         isCovered[unpackedCell->getCell()->getCellId()]++;
                     }
-                    else if (auto macro = dynamic_cast<PlacementInfo::PlacementMacro *>(PU))
+                    else if (auto macro = PlacementInfo::asMacro(PU))
                     {
                         for (auto cell : macro->getCells())
                         {
@@ -197,11 +200,11 @@ PlacementTimingOptimizer::findCriticalPaths(float criticalRatio, std::vector<boo
             for (auto cellId : resPath)
             {
                 auto PU = placementInfo->getPlacementUnitByCellId(cellId);
-                if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(PU))
+                if (auto unpackedCell = PlacementInfo::asUnpackedCell(PU))
                 {
                     isCovered[unpackedCell->getCell()->getCellId()] = 1;
                 }
-                else if (auto macro = dynamic_cast<PlacementInfo::PlacementMacro *>(PU))
+                else if (auto macro = PlacementInfo::asMacro(PU))
                 {
                     for (auto cell : macro->getCells())
                     {
@@ -217,6 +220,7 @@ PlacementTimingOptimizer::findCriticalPaths(float criticalRatio, std::vector<boo
 
 float PlacementTimingOptimizer::conductStaticTimingAnalysis(bool disableOptimisticTiming)
 {
+    ProfileZone profileZone("StaticTimingAnalysis");
     print_status("PlacementTimingOptimizer: conducting Static Timing Analysis");
 
     unsigned int highFanoutThr = 10000;
@@ -264,29 +268,31 @@ float PlacementTimingOptimizer::conductStaticTimingAnalysis(bool disableOptimist
     auto timingGraph = timingInfo->getSimplePlacementTimingGraph();
     setPinsLocation();
 
-    auto &pinLoc = placementInfo->getPinId2location();
     auto &cellLoc = placementInfo->getCellId2location();
 
-    auto &edges = timingGraph->getEdges();
-    int numEdges = edges.size();
-
-#pragma omp parallel for
-    for (int i = 0; i < numEdges; i++)
+    // local moves (e.g., in timing-driven detailed placement) only change a few edges, so the timing can be updated
+    // through their fan-in/fan-out cones
+    std::vector<int> changedEdgeIds;
+    updateEdgeDelays(changedEdgeIds);
+    profileCounter("STA edges updated", changedEdgeIds.size());
+    int numEdges = timingGraph->getEdges().size();
+    if (timingGraph->canPropogateIncrementally() &&
+        changedEdgeIds.size() <= numEdges * incrementalSTAChangedEdgeRatioThr)
     {
-        auto edge = edges[i];
-        auto &pin1Loc = pinLoc[edge->getSourcePin()->getElementIdInType()];
-        auto &pin2Loc = pinLoc[edge->getSinkPin()->getElementIdInType()];
-        if (pin1Loc.X < -5 && pin1Loc.Y < -5)
-            continue;
-        if (pin2Loc.X < -5 && pin2Loc.Y < -5)
-            continue;
-
-        edge->setDelay(getDelayByModel(edge->getSink(), edge->getSource(), pin1Loc.X, pin1Loc.Y, pin2Loc.X, pin2Loc.Y));
+        int evaluatedNodeNum = timingGraph->incrementalPropogateTiming(changedEdgeIds);
+        print_info("PlacementTimingOptimizer: incremental STA for " + std::to_string(changedEdgeIds.size()) +
+                   " changed edges, " + std::to_string(evaluatedNodeNum) + " timing nodes re-evaluated");
+    }
+    else if (useCompactTimingGraph)
+    {
+        timingGraph->propogateTimingWithCompactGraph(&changedEdgeIds);
+    }
+    else
+    {
+        timingGraph->propogateArrivalTime();
+        timingGraph->backPropogateRequiredArrivalTime();
+        timingGraph->updateCriticalPath();
     }
-
-    timingGraph->propogateArrivalTime();
-    timingGraph->backPropogateRequiredArrivalTime();
-    timingGraph->updateCriticalPath();
 
     auto resPath = timingGraph->backTraceDelayLongestPathFromNode(timingGraph->getCriticalEndPoint());
 
@@ -471,56 +477,109 @@ float PlacementTimingOptimizer::getSlackThr()
     return slackThr;
 }
 
-void PlacementTimingOptimizer::incrementalStaticTimingAnalysis_forPUWithLocation(PlacementInfo::PlacementUnit *curPU,
-                                                                                 float targetX, float targetY)
+void PlacementTimingOptimizer::updateEdgeDelays(std::vector<int> &changedEdgeIds)
 {
-    print_status("PlacementTimingOptimizer: conducting incremental Static Timing Analysis");
-
-    assert(timingInfo);
     auto timingGraph = timingInfo->getSimplePlacementTimingGraph();
-    setPinsLocation();
-
-    auto &pinLoc = placementInfo->getPinId2location();
-
     auto &edges = timingGraph->getEdges();
     int numEdges = edges.size();
+    std::vector<unsigned char> edgeChanged(numEdges, 0);
 
 #pragma omp parallel for
     for (int i = 0; i < numEdges; i++)
     {
-        auto edge = edges[i];
-        auto &pin1Loc = pinLoc[edge->getSourcePin()->getElementIdInType()];
-        auto &pin2Loc = pinLoc[edge->getSinkPin()->getElementIdInType()];
-        if (pin1Loc.X < -5 && pin1Loc.Y < -5)
-            continue;
-        if (pin2Loc.X < -5 && pin2Loc.Y < -5)
-            continue;
+        edgeChanged[i] = updateEdgeDelay(edges[i]);
+    }
 
-        edge->setDelay(getDelayByModel(edge->getSink(), edge->getSource(), pin1Loc.X, pin1Loc.Y, pin2Loc.X, pin2Loc.Y));
+    changedEdgeIds.clear();
+    for (int i = 0; i < numEdges; i++)
+    {
+        if (edgeChanged[i])
+            changedEdgeIds.push_back(i);
     }
+}
 
-    timingGraph->propogateArrivalTime();
-    timingGraph->backPropogateRequiredArrivalTime();
-    float maxDelay = 0;
-    int maxDelayId = -1;
-    for (unsigned int i = 0; i < timingGraph->getNodes().size(); i++)
+void PlacementTimingOptimizer::incrementalStaticTimingAnalysis_forPUWithLocation(PlacementInfo::PlacementUnit *curPU,
+                                                                                 float targetX, float targetY)
+{
+    assert(timingInfo);
+    auto timingGraph = timingInfo->getSimplePlacementTimingGraph();
+    auto &timingNodes = timingGraph->getNodes();
+    auto &cellLoc = placementInfo->getCellId2location();
+    auto &pinLoc = placementInfo->getPinId2location();
+    if (pinLoc.size() != designInfo->getPins().size())
+        setPinsLocation();
+
+    // move the cells in the PlacementUnit (and their pins) to the target location
+    std::vector<DesignInfo::DesignCell *> movedCells;
+    std::vector<PlacementInfo::Location> movedCellLocs;
+    if (auto curUnpackedCell = PlacementInfo::asUnpackedCell(curPU))
     {
-        if (timingGraph->getNodes()[i]->getLatestInputArrival() > maxDelay)
+        PlacementInfo::Location newLoc;
+        newLoc.X = targetX;
+        newLoc.Y = targetY;
+        movedCells.push_back(curUnpackedCell->getCell());
+        movedCellLocs.push_back(newLoc);
+    }
+    else if (auto curMacro = PlacementInfo::asMacro(curPU))
+    {
+        for (int vId = 0; vId < curMacro->getNumOfCells(); vId++)
         {
-            maxDelay = timingGraph->getNodes()[i]->getLatestInputArrival();
-            maxDelayId = i;
+            float offsetX_InMacro, offsetY_InMacro;
+            DesignInfo::DesignCellType cellType;
+            curMacro->getVirtualCellInfo(vId, offsetX_InMacro, offsetY_InMacro, cellType);
+            PlacementInfo::Location newLoc;
+            newLoc.X = targetX + offsetX_InMacro;
+            newLoc.Y = targetY + offsetY_InMacro;
+            movedCells.push_back(curMacro->getCell(vId));
+            movedCellLocs.push_back(newLoc);
         }
     }
 
-    auto resPath = timingGraph->backTraceDelayLongestPathFromNode(maxDelayId);
+    for (unsigned int i = 0; i < movedCells.size(); i++)
+    {
+        auto curCell = movedCells[i];
+        cellLoc[curCell->getCellId()] = movedCellLocs[i];
+        for (auto tmpPin : curCell->getPins())
+        {
+            pinLoc[tmpPin->getElementIdInType()].X = movedCellLocs[i].X + tmpPin->getOffsetXInCell();
+            pinLoc[tmpPin->getElementIdInType()].Y = movedCellLocs[i].Y + tmpPin->getOffsetYInCell();
+        }
+    }
 
-    std::cout << "An example of long delay path for the current placement:\n";
-    for (auto id : resPath)
+    if (!timingGraph->canPropogateIncrementally())
     {
-        std::cout << designInfo->getCells()[id]
-                  << "   [delay]: " << timingGraph->getNodes()[id]->getLatestInputArrival()
-                  << "   [required]: " << timingGraph->getNodes()[id]->getRequiredArrivalTime() << "\n";
+        std::vector<int> changedEdgeIds;
+        updateEdgeDelays(changedEdgeIds);
+        if (useCompactTimingGraph)
+        {
+            timingGraph->propogateTimingWithCompactGraph(&changedEdgeIds);
+        }
+        else
+        {
+            timingGraph->propogateArrivalTime();
+            timingGraph->backPropogateRequiredArrivalTime();
+            timingGraph->updateCriticalPath();
+        }
+        return;
+    }
+
+    // only the edges connected to the moved cells are changed (an edge between two moved cells is updated once)
+    std::vector<int> changedEdgeIds;
+    for (auto curCell : movedCells)
+    {
+        auto curNode = timingNodes[curCell->getCellId()];
+        for (auto inEdge : curNode->getInEdges())
+        {
+            if (updateEdgeDelay(inEdge))
+                changedEdgeIds.push_back(inEdge->getId());
+        }
+        for (auto outEdge : curNode->getOutEdges())
+        {
+            if (updateEdgeDelay(outEdge))
+                changedEdgeIds.push_back(outEdge->getId());
+        }
     }
+    timingGraph->incrementalPropogateTiming(changedEdgeIds);
 }
 
 void PlacementTimingOptimizer::clusterLongPathInOneClockRegion(int pathLenThr, float clusterThrRatio)
@@ -591,7 +650,7 @@ void PlacementTimingOptimizer::clusterLongPathInOneClockRegion(int pathLenThr, f
 
                     for (auto tmpPU : PUsInLongPaths)
                     {
-                        if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(tmpPU))
+                        if (auto unpackedCell = PlacementInfo::asUnpackedCell(tmpPU))
                         {
                             int cellId = unpackedCell->getCell()->getCellId();
                             int clockRegionX, clockRegionY;
@@ -615,7 +674,7 @@ void PlacementTimingOptimizer::clusterLongPathInOneClockRegion(int pathLenThr, f
                                 optClockLocYX = tmpClockLocYX;
                             }
                         }
-                        else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(tmpPU))
+                        else if (auto curMacro = PlacementInfo::asMacro(tmpPU))
                         {
                             for (auto tmpCell : curMacro->getCells())
                             {
@@ -673,13 +732,13 @@ void PlacementTimingOptimizer::clusterLongPathInOneClockRegion(int pathLenThr, f
                                 PU2ClockRegionCenter[curPU] = std::pair<float, float>(fX, fY);
                                 PU2ClockRegionColumn[curPU] = optClockLocYX.second;
 
-                                if (auto unpackedCell = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(curPU))
+                                if (auto unpackedCell = PlacementInfo::asUnpackedCell(curPU))
                                 {
                                     int cellId = unpackedCell->getCell()->getCellId();
                                     if (timingNodes[cellId]->getOutEdges().size() < fanoutThr)
                                         extractedCellIds.insert(cellId);
                                 }
-                                else if (auto curMacro = dynamic_cast<PlacementInfo::PlacementMacro *>(curPU))
+                                else if (auto curMacro = PlacementInfo::asMacro(curPU))
                                 {
                                     for (auto tmpCell : curMacro->getCells())
                                     {
@@ -859,16 +918,14 @@ void PlacementTimingOptimizer::dumpClockRegionClusters()
             outfile0 << "highlight -color_index " << (cluster_id) % 20 + 1 << "  [get_cells {";
             for (int id : clockRegionclusters[cluster_id])
             {
-                if (auto tmpMacro =
-                        dynamic_cast<PlacementInfo::PlacementMacro *>(placementInfo->getPlacementUnits()[id]))
+                if (auto tmpMacro = PlacementInfo::asMacro(placementInfo->getPlacementUnits()[id]))
                 {
                     for (auto cell : tmpMacro->getCells())
                     {
                         outfile0 << cell->getName() << " ";
                     }
                 }
-                else if (auto tmpUnpacked = dynamic_cast<PlacementInfo::PlacementUnpackedCell *>(
-                             placementInfo->getPlacementUnits()[id]))
+                else if (auto tmpUnpacked = PlacementInfo::asUnpackedCell(placementInfo->getPlacementUnits()[id]))
                 {
                     outfile0 << tmpUnpacked->getName() << " ";
                 }
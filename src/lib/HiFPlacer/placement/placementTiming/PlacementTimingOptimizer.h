@@ -58,6 +58,18 @@ class PlacementTimingOptimizer
                                                     std::vector<bool> &FFDirectlyDrivenButNotInOneSlot);
     float getWorstSlackOfCell(DesignInfo::DesignCell *srcCell);
     float conductStaticTimingAnalysis(bool enforeOptimisticTiming = false);
+
+    /**
+     * @brief move a PlacementUnit to the target location and incrementally update the timing
+     *
+     * Only the delays of the TimingEdges connected to the cells in the PlacementUnit are re-evaluated and the timing
+     * is re-propogated through their fan-in/fan-out cones. (If the timing has not been propogated yet, a complete
+     * analysis is conducted.)
+     *
+     * @param curPU the PlacementUnit to be moved
+     * @param targetX
+     * @param targetY
+     */
     void incrementalStaticTimingAnalysis_forPUWithLocation(PlacementInfo::PlacementUnit *curPU, float targetX,
                                                            float targetY);
     void setPinsLocation();
@@ -100,6 +112,32 @@ class PlacementTimingOptimizer
         effectFactor = _effectFactor;
     }
 
+    /**
+     * @brief record the states of the timing optimizer which should be restored when the placement flow is resumed
+     * from a checkpoint
+     *
+     * @param states named states
+     */
+    inline void getCheckpointStates(std::map<std::string, float> &states)
+    {
+        states["PlacementTimingOptimizer.STA_Cnt"] = STA_Cnt;
+        states["PlacementTimingOptimizer.effectFactor"] = effectFactor;
+        states["PlacementTimingOptimizer.clockRegionClusterTooLarge"] = clockRegionClusterTooLarge;
+    }
+
+    /**
+     * @brief restore the states of the timing optimizer recorded in a checkpoint
+     *
+     * @param states named states
+     */
+    inline void setCheckpointStates(std::map<std::string, float> &states)
+    {
+        assert(states.find("PlacementTimingOptimizer.STA_Cnt") != states.end());
+        STA_Cnt = std::round(states["PlacementTimingOptimizer.STA_Cnt"]);
+        effectFactor = states["PlacementTimingOptimizer.effectFactor"];
+        clockRegionClusterTooLarge = states["PlacementTimingOptimizer.clockRegionClusterTooLarge"] > 0.5;
+    }
+
     inline float getDelayByModel(PlacementTimingInfo::TimingGraph<DesignInfo::DesignCell>::TimingNode *node1,
                                  PlacementTimingInfo::TimingGraph<DesignInfo::DesignCell>::TimingNode *node2, float X1,
                                  float Y1, float X2, float Y2)
@@ -193,6 +231,36 @@ class PlacementTimingOptimizer
     }
 
   private:
+    /**
+     * @brief evaluate the delays of all the TimingEdges according to the pin locations and record the edges whose
+     * delays are changed
+     *
+     * @param changedEdgeIds output ids of the TimingEdges whose delays are changed
+     */
+    void updateEdgeDelays(std::vector<int> &changedEdgeIds);
+
+    /**
+     * @brief evaluate the delay of a TimingEdge according to the pin locations
+     *
+     * @param edge
+     * @return true if the delay is changed
+     */
+    inline bool updateEdgeDelay(PlacementTimingInfo::TimingGraph<DesignInfo::DesignCell>::TimingEdge *edge)
+    {
+        auto &pinLoc = placementInfo->getPinId2location();
+        auto &pin1Loc = pinLoc[edge->getSourcePin()->getElementIdInType()];
+        auto &pin2Loc = pinLoc[edge->getSinkPin()->getElementIdInType()];
+        if (pin1Loc.X < -5 && pin1Loc.Y < -5)
+            return false;
+        if (pin2Loc.X < -5 && pin2Loc.Y < -5)
+            return false;
+        float newDelay = getDelayByModel(edge->getSink(), edge->getSource(), pin1Loc.X, pin1Loc.Y, pin2Loc.X, pin2Loc.Y);
+        if (newDelay == edge->getDelay())
+            return false;
+        edge->setDelay(newDelay);
+        return true;
+    }
+
     PlacementInfo *placementInfo = nullptr;
     PlacementTimingInfo *timingInfo = nullptr;
     DesignInfo *designInfo;
@@ -224,6 +292,19 @@ class PlacementTimingOptimizer
     std::vector<float> PUId2Slack;
     bool increaseLowDelayVal = false;
     bool enableCounter = true;
+
+    /**
+     * @brief if the ratio of the TimingEdges with changed delays is lower than this threshold, the timing is updated
+     * incrementally instead of being re-propogated through the entire timing graph
+     *
+     */
+    float incrementalSTAChangedEdgeRatioThr = 0.1;
+
+    /**
+     * @brief propogate the timing with the compact (CSR) copy of the timing graph instead of the TimingNode objects
+     *
+     */
+    bool useCompactTimingGraph = true;
 };
 
 #endif
\ No newline at end of file
@@ -23,7 +23,10 @@
  */
 
 #include "GraphPartitioner.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <omp.h>
 #include <string>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -38,7 +41,12 @@ void GraphPartitioner<NodeList, NetList>::solve(int eachClusterDSPNum, int eachC
     {
         inputCluster.push_back(i);
     }
+
+    // the recursive bi-partitioning tasks are executed by a pool of worker threads
+#pragma omp parallel num_threads(std::max(jobs, 1))
+#pragma omp single
     recursiveMinCutPartition(inputCluster, this, eachClusterDSPNum, eachClusterBRAMNum);
+
     sortClustersBySize();
 }
 
@@ -69,10 +77,8 @@ void GraphPartitioner<NodeList, NetList>::recursiveMinCutPartition(
 
     std::array<std::vector<int>, 2> outputClusters;
 
-    sem_wait(&graphPartitioner->partitionSem);
     int cut = graphPartitioner->minCutBipartition(inputCluster, outputClusters, graphPartitioner, eachClusterDSPNum,
                                                   eachClusterBRAMNum);
-    sem_post(&graphPartitioner->partitionSem);
 
     if (cut == 0)
     {
@@ -90,12 +96,11 @@ void GraphPartitioner<NodeList, NetList>::recursiveMinCutPartition(
     }
     assert(outputClusters[0].size() > 0 && outputClusters[1].size() > 0);
 
-    std::thread t1(recursiveMinCutPartition, std::ref(outputClusters[0]), std::ref(graphPartitioner),
-                   std::ref(eachClusterDSPNum), std::ref(eachClusterBRAMNum));
-    std::thread t2(recursiveMinCutPartition, std::ref(outputClusters[1]), std::ref(graphPartitioner),
-                   std::ref(eachClusterDSPNum), std::ref(eachClusterBRAMNum));
-    t1.join();
-    t2.join();
+#pragma omp task shared(outputClusters)
+    recursiveMinCutPartition(outputClusters[0], graphPartitioner, eachClusterDSPNum, eachClusterBRAMNum);
+#pragma omp task shared(outputClusters)
+    recursiveMinCutPartition(outputClusters[1], graphPartitioner, eachClusterDSPNum, eachClusterBRAMNum);
+#pragma omp taskwait
 }
 
 inline bool checkFileExist(const std::string &name)
@@ -185,52 +190,15 @@ unsigned GraphPartitioner<NodeList, NetList>::minCutBipartition(const std::vecto
         }
     }
 
-    unsigned int shareMemorySize = 6 + numHyperNodes + numPlacementNets + 1 + numPlacementPins + numHyperNodes + 2;
-
-    std::string targetPath = getExePath() + "/partitionHyperGraph";
-
-    if (!checkFileExist(targetPath))
-        targetPath = getExePath() + "/partitionHyperGraph";
-    if (!checkFileExist(targetPath))
-        targetPath = getExePath() + "/partitionHyperGraph";
-
-    if (!checkFileExist(targetPath))
-    {
-        std::cout << "try to find [" << targetPath << "] but not found.\n";
-        assert(false && "target partitioning process executable should be found!");
-    }
-
-    ExternalProcessFunc *externalProc =
-        new ExternalProcessFunc(targetPath, shareMemorySize * 4, graphPartitioner->verbose);
-    int *shareMemory = (int *)externalProc->getSharedMemory();
-    shareMemory[0] = numHyperNodes;
-    shareMemory[1] = numPlacementNets;
-    shareMemory[2] = numPlacementPins;
+    int maxCut = maxCutRate * numPlacementNets;
     double final_imbal = std::max(0.5 - double(minCellClusterSize) / totalWeight, 0.4);
-    *(double *)(shareMemory + 3) = final_imbal;
-    int *cut = shareMemory + 5;
-    int *cwghts = shareMemory + 6;
-    int *xpins = cwghts + numHyperNodes;
-    int *pins = xpins + numPlacementNets + 1;
-    int *partvec = pins + numPlacementPins;
-    int *partweights = partvec + numHyperNodes;
-
-    int *hyperNode2placementUnit = new int[numHyperNodes];
+
+    std::vector<int> hyperNode2placementUnit(numHyperNodes);
     for (auto instId : inputCluster)
         hyperNode2placementUnit[placementUnit2hyperNode[instId]] = instId;
 
-    for (int i = 0; i < numHyperNodes; ++i)
-    {
-        assert((unsigned int)hyperNode2placementUnit[i] < graphPartitioner->nodeList.size());
-        cwghts[i] = graphPartitioner->nodeList[hyperNode2placementUnit[i]]->getWeight();
-        partvec[i] = -1;
-    }
-
-    // map placement nets to hypernet for PaToH
-
-    int maxCut = maxCutRate * numPlacementNets;
-
-    // hyper net to hyper nodes
+    // map placement nets to hypernets (CSR format: the pins of net i are pins[xpins[i], xpins[i+1]))
+    std::vector<int> xpins(numPlacementNets + 1), pins(numPlacementPins);
     xpins[0] = 0;
     int indexNet = 0, indexPin = 0;
     for (auto net : graphPartitioner->netList)
@@ -245,8 +213,73 @@ unsigned GraphPartitioner<NodeList, NetList>::minCutBipartition(const std::vecto
     }
     assert(indexPin == numPlacementPins && indexNet == numPlacementNets);
 
-    // call external process to execute
-    externalProc->execute();
+    std::vector<int> cwghts(numHyperNodes), DSPNums(numHyperNodes), BRAMNums(numHyperNodes);
+    for (int i = 0; i < numHyperNodes; ++i)
+    {
+        assert((unsigned int)hyperNode2placementUnit[i] < graphPartitioner->nodeList.size());
+        cwghts[i] = graphPartitioner->nodeList[hyperNode2placementUnit[i]]->getWeight();
+        DSPNums[i] = graphPartitioner->nodeList[hyperNode2placementUnit[i]]->getDSPNum();
+        BRAMNums[i] = graphPartitioner->nodeList[hyperNode2placementUnit[i]]->getBRAMNum();
+    }
+
+    std::vector<int> partvec(numHyperNodes, -1);
+    std::vector<int> partweights(2, 0);
+    int cut = 0;
+    if (!graphPartitioner->useExternalPartitioner)
+    {
+        // the DSPs/BRAMs are balanced as well if they exceed the limitation of a cluster
+        // the random stream is identified by the cluster to partition, independent of the scheduling of the tasks
+        HypergraphBipartitioner bipartitioner(numHyperNodes, xpins, pins, graphPartitioner->randomSeed,
+                                              *std::min_element(inputCluster.begin(), inputCluster.end()));
+        bipartitioner.addBalanceConstraint(cwghts, std::ceil((1 + final_imbal) * 0.5 * totalWeight));
+        double resourceImbal = std::min(final_imbal, 0.2);
+        if (totalDSPNum > eachClusterDSPNum)
+            bipartitioner.addBalanceConstraint(DSPNums, std::ceil((1 + resourceImbal) * 0.5 * totalDSPNum));
+        if (totalBRAMNum > eachClusterBRAMNum)
+            bipartitioner.addBalanceConstraint(BRAMNums, std::ceil((1 + resourceImbal) * 0.5 * totalBRAMNum));
+        cut = bipartitioner.solve(partvec, partweights);
+    }
+    else
+    {
+#ifdef MULTIPROCESS_PARITION
+        unsigned int shareMemorySize = 6 + numHyperNodes + numPlacementNets + 1 + numPlacementPins + numHyperNodes + 2;
+
+        std::string targetPath = getExePath() + "/partitionHyperGraph";
+        if (!checkFileExist(targetPath))
+        {
+            std::cout << "try to find [" << targetPath << "] but not found.\n";
+            assert(false && "target partitioning process executable should be found!");
+        }
+
+        ExternalProcessFunc *externalProc =
+            new ExternalProcessFunc(targetPath, shareMemorySize * 4, graphPartitioner->verbose);
+        int *shareMemory = (int *)externalProc->getSharedMemory();
+        shareMemory[0] = numHyperNodes;
+        shareMemory[1] = numPlacementNets;
+        shareMemory[2] = numPlacementPins;
+        *(double *)(shareMemory + 3) = final_imbal;
+        int *shmCut = shareMemory + 5;
+        int *shmCwghts = shareMemory + 6;
+        int *shmXpins = shmCwghts + numHyperNodes;
+        int *shmPins = shmXpins + numPlacementNets + 1;
+        int *shmPartvec = shmPins + numPlacementPins;
+        int *shmPartweights = shmPartvec + numHyperNodes;
+        std::copy(cwghts.begin(), cwghts.end(), shmCwghts);
+        std::copy(xpins.begin(), xpins.end(), shmXpins);
+        std::copy(pins.begin(), pins.end(), shmPins);
+        std::copy(partvec.begin(), partvec.end(), shmPartvec);
+
+        // call external process to execute
+        externalProc->execute();
+
+        std::copy(shmPartvec, shmPartvec + numHyperNodes, partvec.begin());
+        std::copy(shmPartweights, shmPartweights + 2, partweights.begin());
+        cut = *shmCut;
+        delete externalProc;
+#else
+        assert(false && "the external partitioner is not enabled (MULTIPROCESS_PARITION is not defined)");
+#endif
+    }
 
     // Postprocessing
     for (int i = 0; i < numHyperNodes; ++i)
@@ -263,7 +296,7 @@ unsigned GraphPartitioner<NodeList, NetList>::minCutBipartition(const std::vecto
     double imbal = 0.5 - double(minClusterTotalWeight) / totalWeight;
 
     graphPartitioner->cntLock.lock();
-    if ((*cut > maxCut || ((float)outputClusters[0].size() / (float)outputClusters[1].size() < 0.666) ||
+    if ((cut > maxCut || ((float)outputClusters[0].size() / (float)outputClusters[1].size() < 0.666) ||
          ((float)outputClusters[1].size() / (float)outputClusters[0].size() < 0.666)) &&
         (minCellClusterSize * 1.25 > totalWeight && totalDSPNum <= 3 * eachClusterDSPNum &&
          totalBRAMNum <= 3 * eachClusterBRAMNum))
@@ -271,7 +304,7 @@ unsigned GraphPartitioner<NodeList, NetList>::minCutBipartition(const std::vecto
         // if (graphPartitioner->verbose)
         print_warning("partitioned iter#" + std::to_string(cnt) + " #node: " + std::to_string(numHyperNodes) +
                       " #net: " + std::to_string(numPlacementNets) + " max_cut: " + std::to_string(maxCut) +
-                      " max_imbal: " + std::to_string(final_imbal) + " get too large cut: " + std::to_string(*cut) +
+                      " max_imbal: " + std::to_string(final_imbal) + " get too large cut: " + std::to_string(cut) +
                       " failed to find cut meeting requirements of min-cut or size balance. cluster[0].size=" +
                       std::to_string(outputClusters[0].size()) +
                       " cluster[1].size=" + std::to_string(outputClusters[1].size()));
@@ -285,7 +318,7 @@ unsigned GraphPartitioner<NodeList, NetList>::minCutBipartition(const std::vecto
                        " #net: " + std::to_string(numPlacementNets) + " max_cut: " + std::to_string(maxCut) +
                        " max_imbal: " + std::to_string(final_imbal) + " succeed with " +
                        std::to_string(partweights[0]) + " and " + std::to_string(partweights[1]) +
-                       " (cut: " + std::to_string(*cut) + ", imbal: " + std::to_string(imbal) + ")" +
+                       " (cut: " + std::to_string(cut) + ", imbal: " + std::to_string(imbal) + ")" +
                        "cluster[0].size=" + std::to_string(outputClusters[0].size()) +
                        " cluster[1].size=" + std::to_string(outputClusters[1].size()));
     }
@@ -293,11 +326,7 @@ unsigned GraphPartitioner<NodeList, NetList>::minCutBipartition(const std::vecto
     ++cnt;
     graphPartitioner->cntLock.unlock();
 
-    int res = *cut;
-    delete[] hyperNode2placementUnit;
-    delete externalProc;
-
-    return res;
+    return cut;
 }
 
 // declare involved templates
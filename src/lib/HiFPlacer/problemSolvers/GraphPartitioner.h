@@ -25,6 +25,7 @@
 #ifndef _GRAPHPARTITIONER
 #define _GRAPHPARTITIONER
 
+#include "HypergraphBipartitioner.h"
 #include "PlacementInfo.h"
 #include "sysInfo.h"
 #include <assert.h>
@@ -32,11 +33,9 @@
 #include <iostream>
 #include <map>
 #include <mutex>
-#include <semaphore.h>
 #include <set>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <vector>
 
 #define MULTIPROCESS_PARITION
@@ -45,6 +44,10 @@
  * @brief GraphPartitioner will recursively bi-partition the netlist (which could be netlist of clusters) based on
  * connectivitity and the net weights
  *
+ * By default, each bi-partitioning is conducted in-process by HypergraphBipartitioner and the recursive bi-partitioning
+ * tasks are executed by a pool of worker threads. The external PaToH-based executable (partitionHyperGraph) can still
+ * be used if MULTIPROCESS_PARITION is defined.
+ *
  * @tparam NodeList given node list type
  * @tparam NetList given net list type
  */
@@ -61,11 +64,8 @@ template <class NodeList, class NetList> class GraphPartitioner
      * @param verbose whether dumps detailed information
      */
     GraphPartitioner(NodeList &nodeList, NetList &netList, int minClusterCellNum, int jobs, bool verbose)
-        : nodeList(nodeList), netList(netList), minClusterCellNum(minClusterCellNum), verbose(verbose)
+        : nodeList(nodeList), netList(netList), minClusterCellNum(minClusterCellNum), jobs(jobs), verbose(verbose)
     {
-        sem_init(&partitionSem, 0, 0);
-        for (int tid = 0; tid < jobs; tid++)
-            sem_post(&partitionSem);
     }
 
     ~GraphPartitioner()
@@ -150,6 +150,27 @@ template <class NodeList, class NetList> class GraphPartitioner
         maxCutRate = _maxCutRate;
     }
 
+    /**
+     * @brief Set whether the bi-partitioning is conducted by the external PaToH-based executable (partitionHyperGraph)
+     * instead of the in-process HypergraphBipartitioner
+     *
+     * @param _useExternalPartitioner
+     */
+    void setUseExternalPartitioner(bool _useExternalPartitioner)
+    {
+        useExternalPartitioner = _useExternalPartitioner;
+    }
+
+    /**
+     * @brief Set the seed of the random streams of the bi-partitioning tasks
+     *
+     * @param _randomSeed
+     */
+    void setRandomSeed(uint64_t _randomSeed)
+    {
+        randomSeed = _randomSeed;
+    }
+
   private:
     /**
      * @brief the resultant clusters (vectors) after partitioning
@@ -163,11 +184,6 @@ template <class NodeList, class NetList> class GraphPartitioner
      */
     std::vector<std::set<int>> ClusterPUIdSets;
 
-    /**
-     * @brief used to limit the number of processes for the parallel partitioning
-     *
-     */
-    sem_t partitionSem;
     std::mutex clustersLock, cntLock;
 
     double maxCutRate = 0.0333;
@@ -176,6 +192,16 @@ template <class NodeList, class NetList> class GraphPartitioner
     NetList &netList;
     unsigned int minClusterCellNum;
 
+    /**
+     * @brief the number of worker threads for the parallel partitioning tasks
+     *
+     */
+    int jobs;
+
+    bool useExternalPartitioner = false;
+
+    uint64_t randomSeed = RandomStream::defaultSeed;
+
     /**
      * @brief sort clusters by sizes to fix the output clusters' order for later processing and avoid the random factor
      * due to the multi-process procedure
@@ -0,0 +1,549 @@
+/**
+ * @file HypergraphBipartitioner.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the HypergraphBipartitioner which bi-partitions a
+ * hypergraph with multilevel min-cut method.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "HypergraphBipartitioner.h"
+
+#include <algorithm>
+#include <numeric>
+#include <queue>
+
+HypergraphBipartitioner::HypergraphBipartitioner(int numNodes, const std::vector<int> &xpins,
+                                                 const std::vector<int> &pins, uint64_t seed, uint64_t streamId)
+    : rng(seed, streamId, RandomStream::StreamDomain_HypergraphBipartitioner)
+{
+    assert(xpins.size() > 0);
+    levels.resize(1);
+    Level &level = levels[0];
+    level.numNodes = numNodes;
+
+    // remove the duplicated pins and the nets which can never be cut
+    std::vector<int> netPins;
+    level.xpins.push_back(0);
+    for (unsigned int netId = 0; netId + 1 < xpins.size(); netId++)
+    {
+        netPins.assign(pins.begin() + xpins[netId], pins.begin() + xpins[netId + 1]);
+        std::sort(netPins.begin(), netPins.end());
+        netPins.erase(std::unique(netPins.begin(), netPins.end()), netPins.end());
+        if (netPins.size() < 2)
+            continue;
+        level.pins.insert(level.pins.end(), netPins.begin(), netPins.end());
+        level.xpins.push_back(level.pins.size());
+    }
+    level.numNets = level.xpins.size() - 1;
+    level.netWeights.assign(level.numNets, 1);
+}
+
+void HypergraphBipartitioner::addBalanceConstraint(const std::vector<int> &nodeWeights, int maxPartWeight)
+{
+    Level &level = levels[0];
+    assert(nodeWeights.size() == (unsigned int)level.numNodes);
+    assert(levels.size() == 1);
+
+    std::vector<int> oriNodeWeights = level.nodeWeights;
+    level.nodeWeights.resize(level.numNodes * (numConstraints + 1));
+    long long totalWeight = 0;
+    for (int nodeId = 0; nodeId < level.numNodes; nodeId++)
+    {
+        for (int k = 0; k < numConstraints; k++)
+            level.nodeWeights[nodeId * (numConstraints + 1) + k] = oriNodeWeights[nodeId * numConstraints + k];
+        level.nodeWeights[nodeId * (numConstraints + 1) + numConstraints] = nodeWeights[nodeId];
+        totalWeight += nodeWeights[nodeId];
+    }
+    numConstraints++;
+    totalWeights.push_back(totalWeight);
+    maxPartWeights.push_back(maxPartWeight);
+}
+
+int HypergraphBipartitioner::solve(std::vector<int> &partition, std::vector<int> &partWeights)
+{
+    assert(numConstraints > 0 && "the primary node weight should be set before partitioning");
+    levels.resize(1);
+    buildIncidence(levels[0]);
+
+    while (levels.back().numNodes > coarsestNodeNum && levels.size() < 32)
+    {
+        Level coarse;
+        coarsen(levels.back(), coarse);
+        if (coarse.numNodes > 0.9 * levels.back().numNodes)
+            break;
+        buildIncidence(coarse);
+        levels.push_back(std::move(coarse));
+    }
+
+    std::vector<int> coarsePartition;
+    initialPartition(levels.back(), coarsePartition);
+
+    // uncoarsening: project the partition to the finer level and refine it
+    for (int levelId = levels.size() - 1; levelId > 0; levelId--)
+    {
+        Level &fine = levels[levelId - 1];
+        Level &coarse = levels[levelId];
+        partition.resize(fine.numNodes);
+        for (int nodeId = 0; nodeId < fine.numNodes; nodeId++)
+            partition[nodeId] = coarsePartition[coarse.fineNode2CoarseNode[nodeId]];
+        refine(fine, partition, 4);
+        coarsePartition.swap(partition);
+    }
+    partition.swap(coarsePartition);
+
+    partWeights.assign(2, 0);
+    for (int nodeId = 0; nodeId < levels[0].numNodes; nodeId++)
+        partWeights[partition[nodeId]] += levels[0].nodeWeights[nodeId * numConstraints];
+
+    return getCut(levels[0], partition);
+}
+
+void HypergraphBipartitioner::buildIncidence(Level &level)
+{
+    level.xnets.assign(level.numNodes + 1, 0);
+    for (auto nodeId : level.pins)
+        level.xnets[nodeId + 1]++;
+    for (int nodeId = 0; nodeId < level.numNodes; nodeId++)
+        level.xnets[nodeId + 1] += level.xnets[nodeId];
+    level.nets.resize(level.pins.size());
+    std::vector<int> fillPos(level.xnets.begin(), level.xnets.end() - 1);
+    for (int netId = 0; netId < level.numNets; netId++)
+    {
+        for (int pinId = level.xpins[netId]; pinId < level.xpins[netId + 1]; pinId++)
+            level.nets[fillPos[level.pins[pinId]]++] = netId;
+    }
+}
+
+void HypergraphBipartitioner::coarsen(Level &fine, Level &coarse)
+{
+    int numNodes = fine.numNodes;
+
+    // the coarse nodes should be small enough so the balance can be achieved
+    std::vector<long long> weightCaps(numConstraints);
+    weightCaps[0] = std::max(1LL, totalWeights[0] / 100);
+    for (int k = 1; k < numConstraints; k++)
+        weightCaps[k] = std::max(1LL, maxPartWeights[k] / 4);
+    auto canMerge = [&](int nodeA, int nodeB) -> bool {
+        for (int k = 0; k < numConstraints; k++)
+        {
+            int weightA = fine.nodeWeights[nodeA * numConstraints + k];
+            int weightB = fine.nodeWeights[nodeB * numConstraints + k];
+            if (weightA + weightB <= weightCaps[k])
+                continue;
+            if (k > 0 && (weightA == 0 || weightB == 0))
+                continue;
+            return false;
+        }
+        return true;
+    };
+
+    // heavy-edge matching: the rating between two nodes is sum(w(e) / (|e| - 1)) of their common nets
+    std::vector<int> order(numNodes);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    std::vector<int> match(numNodes, -1);
+    std::vector<double> rating(numNodes, 0);
+    std::vector<int> touchedNodes;
+    for (auto nodeId : order)
+    {
+        if (match[nodeId] >= 0)
+            continue;
+        for (int i = fine.xnets[nodeId]; i < fine.xnets[nodeId + 1]; i++)
+        {
+            int netId = fine.nets[i];
+            int netSize = fine.xpins[netId + 1] - fine.xpins[netId];
+            if (netSize > matchingNetSizeThr)
+                continue;
+            double netRating = (double)fine.netWeights[netId] / (netSize - 1);
+            for (int pinId = fine.xpins[netId]; pinId < fine.xpins[netId + 1]; pinId++)
+            {
+                int neighborId = fine.pins[pinId];
+                if (neighborId == nodeId || match[neighborId] >= 0)
+                    continue;
+                if (rating[neighborId] == 0)
+                    touchedNodes.push_back(neighborId);
+                rating[neighborId] += netRating;
+            }
+        }
+        int bestNeighborId = -1;
+        double bestRating = 0;
+        for (auto neighborId : touchedNodes)
+        {
+            if (rating[neighborId] > bestRating && canMerge(nodeId, neighborId))
+            {
+                bestRating = rating[neighborId];
+                bestNeighborId = neighborId;
+            }
+            rating[neighborId] = 0;
+        }
+        touchedNodes.clear();
+        if (bestNeighborId >= 0)
+        {
+            match[nodeId] = bestNeighborId;
+            match[bestNeighborId] = nodeId;
+        }
+        else
+        {
+            match[nodeId] = nodeId;
+        }
+    }
+
+    // contract the matched nodes
+    coarse.fineNode2CoarseNode.assign(numNodes, -1);
+    coarse.numNodes = 0;
+    for (int nodeId = 0; nodeId < numNodes; nodeId++)
+    {
+        if (coarse.fineNode2CoarseNode[nodeId] >= 0)
+            continue;
+        coarse.fineNode2CoarseNode[nodeId] = coarse.numNodes;
+        coarse.fineNode2CoarseNode[match[nodeId]] = coarse.numNodes;
+        coarse.numNodes++;
+    }
+    coarse.nodeWeights.assign(coarse.numNodes * numConstraints, 0);
+    for (int nodeId = 0; nodeId < numNodes; nodeId++)
+    {
+        int coarseNodeId = coarse.fineNode2CoarseNode[nodeId];
+        for (int k = 0; k < numConstraints; k++)
+            coarse.nodeWeights[coarseNodeId * numConstraints + k] += fine.nodeWeights[nodeId * numConstraints + k];
+    }
+
+    // contract the nets and remove those inside a coarse node
+    std::vector<int> tmpXpins(1, 0), tmpPins, tmpNetWeights;
+    std::vector<int> netPins;
+    for (int netId = 0; netId < fine.numNets; netId++)
+    {
+        netPins.clear();
+        for (int pinId = fine.xpins[netId]; pinId < fine.xpins[netId + 1]; pinId++)
+            netPins.push_back(coarse.fineNode2CoarseNode[fine.pins[pinId]]);
+        std::sort(netPins.begin(), netPins.end());
+        netPins.erase(std::unique(netPins.begin(), netPins.end()), netPins.end());
+        if (netPins.size() < 2)
+            continue;
+        tmpPins.insert(tmpPins.end(), netPins.begin(), netPins.end());
+        tmpXpins.push_back(tmpPins.size());
+        tmpNetWeights.push_back(fine.netWeights[netId]);
+    }
+
+    // merge the identical nets by accumulating their weights
+    int tmpNetNum = tmpNetWeights.size();
+    std::vector<int> netOrder(tmpNetNum);
+    std::iota(netOrder.begin(), netOrder.end(), 0);
+    auto netLess = [&](int netA, int netB) -> bool {
+        int sizeA = tmpXpins[netA + 1] - tmpXpins[netA];
+        int sizeB = tmpXpins[netB + 1] - tmpXpins[netB];
+        if (sizeA != sizeB)
+            return sizeA < sizeB;
+        return std::lexicographical_compare(tmpPins.begin() + tmpXpins[netA], tmpPins.begin() + tmpXpins[netA + 1],
+                                            tmpPins.begin() + tmpXpins[netB], tmpPins.begin() + tmpXpins[netB + 1]);
+    };
+    std::sort(netOrder.begin(), netOrder.end(), netLess);
+
+    coarse.xpins.assign(1, 0);
+    coarse.pins.clear();
+    coarse.netWeights.clear();
+    for (int i = 0; i < tmpNetNum; i++)
+    {
+        int netId = netOrder[i];
+        if (i > 0 && !netLess(netOrder[i - 1], netId))
+        {
+            coarse.netWeights.back() += tmpNetWeights[netId];
+            continue;
+        }
+        coarse.pins.insert(coarse.pins.end(), tmpPins.begin() + tmpXpins[netId], tmpPins.begin() + tmpXpins[netId + 1]);
+        coarse.xpins.push_back(coarse.pins.size());
+        coarse.netWeights.push_back(tmpNetWeights[netId]);
+    }
+    coarse.numNets = coarse.netWeights.size();
+}
+
+void HypergraphBipartitioner::initialPartition(Level &level, std::vector<int> &partition)
+{
+    int numNodes = level.numNodes;
+    double bestViolation = 0;
+    int bestCut = -1;
+    std::vector<int> curPartition;
+    std::vector<char> visited;
+    std::vector<long long> partWeights(2 * numConstraints);
+    std::vector<int> seeds(numNodes);
+    std::iota(seeds.begin(), seeds.end(), 0);
+
+    for (int trial = 0; trial < initialPartitionTrialNum; trial++)
+    {
+        // greedy graph growing: part 0 is grown from a random seed in BFS order until it reaches half of the weight
+        std::shuffle(seeds.begin(), seeds.end(), rng);
+        curPartition.assign(numNodes, 1);
+        visited.assign(numNodes, 0);
+        for (int k = 0; k < numConstraints; k++)
+        {
+            partWeights[k] = 0;
+            partWeights[numConstraints + k] = totalWeights[k];
+        }
+
+        std::queue<int> nodeQueue;
+        unsigned int seedPos = 0;
+        while (partWeights[0] * 2 < totalWeights[0])
+        {
+            if (nodeQueue.empty())
+            {
+                while (seedPos < seeds.size() && visited[seeds[seedPos]])
+                    seedPos++;
+                if (seedPos >= seeds.size())
+                    break;
+                visited[seeds[seedPos]] = 1;
+                nodeQueue.push(seeds[seedPos]);
+            }
+            int nodeId = nodeQueue.front();
+            nodeQueue.pop();
+
+            bool exceedResource = false;
+            for (int k = 1; k < numConstraints; k++)
+            {
+                int weight = level.nodeWeights[nodeId * numConstraints + k];
+                if (weight > 0 && partWeights[k] + weight > maxPartWeights[k])
+                    exceedResource = true;
+            }
+            if (!exceedResource)
+            {
+                curPartition[nodeId] = 0;
+                for (int k = 0; k < numConstraints; k++)
+                {
+                    partWeights[k] += level.nodeWeights[nodeId * numConstraints + k];
+                    partWeights[numConstraints + k] -= level.nodeWeights[nodeId * numConstraints + k];
+                }
+            }
+
+            for (int i = level.xnets[nodeId]; i < level.xnets[nodeId + 1]; i++)
+            {
+                int netId = level.nets[i];
+                if (level.xpins[netId + 1] - level.xpins[netId] > matchingNetSizeThr)
+                    continue;
+                for (int pinId = level.xpins[netId]; pinId < level.xpins[netId + 1]; pinId++)
+                {
+                    int neighborId = level.pins[pinId];
+                    if (!visited[neighborId])
+                    {
+                        visited[neighborId] = 1;
+                        nodeQueue.push(neighborId);
+                    }
+                }
+            }
+        }
+
+        int cut = refine(level, curPartition, 8);
+        for (int k = 0; k < 2 * numConstraints; k++)
+            partWeights[k] = 0;
+        for (int nodeId = 0; nodeId < numNodes; nodeId++)
+        {
+            for (int k = 0; k < numConstraints; k++)
+                partWeights[curPartition[nodeId] * numConstraints + k] +=
+                    level.nodeWeights[nodeId * numConstraints + k];
+        }
+        double violation = getViolation(partWeights);
+        if (bestCut < 0 || violation < bestViolation || (violation == bestViolation && cut < bestCut))
+        {
+            bestViolation = violation;
+            bestCut = cut;
+            partition = curPartition;
+        }
+    }
+}
+
+int HypergraphBipartitioner::refine(Level &level, std::vector<int> &partition, int maxPassNum)
+{
+    int numNodes = level.numNodes;
+    int numNets = level.numNets;
+
+    // pinCount[p * numNets + e] is the number of pins of net e in part p
+    std::vector<int> pinCount(2 * numNets, 0);
+    std::vector<long long> partWeights(2 * numConstraints, 0);
+    for (int nodeId = 0; nodeId < numNodes; nodeId++)
+    {
+        for (int k = 0; k < numConstraints; k++)
+            partWeights[partition[nodeId] * numConstraints + k] += level.nodeWeights[nodeId * numConstraints + k];
+    }
+    for (int netId = 0; netId < numNets; netId++)
+    {
+        for (int pinId = level.xpins[netId]; pinId < level.xpins[netId + 1]; pinId++)
+            pinCount[partition[level.pins[pinId]] * numNets + netId]++;
+    }
+    int cut = getCut(level, partition);
+
+    std::vector<int> gains(numNodes);
+    std::vector<char> locked(numNodes);
+    std::vector<int> moves;
+    int noImprovementLimit = std::max(100, numNodes / 20);
+
+    auto moveNode = [&](int nodeId, int toPart) {
+        int fromPart = 1 - toPart;
+        partition[nodeId] = toPart;
+        for (int k = 0; k < numConstraints; k++)
+        {
+            partWeights[fromPart * numConstraints + k] -= level.nodeWeights[nodeId * numConstraints + k];
+            partWeights[toPart * numConstraints + k] += level.nodeWeights[nodeId * numConstraints + k];
+        }
+        for (int i = level.xnets[nodeId]; i < level.xnets[nodeId + 1]; i++)
+        {
+            int netId = level.nets[i];
+            pinCount[fromPart * numNets + netId]--;
+            pinCount[toPart * numNets + netId]++;
+        }
+    };
+
+    for (int pass = 0; pass < maxPassNum; pass++)
+    {
+        // gain of moving a node: the weights of the nets which become uncut - the weights of those which become cut
+        typedef std::pair<int, int> GainNodePair;
+        std::priority_queue<GainNodePair> gainQueue;
+        for (int nodeId = 0; nodeId < numNodes; nodeId++)
+        {
+            int fromPart = partition[nodeId];
+            int gain = 0;
+            for (int i = level.xnets[nodeId]; i < level.xnets[nodeId + 1]; i++)
+            {
+                int netId = level.nets[i];
+                if (pinCount[fromPart * numNets + netId] == 1)
+                    gain += level.netWeights[netId];
+                if (pinCount[(1 - fromPart) * numNets + netId] == 0)
+                    gain -= level.netWeights[netId];
+            }
+            gains[nodeId] = gain;
+            gainQueue.emplace(gain, nodeId);
+        }
+        locked.assign(numNodes, 0);
+        moves.clear();
+
+        double bestViolation = getViolation(partWeights);
+        int bestCut = cut;
+        int curCut = cut;
+        unsigned int bestMoveNum = 0;
+        int noImprovementCnt = 0;
+
+        while (!gainQueue.empty())
+        {
+            GainNodePair top = gainQueue.top();
+            gainQueue.pop();
+            int nodeId = top.second;
+            if (locked[nodeId] || top.first != gains[nodeId])
+                continue;
+            locked[nodeId] = 1;
+
+            int fromPart = partition[nodeId];
+            int toPart = 1 - fromPart;
+            bool feasible = true;
+            for (int k = 0; k < numConstraints; k++)
+            {
+                int weight = level.nodeWeights[nodeId * numConstraints + k];
+                if (weight > 0 && partWeights[toPart * numConstraints + k] + weight > maxPartWeights[k])
+                    feasible = false;
+            }
+            if (!feasible)
+                continue;
+
+            // update the gains of the free neighbors (the moved node is locked so it is skipped)
+            for (int i = level.xnets[nodeId]; i < level.xnets[nodeId + 1]; i++)
+            {
+                int netId = level.nets[i];
+                int netWeight = level.netWeights[netId];
+                int fromCnt = pinCount[fromPart * numNets + netId];
+                int toCnt = pinCount[toPart * numNets + netId];
+                if (toCnt <= 1 || fromCnt <= 2)
+                {
+                    for (int pinId = level.xpins[netId]; pinId < level.xpins[netId + 1]; pinId++)
+                    {
+                        int neighborId = level.pins[pinId];
+                        if (locked[neighborId])
+                            continue;
+                        int delta = 0;
+                        if (toCnt == 0)
+                            delta += netWeight;
+                        else if (toCnt == 1 && partition[neighborId] == toPart)
+                            delta -= netWeight;
+                        if (fromCnt == 1)
+                            delta -= netWeight;
+                        else if (fromCnt == 2 && partition[neighborId] == fromPart)
+                            delta += netWeight;
+                        if (delta != 0)
+                        {
+                            gains[neighborId] += delta;
+                            gainQueue.emplace(gains[neighborId], neighborId);
+                        }
+                    }
+                }
+            }
+            curCut -= top.first;
+            moveNode(nodeId, toPart);
+            moves.push_back(nodeId);
+
+            double violation = getViolation(partWeights);
+            if (violation < bestViolation || (violation == bestViolation && curCut < bestCut))
+            {
+                bestViolation = violation;
+                bestCut = curCut;
+                bestMoveNum = moves.size();
+                noImprovementCnt = 0;
+            }
+            else if (++noImprovementCnt > noImprovementLimit)
+            {
+                break;
+            }
+        }
+
+        // roll back to the best prefix of the moves
+        for (int i = moves.size() - 1; i >= (int)bestMoveNum; i--)
+            moveNode(moves[i], 1 - partition[moves[i]]);
+        cut = bestCut;
+        if (bestMoveNum == 0)
+            break;
+    }
+    return cut;
+}
+
+double HypergraphBipartitioner::getViolation(const std::vector<long long> &partWeights)
+{
+    double violation = 0;
+    for (int p = 0; p < 2; p++)
+    {
+        for (int k = 0; k < numConstraints; k++)
+        {
+            long long overflow = partWeights[p * numConstraints + k] - maxPartWeights[k];
+            if (overflow > 0)
+                violation += (double)overflow / std::max(1LL, maxPartWeights[k]);
+        }
+    }
+    return violation;
+}
+
+int HypergraphBipartitioner::getCut(Level &level, const std::vector<int> &partition)
+{
+    int cut = 0;
+    for (int netId = 0; netId < level.numNets; netId++)
+    {
+        int firstPart = partition[level.pins[level.xpins[netId]]];
+        for (int pinId = level.xpins[netId] + 1; pinId < level.xpins[netId + 1]; pinId++)
+        {
+            if (partition[level.pins[pinId]] != firstPart)
+            {
+                cut += level.netWeights[netId];
+                break;
+            }
+        }
+    }
+    return cut;
+}
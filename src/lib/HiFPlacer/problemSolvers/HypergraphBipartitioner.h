@@ -0,0 +1,186 @@
+/**
+ * @file HypergraphBipartitioner.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of HypergraphBipartitioner class and its internal modules and APIs
+ * which bi-partition a hypergraph with multilevel min-cut method.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _HYPERGRAPHBIPARTITIONER
+#define _HYPERGRAPHBIPARTITIONER
+
+#include "randomStream.h"
+#include <assert.h>
+#include <vector>
+
+/**
+ * @brief HypergraphBipartitioner is an in-process multilevel hypergraph bi-partitioner (hMETIS/PaToH-like) which
+ * minimizes the number of cut nets under balance constraints.
+ *
+ * The hypergraph is coarsened by heavy-edge matching until it is small enough, partitioned by greedy graph growing
+ * with multiple trials, and then projected back level by level with Fiduccia-Mattheyses (FM) refinement. Besides the
+ * primary node weight, additional balance constraints (e.g., the numbers of DSPs/BRAMs) can be specified, so both
+ * parts will not exceed the given limitations of each resource.
+ *
+ * The hypergraph is given in the same CSR format as PaToH: the pins of net i are pins[xpins[i], xpins[i+1]).
+ */
+class HypergraphBipartitioner
+{
+  public:
+    /**
+     * @brief Construct a new Hypergraph Bipartitioner object
+     *
+     * @param numNodes the number of nodes in the hypergraph
+     * @param xpins the pin offsets of the nets (size: #net + 1)
+     * @param pins the node ids of the pins of the nets
+     * @param seed the seed of the random number generator, so the result is deterministic
+     * @param streamId the id of the random stream, which identifies the bi-partitioning task
+     */
+    HypergraphBipartitioner(int numNodes, const std::vector<int> &xpins, const std::vector<int> &pins,
+                            uint64_t seed = RandomStream::defaultSeed, uint64_t streamId = 0);
+    ~HypergraphBipartitioner()
+    {
+    }
+
+    /**
+     * @brief add a balance constraint. The first one is the primary node weight used for coarsening.
+     *
+     * @param nodeWeights the weights of the nodes for this constraint
+     * @param maxPartWeight the maximum total weight of each part for this constraint
+     */
+    void addBalanceConstraint(const std::vector<int> &nodeWeights, int maxPartWeight);
+
+    /**
+     * @brief conduct the multilevel bi-partitioning
+     *
+     * @param partition output part id (0/1) of each node
+     * @param partWeights output total primary weights of the two parts
+     * @return int the number of cut nets
+     */
+    int solve(std::vector<int> &partition, std::vector<int> &partWeights);
+
+    /**
+     * @brief Get the number of levels in the latest multilevel partitioning
+     *
+     * @return int
+     */
+    inline int getLevelNum()
+    {
+        return levels.size();
+    }
+
+  private:
+    /**
+     * @brief a level of the multilevel hierarchy. Node i at this level is the coarse node of the nodes i' with
+     * fineNode2CoarseNode[i'] == i at the previous (finer) level.
+     *
+     */
+    struct Level
+    {
+        int numNodes = 0;
+        int numNets = 0;
+
+        /**
+         * @brief the weight of node i for constraint k is nodeWeights[i * numConstraints + k]
+         *
+         */
+        std::vector<int> nodeWeights;
+        std::vector<int> netWeights;
+        std::vector<int> xpins;
+        std::vector<int> pins;
+
+        /**
+         * @brief the nets of node i are nets[xnets[i], xnets[i+1])
+         *
+         */
+        std::vector<int> xnets;
+        std::vector<int> nets;
+        std::vector<int> fineNode2CoarseNode;
+    };
+
+    /**
+     * @brief build the node-to-net incidence of a level
+     *
+     * @param level
+     */
+    void buildIncidence(Level &level);
+
+    /**
+     * @brief coarsen a level by heavy-edge matching and contract the matched nodes and the identical nets
+     *
+     * @param fine the finer level
+     * @param coarse the output coarser level
+     */
+    void coarsen(Level &fine, Level &coarse);
+
+    /**
+     * @brief get an initial partition of the coarsest level by greedy graph growing with multiple trials
+     *
+     * @param level
+     * @param partition output part id of each node
+     */
+    void initialPartition(Level &level, std::vector<int> &partition);
+
+    /**
+     * @brief refine the partition with Fiduccia-Mattheyses passes
+     *
+     * @param level
+     * @param partition the part id of each node, which will be updated
+     * @param maxPassNum the maximum number of FM passes
+     * @return int the number of cut nets after refinement
+     */
+    int refine(Level &level, std::vector<int> &partition, int maxPassNum);
+
+    /**
+     * @brief evaluate how much the part weights exceed the limitations (normalized and summed)
+     *
+     * @param partWeights the weight of part p for constraint k is partWeights[p * numConstraints + k]
+     * @return double 0 if all the balance constraints are met
+     */
+    double getViolation(const std::vector<long long> &partWeights);
+
+    int getCut(Level &level, const std::vector<int> &partition);
+
+    int numConstraints = 0;
+    std::vector<long long> totalWeights;
+    std::vector<long long> maxPartWeights;
+    std::vector<Level> levels;
+    RandomStream rng;
+
+    /**
+     * @brief the coarsening stops when the number of nodes is lower than this threshold
+     *
+     */
+    int coarsestNodeNum = 200;
+
+    /**
+     * @brief nets with more pins than this threshold are ignored during matching
+     *
+     */
+    int matchingNetSizeThr = 64;
+
+    /**
+     * @brief the number of trials of initial partitioning
+     *
+     */
+    int initialPartitionTrialNum = 8;
+};
+
+#endif
@@ -0,0 +1,405 @@
+/**
+ * @file LinearSolverBackend.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the linear solver backends used by QPSolverWrapper.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "LinearSolverBackend.h"
+#include "deterministicParallel.h"
+#include "strPrint.h"
+
+#include <algorithm>
+#include <cmath>
+#include <omp.h>
+
+LinearSolverBackend *LinearSolverBackend::createBackend(std::string name, int maxIters, float tolerence)
+{
+    if (name == "CG")
+        return new EigenCGSolverBackend<Eigen::DiagonalPreconditioner<double>>(name, maxIters, tolerence);
+    if (name == "ICCG")
+        return new EigenCGSolverBackend<Eigen::IncompleteCholesky<double>>(name, maxIters, tolerence);
+    if (name == "floatJacobiCG")
+        return new FloatPCGSolverBackend(FloatPCGSolverBackend::Preconditioner_Jacobi, maxIters, tolerence);
+    if (name == "floatSSORCG")
+        return new FloatPCGSolverBackend(FloatPCGSolverBackend::Preconditioner_BlockSSOR, maxIters, tolerence);
+    if (name == "AMGCG")
+        return new EigenCGSolverBackend<AMGPreconditioner>(name, maxIters, tolerence);
+    print_error("undefined linear solver backend: " + name +
+                ". Available backends: CG, ICCG, floatJacobiCG, floatSSORCG, AMGCG.");
+    assert(false && "undefined linear solver backend");
+    return nullptr;
+}
+
+void FloatPCGSolverBackend::loadMatrix(const Eigen::SparseMatrix<double> &A)
+{
+    assert(A.isCompressed());
+    assert(A.rows() == A.cols());
+    numRows = A.rows();
+    int nnz = A.nonZeros();
+    rowStart.assign(A.outerIndexPtr(), A.outerIndexPtr() + numRows + 1);
+    colIds.assign(A.innerIndexPtr(), A.innerIndexPtr() + nnz);
+    values.resize(nnz);
+    invDiag.resize(numRows);
+
+    const double *AValues = A.valuePtr();
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int row = 0; row < numRows; row++)
+    {
+        float diag = 0;
+        for (int i = rowStart[row]; i < rowStart[row + 1]; i++)
+        {
+            values[i] = AValues[i];
+            if (colIds[i] == row)
+                diag += values[i];
+        }
+        // keep the row unscaled if the diagonal element is missing, like Eigen::DiagonalPreconditioner
+        invDiag[row] = (std::fabs(diag) > 1e-12) ? 1.0 / diag : 1.0;
+    }
+
+    int numBlocks = getParallelChunkNum(numRows, deterministic);
+    blockRowStart.resize(numBlocks + 1);
+    for (int blockId = 0; blockId <= numBlocks; blockId++)
+        blockRowStart[blockId] = (long long)numRows * blockId / numBlocks;
+}
+
+void FloatPCGSolverBackend::multiply(const std::vector<float> &x, std::vector<float> &y)
+{
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int row = 0; row < numRows; row++)
+    {
+        float sum = 0;
+        for (int i = rowStart[row]; i < rowStart[row + 1]; i++)
+            sum += values[i] * x[colIds[i]];
+        y[row] = sum;
+    }
+}
+
+void FloatPCGSolverBackend::applyPreconditioner(const std::vector<float> &r, std::vector<float> &z)
+{
+    if (preconditionerType == Preconditioner_Jacobi)
+    {
+#pragma omp parallel for
+        for (int row = 0; row < numRows; row++)
+            z[row] = invDiag[row] * r[row];
+        return;
+    }
+
+    // M = w/(2-w) * (D/w + L) (D/w)^-1 (D/w + U), restricted to the diagonal blocks
+    int numBlocks = blockRowStart.size() - 1;
+    float w = relaxationFactor;
+#pragma omp parallel for schedule(static, 1)
+    for (int blockId = 0; blockId < numBlocks; blockId++)
+    {
+        int blockBegin = blockRowStart[blockId];
+        int blockEnd = blockRowStart[blockId + 1];
+
+        // forward sweep: (D/w + L) y = r
+        for (int row = blockBegin; row < blockEnd; row++)
+        {
+            float sum = r[row];
+            for (int i = rowStart[row]; i < rowStart[row + 1]; i++)
+            {
+                int col = colIds[i];
+                if (col >= blockBegin && col < row)
+                    sum -= values[i] * z[col];
+            }
+            z[row] = sum * w * invDiag[row];
+        }
+
+        // (D/w) y
+        for (int row = blockBegin; row < blockEnd; row++)
+            z[row] = z[row] / (w * invDiag[row]);
+
+        // backward sweep: (D/w + U) z = (D/w) y
+        for (int row = blockEnd - 1; row >= blockBegin; row--)
+        {
+            float sum = z[row];
+            for (int i = rowStart[row]; i < rowStart[row + 1]; i++)
+            {
+                int col = colIds[i];
+                if (col > row && col < blockEnd)
+                    sum -= values[i] * z[col];
+            }
+            z[row] = sum * w * invDiag[row];
+        }
+
+        for (int row = blockBegin; row < blockEnd; row++)
+            z[row] *= (2 - w) / w;
+    }
+}
+
+void FloatPCGSolverBackend::solve(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &b,
+                                  const Eigen::VectorXd &guess, Eigen::VectorXd &x)
+{
+    loadMatrix(A);
+    int n = numRows;
+    xVec.resize(n);
+    rVec.resize(n);
+    zVec.resize(n);
+    pVec.resize(n);
+    qVec.resize(n);
+
+    double bNorm2 = parallelSum(
+        n,
+        [&](int i) -> double {
+            xVec[i] = guess[i];
+            return b[i] * b[i];
+        },
+        deterministic);
+
+    iterations = 0;
+    residual = 0;
+    if (bNorm2 == 0)
+    {
+        x = Eigen::VectorXd::Zero(n);
+        return;
+    }
+
+    multiply(xVec, qVec);
+    double rNorm2 = parallelSum(
+        n,
+        [&](int i) -> double {
+            rVec[i] = b[i] - qVec[i];
+            return (double)rVec[i] * rVec[i];
+        },
+        deterministic);
+
+    double threshold2 = (double)tolerence * tolerence * bNorm2;
+    if (rNorm2 > threshold2)
+    {
+        applyPreconditioner(rVec, zVec);
+        double rz = parallelSum(
+            n,
+            [&](int i) -> double {
+                pVec[i] = zVec[i];
+                return (double)rVec[i] * zVec[i];
+            },
+            deterministic);
+
+        while (iterations < maxIters)
+        {
+            multiply(pVec, qVec);
+            double pq = parallelSum(n, [&](int i) -> double { return (double)pVec[i] * qVec[i]; }, deterministic);
+            float alpha = rz / pq;
+
+            rNorm2 = parallelSum(
+                n,
+                [&](int i) -> double {
+                    xVec[i] += alpha * pVec[i];
+                    rVec[i] -= alpha * qVec[i];
+                    return (double)rVec[i] * rVec[i];
+                },
+                deterministic);
+            iterations++;
+            if (rNorm2 < threshold2)
+                break;
+
+            applyPreconditioner(rVec, zVec);
+            double rzNew = parallelSum(n, [&](int i) -> double { return (double)rVec[i] * zVec[i]; }, deterministic);
+            float beta = rzNew / rz;
+            rz = rzNew;
+#pragma omp parallel for
+            for (int i = 0; i < n; i++)
+                pVec[i] = zVec[i] + beta * pVec[i];
+        }
+    }
+
+    residual = std::sqrt(rNorm2 / bNorm2);
+    x.resize(n);
+#pragma omp parallel for
+    for (int i = 0; i < n; i++)
+        x[i] = xVec[i];
+}
+
+int AMGPreconditioner::aggregate(const LevelMatrixType &A, std::vector<int> &node2Aggregate) const
+{
+    int n = A.rows();
+    Eigen::VectorXd diag = A.diagonal();
+    node2Aggregate.assign(n, -1);
+
+    auto isStrong = [&](int i, int j, double a_ij) {
+        return i != j && std::fabs(a_ij) >= strengthThreshold * std::sqrt(std::fabs(diag[i] * diag[j]));
+    };
+
+    // pass 1: a node whose strong neighbors are all free forms a new aggregate with them
+    int numAggregates = 0;
+    for (int i = 0; i < n; i++)
+    {
+        if (node2Aggregate[i] >= 0)
+            continue;
+        bool allFree = true;
+        bool hasStrongNeighbor = false;
+        for (LevelMatrixType::InnerIterator it(A, i); it; ++it)
+        {
+            if (isStrong(i, it.col(), it.value()))
+            {
+                hasStrongNeighbor = true;
+                if (node2Aggregate[it.col()] >= 0)
+                {
+                    allFree = false;
+                    break;
+                }
+            }
+        }
+        if (!allFree || !hasStrongNeighbor)
+            continue;
+        node2Aggregate[i] = numAggregates;
+        for (LevelMatrixType::InnerIterator it(A, i); it; ++it)
+        {
+            if (isStrong(i, it.col(), it.value()))
+                node2Aggregate[it.col()] = numAggregates;
+        }
+        numAggregates++;
+    }
+
+    // pass 2: the remaining nodes join the aggregate of their strongest aggregated neighbor, or become singletons
+    std::vector<int> pass1Aggregate = node2Aggregate;
+    for (int i = 0; i < n; i++)
+    {
+        if (node2Aggregate[i] >= 0)
+            continue;
+        double strongest = 0;
+        for (LevelMatrixType::InnerIterator it(A, i); it; ++it)
+        {
+            if (pass1Aggregate[it.col()] >= 0 && isStrong(i, it.col(), it.value()) &&
+                std::fabs(it.value()) > strongest)
+            {
+                strongest = std::fabs(it.value());
+                node2Aggregate[i] = pass1Aggregate[it.col()];
+            }
+        }
+        if (node2Aggregate[i] < 0)
+            node2Aggregate[i] = numAggregates++;
+    }
+    return numAggregates;
+}
+
+void AMGPreconditioner::setup(LevelMatrixType &A)
+{
+    levelMatrices.clear();
+    levelInvDiags.clear();
+    prolongations.clear();
+    coarsestSolver = Eigen::LLT<Eigen::MatrixXd>();
+    setupInfo = Eigen::Success;
+    if (A.rows() == 0)
+    {
+        setupInfo = Eigen::InvalidInput;
+        return;
+    }
+
+    levelMatrices.push_back(A);
+    while ((int)levelMatrices.size() < maxLevels && levelMatrices.back().rows() > coarsestSize)
+    {
+        const LevelMatrixType &fineA = levelMatrices.back();
+        std::vector<int> node2Aggregate;
+        int numAggregates = aggregate(fineA, node2Aggregate);
+        if (numAggregates == 0)
+        {
+            // the coarse level would be empty, so the current level is regarded as the coarsest one
+            setupInfo = Eigen::InvalidInput;
+            break;
+        }
+        if (numAggregates > 0.9 * fineA.rows())
+            break; // the coarsening stagnates
+
+        std::vector<Eigen::Triplet<double>> PTriplets;
+        PTriplets.reserve(fineA.rows());
+        for (int i = 0; i < fineA.rows(); i++)
+            PTriplets.push_back(Eigen::Triplet<double>(i, node2Aggregate[i], 1.0));
+        LevelMatrixType P(fineA.rows(), numAggregates);
+        P.setFromTriplets(PTriplets.begin(), PTriplets.end());
+
+        LevelMatrixType coarseA = LevelMatrixType(P.transpose()) * fineA * P;
+        prolongations.push_back(P);
+        levelMatrices.push_back(coarseA);
+    }
+
+    for (auto &levelA : levelMatrices)
+    {
+        Eigen::VectorXd invDiag = levelA.diagonal();
+        for (int i = 0; i < invDiag.size(); i++)
+            invDiag[i] = (std::fabs(invDiag[i]) > 1e-12) ? 1.0 / invDiag[i] : 1.0;
+        levelInvDiags.push_back(invDiag);
+    }
+
+    // the coarsest level is solved directly if it is small enough, otherwise it is only smoothed
+    if (levelMatrices.back().rows() <= 4 * coarsestSize)
+    {
+        // the isolated nodes (zero rows, e.g., the variables without any net) make the matrix singular, so they are
+        // decoupled by unit diagonal entries, as in the smoothing
+        Eigen::MatrixXd coarsestA(levelMatrices.back());
+        for (int i = 0; i < coarsestA.rows(); i++)
+        {
+            if (std::fabs(coarsestA(i, i)) <= 1e-12)
+                coarsestA(i, i) = 1.0;
+        }
+        coarsestSolver.compute(coarsestA);
+        if (coarsestSolver.info() != Eigen::Success && setupInfo == Eigen::Success)
+            setupInfo = Eigen::NumericalIssue;
+    }
+}
+
+void AMGPreconditioner::smooth(int level, const Eigen::VectorXd &b, Eigen::VectorXd &x) const
+{
+    const LevelMatrixType &A = levelMatrices[level];
+    for (int step = 0; step < smoothSteps; step++)
+    {
+        Eigen::VectorXd r = b - A * x;
+        x += jacobiWeight * levelInvDiags[level].cwiseProduct(r);
+    }
+}
+
+void AMGPreconditioner::VCycle(int level, const Eigen::VectorXd &b, Eigen::VectorXd &x) const
+{
+    if (level == (int)levelMatrices.size() - 1)
+    {
+        if (coarsestSolver.rows() == b.size() && coarsestSolver.info() == Eigen::Success)
+        {
+            x = coarsestSolver.solve(b);
+        }
+        else
+        {
+            x = Eigen::VectorXd::Zero(b.size());
+            for (int i = 0; i < 5; i++)
+                smooth(level, b, x);
+        }
+        return;
+    }
+
+    const LevelMatrixType &A = levelMatrices[level];
+    const LevelMatrixType &P = prolongations[level];
+    x = Eigen::VectorXd::Zero(b.size());
+    smooth(level, b, x);
+    Eigen::VectorXd coarseB = P.transpose() * (b - A * x);
+    Eigen::VectorXd coarseX;
+    VCycle(level + 1, coarseB, coarseX);
+    x += P * coarseX;
+    smooth(level, b, x);
+}
+
+Eigen::VectorXd AMGPreconditioner::solve(const Eigen::VectorXd &b) const
+{
+    if (levelMatrices.empty())
+        return b;
+    Eigen::VectorXd x;
+    VCycle(0, b, x);
+    return x;
+}
@@ -0,0 +1,358 @@
+/**
+ * @file LinearSolverBackend.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of the linear solver backends used by QPSolverWrapper.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _LINEARSOLVERBACKEND
+#define _LINEARSOLVERBACKEND
+
+#include "Eigen/Eigen"
+#include "Eigen/IterativeLinearSolvers"
+#include "Eigen/SparseCore"
+#include "strPrint.h"
+#include <assert.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief LinearSolverBackend solves the symmetric positive definite linear system Ax=b derived from the unconstrained
+ * quadratic placement problem (min_x 0.5 * x'Ax - b'x).
+ *
+ * Different backends trade off the cost of preconditioner setup against the number of iterations. The backend is
+ * selected by name (see createBackend) and reports the iteration count and the relative residual (|b-Ax|/|b|) of the
+ * latest solve.
+ *
+ */
+class LinearSolverBackend
+{
+  public:
+    LinearSolverBackend(int maxIters, float tolerence) : maxIters(maxIters), tolerence(tolerence)
+    {
+    }
+    virtual ~LinearSolverBackend()
+    {
+    }
+
+    /**
+     * @brief solve Ax=b
+     *
+     * @param A the symmetric positive definite matrix with both lower and upper parts stored in compressed format
+     * @param b the right hand side
+     * @param guess the initial guess of the solution
+     * @param x the solution
+     */
+    virtual void solve(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &b, const Eigen::VectorXd &guess,
+                       Eigen::VectorXd &x) = 0;
+
+    /**
+     * @brief Get the number of iterations of the latest solve
+     *
+     * @return int
+     */
+    inline int getIterations()
+    {
+        return iterations;
+    }
+
+    /**
+     * @brief Get the relative residual |b-Ax|/|b| of the latest solve
+     *
+     * @return double
+     */
+    inline double getResidual()
+    {
+        return residual;
+    }
+
+    /**
+     * @brief Get the name of the backend
+     *
+     * @return std::string
+     */
+    virtual std::string getName() = 0;
+
+    /**
+     * @brief set whether the multi-threaded backends should split the work independently of the number of threads so
+     * the solution is the same for any number of threads
+     *
+     * @param _deterministic
+     */
+    inline void setDeterministic(bool _deterministic)
+    {
+        deterministic = _deterministic;
+    }
+
+    /**
+     * @brief create a backend according to its name
+     *
+     * available backends:
+     * "CG": Eigen conjugate gradient with diagonal preconditioner (default)
+     * "ICCG": Eigen conjugate gradient with incomplete Cholesky preconditioner
+     * "floatJacobiCG": multi-threaded float-precision conjugate gradient with Jacobi preconditioner
+     * "floatSSORCG": multi-threaded float-precision conjugate gradient with block SSOR preconditioner
+     * "AMGCG": Eigen conjugate gradient with aggregation-based algebraic multigrid preconditioner
+     *
+     * @param name the name of the backend
+     * @param maxIters the maximum number of iterations
+     * @param tolerence the tolerence of the relative residual
+     * @return LinearSolverBackend*
+     */
+    static LinearSolverBackend *createBackend(std::string name, int maxIters, float tolerence);
+
+  protected:
+    int maxIters;
+    float tolerence;
+    int iterations = 0;
+    double residual = 0;
+    bool deterministic = false;
+};
+
+/**
+ * @brief a backend based on Eigen::ConjugateGradient with a given preconditioner
+ *
+ * @tparam PreconditionerType the preconditioner for Eigen::ConjugateGradient
+ */
+template <typename PreconditionerType> class EigenCGSolverBackend : public LinearSolverBackend
+{
+  public:
+    EigenCGSolverBackend(std::string name, int maxIters, float tolerence)
+        : LinearSolverBackend(maxIters, tolerence), name(name)
+    {
+    }
+    ~EigenCGSolverBackend()
+    {
+    }
+
+    void solve(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &b, const Eigen::VectorXd &guess,
+               Eigen::VectorXd &x) override
+    {
+        CGSolver.setMaxIterations(maxIters);
+        CGSolver.setTolerance(tolerence);
+        CGSolver.compute(A);
+        // the status of the preconditioner setup is overwritten by the convergence status after solving
+        if (CGSolver.info() != Eigen::Success)
+            print_warning("LinearSolverBackend: the preconditioner setup of " + name +
+                          " failed, and the solution might converge slowly or not converge.");
+        x = CGSolver.solveWithGuess(b, guess);
+        iterations = CGSolver.iterations();
+        residual = CGSolver.error();
+    }
+
+    std::string getName() override
+    {
+        return name;
+    }
+
+  private:
+    std::string name;
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper, PreconditionerType> CGSolver;
+};
+
+/**
+ * @brief a multi-threaded preconditioned conjugate gradient solver in float precision
+ *
+ * The matrix and the vectors are converted into float to halve the memory traffic of the sparse matrix-vector
+ * products, while the inner products are accumulated in double. The preconditioner can be Jacobi or block SSOR, where
+ * each OpenMP thread applies symmetric successive over-relaxation to its own contiguous block of rows and the
+ * couplings between blocks are ignored, so the preconditioner is still symmetric positive definite and can be applied
+ * in parallel.
+ *
+ */
+class FloatPCGSolverBackend : public LinearSolverBackend
+{
+  public:
+    enum PreconditionerType
+    {
+        Preconditioner_Jacobi = 0,
+        Preconditioner_BlockSSOR
+    };
+
+    FloatPCGSolverBackend(PreconditionerType preconditionerType, int maxIters, float tolerence,
+                          float relaxationFactor = 1.0)
+        : LinearSolverBackend(maxIters, tolerence), preconditionerType(preconditionerType),
+          relaxationFactor(relaxationFactor)
+    {
+        assert(relaxationFactor > 0 && relaxationFactor < 2);
+    }
+    ~FloatPCGSolverBackend()
+    {
+    }
+
+    void solve(const Eigen::SparseMatrix<double> &A, const Eigen::VectorXd &b, const Eigen::VectorXd &guess,
+               Eigen::VectorXd &x) override;
+
+    std::string getName() override
+    {
+        return (preconditionerType == Preconditioner_Jacobi) ? "floatJacobiCG" : "floatSSORCG";
+    }
+
+  private:
+    /**
+     * @brief load the matrix A into float arrays (A is symmetric so its compressed columns are also its rows)
+     *
+     * @param A
+     */
+    void loadMatrix(const Eigen::SparseMatrix<double> &A);
+
+    /**
+     * @brief y = A * x
+     *
+     */
+    void multiply(const std::vector<float> &x, std::vector<float> &y);
+
+    /**
+     * @brief z = M^-1 * r
+     *
+     */
+    void applyPreconditioner(const std::vector<float> &r, std::vector<float> &z);
+
+    PreconditionerType preconditionerType;
+    float relaxationFactor;
+
+    int numRows = 0;
+    std::vector<int> rowStart;
+    std::vector<int> colIds;
+    std::vector<float> values;
+    std::vector<float> invDiag;
+
+    /**
+     * @brief the rows of block i are [blockRowStart[i], blockRowStart[i+1])
+     *
+     */
+    std::vector<int> blockRowStart;
+
+    std::vector<float> xVec, rVec, zVec, pVec, qVec;
+};
+
+/**
+ * @brief an aggregation-based algebraic multigrid (AMG) preconditioner which can be plugged into
+ * Eigen::ConjugateGradient
+ *
+ * The hierarchy is built by greedy aggregation of strongly-connected nodes with piecewise-constant prolongation and
+ * Galerkin coarse operators (A_c = P'AP). Each application is a symmetric V-cycle with damped Jacobi smoothing and a
+ * dense Cholesky solve on the coarsest level, so the preconditioner is symmetric positive definite.
+ *
+ */
+class AMGPreconditioner
+{
+  public:
+    typedef double Scalar;
+    typedef double RealScalar;
+    typedef Eigen::SparseMatrix<double, Eigen::RowMajor> LevelMatrixType;
+    enum
+    {
+        ColsAtCompileTime = Eigen::Dynamic,
+        MaxColsAtCompileTime = Eigen::Dynamic
+    };
+
+    AMGPreconditioner()
+    {
+    }
+
+    template <typename MatType> explicit AMGPreconditioner(const MatType &mat)
+    {
+        compute(mat);
+    }
+
+    template <typename MatType> AMGPreconditioner &analyzePattern(const MatType &)
+    {
+        return *this;
+    }
+
+    template <typename MatType> AMGPreconditioner &factorize(const MatType &mat)
+    {
+        return compute(mat);
+    }
+
+    template <typename MatType> AMGPreconditioner &compute(const MatType &mat)
+    {
+        LevelMatrixType A = mat;
+        setup(A);
+        return *this;
+    }
+
+    /**
+     * @brief apply a V-cycle to b with zero initial guess
+     *
+     * @param b
+     * @return Eigen::VectorXd
+     */
+    Eigen::VectorXd solve(const Eigen::VectorXd &b) const;
+
+    /**
+     * @brief get the status of the latest setup
+     *
+     * Eigen::InvalidInput if the matrix or a coarse level is empty, Eigen::NumericalIssue if the direct solver of the
+     * coarsest level fails (e.g., the coarsest matrix is singular), in which case the V-cycle only smooths the
+     * coarsest level.
+     *
+     * @return Eigen::ComputationInfo
+     */
+    Eigen::ComputationInfo info() const
+    {
+        return setupInfo;
+    }
+
+    inline int getNumLevels() const
+    {
+        return levelMatrices.size();
+    }
+
+  private:
+    /**
+     * @brief build the multigrid hierarchy for a matrix
+     *
+     * @param A
+     */
+    void setup(LevelMatrixType &A);
+
+    /**
+     * @brief aggregate the nodes of a matrix according to the strength of connections
+     *
+     * @param A the matrix
+     * @param node2Aggregate the resultant aggregate id of each node
+     * @return int the number of aggregates
+     */
+    int aggregate(const LevelMatrixType &A, std::vector<int> &node2Aggregate) const;
+
+    void VCycle(int level, const Eigen::VectorXd &b, Eigen::VectorXd &x) const;
+
+    void smooth(int level, const Eigen::VectorXd &b, Eigen::VectorXd &x) const;
+
+    std::vector<LevelMatrixType> levelMatrices;
+    std::vector<Eigen::VectorXd> levelInvDiags;
+    std::vector<LevelMatrixType> prolongations;
+    Eigen::LLT<Eigen::MatrixXd> coarsestSolver;
+    Eigen::ComputationInfo setupInfo = Eigen::Success;
+
+    /**
+     * @brief the size of the coarsest level, which is solved directly
+     *
+     */
+    int coarsestSize = 500;
+    int maxLevels = 12;
+    float strengthThreshold = 0.08;
+    int smoothSteps = 2;
+    double jacobiWeight = 2.0 / 3.0;
+};
+
+#endif
@@ -1,7 +1,8 @@
 /**
  * @file MinCostBipartiteMatcher.cc
  * @author Tingyuan LIANG (tliang@connect.ust.hk)
- * @brief
+ * @brief This implementation file contains APIs' implementation of the MinCostBipartiteMatcher which finds the
+ * minimum-cost matching of bipartite graphs for legalization.
  * @version 0.1
  * @date 2021-10-02
  *
@@ -23,38 +24,266 @@
  */
 
 #include "MinCostBipartiteMatcher.h"
+#include <algorithm>
+#include <cmath>
 #include <omp.h>
 
+void MinCostBipartiteMatcher::setWarmStart(const std::vector<int> &initialLeft2Right,
+                                           const std::vector<float> &initialRightPrices)
+{
+    assert(initialLeft2Right.size() == (unsigned int)numLeftNodes);
+    assert(initialRightPrices.size() == (unsigned int)numRightNodes);
+    for (int i = 0; i < numRightNodes; i++)
+        rightPrices[i] = std::max(0.0f, initialRightPrices[i]);
+    for (int i = 0; i < numLeftNodes; i++)
+    {
+        int rightNode = initialLeft2Right[i];
+        if (rightNode < 0 || rightNode >= numRightNodes || right2left[rightNode] >= 0)
+            continue;
+        for (auto &edge : adjList[i])
+        {
+            if (edge.first == rightNode)
+            {
+                left2right[i] = rightNode;
+                right2left[rightNode] = i;
+                break;
+            }
+        }
+    }
+    warmStarted = true;
+}
+
 void MinCostBipartiteMatcher::solve()
 {
-    int numSolvers = minCostFlowSolvers.size();
-#pragma omp parallel for schedule(dynamic)
-    for (int solverId = 0; solverId < numSolvers; solverId++)
+    if (algorithm == MatcherAlgorithm_MinCostFlow)
+    {
+        std::fill(left2right.begin(), left2right.end(), -1);
+        std::fill(right2left.begin(), right2left.end(), -1);
+    }
+
+    // the larger subproblems are dispatched first for load balance
+    int numSubgraphs = connectedSubgraphs.size();
+    std::vector<int> subgraphOrder(numSubgraphs);
+    for (int i = 0; i < numSubgraphs; i++)
+        subgraphOrder[i] = i;
+    std::stable_sort(subgraphOrder.begin(), subgraphOrder.end(), [&](int a, int b) -> bool {
+        return connectedSubgraphs[a].leftNodes.size() + connectedSubgraphs[a].rightNodes.size() >
+               connectedSubgraphs[b].leftNodes.size() + connectedSubgraphs[b].rightNodes.size();
+    });
+
+    int threadNum = std::max(1, std::min(maxThreadNum, numSubgraphs));
+#pragma omp parallel for schedule(dynamic, 1) num_threads(threadNum)
+    for (int orderId = 0; orderId < numSubgraphs; orderId++)
+    {
+        auto &subgraph = connectedSubgraphs[subgraphOrder[orderId]];
+        if (algorithm == MatcherAlgorithm_Auction)
+            solveByAuction(subgraph);
+        else
+            solveByMinCostFlow(subgraph);
+    }
+}
+
+void MinCostBipartiteMatcher::solveByMinCostFlow(ConnectedSubgraph &subgraph)
+{
+    int numLocalLeft = subgraph.leftNodes.size();
+    int numLocalRight = subgraph.rightNodes.size();
+
+    int srcNode = numLocalLeft + numLocalRight;
+    int sinkNode = srcNode + 1;
+    MinCostFlow minCostFlowSolver(numLocalLeft + numLocalRight + 2, numLocalLeft, srcNode, sinkNode);
+    for (int i = 0; i < numLocalLeft; i++)
+    {
+        for (auto &edge : adjList[subgraph.leftNodes[i]])
+        {
+            assert(edge.second > 0.00001);
+            minCostFlowSolver.addEdge(i, numLocalLeft + rightLocalIds[edge.first], 1, edge.second);
+        }
+    }
+    for (int i = 0; i < numLocalLeft; i++)
+        minCostFlowSolver.addEdge(srcNode, i, 1, 0);
+    for (int i = numLocalLeft; i < numLocalLeft + numLocalRight; i++)
+        minCostFlowSolver.addEdge(i, sinkNode, 1, 0);
+
+    minCostFlowSolver.calcMinCostFlow(srcNode, sinkNode, std::min(numLocalLeft, numExpectedMatches));
+
+    for (int i = 0; i < numLocalLeft; i++)
     {
-        minCostFlowSolvers[solverId]->calcMinCostFlow(srcNode, sinkNode, numExpectedMatches);
-        for (int i = 0; i < numLeftNodes; i++)
+        for (auto resEdge : minCostFlowSolver.resGraph.adj[i])
         {
-            for (unsigned int j = 0; j < minCostFlowSolvers[solverId]->resGraph.adj[i].size(); j++)
+            int destination = resEdge->destination;
+            if (destination >= numLocalLeft && destination < numLocalLeft + numLocalRight)
             {
-                int destination = minCostFlowSolvers[solverId]->resGraph.adj[i][j]->destination;
-                if (destination >= numLeftNodes && destination < numLeftNodes + numRightNodes)
+                if (resEdge->residualFlow == 0)
                 {
-                    if (minCostFlowSolvers[solverId]->resGraph.adj[i][j]->residualFlow == 0)
+                    int leftNode = subgraph.leftNodes[i];
+                    int rightNode = subgraph.rightNodes[destination - numLocalLeft];
+                    assert(left2right[leftNode] < 0);
+                    left2right[leftNode] = rightNode;
+                    assert(right2left[rightNode] < 0);
+                    right2left[rightNode] = leftNode;
+                }
+            }
+        }
+    }
+}
+
+void MinCostBipartiteMatcher::solveByAuction(ConnectedSubgraph &subgraph)
+{
+    int numLocalLeft = subgraph.leftNodes.size();
+    int numLocalRight = subgraph.rightNodes.size();
+
+    // local copies of the assignment and the prices. person2Obj[i] is -1 if the left node i is not assigned yet and
+    // -2 if it is assigned to the dummy "unmatched" object, whose price is always 0.
+    const int dummyObj = -2;
+    std::vector<int> person2Obj(numLocalLeft, -1);
+    std::vector<int> obj2Person(numLocalRight, -1);
+    std::vector<double> prices(numLocalRight, 0);
+    double maxCost = 0;
+    for (int i = 0; i < numLocalLeft; i++)
+    {
+        int leftNode = subgraph.leftNodes[i];
+        for (auto &edge : adjList[leftNode])
+            maxCost = std::max(maxCost, (double)edge.second);
+        if (warmStarted && left2right[leftNode] >= 0)
+        {
+            person2Obj[i] = rightLocalIds[left2right[leftNode]];
+            obj2Person[person2Obj[i]] = i;
+        }
+    }
+    if (warmStarted)
+    {
+        for (int j = 0; j < numLocalRight; j++)
+            prices[j] = rightPrices[subgraph.rightNodes[j]];
+    }
+    maxCost = std::max(maxCost, 1.0);
+
+    // staying unmatched costs more than any augmenting path, so the maximum matching is preferred
+    const double dummyCost = (maxCost + 1) * (numLocalLeft + 1);
+    const double finalEps = 1e-3 * maxCost / (numLocalLeft + 1);
+    double eps = warmStarted ? finalEps * 25 : maxCost / 5;
+    if (eps < finalEps)
+        eps = finalEps;
+
+    // find the best object, the best value and the second best value of a person, including the dummy object
+    auto findBestObjs = [&](int i, int &bestObj, double &bestValue, double &secondValue) {
+        bestObj = dummyObj;
+        bestValue = -dummyCost;
+        secondValue = -dummyCost;
+        for (auto &edge : adjList[subgraph.leftNodes[i]])
+        {
+            int j = rightLocalIds[edge.first];
+            double value = -edge.second - prices[j];
+            if (value > bestValue)
+            {
+                if (bestObj != dummyObj)
+                    secondValue = bestValue;
+                bestObj = j;
+                bestValue = value;
+            }
+            else if (value > secondValue)
+            {
+                secondValue = value;
+            }
+        }
+    };
+
+    std::queue<int> unassignedPersons;
+    while (true)
+    {
+        // drop the assignments violating epsilon-complementary slackness and reset the prices of the unassigned
+        // objects, until the assignment and the prices are consistent
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int i = 0; i < numLocalLeft; i++)
+            {
+                if (person2Obj[i] == -1)
+                    continue;
+                int bestObj;
+                double bestValue, secondValue;
+                findBestObjs(i, bestObj, bestValue, secondValue);
+                double curValue = -dummyCost;
+                if (person2Obj[i] >= 0)
+                {
+                    int j = person2Obj[i];
+                    for (auto &edge : adjList[subgraph.leftNodes[i]])
                     {
-                        assert(left2right[i] < 0);
-                        left2right[i] = destination - numLeftNodes;
-                        assert(right2left[destination - numLeftNodes] < 0);
-                        right2left[destination - numLeftNodes] = i;
+                        if (rightLocalIds[edge.first] == j)
+                        {
+                            curValue = -edge.second - prices[j];
+                            break;
+                        }
                     }
                 }
+                if (curValue < bestValue - eps)
+                {
+                    if (person2Obj[i] >= 0)
+                        obj2Person[person2Obj[i]] = -1;
+                    person2Obj[i] = -1;
+                    changed = true;
+                }
+            }
+            for (int j = 0; j < numLocalRight; j++)
+            {
+                if (obj2Person[j] < 0 && prices[j] > 0)
+                {
+                    prices[j] = 0;
+                    changed = true;
+                }
             }
         }
+
+        for (int i = 0; i < numLocalLeft; i++)
+        {
+            if (person2Obj[i] == -1)
+                unassignedPersons.push(i);
+        }
+
+        // Gauss-Seidel bidding
+        while (unassignedPersons.size())
+        {
+            int i = unassignedPersons.front();
+            unassignedPersons.pop();
+            int bestObj;
+            double bestValue, secondValue;
+            findBestObjs(i, bestObj, bestValue, secondValue);
+            if (bestObj == dummyObj)
+            {
+                person2Obj[i] = dummyObj;
+                continue;
+            }
+            prices[bestObj] += bestValue - secondValue + eps;
+            if (obj2Person[bestObj] >= 0)
+            {
+                person2Obj[obj2Person[bestObj]] = -1;
+                unassignedPersons.push(obj2Person[bestObj]);
+            }
+            obj2Person[bestObj] = i;
+            person2Obj[i] = bestObj;
+        }
+
+        if (eps <= finalEps)
+            break;
+        eps = std::max(eps / 5, finalEps);
+    }
+
+    for (int i = 0; i < numLocalLeft; i++)
+    {
+        int leftNode = subgraph.leftNodes[i];
+        left2right[leftNode] = -1;
+        if (person2Obj[i] >= 0)
+            left2right[leftNode] = subgraph.rightNodes[person2Obj[i]];
+    }
+    for (int j = 0; j < numLocalRight; j++)
+    {
+        int rightNode = subgraph.rightNodes[j];
+        right2left[rightNode] = obj2Person[j] >= 0 ? subgraph.leftNodes[obj2Person[j]] : -1;
+        rightPrices[rightNode] = prices[j];
     }
 }
 
-void MinCostBipartiteMatcher::getConnectedSubgraphAdjList(std::vector<std::vector<std::pair<int, float>>> &adjList,
-                                                          std::vector<int> &leftId2ConnectedSubgraphId,
-                                                          int &numConnectedSubgraphs, int maxThreadNum)
+void MinCostBipartiteMatcher::getConnectedSubgraphs()
 {
     std::vector<std::vector<int>> inv_adjList;
     inv_adjList.resize(numRightNodes, std::vector<int>());
@@ -68,42 +297,50 @@ void MinCostBipartiteMatcher::getConnectedSubgraphAdjList(std::vector<std::vecto
         }
     }
 
-    numConnectedSubgraphs = 0;
-    for (unsigned int leftNodeId = 0; leftNodeId < adjList.size(); leftNodeId++)
+    // each node belongs to exactly one subgraph, so the visited flags are shared by all the subgraphs
+    connectedSubgraphs.clear();
+    leftLocalIds.assign(numLeftNodes, -1);
+    rightLocalIds.assign(numRightNodes, -1);
+    std::vector<bool> reachedLeft(numLeftNodes, false);
+    std::vector<bool> reachedRight(numRightNodes, false);
+    for (int leftNodeId = 0; leftNodeId < numLeftNodes; leftNodeId++)
     {
-        if (leftId2ConnectedSubgraphId[leftNodeId] >= 0)
+        if (reachedLeft[leftNodeId] || adjList[leftNodeId].empty())
             continue;
-        int curNode = leftNodeId;
+        connectedSubgraphs.emplace_back();
+        ConnectedSubgraph &subgraph = connectedSubgraphs.back();
 
-        bool reachedRight[numRightNodes];
-        memset(reachedRight, 0, sizeof(reachedRight));
         std::queue<int> leftNodeInQ;
-        leftNodeInQ.push(curNode);
-        leftId2ConnectedSubgraphId[curNode] = numConnectedSubgraphs % maxThreadNum;
+        leftNodeInQ.push(leftNodeId);
+        reachedLeft[leftNodeId] = true;
         while (leftNodeInQ.size())
         {
-            curNode = leftNodeInQ.front();
+            int curNode = leftNodeInQ.front();
             leftNodeInQ.pop();
+            subgraph.leftNodes.push_back(curNode);
             for (auto tmpPair : adjList[curNode])
             {
                 int rightNode = tmpPair.first;
                 if (reachedRight[rightNode])
                     continue;
-                reachedRight[rightNode] = 1;
+                reachedRight[rightNode] = true;
+                subgraph.rightNodes.push_back(rightNode);
                 for (int nextLeftId : inv_adjList[rightNode])
                 {
-                    if (leftId2ConnectedSubgraphId[nextLeftId] < 0)
+                    if (!reachedLeft[nextLeftId])
                     {
-                        leftId2ConnectedSubgraphId[nextLeftId] = numConnectedSubgraphs % maxThreadNum;
+                        reachedLeft[nextLeftId] = true;
                         leftNodeInQ.push(nextLeftId);
                     }
                 }
             }
         }
 
-        numConnectedSubgraphs++;
+        std::sort(subgraph.leftNodes.begin(), subgraph.leftNodes.end());
+        std::sort(subgraph.rightNodes.begin(), subgraph.rightNodes.end());
+        for (unsigned int i = 0; i < subgraph.leftNodes.size(); i++)
+            leftLocalIds[subgraph.leftNodes[i]] = i;
+        for (unsigned int i = 0; i < subgraph.rightNodes.size(); i++)
+            rightLocalIds[subgraph.rightNodes[i]] = i;
     }
-
-    // print_info("MinCostBipartiteMatcher finds " + std::to_string(numConnectedSubgraphs) +
-    //            " connected subgraphs in the input bipartie graph");
-}
\ No newline at end of file
+}
@@ -1,7 +1,8 @@
 /**
  * @file MinCostBipartiteMatcher.h
  * @author Tingyuan LIANG (tliang@connect.ust.hk)
- * @brief
+ * @brief This header file contains the definitions of MinCostBipartiteMatcher class and its internal modules and
+ * APIs which find the minimum-cost matching of bipartite graphs for legalization.
  * @version 0.1
  * @date 2021-10-02
  *
@@ -33,6 +34,7 @@
 #include <iostream>
 #include <map>
 #include <mutex>
+#include <queue>
 #include <semaphore.h>
 #include <set>
 #include <sstream>
@@ -40,80 +42,78 @@
 #include <thread>
 #include <vector>
 
+/**
+ * @brief MinCostBipartiteMatcher finds the minimum-cost maximum matching of a bipartite graph, e.g., the matching
+ * between the elements to legalize and the candidate sites.
+ *
+ * The graph is split into connected subgraphs and a compact subproblem, which only contains the nodes and edges of a
+ * subgraph, is built for each of them. The subproblems are solved independently by multiple threads from a work queue
+ * sorted by the sizes of the subproblems. Each subproblem can be solved by the min-cost flow algorithm (successive
+ * shortest path) or by the epsilon-scaling auction algorithm, which can be warm-started from the assignment and the
+ * prices of the right nodes obtained in a previous matching of a similar graph.
+ */
 class MinCostBipartiteMatcher
 {
   public:
+    /**
+     * @brief the algorithm to solve the subproblems
+     *
+     */
+    enum MatcherAlgorithm
+    {
+        MatcherAlgorithm_MinCostFlow = 0,
+        MatcherAlgorithm_Auction
+    };
+
+    /**
+     * @brief Construct a new Min Cost Bipartite Matcher object
+     *
+     * @param numLeftNodes
+     * @param numRightNodes
+     * @param numExpectedMatches the maximum number of matches in each connected subgraph
+     * @param adjList the adjacent list of the left nodes, i.e., (right node id, cost) pairs. The costs should be
+     * positive.
+     * @param maxThreadNum
+     * @param verbose
+     * @param algorithm the algorithm to solve the subproblems
+     */
     MinCostBipartiteMatcher(int numLeftNodes, int numRightNodes, int numExpectedMatches,
-                            std::vector<std::vector<std::pair<int, float>>> &adjList, int maxThreadNum, bool verbose)
+                            std::vector<std::vector<std::pair<int, float>>> &adjList, int maxThreadNum, bool verbose,
+                            MatcherAlgorithm algorithm = MatcherAlgorithm_MinCostFlow)
         : numLeftNodes(numLeftNodes), numRightNodes(numRightNodes), numExpectedMatches(numExpectedMatches),
-          adjList(adjList), maxThreadNum(maxThreadNum), verbose(verbose)
+          adjList(adjList), maxThreadNum(maxThreadNum), verbose(verbose), algorithm(algorithm)
     {
+        assert(adjList.size() == (unsigned int)numLeftNodes);
+        left2right.clear();
+        right2left.clear();
+        left2right.resize(numLeftNodes, -1);
+        right2left.resize(numRightNodes, -1);
+        rightPrices.resize(numRightNodes, 0);
 
-        std::vector<int> leftId2ConnectedSubgraphId(0);
-        leftId2ConnectedSubgraphId.resize(numLeftNodes, -1);
-        int numConnectedSubgraphs = -1;
-        getConnectedSubgraphAdjList(adjList, leftId2ConnectedSubgraphId, numConnectedSubgraphs, maxThreadNum);
-        if (maxThreadNum < numConnectedSubgraphs)
-            threadNum = maxThreadNum;
-        else
-            threadNum = numConnectedSubgraphs;
-        minCostFlowSolvers.clear();
-        minCostFlowSolvers.resize(threadNum, nullptr);
-
-        int totalNumEdges = 0;
-        for (auto &curList : adjList)
-            totalNumEdges += curList.size();
-        totalNumEdges += numLeftNodes + numRightNodes;
-
-        srcNode = numLeftNodes + numRightNodes;
-        sinkNode = srcNode + 1;
-        for (int i = 0; i < threadNum; i++)
-            minCostFlowSolvers[i] = new MinCostFlow(numLeftNodes + numRightNodes + 2, numLeftNodes, srcNode, sinkNode);
+        getConnectedSubgraphs();
 
         if (verbose)
         {
-            print_info("#ConnectedSubgraphs: " + std::to_string(numConnectedSubgraphs));
+            print_info("#ConnectedSubgraphs: " + std::to_string(connectedSubgraphs.size()));
             print_info("#leftNodes: " + std::to_string(numLeftNodes));
             print_info("#rightNodes: " + std::to_string(numRightNodes));
         }
-
-        assert(adjList.size() == (unsigned int)numLeftNodes);
-        for (int i = 0; i < numLeftNodes; i++)
-        {
-            for (unsigned int j = 0; j < adjList[i].size(); j++)
-            {
-                assert(leftId2ConnectedSubgraphId[i] >= 0);
-                int v = adjList[i][j].first + numLeftNodes;
-                float w = adjList[i][j].second;
-                assert(w > 0.00001);
-                minCostFlowSolvers[leftId2ConnectedSubgraphId[i]]->addEdge(i, v, 1, w);
-            }
-        }
-
-        for (int solverId = 0; solverId < threadNum; solverId++)
-        {
-            for (int i = 0; i < numLeftNodes; i++)
-            {
-                minCostFlowSolvers[solverId]->addEdge(srcNode, i, 1, 0);
-            }
-            for (int i = numLeftNodes; i < numLeftNodes + numRightNodes; i++)
-            {
-                minCostFlowSolvers[solverId]->addEdge(i, sinkNode, 1, 0);
-            }
-        }
-
-        left2right.clear();
-        right2left.clear();
-        left2right.resize(numLeftNodes, -1);
-        right2left.resize(numRightNodes, -1);
     }
 
     ~MinCostBipartiteMatcher()
     {
-        for (auto minCostFlowSolver : minCostFlowSolvers)
-            delete minCostFlowSolver;
     }
 
+    /**
+     * @brief set the initial assignment and the initial prices of the right nodes for the auction algorithm
+     *
+     * The initial matches which are not edges of the graph or conflict with each other are ignored.
+     *
+     * @param initialLeft2Right the initially matched right node of each left node (-1 if unmatched)
+     * @param initialRightPrices the initial price of each right node
+     */
+    void setWarmStart(const std::vector<int> &initialLeft2Right, const std::vector<float> &initialRightPrices);
+
     void solve();
 
     inline int getMatchedRightNode(int x)
@@ -121,24 +121,74 @@ class MinCostBipartiteMatcher
         return left2right[x];
     }
 
+    /**
+     * @brief get the price of a right node after the matching by the auction algorithm, which can be used to
+     * warm-start a later matching
+     *
+     * @param y
+     * @return float
+     */
+    inline float getRightNodePrice(int y)
+    {
+        return rightPrices[y];
+    }
+
   private:
+    /**
+     * @brief the left nodes and the right nodes of a connected subgraph, in the ascending order of their ids
+     *
+     */
+    struct ConnectedSubgraph
+    {
+        std::vector<int> leftNodes;
+        std::vector<int> rightNodes;
+    };
+
+    /**
+     * @brief find the connected subgraphs containing at least one edge and the local ids of the nodes in their
+     * subgraphs
+     *
+     */
+    void getConnectedSubgraphs();
+
+    /**
+     * @brief solve the subproblem of a connected subgraph with the min-cost flow algorithm
+     *
+     * @param subgraph
+     */
+    void solveByMinCostFlow(ConnectedSubgraph &subgraph);
+
+    /**
+     * @brief solve the subproblem of a connected subgraph with the epsilon-scaling auction algorithm
+     *
+     * Each left node can also stay unmatched with a cost larger than the cost of any augmenting path, so the auction
+     * is always feasible and its result is a maximum matching with (nearly) minimum cost.
+     *
+     * @param subgraph
+     */
+    void solveByAuction(ConnectedSubgraph &subgraph);
+
     int numLeftNodes;
     int numRightNodes;
     int numExpectedMatches;
     std::vector<std::vector<std::pair<int, float>>> &adjList;
-    std::vector<std::vector<std::vector<std::pair<int, float>>>> connectedSubgraphAdjList;
-    void getConnectedSubgraphAdjList(std::vector<std::vector<std::pair<int, float>>> &adjList,
-                                     std::vector<int> &leftId2ConnectedSubgraphId, int &numConnectedSubgraphs,
-                                     int maxThreadNum);
     int maxThreadNum;
-    int threadNum = 1;
     bool verbose;
+    MatcherAlgorithm algorithm;
+
+    std::vector<ConnectedSubgraph> connectedSubgraphs;
+
+    /**
+     * @brief the id of each node in the node list of its connected subgraph
+     *
+     */
+    std::vector<int> leftLocalIds;
+    std::vector<int> rightLocalIds;
 
-    std::vector<MinCostFlow *> minCostFlowSolvers;
-    int srcNode;
-    int sinkNode;
     std::vector<int> left2right;
     std::vector<int> right2left;
+    std::vector<float> rightPrices;
+    bool warmStarted = false;
 };
 
 #endif
\ No newline at end of file
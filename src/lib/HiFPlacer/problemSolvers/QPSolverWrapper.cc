@@ -23,15 +23,17 @@
  */
 
 #include "QPSolverWrapper.h"
+#include "profiler.h"
 
+#include <algorithm>
 #include <cmath>
+#include <omp.h>
 
 void QPSolverWrapper::QPSolve(QPSolverWrapper *&curSolver)
 {
+    ProfileZone profileZone("QPSolve");
     // osqp::OsqpSolver &osqpSolver = curSolver->osqpSolver;
 
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper> &CGSolver = curSolver->CGSolver;
-    std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList = curSolver->solverData.objectiveMatrixTripletList;
     Eigen::VectorXd &objectiveVector = curSolver->solverData.objectiveVector;
 
     // min_x 0.5 * x'Px + q'x
@@ -43,26 +45,35 @@ void QPSolverWrapper::QPSolve(QPSolverWrapper *&curSolver)
     // lower_bounds is l.
     // upper_bounds is u.
 
-    Eigen::SparseMatrix<double> objective_matrix(objectiveVector.size(), objectiveVector.size());
-    for (unsigned int i = 0; i < objectiveVector.size(); i++)
-        objectiveMatrixTripletList.push_back(Eigen::Triplet<float>(i, i, curSolver->solverData.objectiveMatrixDiag[i]));
-    objective_matrix.setFromTriplets(objectiveMatrixTripletList.begin(), objectiveMatrixTripletList.end());
+    curSolver->loadObjectiveMatrix();
+    Eigen::SparseMatrix<double> &objective_matrix = curSolver->objectiveMatrix;
 
     if (curSolver->solverSettings.useUnconstrainedCG)
     {
         /////////////////////////////////////////////////////////////////////////
-        // Conjugate Gradient (does not support constraint yet.)
+        // Iterative linear solver for Px=-q (does not support constraint yet.)
+        if (!curSolver->linearSolver ||
+            curSolver->linearSolver->getName() != curSolver->solverSettings.linearSolverBackend)
+        {
+            if (curSolver->linearSolver)
+                delete curSolver->linearSolver;
+            curSolver->linearSolver =
+                LinearSolverBackend::createBackend(curSolver->solverSettings.linearSolverBackend,
+                                                   curSolver->solverSettings.maxIters,
+                                                   curSolver->solverSettings.tolerence);
+            curSolver->linearSolver->setDeterministic(curSolver->solverSettings.deterministic);
+        }
         if (curSolver->solverSettings.verbose)
             print_status("Unconstrained CG Solver Started.");
-        CGSolver.setMaxIterations(curSolver->solverSettings.maxIters);
-        CGSolver.setTolerance(curSolver->solverSettings.tolerence);
-        CGSolver.compute(objective_matrix);
         if (curSolver->solverSettings.solutionForward)
-            curSolver->solverData.oriSolution =
-                CGSolver.solveWithGuess(-objectiveVector, curSolver->solverData.oriSolution);
+            curSolver->linearSolver->solve(objective_matrix, -objectiveVector, curSolver->solverData.oriSolution,
+                                           curSolver->solverData.oriSolution);
         else
-            curSolver->solverData.solution =
-                CGSolver.solveWithGuess(-objectiveVector, curSolver->solverData.oriSolution);
+            curSolver->linearSolver->solve(objective_matrix, -objectiveVector, curSolver->solverData.oriSolution,
+                                           curSolver->solverData.solution);
+        curSolver->solverData.iterations = curSolver->linearSolver->getIterations();
+        curSolver->solverData.residual = curSolver->linearSolver->getResidual();
+        profileCounter("CG iterations", curSolver->solverData.iterations);
         if (curSolver->solverSettings.verbose)
             print_status("Unconstrained CG Solver Done.");
     }
@@ -124,3 +135,115 @@ void QPSolverWrapper::QPSolve(QPSolverWrapper *&curSolver)
         //     print_status("OSQP Solver Done.");
     }
 }
+
+void QPSolverWrapper::loadObjectiveMatrix()
+{
+    std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList = solverData.objectiveMatrixTripletList;
+    std::vector<float> &objectiveMatrixDiag = solverData.objectiveMatrixDiag;
+    int numElements = solverData.objectiveVector.size();
+    int numTriplets = objectiveMatrixTripletList.size();
+    assert((int)objectiveMatrixDiag.size() == numElements);
+
+    bool patternChanged =
+        objectiveMatrix.rows() != numElements || (int)cachedTripletRows.size() != numTriplets || !numElements;
+    if (!patternChanged)
+    {
+        int mismatchCnt = 0;
+#pragma omp parallel for reduction(+ : mismatchCnt)
+        for (int tripletId = 0; tripletId < numTriplets; tripletId++)
+        {
+            mismatchCnt += objectiveMatrixTripletList[tripletId].row() != cachedTripletRows[tripletId] ||
+                           objectiveMatrixTripletList[tripletId].col() != cachedTripletCols[tripletId];
+        }
+        patternChanged = mismatchCnt > 0;
+    }
+    if (patternChanged)
+        rebuildObjectiveMatrixPattern();
+
+    const int *outerIndex = objectiveMatrix.outerIndexPtr();
+    double *values = objectiveMatrix.valuePtr();
+
+    // each column is accumulated by one thread in the triplet order, followed by the diagonal element
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int col = 0; col < numElements; col++)
+    {
+        for (int valueId = outerIndex[col]; valueId < outerIndex[col + 1]; valueId++)
+            values[valueId] = 0;
+        for (int i = colTripletStart[col]; i < colTripletStart[col + 1]; i++)
+        {
+            int tripletId = colTripletIds[i];
+            values[tripletId2ValueId[tripletId]] += objectiveMatrixTripletList[tripletId].value();
+        }
+        values[diagValueId[col]] += objectiveMatrixDiag[col];
+    }
+}
+
+void QPSolverWrapper::rebuildObjectiveMatrixPattern()
+{
+    std::vector<Eigen::Triplet<float>> &objectiveMatrixTripletList = solverData.objectiveMatrixTripletList;
+    int numElements = solverData.objectiveVector.size();
+    int numTriplets = objectiveMatrixTripletList.size();
+
+    cachedTripletRows.resize(numTriplets);
+    cachedTripletCols.resize(numTriplets);
+    colTripletStart.assign(numElements + 1, 0);
+    for (int tripletId = 0; tripletId < numTriplets; tripletId++)
+    {
+        int row = objectiveMatrixTripletList[tripletId].row();
+        int col = objectiveMatrixTripletList[tripletId].col();
+        assert(row >= 0 && row < numElements && col >= 0 && col < numElements);
+        cachedTripletRows[tripletId] = row;
+        cachedTripletCols[tripletId] = col;
+        colTripletStart[col + 1]++;
+    }
+    for (int col = 0; col < numElements; col++)
+        colTripletStart[col + 1] += colTripletStart[col];
+
+    // stable counting sort, so the triplets in a column keep their original order
+    colTripletIds.resize(numTriplets);
+    std::vector<int> colFillPos(colTripletStart.begin(), colTripletStart.end() - 1);
+    for (int tripletId = 0; tripletId < numTriplets; tripletId++)
+        colTripletIds[colFillPos[cachedTripletCols[tripletId]]++] = tripletId;
+
+    // collect the distinct rows (including the diagonal one) of each column. Column c has at most
+    // colTripletStart[c+1]-colTripletStart[c]+1 distinct rows, stored temporarily from colTripletStart[c]+c.
+    std::vector<int> tmpRows(numTriplets + numElements);
+    std::vector<int> colNNZ(numElements);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int col = 0; col < numElements; col++)
+    {
+        int tmpBegin = colTripletStart[col] + col;
+        int tmpEnd = tmpBegin;
+        tmpRows[tmpEnd++] = col;
+        for (int i = colTripletStart[col]; i < colTripletStart[col + 1]; i++)
+            tmpRows[tmpEnd++] = cachedTripletRows[colTripletIds[i]];
+        std::sort(tmpRows.begin() + tmpBegin, tmpRows.begin() + tmpEnd);
+        colNNZ[col] = std::unique(tmpRows.begin() + tmpBegin, tmpRows.begin() + tmpEnd) - (tmpRows.begin() + tmpBegin);
+    }
+
+    objectiveMatrix.resize(numElements, numElements);
+    int *outerIndex = objectiveMatrix.outerIndexPtr();
+    outerIndex[0] = 0;
+    for (int col = 0; col < numElements; col++)
+        outerIndex[col + 1] = outerIndex[col] + colNNZ[col];
+    objectiveMatrix.resizeNonZeros(outerIndex[numElements]);
+    int *innerIndex = objectiveMatrix.innerIndexPtr();
+
+    tripletId2ValueId.resize(numTriplets);
+    diagValueId.resize(numElements);
+#pragma omp parallel for schedule(dynamic, 1024)
+    for (int col = 0; col < numElements; col++)
+    {
+        std::copy(tmpRows.begin() + colTripletStart[col] + col,
+                  tmpRows.begin() + colTripletStart[col] + col + colNNZ[col], innerIndex + outerIndex[col]);
+        int *colRowBegin = innerIndex + outerIndex[col];
+        int *colRowEnd = innerIndex + outerIndex[col + 1];
+        for (int i = colTripletStart[col]; i < colTripletStart[col + 1]; i++)
+        {
+            int tripletId = colTripletIds[i];
+            tripletId2ValueId[tripletId] =
+                std::lower_bound(colRowBegin, colRowEnd, cachedTripletRows[tripletId]) - innerIndex;
+        }
+        diagValueId[col] = std::lower_bound(colRowBegin, colRowEnd, col) - innerIndex;
+    }
+}
@@ -27,6 +27,7 @@
 
 #include "Eigen/Eigen"
 #include "Eigen/SparseCore"
+#include "LinearSolverBackend.h"
 //#include "osqp++/osqp++.h"
 #include "strPrint.h"
 #include <assert.h>
@@ -47,12 +48,28 @@ class QPSolverWrapper
         Eigen::VectorXd objectiveVector;
         Eigen::VectorXd solution;
         Eigen::VectorXd oriSolution;
+
+        /**
+         * @brief the number of iterations of the latest solve
+         *
+         */
+        int iterations = 0;
+
+        /**
+         * @brief the relative residual |b-Ax|/|b| of the latest solve
+         *
+         */
+        double residual = 0;
     } solverDataType;
 
     solverDataType solverData;
     // osqp::OsqpSolver osqpSolver;
 
-    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper> CGSolver;
+    /**
+     * @brief the linear solver for the unconstrained QP problem, created according to solverSettings.linearSolverBackend
+     *
+     */
+    LinearSolverBackend *linearSolver = nullptr;
     typedef struct
     {
         bool useUnconstrainedCG = true;
@@ -63,6 +80,19 @@ class QPSolverWrapper
         float tolerence = 0.001;
         bool solutionForward = false;
         bool verbose = false;
+
+        /**
+         * @brief the name of the linear solver backend for the unconstrained QP problem (see
+         * LinearSolverBackend::createBackend)
+         *
+         */
+        std::string linearSolverBackend = "CG";
+
+        /**
+         * @brief whether the linear solver should produce the same solution for any number of threads
+         *
+         */
+        bool deterministic = false;
     } solverSettingsType;
     solverSettingsType solverSettings;
 
@@ -80,9 +110,51 @@ class QPSolverWrapper
     }
     ~QPSolverWrapper()
     {
+        if (linearSolver)
+            delete linearSolver;
     }
 
     static void QPSolve(QPSolverWrapper *&curSolver);
+
+    /**
+     * @brief the objective matrix P assembled from objectiveMatrixTripletList and objectiveMatrixDiag
+     *
+     */
+    Eigen::SparseMatrix<double> objectiveMatrix;
+
+    /**
+     * @brief assemble the objective matrix P into a reusable compressed (column-major) structure
+     *
+     * The sparsity pattern is rebuilt only when the (row, col) sequence of the triplets changes, i.e., the pin pairing
+     * of the B2B net model changes. Otherwise, only the values are re-accumulated column by column in parallel,
+     * which avoids the sorting and allocation in Eigen::SparseMatrix::setFromTriplets.
+     */
+    void loadObjectiveMatrix();
+
+  private:
+    /**
+     * @brief rebuild the sparsity pattern of the objective matrix and the mapping from triplets to the values
+     *
+     */
+    void rebuildObjectiveMatrixPattern();
+
+    std::vector<int> cachedTripletRows;
+    std::vector<int> cachedTripletCols;
+
+    /**
+     * @brief the triplets bucketed by column: the ids of the triplets in column c are colTripletIds[colTripletStart[c],
+     * colTripletStart[c+1])
+     *
+     */
+    std::vector<int> colTripletStart;
+    std::vector<int> colTripletIds;
+
+    /**
+     * @brief the index in the value array of the objective matrix for each triplet/diagonal element
+     *
+     */
+    std::vector<int> tripletId2ValueId;
+    std::vector<int> diagValueId;
 };
 
 #endif
\ No newline at end of file
@@ -24,6 +24,7 @@
 
 #include "SAPlacer.h"
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -162,7 +163,7 @@ void swapVectors(std::vector<int> &a, std::vector<int> &b)
     b = c;
 }
 
-void shuffleVectors(std::vector<std::vector<int>> &a, boost::mt19937 &rng)
+void shuffleVectors(std::vector<std::vector<int>> &a, RandomStream &rng)
 {
     int N = a.size();
     for (int i = N - 1; i > 0; --i)
@@ -177,7 +178,7 @@ void SAPlacer::randomSwapInWideRange(const std::vector<std::vector<std::vector<i
                                      std::vector<std::vector<std::vector<int>>> &new_grid2clusters,
                                      const std::vector<std::pair<int, int>> &cluster2XY,
                                      std::vector<std::pair<int, int>> &new_cluster2XY, float temperature,
-                                     boost::mt19937 &rng)
+                                     RandomStream &rng)
 {
     int gridY0 = rng() % (gridH * gridW) / gridW;
     int gridX0 = rng() % (gridH * gridW) % gridW;
@@ -314,7 +315,7 @@ void SAPlacer::randomSwapInWideRangeWithNeighbors(const std::vector<std::vector<
                                                   std::vector<std::vector<std::vector<int>>> &new_grid2clusters,
                                                   const std::vector<std::pair<int, int>> &cluster2XY,
                                                   std::vector<std::pair<int, int>> &new_cluster2XY, float temperature,
-                                                  boost::mt19937 &rng)
+                                                  RandomStream &rng)
 {
     int gridY0 = rng() % (gridH * gridW) / gridW;
     int gridX0 = rng() % (gridH * gridW) % gridW;
@@ -402,7 +403,7 @@ void SAPlacer::randomSwapInWideRangeWithNeighbors(const std::vector<std::vector<
 void SAPlacer::randomShuffleRowColumn(const std::vector<std::vector<std::vector<int>>> &grid2clusters,
                                       std::vector<std::vector<std::vector<int>>> &new_grid2clusters,
                                       const std::vector<std::pair<int, int>> &cluster2XY,
-                                      std::vector<std::pair<int, int>> &new_cluster2XY, boost::mt19937 &rng)
+                                      std::vector<std::pair<int, int>> &new_cluster2XY, RandomStream &rng)
 {
     new_grid2clusters = grid2clusters;
     new_cluster2XY = cluster2XY;
@@ -432,11 +433,258 @@ void SAPlacer::randomShuffleRowColumn(const std::vector<std::vector<std::vector<
     return;
 }
 
-float SAPlacer::probabilituFunc(double oriE, double newE, float T)
+float SAPlacer::probabilituFunc(double oriE, double newE, float T, double calibrationE)
 {
     if (newE < oriE)
         return 1.0;
-    return exp(-10 * (newE / SACalibrationOffset - oriE / SACalibrationOffset) / T);
+    return exp(-10 * (newE / calibrationE - oriE / calibrationE) / T);
+}
+
+void SAPlacer::buildIncrementalCostTables()
+{
+    int clusterNum = clusterAdjMat.size();
+    int gridNum = gridH * gridW;
+    float regionW = deviceW / gridW;
+    float regionH = deviceH / gridH;
+
+    adjBegin.clear();
+    adjClusters.clear();
+    adjWeights.clear();
+    for (int clusterA = 0; clusterA < clusterNum; clusterA++)
+    {
+        adjBegin.push_back(adjClusters.size());
+        for (int clusterB = 0; clusterB < clusterNum; clusterB++)
+        {
+            if (clusterA == clusterB)
+                continue;
+            // the same entry as the one used by evaluateClusterPlacement
+            float weight = clusterAdjMat[std::max(clusterA, clusterB)][std::min(clusterA, clusterB)];
+            if (weight > 0.00001)
+            {
+                adjClusters.push_back(clusterB);
+                adjWeights.push_back(weight);
+            }
+        }
+    }
+    adjBegin.push_back(adjClusters.size());
+
+    cluster2FixedCostInGrid.assign((size_t)clusterNum * gridNum, 0);
+    for (int clusterA = 0; clusterA < clusterNum; clusterA++)
+    {
+        for (int gridY = 0; gridY < gridH; gridY++)
+            for (int gridX = 0; gridX < gridW; gridX++)
+            {
+                double resWL = 0;
+                for (unsigned int fixedUnitId = 0; fixedUnitId < cluster2FixedUnitMat[clusterA].size(); fixedUnitId++)
+                {
+                    if (cluster2FixedUnitMat[clusterA][fixedUnitId] > 0.00001)
+                    {
+                        resWL += connectionToFixedFactor * cluster2FixedUnitMat[clusterA][fixedUnitId] *
+                                 (fabs((gridX * regionW + regionW / 2) - fixedX[fixedUnitId]) +
+                                  y2xRatio * fabs((gridY * regionH + regionH / 2) - fixedY[fixedUnitId]));
+                    }
+                }
+                cluster2FixedCostInGrid[(size_t)clusterA * gridNum + gridY * gridW + gridX] = resWL;
+            }
+    }
+}
+
+double SAPlacer::getGridOverlapCost(const std::vector<int> &clustersInGrid)
+{
+    if (clustersInGrid.size() <= 1)
+        return 0;
+    float regionW = deviceW / gridW;
+    float regionH = deviceH / gridH;
+    double resWL = 0;
+    for (unsigned int clusterAId = 1; clusterAId < clustersInGrid.size(); clusterAId++)
+        for (unsigned int clusterBId = 0; clusterBId < clusterAId; clusterBId++)
+        {
+            int clusterA = clustersInGrid[clusterAId];
+            int clusterB = clustersInGrid[clusterBId];
+            resWL += 5000 *
+                     std::pow(std::min(1.1, (clusterWeights[clusterA] + clusterWeights[clusterB]) / 20000.0), 2) *
+                     (regionW + y2xRatio * regionH);
+        }
+    return resWL;
+}
+
+void SAPlacer::touchGrid(SAState &state, int gridId)
+{
+    for (auto touchedGridId : state.touchedGrids)
+    {
+        if (touchedGridId == gridId)
+            return;
+    }
+    if (state.touchedGridsOldClusters.size() <= state.touchedGrids.size())
+        state.touchedGridsOldClusters.emplace_back();
+    state.touchedGridsOldClusters[state.touchedGrids.size()] = state.grid2clusters[gridId];
+    state.touchedGrids.push_back(gridId);
+}
+
+void SAPlacer::randomSwapInWideRangeInPlace(SAState &state, float temperature, RandomStream &rng)
+{
+    // the random numbers are drawn in the same order as randomSwapInWideRange so the two kernels follow the same
+    // trajectory for the same seed
+    auto &grid2clusters = state.grid2clusters;
+
+    int gridY0 = rng() % (gridH * gridW) / gridW;
+    int gridX0 = rng() % (gridH * gridW) % gridW;
+
+    int gridY1 = rng() % (gridH * gridW) / gridW;
+    int gridX1 = rng() % (gridH * gridW) % gridW;
+
+    while ((gridX1 == gridX0 && gridY1 == gridY0) ||
+           (grid2clusters[gridY1 * gridW + gridX1].size() + grid2clusters[gridY0 * gridW + gridX0].size()) == 0)
+    {
+        gridY0 = rng() % (gridH * gridW) / gridW;
+        gridX0 = rng() % (gridH * gridW) % gridW;
+
+        gridY1 = rng() % (gridH * gridW) / gridW;
+        gridX1 = rng() % (gridH * gridW) % gridW;
+    }
+
+    int gridId0 = gridY0 * gridW + gridX0;
+    int gridId1 = gridY1 * gridW + gridX1;
+    touchGrid(state, gridId0);
+    touchGrid(state, gridId1);
+    const std::vector<int> &oldClustersInGrid0 = state.touchedGridsOldClusters[0];
+
+    auto &clustersMixed = state.clustersMixed;
+    clustersMixed.clear();
+    for (auto id : grid2clusters[gridId0])
+        clustersMixed.push_back(id);
+    for (auto id : grid2clusters[gridId1])
+        clustersMixed.push_back(id);
+
+    for (unsigned int i = 0; i < clustersMixed.size(); i++)
+    {
+        for (unsigned int j = i + 1; j < clustersMixed.size(); j++)
+        {
+            if (rng() % 2)
+            {
+                int tmp = clustersMixed[i];
+                clustersMixed[i] = clustersMixed[j];
+                clustersMixed[j] = tmp;
+            }
+        }
+    }
+
+    while (true)
+    {
+        grid2clusters[gridId0].clear();
+        grid2clusters[gridId1].clear();
+        for (auto id : clustersMixed)
+        {
+            if (rng() % 2)
+                grid2clusters[gridId1].push_back(id);
+            else
+                grid2clusters[gridId0].push_back(id);
+        }
+        std::sort(grid2clusters[gridId0].begin(), grid2clusters[gridId0].end());
+        std::sort(grid2clusters[gridId1].begin(), grid2clusters[gridId1].end());
+        if (grid2clusters[gridId0] != oldClustersInGrid0)
+            break;
+    }
+
+    if (rng() % 20 == 0 && temperature > 0.5) // shuffle multiple cluster?
+    {
+        auto &shuffledGrids = state.shuffledGrids;
+        shuffledGrids.clear();
+        if (rng() % 2) // shuffle row
+        {
+            int rowId = rng() % gridH;
+            for (int tmpI = 0; tmpI < gridW; tmpI++)
+                shuffledGrids.push_back(rowId * gridW + tmpI);
+        }
+        else
+        {
+            int columnId = rng() % gridW;
+            for (int tmpI = 0; tmpI < gridH; tmpI++)
+                shuffledGrids.push_back(tmpI * gridW + columnId);
+        }
+        for (auto gridId : shuffledGrids)
+            touchGrid(state, gridId);
+        for (int i = shuffledGrids.size() - 1; i > 0; --i)
+        {
+            int r = rng() % (i + 1);
+            grid2clusters[shuffledGrids[i]].swap(grid2clusters[shuffledGrids[r]]);
+        }
+    }
+
+    // find the clusters whose grids are changed and update their locations
+    for (auto gridId : state.touchedGrids)
+    {
+        std::pair<int, int> gridXY(gridId % gridW, gridId / gridW);
+        for (auto clusterId : grid2clusters[gridId])
+        {
+            if (state.cluster2XY[clusterId] != gridXY)
+            {
+                state.cluster2MovedId[clusterId] = state.movedClusters.size();
+                state.movedClusters.push_back(clusterId);
+                state.movedClustersOldXY.push_back(state.cluster2XY[clusterId]);
+                state.cluster2XY[clusterId] = gridXY;
+            }
+        }
+    }
+}
+
+double SAPlacer::getMoveDeltaCost(SAState &state)
+{
+    int gridNum = gridH * gridW;
+    double deltaE = 0;
+
+    for (unsigned int movedId = 0; movedId < state.movedClusters.size(); movedId++)
+    {
+        int clusterA = state.movedClusters[movedId];
+        auto &oldXYA = state.movedClustersOldXY[movedId];
+        auto &newXYA = state.cluster2XY[clusterA];
+
+        deltaE += cluster2FixedCostInGrid[(size_t)clusterA * gridNum + newXYA.second * gridW + newXYA.first] -
+                  cluster2FixedCostInGrid[(size_t)clusterA * gridNum + oldXYA.second * gridW + oldXYA.first];
+
+        for (int adjId = adjBegin[clusterA]; adjId < adjBegin[clusterA + 1]; adjId++)
+        {
+            int clusterB = adjClusters[adjId];
+            int movedIdB = state.cluster2MovedId[clusterB];
+            if (movedIdB < 0)
+            {
+                auto &XYB = state.cluster2XY[clusterB];
+                deltaE += getPairCost(adjWeights[adjId], newXYA, XYB) - getPairCost(adjWeights[adjId], oldXYA, XYB);
+            }
+            else if (movedIdB > (int)movedId)
+            {
+                // the pair of two moved clusters is evaluated only once
+                deltaE += getPairCost(adjWeights[adjId], newXYA, state.cluster2XY[clusterB]) -
+                          getPairCost(adjWeights[adjId], oldXYA, state.movedClustersOldXY[movedIdB]);
+            }
+        }
+    }
+
+    for (unsigned int touchedId = 0; touchedId < state.touchedGrids.size(); touchedId++)
+    {
+        deltaE += getGridOverlapCost(state.grid2clusters[state.touchedGrids[touchedId]]) -
+                  getGridOverlapCost(state.touchedGridsOldClusters[touchedId]);
+    }
+
+    return deltaE;
+}
+
+void SAPlacer::undoMove(SAState &state)
+{
+    for (unsigned int touchedId = 0; touchedId < state.touchedGrids.size(); touchedId++)
+        state.grid2clusters[state.touchedGrids[touchedId]].swap(state.touchedGridsOldClusters[touchedId]);
+    for (unsigned int movedId = 0; movedId < state.movedClusters.size(); movedId++)
+        state.cluster2XY[state.movedClusters[movedId]] = state.movedClustersOldXY[movedId];
+    commitMove(state);
+}
+
+void SAPlacer::commitMove(SAState &state)
+{
+    for (auto clusterId : state.movedClusters)
+        state.cluster2MovedId[clusterId] = -1;
+    state.movedClusters.clear();
+    state.movedClustersOldXY.clear();
+    state.touchedGrids.clear();
 }
 
 void SAPlacer::worker(SAPlacer *saPlacer, std::vector<std::vector<std::vector<int>>> &init_grid2clusters,
@@ -445,50 +693,66 @@ void SAPlacer::worker(SAPlacer *saPlacer, std::vector<std::vector<std::vector<in
                       std::vector<std::pair<int, int>> &opt_cluster2XY, int &totalIterNum, int &workers_randomSeed,
                       double &resE)
 {
-    std::vector<std::pair<int, int>> cur_cluster2XY = init_cluster2XY;
-    std::vector<std::vector<std::vector<int>>> cur_grid2clusters = init_grid2clusters;
-    std::vector<std::pair<int, int>> new_cluster2XY;
-    std::vector<std::vector<std::vector<int>>> new_grid2clusters;
+    int gridH = saPlacer->gridH;
+    int gridW = saPlacer->gridW;
 
-    boost::mt19937 rng(workers_randomSeed);
+    SAState state;
+    state.cluster2XY = init_cluster2XY;
+    state.grid2clusters.resize(gridH * gridW);
+    for (int gridY = 0; gridY < gridH; gridY++)
+        for (int gridX = 0; gridX < gridW; gridX++)
+            state.grid2clusters[gridY * gridW + gridX] = init_grid2clusters[gridY][gridX];
+    state.cluster2MovedId.resize(init_cluster2XY.size(), -1);
+
+    std::vector<std::pair<int, int>> best_cluster2XY;
+    bool improved = false;
+
+    RandomStream rng(saPlacer->randomSeed, workers_randomSeed, RandomStream::StreamDomain_SAAnnealing);
 
     double oriE = saPlacer->evaluateClusterPlacement(init_grid2clusters, init_cluster2XY);
     resE = oriE;
-    // double inputE = oriE;
+    state.calibrationE = oriE;
 
     int SAIterNum = (totalIterNum - 1);
     for (int k = SAIterNum; k >= 0; k--)
     {
-
         float temperature = (float)(k + 1) / SAIterNum;
-        new_cluster2XY.clear();
-        new_grid2clusters.clear();
 
-        if (k > SAIterNum)
-            saPlacer->randomShuffleRowColumn(cur_grid2clusters, new_grid2clusters, cur_cluster2XY, new_cluster2XY, rng);
-        else
-            saPlacer->randomSwapInWideRange(cur_grid2clusters, new_grid2clusters, cur_cluster2XY, new_cluster2XY,
-                                            temperature, rng);
-        double newE = saPlacer->evaluateClusterPlacement(new_grid2clusters, new_cluster2XY);
+        saPlacer->randomSwapInWideRangeInPlace(state, temperature, rng);
+        double newE = oriE + saPlacer->getMoveDeltaCost(state);
 
         float thr = (float)rng() / (float)rng.max();
-        float P = saPlacer->probabilituFunc(oriE, newE, temperature);
-        if (P >= thr || k > SAIterNum)
-        {
-            oriE = newE;
-            cur_grid2clusters = new_grid2clusters;
-            cur_cluster2XY = new_cluster2XY;
-        }
+        float P = saPlacer->probabilituFunc(oriE, newE, temperature, state.calibrationE);
+        bool accepted = P >= thr;
 
         if (resE > newE)
         {
             resE = newE;
-            opt_grid2clusters = new_grid2clusters;
-            opt_cluster2XY = new_cluster2XY;
+            best_cluster2XY = state.cluster2XY;
+            improved = true;
+        }
+
+        if (accepted)
+        {
+            oriE = newE;
+            saPlacer->commitMove(state);
+        }
+        else
+        {
+            saPlacer->undoMove(state);
         }
     }
 
-    // assert(inputE > resE);
+    if (improved)
+    {
+        opt_cluster2XY = best_cluster2XY;
+        opt_grid2clusters = std::vector<std::vector<std::vector<int>>>(
+            gridH, std::vector<std::vector<int>>(gridW, std::vector<int>()));
+        for (unsigned int clusterId = 0; clusterId < opt_cluster2XY.size(); clusterId++)
+            opt_grid2clusters[opt_cluster2XY[clusterId].second][opt_cluster2XY[clusterId].first].push_back(clusterId);
+        // remove the accumulated rounding error of the incremental evaluation
+        resE = saPlacer->evaluateClusterPlacement(opt_grid2clusters, opt_cluster2XY);
+    }
 }
 
 void SAPlacer::greedyPlaceACluster(const std::vector<std::pair<int, int>> &init_cluster2XY,
@@ -524,8 +788,8 @@ void SAPlacer::greedyPlaceACluster(const std::vector<std::pair<int, int>> &init_
 
     if (highConnectCluster < 0)
     {
-        int gridY0 = random() % (gridH * gridW) / gridW;
-        int gridX0 = random() % (gridH * gridW) % gridW;
+        int gridY0 = initRandomStream() % (gridH * gridW) / gridW;
+        int gridX0 = initRandomStream() % (gridH * gridW) % gridW;
         res_cluster2XY[clusterIdToPlace].first = gridX0;
         res_cluster2XY[clusterIdToPlace].second = gridY0;
         res_grid2clusters[gridY0][gridX0].push_back(clusterIdToPlace);
@@ -598,7 +862,7 @@ int SAPlacer::greedyFindNextClusterToPlace(std::vector<std::pair<int, int>> &tmp
     if (highConnectCluster < 0)
     {
         assert(unplacedClusterIds.size());
-        return unplacedClusterIds[random() % unplacedClusterIds.size()];
+        return unplacedClusterIds[initRandomStream() % unplacedClusterIds.size()];
     }
     else
     {
@@ -625,7 +889,7 @@ void SAPlacer::greedyInitialize(std::vector<std::pair<int, int>> &init_cluster2X
             {
                 if (cluster2FixedUnitMat[i][fixedUnitId])
                 {
-                    if (random() % 2 == 0)
+                    if (initRandomStream() % 2 == 0)
                     {
                         std::vector<std::pair<int, int>> new_cluster2XY;
                         std::vector<std::vector<std::vector<int>>> new_grid2clusters;
@@ -699,11 +963,21 @@ void SAPlacer::solve()
     std::vector<double> works_E;
     std::vector<int> workers_randomSeed;
 
+    // each restart starts from its own initial placement and normalizes its energy changes with its own initial
+    // energy, so the restarts in a batch do not depend on each other
+    std::vector<std::vector<std::pair<int, int>>> workers_initCluster2XY;
+    std::vector<std::vector<std::vector<std::vector<int>>>> workers_initGrid2clusters;
+    std::vector<double> workers_initE;
+
     // assign each restarted task to a thread
     int workerIterNum = Kmax / restartNum;
     std::vector<std::pair<int, double>> seedAndE;
     seedAndE.clear();
 
+    buildIncrementalCostTables();
+    long long SAMoveNum = 0;
+    double SAWorkerTime = 0;
+
     int initOffset = 0;
     for (int restartI = restartNum; restartI > 0; restartI -= nJobs)
     {
@@ -715,8 +989,11 @@ void SAPlacer::solve()
         workers_grid2clusters.clear();
         works_E.clear();
         workers_randomSeed.clear();
+        workers_initCluster2XY.clear();
+        workers_initGrid2clusters.clear();
+        workers_initE.clear();
 
-        for (int threadId = restartI; threadId >= 0 && threadId > restartI - nJobs; threadId--)
+        for (int threadId = restartI; threadId > 0 && threadId > restartI - nJobs; threadId--)
         {
 
             // generate initial cluster placement
@@ -725,6 +1002,7 @@ void SAPlacer::solve()
                 gridH, std::vector<std::vector<int>>(gridW, std::vector<int>()));
 
             initOffset++;
+            initRandomStream.reseed(randomSeed, threadId, RandomStream::StreamDomain_SAInitialization);
             greedyInitialize(init_cluster2XY, init_grid2clusters, initOffset / 8);
 
             for (unsigned int clusterA = 0; clusterA < clusterAdjMat.size(); clusterA++)
@@ -738,16 +1016,20 @@ void SAPlacer::solve()
                     std::sort(init_grid2clusters[gridY][gridX].begin(), init_grid2clusters[gridY][gridX].end());
                 }
             }
-            SACalibrationOffset = evaluateClusterPlacement(init_grid2clusters, init_cluster2XY);
 
+            workers_initCluster2XY.push_back(init_cluster2XY);
+            workers_initGrid2clusters.push_back(init_grid2clusters);
+            workers_initE.push_back(evaluateClusterPlacement(init_grid2clusters, init_cluster2XY));
             workers_cluster2XY.push_back(init_cluster2XY);
             workers_grid2clusters.push_back(init_grid2clusters);
             works_E.push_back(0);
             workers_randomSeed.push_back(threadId);
         }
+        auto workerStartTime = std::chrono::steady_clock::now();
         for (unsigned int threadId = 0; threadId < workers_cluster2XY.size(); threadId++)
         {
-            threads.push_back(std::thread(worker, this, std::ref(init_grid2clusters), std::ref(init_cluster2XY),
+            threads.push_back(std::thread(worker, this, std::ref(workers_initGrid2clusters[threadId]),
+                                          std::ref(workers_initCluster2XY[threadId]),
                                           std::ref(workers_grid2clusters[threadId]),
                                           std::ref(workers_cluster2XY[threadId]), std::ref(workerIterNum),
                                           std::ref(workers_randomSeed[threadId]), std::ref(works_E[threadId])));
@@ -757,12 +1039,16 @@ void SAPlacer::solve()
             threads[threadId].join();
             seedAndE.emplace_back(workers_randomSeed[threadId], works_E[threadId]);
         }
+        SAWorkerTime +=
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - workerStartTime).count();
+        SAMoveNum += (long long)workerIterNum * threads.size();
 
         if (works_E[0] < resE)
         {
             resE = works_E[0];
             res_grid2clusters = workers_grid2clusters[0];
             res_cluster2XY = workers_cluster2XY[0];
+            SACalibrationOffset = workers_initE[0];
         }
 
         for (unsigned int threadId = 1; threadId < threads.size(); threadId++)
@@ -772,12 +1058,16 @@ void SAPlacer::solve()
                 resE = works_E[threadId];
                 res_grid2clusters = workers_grid2clusters[threadId];
                 res_cluster2XY = workers_cluster2XY[threadId];
+                SACalibrationOffset = workers_initE[threadId];
             }
         }
     }
     printf("\n");
     print_info("SA optimization ratio (finalE/initE) = " + std::to_string(resE / SACalibrationOffset));
     print_info("SA optimization initE = " + std::to_string(SACalibrationOffset));
+    if (SAWorkerTime > 0)
+        print_info("SA throughput: " + std::to_string(SAMoveNum) + " moves in " + std::to_string(SAWorkerTime) +
+                   "s (" + std::to_string((long long)(SAMoveNum / SAWorkerTime)) + " moves/s)");
     for (int restartI = restartNum - 1; restartI >= 0; restartI--)
     {
         std::cout << " " << seedAndE[restartI].first << "(" << seedAndE[restartI].second << ")";
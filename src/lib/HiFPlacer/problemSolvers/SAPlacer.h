@@ -25,10 +25,11 @@
 #ifndef _SAPLACER
 #define _SAPLACER
 
+#include "randomStream.h"
 #include "strPrint.h"
 #include "sysInfo.h"
 #include <assert.h>
-#include <boost/random.hpp>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -44,11 +45,11 @@ class SAPlacer
              std::vector<std::vector<float>> &cluster2FixedUnitMat, std::vector<float> &fixedX,
              std::vector<float> &fixedY, int gridH, int gridW, float deviceH, float deviceW,
              float connectionToFixedFactor = 5.0, float y2xRatio = 0.8, int Kmax = 100000, int nJobs = 1,
-             int restartNum = 10, bool verbose = false)
+             int restartNum = 10, bool verbose = false, uint64_t randomSeed = RandomStream::defaultSeed)
         : placerName(placerName), clusterAdjMat(clusterAdjMat), clusterWeights(clusterWeights),
           cluster2FixedUnitMat(cluster2FixedUnitMat), fixedX(fixedX), fixedY(fixedY), gridH(gridH), gridW(gridW),
           deviceH(deviceH), deviceW(deviceW), connectionToFixedFactor(connectionToFixedFactor), y2xRatio(y2xRatio),
-          Kmax(Kmax), nJobs(nJobs), restartNum(restartNum), verbose(verbose)
+          Kmax(Kmax), nJobs(nJobs), restartNum(restartNum), verbose(verbose), randomSeed(randomSeed)
     {
     }
     ~SAPlacer()
@@ -94,30 +95,150 @@ class SAPlacer
     int restartNum;
     bool verbose;
 
+    /**
+     * @brief the seed of the random streams. Restart i draws its greedy initialization and its annealing from the
+     * streams with id i in two different domains, so the result does not depend on the number of threads.
+     *
+     */
+    uint64_t randomSeed;
+
+    /**
+     * @brief the random stream used by the greedy initialization of the current restart
+     *
+     */
+    RandomStream initRandomStream;
+
     std::vector<std::pair<int, int>> res_cluster2XY;
     std::vector<std::vector<std::vector<int>>> res_grid2clusters;
     double resE;
 
+    /**
+     * @brief the energy of the initial placement of the restart which gets the best result
+     *
+     */
     double SACalibrationOffset;
 
     void randomSwapInWideRange(const std::vector<std::vector<std::vector<int>>> &grid2clusters,
                                std::vector<std::vector<std::vector<int>>> &new_Grid2clusters,
                                const std::vector<std::pair<int, int>> &cluster2XY,
                                std::vector<std::pair<int, int>> &new_cluster2XY, float temperature,
-                               boost::mt19937 &rng);
+                               RandomStream &rng);
 
     void randomSwapInWideRangeWithNeighbors(const std::vector<std::vector<std::vector<int>>> &grid2clusters,
                                             std::vector<std::vector<std::vector<int>>> &new_Grid2clusters,
                                             const std::vector<std::pair<int, int>> &cluster2XY,
                                             std::vector<std::pair<int, int>> &new_cluster2XY, float temperature,
-                                            boost::mt19937 &rng);
+                                            RandomStream &rng);
 
     void randomShuffleRowColumn(const std::vector<std::vector<std::vector<int>>> &grid2clusters,
                                 std::vector<std::vector<std::vector<int>>> &new_grid2clusters,
                                 const std::vector<std::pair<int, int>> &cluster2XY,
-                                std::vector<std::pair<int, int>> &new_cluster2XY, boost::mt19937 &rng);
+                                std::vector<std::pair<int, int>> &new_cluster2XY, RandomStream &rng);
+
+    float probabilituFunc(double oriE, double newE, float T, double calibrationE);
+
+    /**
+     * @brief the state of a simulated annealing worker. Moves are applied in place and undone if they are rejected,
+     * so the placement is never deep-copied during the annealing.
+     *
+     */
+    struct SAState
+    {
+        std::vector<std::pair<int, int>> cluster2XY;
+
+        /**
+         * @brief the clusters in each grid, indexed by gridY * gridW + gridX
+         *
+         */
+        std::vector<std::vector<int>> grid2clusters;
+
+        std::vector<int> movedClusters;
+        std::vector<std::pair<int, int>> movedClustersOldXY;
+
+        /**
+         * @brief the index of a cluster in movedClusters, or -1 if it is not moved by the current move
+         *
+         */
+        std::vector<int> cluster2MovedId;
+
+        std::vector<int> touchedGrids;
+
+        /**
+         * @brief the clusters in the touched grids before the current move (buffers are reused among moves)
+         *
+         */
+        std::vector<std::vector<int>> touchedGridsOldClusters;
+
+        std::vector<int> clustersMixed;
+        std::vector<int> shuffledGrids;
+
+        /**
+         * @brief the energy of the initial placement of the restart, which normalizes the energy changes in the
+         * acceptance probability
+         *
+         */
+        double calibrationE = 1.0;
+    };
+
+    /**
+     * @brief the sparse (CSR) adjacency of the clusters, i.e., the neighbors of cluster A are
+     * adjClusters[adjBegin[A], adjBegin[A+1]) with weights adjWeights[...]
+     *
+     */
+    std::vector<int> adjBegin;
+    std::vector<int> adjClusters;
+    std::vector<float> adjWeights;
+
+    /**
+     * @brief the wirelength between cluster A and the fixed units if A is placed in grid G, indexed by
+     * A * gridH * gridW + G
+     *
+     */
+    std::vector<double> cluster2FixedCostInGrid;
+
+    void buildIncrementalCostTables();
+
+    inline double getPairCost(float weight, const std::pair<int, int> &XYA, const std::pair<int, int> &XYB)
+    {
+        float regionW = deviceW / gridW;
+        float regionH = deviceH / gridH;
+        double res = weight * (fabs(XYA.first - XYB.first) * regionW +
+                               y2xRatio * fabs(XYA.second - XYB.second) * regionH);
+        if (XYA.first == 2 || XYB.first == 2)
+            res += fabs(XYA.first - XYB.first) * regionW * 0.5;
+        return res;
+    }
+
+    double getGridOverlapCost(const std::vector<int> &clustersInGrid);
+
+    /**
+     * @brief record the clusters in a grid before it is changed by the current move
+     *
+     * @param state
+     * @param gridId
+     */
+    void touchGrid(SAState &state, int gridId);
+
+    /**
+     * @brief apply a random move (the same move as randomSwapInWideRange) to the placement in place
+     *
+     * @param state
+     * @param temperature
+     * @param rng
+     */
+    void randomSwapInWideRangeInPlace(SAState &state, float temperature, RandomStream &rng);
+
+    /**
+     * @brief get the cost change of the current move by evaluating only the adjacency rows of the moved clusters and
+     * the touched grids
+     *
+     * @param state
+     * @return double
+     */
+    double getMoveDeltaCost(SAState &state);
 
-    float probabilituFunc(double oriE, double newE, float T);
+    void undoMove(SAState &state);
+    void commitMove(SAState &state);
 
     static void worker(SAPlacer *saPlacer, std::vector<std::vector<std::vector<int>>> &init_grid2clusters,
                        std::vector<std::pair<int, int>> &init_cluster2XY,
@@ -0,0 +1,211 @@
+/**
+ * @file binaryDB.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains the writer and the memory-mapped reader of the compiled binary database
+ * files.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "binaryDB.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <functional>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+struct BinaryDBHeader
+{
+    char kind[8];
+    uint64_t sourceSignature;
+    uint64_t sectionNum;
+    uint64_t fileSize;
+};
+
+inline uint64_t alignTo8(uint64_t offset)
+{
+    return (offset + 7) & ~(uint64_t)7;
+}
+} // namespace
+
+uint64_t getFileSignature(const std::string &fileName)
+{
+    struct stat buf;
+    if (stat(fileName.c_str(), &buf) == -1)
+        return 0;
+    uint64_t signature = (uint64_t)buf.st_size;
+    signature = signature * 1000000007ULL + (uint64_t)buf.st_mtim.tv_sec;
+    signature = signature * 1000000007ULL + (uint64_t)buf.st_mtim.tv_nsec;
+    return signature ? signature : 1;
+}
+
+std::string getBinaryDBFileName(const std::string &inputFileName, const std::string &cacheDir)
+{
+    if (cacheDir == "")
+        return inputFileName + ".amfdb";
+    std::string baseName = inputFileName.substr(inputFileName.find_last_of('/') + 1);
+    std::stringstream ss;
+    // different input files may share the same base name
+    ss << cacheDir << "/" << baseName << "." << std::hex << std::hash<std::string>()(inputFileName) << ".amfdb";
+    return ss.str();
+}
+
+int32_t BinaryDBWriter::internString(const std::string &str)
+{
+    assert(!stringTableAdopted && "the strings cannot be interned into an adopted string table.");
+    auto insertRes = str2Id.emplace(str, (int32_t)str2Id.size());
+    if (insertRes.second)
+    {
+        strChars.insert(strChars.end(), str.begin(), str.end());
+        strOffsets.push_back(strChars.size());
+    }
+    return insertRes.first->second;
+}
+
+void BinaryDBWriter::adoptStringTable(std::vector<uint64_t> &&offsets, std::vector<char> &&chars)
+{
+    assert(str2Id.empty() && "the string table should be adopted before any string is interned.");
+    assert(offsets.size() && offsets[0] == 0 && offsets.back() == chars.size());
+    strOffsets = std::move(offsets);
+    strChars = std::move(chars);
+    stringTableAdopted = true;
+}
+
+bool BinaryDBWriter::write(const std::string &fileName, const char *kind, uint64_t sourceSignature)
+{
+    std::vector<std::pair<const char *, uint64_t>> allSections;
+    for (auto &section : sections)
+        allSections.emplace_back(section.data(), section.size());
+    allSections.emplace_back((const char *)strOffsets.data(), strOffsets.size() * sizeof(uint64_t));
+    allSections.emplace_back(strChars.data(), strChars.size());
+
+    BinaryDBHeader header;
+    memcpy(header.kind, kind, sizeof(header.kind));
+    header.sourceSignature = sourceSignature;
+    header.sectionNum = allSections.size();
+
+    std::vector<uint64_t> sectionTable;
+    uint64_t offset = sizeof(BinaryDBHeader) + allSections.size() * 2 * sizeof(uint64_t);
+    for (auto &section : allSections)
+    {
+        offset = alignTo8(offset);
+        sectionTable.push_back(offset);
+        sectionTable.push_back(section.second);
+        offset += section.second;
+    }
+    header.fileSize = offset;
+
+    // write into a temporary file first so concurrent runs never read a partially written database
+    std::string tmpFileName = fileName + ".tmp" + std::to_string(getpid());
+    FILE *fp = fopen(tmpFileName.c_str(), "wb");
+    if (!fp)
+        return false;
+    bool success = fwrite(&header, sizeof(header), 1, fp) == 1;
+    success &= fwrite(sectionTable.data(), sizeof(uint64_t), sectionTable.size(), fp) == sectionTable.size();
+    uint64_t written = sizeof(BinaryDBHeader) + sectionTable.size() * sizeof(uint64_t);
+    const char zeros[8] = {0};
+    for (auto &section : allSections)
+    {
+        uint64_t padding = alignTo8(written) - written;
+        if (padding)
+            success &= fwrite(zeros, 1, padding, fp) == padding;
+        if (section.second)
+            success &= fwrite(section.first, 1, section.second, fp) == section.second;
+        written += padding + section.second;
+    }
+    success &= fclose(fp) == 0;
+    if (success)
+        success = rename(tmpFileName.c_str(), fileName.c_str()) == 0;
+    if (!success)
+        remove(tmpFileName.c_str());
+    return success;
+}
+
+BinaryDB::~BinaryDB()
+{
+    close();
+}
+
+void BinaryDB::close()
+{
+    if (mappedData)
+        munmap((void *)mappedData, mappedSize);
+    mappedData = nullptr;
+    mappedSize = 0;
+    sectionNum = 0;
+}
+
+bool BinaryDB::open(const std::string &fileName, const char *kind, uint64_t sourceSignature)
+{
+    close();
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat buf;
+    if (fstat(fd, &buf) == -1 || (size_t)buf.st_size < sizeof(BinaryDBHeader))
+    {
+        ::close(fd);
+        return false;
+    }
+    mappedSize = buf.st_size;
+    void *addr = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+    {
+        mappedSize = 0;
+        return false;
+    }
+    mappedData = (const char *)addr;
+
+    const BinaryDBHeader *header = (const BinaryDBHeader *)mappedData;
+    if (memcmp(header->kind, kind, sizeof(header->kind)) || header->sourceSignature != sourceSignature ||
+        header->fileSize != mappedSize || header->sectionNum < 2 ||
+        sizeof(BinaryDBHeader) + header->sectionNum * 2 * sizeof(uint64_t) > mappedSize)
+    {
+        close();
+        return false;
+    }
+    sectionTable = (const uint64_t *)(mappedData + sizeof(BinaryDBHeader));
+    for (uint64_t sectionId = 0; sectionId < header->sectionNum; sectionId++)
+    {
+        if (sectionTable[sectionId * 2] + sectionTable[sectionId * 2 + 1] > mappedSize)
+        {
+            close();
+            return false;
+        }
+    }
+
+    // the last two sections are the string table
+    sectionNum = header->sectionNum;
+    size_t offsetNum, charNum;
+    strOffsets = getSection<uint64_t>(sectionNum - 2, offsetNum);
+    strChars = getSection<char>(sectionNum - 1, charNum);
+    if (offsetNum < 1 || strOffsets[offsetNum - 1] != charNum)
+    {
+        close();
+        return false;
+    }
+    strNum = offsetNum - 1;
+    sectionNum -= 2;
+    return true;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file binaryDB.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of the writer and the memory-mapped reader of the compiled binary
+ * database files, which are used to cache the parsed design/device information.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _BINARYDB
+#define _BINARYDB
+
+#include <assert.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief get a signature (size and modification time) of a file, so a cache compiled from the file can be invalidated
+ * when the file is changed
+ *
+ * @param fileName
+ * @return uint64_t 0 if the file does not exist
+ */
+uint64_t getFileSignature(const std::string &fileName);
+
+/**
+ * @brief get the name of the binary cache file of an input file
+ *
+ * @param inputFileName the input (text/archived) file
+ * @param cacheDir the directory of the cache file. If it is empty, the cache file is put beside the input file.
+ * @return std::string
+ */
+std::string getBinaryDBFileName(const std::string &inputFileName, const std::string &cacheDir);
+
+/**
+ * @brief BinaryDBWriter accumulates flat arrays of plain records (sections) and an interned string table, and dumps
+ * them into a binary database file.
+ *
+ * The file layout is: header, section table, and the 8-byte aligned sections. The string table is stored as the last
+ * two sections (the offsets of the strings and the characters).
+ */
+class BinaryDBWriter
+{
+  public:
+    BinaryDBWriter()
+    {
+    }
+    ~BinaryDBWriter()
+    {
+    }
+
+    /**
+     * @brief get the id of a string in the string table (the string is added if it is not in the table)
+     *
+     * @param str
+     * @return int32_t
+     */
+    int32_t internString(const std::string &str);
+
+    /**
+     * @brief take over a string table built elsewhere (e.g. by a StringInterner in parallel), so the strings are not
+     * interned again. No string can be interned into the writer after that.
+     *
+     * @param offsets the i-th string is chars[offsets[i], offsets[i+1])
+     * @param chars
+     */
+    void adoptStringTable(std::vector<uint64_t> &&offsets, std::vector<char> &&chars);
+
+    inline std::string getString(int32_t strId) const
+    {
+        assert(strId >= 0 && (size_t)strId + 1 < strOffsets.size());
+        return std::string(strChars.data() + strOffsets[strId], strOffsets[strId + 1] - strOffsets[strId]);
+    }
+
+    inline size_t getStringNum() const
+    {
+        return strOffsets.size() - 1;
+    }
+
+    /**
+     * @brief add a flat array of plain records as a section
+     *
+     * @tparam T a trivially copyable record type
+     * @param records
+     * @return int the id of the section
+     */
+    template <typename T> int addSection(const std::vector<T> &records)
+    {
+        sections.emplace_back(records.size() * sizeof(T));
+        if (records.size())
+            memcpy(sections.back().data(), records.data(), records.size() * sizeof(T));
+        return sections.size() - 1;
+    }
+
+    /**
+     * @brief write the database into a file
+     *
+     * @param fileName
+     * @param kind an 8-character tag of the database kind and format version
+     * @param sourceSignature the signature of the source file of the database
+     * @return true if the file is written successfully
+     */
+    bool write(const std::string &fileName, const char *kind, uint64_t sourceSignature);
+
+  private:
+    std::vector<std::vector<char>> sections;
+    std::unordered_map<std::string, int32_t> str2Id;
+    std::vector<uint64_t> strOffsets = {0};
+    std::vector<char> strChars;
+    bool stringTableAdopted = false;
+};
+
+/**
+ * @brief BinaryDB maps a binary database file written by BinaryDBWriter into memory and provides read-only accesses
+ * to its sections and strings without parsing.
+ */
+class BinaryDB
+{
+  public:
+    BinaryDB()
+    {
+    }
+    ~BinaryDB();
+
+    /**
+     * @brief map a binary database file into memory
+     *
+     * @param fileName
+     * @param kind the expected 8-character tag of the database kind and format version
+     * @param sourceSignature the expected signature of the source file of the database
+     * @return true if the file exists and matches the kind and the source signature
+     */
+    bool open(const std::string &fileName, const char *kind, uint64_t sourceSignature);
+
+    /**
+     * @brief get a section as a flat array of records
+     *
+     * @tparam T the record type used to write the section
+     * @param sectionId
+     * @param num output the number of records
+     * @return const T* the pointer to the first record
+     */
+    template <typename T> const T *getSection(int sectionId, size_t &num) const
+    {
+        assert(sectionId >= 0 && sectionId < sectionNum);
+        assert(sectionTable[sectionId * 2 + 1] % sizeof(T) == 0);
+        num = sectionTable[sectionId * 2 + 1] / sizeof(T);
+        return reinterpret_cast<const T *>(mappedData + sectionTable[sectionId * 2]);
+    }
+
+    inline int getSectionNum() const
+    {
+        return sectionNum;
+    }
+
+    inline std::string getString(int32_t strId) const
+    {
+        assert(strId >= 0 && (uint64_t)strId < strNum);
+        return std::string(strChars + strOffsets[strId], strOffsets[strId + 1] - strOffsets[strId]);
+    }
+
+    inline size_t getStringNum() const
+    {
+        return strNum;
+    }
+
+  private:
+    void close();
+
+    const char *mappedData = nullptr;
+    size_t mappedSize = 0;
+    int sectionNum = 0;
+    const uint64_t *sectionTable = nullptr;
+    uint64_t strNum = 0;
+    const uint64_t *strOffsets = nullptr;
+    const char *strChars = nullptr;
+};
+
+#endif
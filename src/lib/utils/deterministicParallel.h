@@ -0,0 +1,105 @@
+/**
+ * @file deterministicParallel.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the helpers which split the parallel work independently of the number of threads
+ * in the deterministic mode, so the floating-point results are the same for any number of threads.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _DETERMINISTICPARALLEL
+#define _DETERMINISTICPARALLEL
+
+#include <algorithm>
+#include <map>
+#include <omp.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief the number of chunks to split the parallel work in the deterministic mode, instead of the number of threads
+ *
+ */
+constexpr int deterministicChunkNum = 64;
+
+/**
+ * @brief check whether the deterministic mode ("Deterministic" in the configuration) is enabled
+ *
+ * @param JSONCfg
+ * @return true if the results should be the same for any number of threads ("jobs")
+ */
+inline bool isDeterministicMode(std::map<std::string, std::string> &JSONCfg)
+{
+    return JSONCfg.find("Deterministic") != JSONCfg.end() && JSONCfg["Deterministic"] == "true";
+}
+
+/**
+ * @brief get the number of chunks to split the items for the threads. The chunks are merged in order so the results
+ * only depend on the number of chunks, which is fixed in the deterministic mode.
+ *
+ * @param itemNum
+ * @param deterministic
+ * @return int
+ */
+inline int getParallelChunkNum(int itemNum, bool deterministic)
+{
+    int chunkNum = deterministic ? deterministicChunkNum : omp_get_max_threads();
+    return std::max(1, std::min(chunkNum, itemNum));
+}
+
+/**
+ * @brief sum up the values of the items in parallel. In the deterministic mode, the items are summed in a fixed
+ * number of contiguous chunks whose partial sums are added in order, otherwise by an OpenMP reduction whose rounding
+ * depends on the number of threads.
+ *
+ * @tparam Func double(int)
+ * @param itemNum
+ * @param getItemValue get the value of an item, which can also update the item since each item is visited once
+ * @param deterministic
+ * @return double
+ */
+template <typename Func> inline double parallelSum(int itemNum, Func getItemValue, bool deterministic)
+{
+    double sum = 0;
+    if (!deterministic)
+    {
+#pragma omp parallel for reduction(+ : sum)
+        for (int i = 0; i < itemNum; i++)
+            sum += getItemValue(i);
+        return sum;
+    }
+
+    int chunkNum = getParallelChunkNum(itemNum, true);
+    std::vector<double> chunkSums(chunkNum, 0);
+#pragma omp parallel for schedule(static, 1)
+    for (int chunkId = 0; chunkId < chunkNum; chunkId++)
+    {
+        int itemBegin = (long long)itemNum * chunkId / chunkNum;
+        int itemEnd = (long long)itemNum * (chunkId + 1) / chunkNum;
+        double chunkSum = 0;
+        for (int i = itemBegin; i < itemEnd; i++)
+            chunkSum += getItemValue(i);
+        chunkSums[chunkId] = chunkSum;
+    }
+    for (int chunkId = 0; chunkId < chunkNum; chunkId++)
+        sum += chunkSums[chunkId];
+    return sum;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+ * @file fixedCapacityVector.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a vector with a fixed capacity and inline storage, which can be
+ * copied without heap allocation.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _FIXEDCAPACITYVECTOR
+#define _FIXEDCAPACITYVECTOR
+
+#include <algorithm>
+#include <array>
+#include <assert.h>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief FixedCapacityVector is a replacement of std::vector<T> for the lists whose sizes are bounded by the hardware,
+ * e.g., the FFs of a control set in a CLB site.
+ *
+ * The elements are stored in an inline std::array with a count, so copying the vector is just a memory copy and it
+ * never allocates memory. Adding an element beyond the capacity is a bug of the caller.
+ *
+ * @tparam T the type of the elements, which should be trivially copyable (e.g., pointers)
+ * @tparam N the capacity
+ */
+template <typename T, unsigned int N> class FixedCapacityVector
+{
+  public:
+    typedef T *iterator;
+    typedef const T *const_iterator;
+
+    inline iterator begin()
+    {
+        return elements.data();
+    }
+
+    inline iterator end()
+    {
+        return elements.data() + num;
+    }
+
+    inline const_iterator begin() const
+    {
+        return elements.data();
+    }
+
+    inline const_iterator end() const
+    {
+        return elements.data() + num;
+    }
+
+    inline size_t size() const
+    {
+        return num;
+    }
+
+    inline bool empty() const
+    {
+        return num == 0;
+    }
+
+    inline void clear()
+    {
+        num = 0;
+    }
+
+    inline const T &operator[](size_t i) const
+    {
+        assert(i < num);
+        return elements[i];
+    }
+
+    inline T &operator[](size_t i)
+    {
+        assert(i < num);
+        return elements[i];
+    }
+
+    inline void push_back(const T &val)
+    {
+        assert(num < N && "FixedCapacityVector is full.");
+        elements[num++] = val;
+    }
+
+    /**
+     * @brief erase the element at the given position and keep the order of the other elements
+     *
+     * @param pos
+     */
+    inline void erase(iterator pos)
+    {
+        assert(pos >= begin() && pos < end());
+        std::copy(pos + 1, end(), pos);
+        num--;
+    }
+
+  private:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "FixedCapacityVector only stores trivially copyable elements.");
+
+    size_t num = 0;
+    std::array<T, N> elements = {};
+};
+
+#endif
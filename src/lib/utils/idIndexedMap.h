@@ -0,0 +1,239 @@
+/**
+ * @file idIndexedMap.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a flat map whose keys are objects with dense ids, e.g.,
+ * PlacementUnits, so the values are stored in a vector indexed by the ids of the keys.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _IDINDEXEDMAP
+#define _IDINDEXEDMAP
+
+#include <assert.h>
+#include <climits>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief IdIndexedMap maps objects with dense ids (obtained by K::getId()) to values. It is a drop-in replacement of
+ * std::map<K *, V> for the frequently-accessed mappings in the placement flow.
+ *
+ * The (key, value) pair of a key is stored in the slot indexed by the id of the key and the key pointer of each slot
+ * indicates whether the slot is valid, so a lookup is just an indexing without any allocation or comparison.
+ * Accessing the existing entries of different keys from multiple threads is safe while inserting new entries is not.
+ * Iteration visits the entries in the order of the ids of the keys.
+ *
+ * If the ids of the keys are renewed, remapIds() should be called before the next lookup.
+ *
+ * @tparam K the type of the keys, which should provide getId()
+ * @tparam V the type of the values
+ */
+template <typename K, typename V> class IdIndexedMap
+{
+  public:
+    IdIndexedMap()
+    {
+    }
+    ~IdIndexedMap()
+    {
+    }
+
+    /**
+     * @brief iterator over the valid entries, which is dereferenced to the (key, value) pair of an entry
+     *
+     */
+    class iterator
+    {
+      public:
+        iterator(IdIndexedMap *map, size_t id) : map(map), id(id)
+        {
+            skipInvalid();
+        }
+
+        inline std::pair<K *, V> &operator*() const
+        {
+            return map->slots[id];
+        }
+
+        inline std::pair<K *, V> *operator->() const
+        {
+            return &map->slots[id];
+        }
+
+        inline iterator &operator++()
+        {
+            id++;
+            skipInvalid();
+            return *this;
+        }
+
+        inline bool operator==(const iterator &anotherIt) const
+        {
+            return id == anotherIt.id;
+        }
+
+        inline bool operator!=(const iterator &anotherIt) const
+        {
+            return id != anotherIt.id;
+        }
+
+      private:
+        inline void skipInvalid()
+        {
+            while (id < map->slots.size() && !map->slots[id].first)
+                id++;
+        }
+
+        IdIndexedMap *map;
+        size_t id;
+    };
+
+    inline iterator begin()
+    {
+        return iterator(this, 0);
+    }
+
+    inline iterator end()
+    {
+        return iterator(this, slots.size());
+    }
+
+    /**
+     * @brief get the value of a key and insert a default value if the key is not in the map
+     *
+     * @param key
+     * @return V&
+     */
+    inline V &operator[](K *key)
+    {
+        size_t id = getIdOf(key);
+        if (id >= slots.size())
+            slots.resize(id + 1, std::pair<K *, V>(nullptr, V()));
+        if (!slots[id].first)
+        {
+            slots[id].first = key;
+            slots[id].second = V();
+            validNum++;
+        }
+        assert(slots[id].first == key && "the ids of the keys are renewed without remapIds().");
+        return slots[id].second;
+    }
+
+    /**
+     * @brief get the value of a key which should be in the map
+     *
+     * @param key
+     * @return V&
+     */
+    inline V &at(K *key)
+    {
+        size_t id = getIdOf(key);
+        assert(id < slots.size() && slots[id].first == key);
+        return slots[id].second;
+    }
+
+    /**
+     * @brief check whether the key is in the map, compatible with std::map::count()
+     *
+     * @param key
+     * @return size_t 1 if the key is in the map, otherwise 0
+     */
+    inline size_t count(K *key) const
+    {
+        size_t id = getIdOf(key);
+        return id < slots.size() && slots[id].first == key;
+    }
+
+    /**
+     * @brief remove a key from the map if it is in the map
+     *
+     * @param key
+     */
+    inline void erase(K *key)
+    {
+        size_t id = getIdOf(key);
+        if (id < slots.size() && slots[id].first == key)
+        {
+            slots[id].first = nullptr;
+            slots[id].second = V();
+            validNum--;
+        }
+    }
+
+    /**
+     * @brief remove all the entries but keep the allocated slots for the later insertions
+     *
+     */
+    inline void clear()
+    {
+        if (!validNum)
+            return;
+        for (auto &slot : slots)
+            slot.first = nullptr;
+        validNum = 0;
+    }
+
+    inline size_t size() const
+    {
+        return validNum;
+    }
+
+    inline bool empty() const
+    {
+        return validNum == 0;
+    }
+
+    /**
+     * @brief move the entries to the slots of the renewed ids of their keys
+     *
+     * The keys in the map should be still alive and their new ids should be unique.
+     *
+     */
+    void remapIds()
+    {
+        std::vector<std::pair<K *, V>> oldSlots;
+        oldSlots.swap(slots);
+        validNum = 0;
+        for (auto &oldSlot : oldSlots)
+        {
+            if (oldSlot.first)
+                operator[](oldSlot.first) = std::move(oldSlot.second);
+        }
+    }
+
+  private:
+    inline size_t getIdOf(K *key) const
+    {
+        assert(key);
+        long long id = (long long)key->getId();
+        assert(id >= 0 && id < INT_MAX && "the key has no valid id.");
+        return id;
+    }
+
+    /**
+     * @brief the (key, value) pair in each slot, whose key is nullptr if the slot is invalid
+     *
+     */
+    std::vector<std::pair<K *, V>> slots;
+    size_t validNum = 0;
+};
+
+#endif
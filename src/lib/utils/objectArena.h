@@ -0,0 +1,154 @@
+/**
+ * @file objectArena.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a typed object arena, which bump-allocates objects of the same
+ * type in slabs and frees them en masse.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _OBJECTARENA
+#define _OBJECTARENA
+
+#include <assert.h>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief ObjectArena allocates the objects of type T one after another in slabs, so the objects created in the order
+ * of their ids are laid out sequentially in memory and iterating them in id order walks the memory sequentially.
+ *
+ * An object can be destroyed individually, but its slot is only reclaimed when the whole arena is cleared. The arena
+ * is not thread-safe and all the objects are destroyed when the arena is destroyed.
+ *
+ * @tparam T the type of the objects
+ */
+template <typename T> class ObjectArena
+{
+  public:
+    /**
+     * @brief Construct a new Object Arena object
+     *
+     * @param slabObjNum the number of objects in each slab
+     */
+    ObjectArena(size_t slabObjNum = 4096) : slabObjNum(slabObjNum)
+    {
+        assert(slabObjNum > 0);
+    }
+
+    ObjectArena(const ObjectArena &) = delete;
+    ObjectArena &operator=(const ObjectArena &) = delete;
+
+    ~ObjectArena()
+    {
+        clear();
+    }
+
+    /**
+     * @brief construct a new object in the arena
+     *
+     * @tparam Args
+     * @param args the arguments of the constructor of T
+     * @return T*
+     */
+    template <typename... Args> T *create(Args &&...args)
+    {
+        if (slabs.empty() || curSlabUsed == slabObjNum)
+        {
+            slabs.emplace_back(new Slot[slabObjNum]);
+            curSlabUsed = 0;
+        }
+        Slot &slot = slabs.back()[curSlabUsed];
+        T *obj = new (slot.storage) T(std::forward<Args>(args)...);
+        slot.alive = true;
+        curSlabUsed++;
+        liveNum++;
+        return obj;
+    }
+
+    /**
+     * @brief destroy an object created by this arena. Its memory is kept until the arena is cleared.
+     *
+     * @param obj
+     */
+    void destroy(T *obj)
+    {
+        Slot *slot = reinterpret_cast<Slot *>(obj);
+        assert(slot->alive && "the object has been destroyed.");
+        obj->~T();
+        slot->alive = false;
+        liveNum--;
+    }
+
+    /**
+     * @brief destroy all the living objects and free all the slabs
+     *
+     */
+    void clear()
+    {
+        for (size_t slabId = 0; slabId < slabs.size(); slabId++)
+        {
+            size_t slotNum = (slabId + 1 == slabs.size()) ? curSlabUsed : slabObjNum;
+            for (size_t slotId = 0; slotId < slotNum; slotId++)
+            {
+                Slot &slot = slabs[slabId][slotId];
+                if (slot.alive)
+                {
+                    reinterpret_cast<T *>(slot.storage)->~T();
+                    slot.alive = false;
+                }
+            }
+        }
+        slabs.clear();
+        curSlabUsed = 0;
+        liveNum = 0;
+    }
+
+    /**
+     * @brief get the number of the objects which are created but not destroyed
+     *
+     * @return size_t
+     */
+    inline size_t getLiveNum() const
+    {
+        return liveNum;
+    }
+
+  private:
+    /**
+     * @brief the storage of an object. The storage is the first member, so a pointer to the object is also a pointer
+     * to its slot.
+     *
+     */
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+        bool alive;
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    size_t slabObjNum;
+    size_t curSlabUsed = 0;
+    size_t liveNum = 0;
+};
+
+#endif
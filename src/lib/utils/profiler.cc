@@ -0,0 +1,312 @@
+/**
+ * @file profiler.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains the built-in hierarchical profiler and its Chrome trace/summary exporters.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "profiler.h"
+#include "strPrint.h"
+#include "sysInfo.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+thread_local Profiler::ThreadRecordHolder Profiler::threadRecordHolder;
+
+namespace
+{
+std::string escapeJSONString(const std::string &str)
+{
+    std::string res;
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            res.push_back('\\');
+        res.push_back(c);
+    }
+    return res;
+}
+} // namespace
+
+Profiler &Profiler::getInstance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+{
+    startTime = std::chrono::steady_clock::now();
+}
+
+Profiler::~Profiler()
+{
+    for (auto record : threadRecords)
+        delete record;
+}
+
+Profiler::ThreadRecordHolder::~ThreadRecordHolder()
+{
+    if (record)
+        Profiler::getInstance().releaseThreadRecord(record);
+}
+
+int Profiler::internName(const char *name)
+{
+    std::lock_guard<std::mutex> lock(profilerLock);
+    auto insertRes = name2Id.emplace(name, (int)names.size());
+    if (insertRes.second)
+        names.push_back(name);
+    return insertRes.first->second;
+}
+
+Profiler::ThreadRecord *Profiler::getThreadRecord()
+{
+    if (threadRecordHolder.record)
+        return threadRecordHolder.record;
+    std::lock_guard<std::mutex> lock(profilerLock);
+    if (freeThreadRecords.size())
+    {
+        threadRecordHolder.record = freeThreadRecords.back();
+        freeThreadRecords.pop_back();
+    }
+    else
+    {
+        threadRecordHolder.record = new ThreadRecord();
+        threadRecordHolder.record->lane = threadRecords.size();
+        threadRecords.push_back(threadRecordHolder.record);
+    }
+    return threadRecordHolder.record;
+}
+
+void Profiler::releaseThreadRecord(ThreadRecord *record)
+{
+    std::lock_guard<std::mutex> lock(profilerLock);
+    // the zones which are not closed by the exited thread are dropped
+    record->openZones.clear();
+    freeThreadRecords.push_back(record);
+}
+
+void Profiler::setEnabled(bool _enabled)
+{
+    if (_enabled)
+    {
+        getThreadRecord()->isMainThread = true;
+        enabled = true;
+        sampleMemory();
+    }
+    else
+    {
+        enabled = false;
+    }
+}
+
+void Profiler::beginZone(const char *name)
+{
+    if (!isEnabled())
+        return;
+    ThreadRecord *record = getThreadRecord();
+    record->openZones.push_back(OpenZone{getNameId(record, name), getTimeNs()});
+    // the memory usage is sampled inside the stages and their direct sub-zones
+    if (record->isMainThread && record->openZones.size() <= 2)
+        sampleMemory();
+}
+
+void Profiler::endZone()
+{
+    ThreadRecord *record = threadRecordHolder.record;
+    if (!record || !record->openZones.size())
+        return;
+    if (record->isMainThread && record->openZones.size() <= 2)
+        sampleMemory();
+    OpenZone &openZone = record->openZones.back();
+    record->zones.push_back(
+        ZoneEvent{openZone.nameId, (int)record->openZones.size() - 1, openZone.beginNs, getTimeNs()});
+    record->openZones.pop_back();
+}
+
+void Profiler::addCounter(const char *name, double delta)
+{
+    if (!isEnabled())
+        return;
+    ThreadRecord *record = getThreadRecord();
+    record->counters.push_back(CounterEvent{getNameId(record, name), getTimeNs(), delta});
+}
+
+void Profiler::sampleMemory()
+{
+    MemoryEvent memoryEvent{getTimeNs(), getCurrentRSS(), getPeakRSS()};
+    std::lock_guard<std::mutex> lock(profilerLock);
+    memoryEvents.push_back(memoryEvent);
+}
+
+void Profiler::dumpChromeTrace(std::string fileName)
+{
+    print_status("Profiler: dumping Chrome trace to: " + fileName);
+    std::lock_guard<std::mutex> lock(profilerLock);
+    std::ofstream outfile0(fileName.c_str());
+    if (!outfile0.is_open())
+    {
+        print_warning("Profiler: failed to open " + fileName);
+        return;
+    }
+
+    // timestamps in Chrome trace are in microseconds
+    outfile0 << std::fixed << std::setprecision(3);
+    outfile0 << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    bool firstEvent = true;
+    auto startEvent = [&]() {
+        if (!firstEvent)
+            outfile0 << ",\n";
+        firstEvent = false;
+    };
+
+    std::vector<CounterEvent> allCounters;
+    for (auto record : threadRecords)
+    {
+        startEvent();
+        outfile0 << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << record->lane
+                 << ", \"args\": {\"name\": \""
+                 << (record->isMainThread ? std::string("main") : "worker " + std::to_string(record->lane))
+                 << "\"}}";
+        for (auto &zone : record->zones)
+        {
+            startEvent();
+            outfile0 << "{\"name\": \"" << escapeJSONString(names[zone.nameId])
+                     << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << record->lane << ", \"ts\": " << zone.beginNs / 1e3
+                     << ", \"dur\": " << (zone.endNs - zone.beginNs) / 1e3 << "}";
+        }
+        allCounters.insert(allCounters.end(), record->counters.begin(), record->counters.end());
+    }
+
+    // counters are shown as their accumulated values over time
+    std::sort(allCounters.begin(), allCounters.end(),
+              [](const CounterEvent &a, const CounterEvent &b) -> bool { return a.timeNs < b.timeNs; });
+    std::vector<double> accumulatedValues(names.size(), 0);
+    for (auto &counter : allCounters)
+    {
+        accumulatedValues[counter.nameId] += counter.delta;
+        startEvent();
+        outfile0 << "{\"name\": \"" << escapeJSONString(names[counter.nameId])
+                 << "\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << counter.timeNs / 1e3 << ", \"args\": {\"value\": "
+                 << accumulatedValues[counter.nameId] << "}}";
+    }
+
+    for (auto &memoryEvent : memoryEvents)
+    {
+        startEvent();
+        outfile0 << "{\"name\": \"memory (MB)\", \"ph\": \"C\", \"pid\": 1, \"ts\": " << memoryEvent.timeNs / 1e3
+                 << ", \"args\": {\"RSS\": " << memoryEvent.currentRSS / 1048576.0
+                 << ", \"peak RSS\": " << memoryEvent.peakRSS / 1048576.0 << "}}";
+    }
+    outfile0 << "\n]}\n";
+    outfile0.close();
+}
+
+void Profiler::dumpSummary(std::string fileName)
+{
+    print_status("Profiler: dumping stage summary to: " + fileName);
+    std::lock_guard<std::mutex> lock(profilerLock);
+    std::ofstream outfile0(fileName.c_str());
+    if (!outfile0.is_open())
+    {
+        print_warning("Profiler: failed to open " + fileName);
+        return;
+    }
+
+    // the top-level zones of the main thread are the stages
+    std::vector<ZoneEvent> stages;
+    for (auto record : threadRecords)
+    {
+        if (!record->isMainThread)
+            continue;
+        for (auto &zone : record->zones)
+        {
+            if (zone.depth == 0)
+                stages.push_back(zone);
+        }
+    }
+    std::sort(stages.begin(), stages.end(),
+              [](const ZoneEvent &a, const ZoneEvent &b) -> bool { return a.beginNs < b.beginNs; });
+
+    outfile0 << std::fixed << std::setprecision(3);
+    outfile0 << std::left << std::setw(32) << "stage" << std::right << std::setw(14) << "wall time(s)"
+             << std::setw(16) << "peak RSS(MB)" << std::setw(16) << "RSS delta(MB)" << "\n";
+    for (auto &stage : stages)
+    {
+        size_t peakRSS = 0, beginRSS = 0, endRSS = 0;
+        int64_t beginSampleTime = -1;
+        for (auto &memoryEvent : memoryEvents)
+        {
+            if (memoryEvent.timeNs < stage.beginNs || memoryEvent.timeNs > stage.endNs)
+                continue;
+            peakRSS = std::max(peakRSS, memoryEvent.peakRSS);
+            if (beginSampleTime < 0)
+            {
+                beginSampleTime = memoryEvent.timeNs;
+                beginRSS = memoryEvent.currentRSS;
+            }
+            endRSS = memoryEvent.currentRSS;
+        }
+        outfile0 << std::left << std::setw(32) << names[stage.nameId] << std::right << std::setw(14)
+                 << (stage.endNs - stage.beginNs) / 1e9 << std::setw(16) << peakRSS / 1048576.0 << std::setw(16)
+                 << ((double)endRSS - (double)beginRSS) / 1048576.0 << "\n";
+    }
+
+    // zones of all the threads and counters are attributed to the stage which is running when they start
+    for (auto &stage : stages)
+    {
+        std::map<std::string, std::pair<double, int>> zoneName2TimeAndCalls;
+        std::map<std::string, double> counterName2Value;
+        for (auto record : threadRecords)
+        {
+            for (auto &zone : record->zones)
+            {
+                if (zone.beginNs < stage.beginNs || zone.beginNs > stage.endNs)
+                    continue;
+                if (record->isMainThread && zone.depth == 0)
+                    continue;
+                auto &timeAndCalls = zoneName2TimeAndCalls[names[zone.nameId]];
+                timeAndCalls.first += (zone.endNs - zone.beginNs) / 1e9;
+                timeAndCalls.second++;
+            }
+            for (auto &counter : record->counters)
+            {
+                if (counter.timeNs >= stage.beginNs && counter.timeNs <= stage.endNs)
+                    counterName2Value[names[counter.nameId]] += counter.delta;
+            }
+        }
+        outfile0 << "\n[" << names[stage.nameId] << "]\n";
+        for (auto &it : zoneName2TimeAndCalls)
+        {
+            outfile0 << "    zone    " << std::left << std::setw(40) << it.first << std::right << std::setw(14)
+                     << it.second.first << "s" << std::setw(10) << it.second.second << " calls\n";
+        }
+        for (auto &it : counterName2Value)
+        {
+            outfile0 << "    counter " << std::left << std::setw(40) << it.first << std::right << std::setw(15)
+                     << std::setprecision(0) << it.second << std::setprecision(3) << "\n";
+        }
+    }
+    outfile0.close();
+}
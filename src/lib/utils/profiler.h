@@ -0,0 +1,255 @@
+/**
+ * @file profiler.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of the built-in hierarchical profiler, which records nested timing
+ * zones, counters and memory usage of the placement stages and exports them as a Chrome trace and a summary table.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _PROFILER
+#define _PROFILER
+
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Profiler records the timing zones, the counters and the memory usage of the placer.
+ *
+ * Each thread records its events into its own ThreadRecord so the hot paths do not contend for locks. The records of
+ * exited threads are recycled for the threads created later, so the short-lived std::threads in the placer do not
+ * produce an unbounded number of lanes in the trace. The top-level zones of the thread enabling the profiler are
+ * regarded as the stages in the summary table.
+ *
+ * The profiler is disabled by default and all the recording functions return immediately when it is disabled.
+ *
+ * The names of zones and counters should be string literals (or other strings that live until the end of the program),
+ * since each thread caches the name ids by the addresses of the names, so recording an event does not need the lock.
+ */
+class Profiler
+{
+  public:
+    static Profiler &getInstance();
+
+    /**
+     * @brief enable/disable the profiler. The thread enabling the profiler is regarded as the main thread.
+     *
+     * @param _enabled
+     */
+    void setEnabled(bool _enabled);
+
+    inline bool isEnabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief open a (nested) timing zone in the current thread
+     *
+     * @param name the zones with the same name are aggregated in the summary table (should be a string literal)
+     */
+    void beginZone(const char *name);
+
+    /**
+     * @brief close the innermost timing zone of the current thread
+     *
+     */
+    void endZone();
+
+    /**
+     * @brief accumulate a counter (e.g., the number of CG iterations)
+     *
+     * @param name should be a string literal
+     * @param delta
+     */
+    void addCounter(const char *name, double delta);
+
+    /**
+     * @brief sample the current resident set size of the process
+     *
+     */
+    void sampleMemory();
+
+    /**
+     * @brief dump the recorded events as a JSON file in Chrome trace event format, which can be loaded by
+     * chrome://tracing or Perfetto
+     *
+     * @param fileName
+     */
+    void dumpChromeTrace(std::string fileName);
+
+    /**
+     * @brief dump a table of the wall time, the peak memory, the time of the zones and the counters of each stage
+     *
+     * @param fileName
+     */
+    void dumpSummary(std::string fileName);
+
+  private:
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
+
+    struct ZoneEvent
+    {
+        int nameId;
+        int depth;
+        int64_t beginNs;
+        int64_t endNs;
+    };
+
+    struct CounterEvent
+    {
+        int nameId;
+        int64_t timeNs;
+        double delta;
+    };
+
+    struct MemoryEvent
+    {
+        int64_t timeNs;
+        size_t currentRSS;
+        size_t peakRSS;
+    };
+
+    struct OpenZone
+    {
+        int nameId;
+        int64_t beginNs;
+    };
+
+    /**
+     * @brief the events recorded by a thread
+     *
+     */
+    struct ThreadRecord
+    {
+        int lane;
+        bool isMainThread = false;
+        std::vector<ZoneEvent> zones;
+        std::vector<CounterEvent> counters;
+        std::vector<OpenZone> openZones;
+
+        /**
+         * @brief the name ids which have been interned by the thread, indexed by the addresses of the names
+         *
+         */
+        std::unordered_map<const char *, int> nameAddr2Id;
+    };
+
+    /**
+     * @brief the holder of the record of a thread, which returns the record to the profiler when the thread exits
+     *
+     */
+    struct ThreadRecordHolder
+    {
+        ThreadRecord *record = nullptr;
+        ~ThreadRecordHolder();
+    };
+
+    inline int64_t getTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime)
+            .count();
+    }
+
+    int internName(const char *name);
+
+    /**
+     * @brief get the id of a name with the cache of the thread, which only interns the name under the lock at the first
+     * time the thread records it
+     *
+     * @param record the record of the current thread
+     * @param name
+     * @return int
+     */
+    inline int getNameId(ThreadRecord *record, const char *name)
+    {
+        auto it = record->nameAddr2Id.find(name);
+        if (it != record->nameAddr2Id.end())
+            return it->second;
+        int nameId = internName(name);
+        record->nameAddr2Id.emplace(name, nameId);
+        return nameId;
+    }
+
+    ThreadRecord *getThreadRecord();
+    void releaseThreadRecord(ThreadRecord *record);
+
+    std::atomic<bool> enabled{false};
+    std::chrono::steady_clock::time_point startTime;
+
+    std::mutex profilerLock;
+    std::unordered_map<std::string, int> name2Id;
+    std::vector<std::string> names;
+    std::vector<ThreadRecord *> threadRecords;
+    std::vector<ThreadRecord *> freeThreadRecords;
+    std::vector<MemoryEvent> memoryEvents;
+
+    static thread_local ThreadRecordHolder threadRecordHolder;
+};
+
+/**
+ * @brief ProfileZone is a scoped timer which opens a profiler zone when it is constructed and closes the zone when it
+ * is destructed.
+ *
+ */
+class ProfileZone
+{
+  public:
+    ProfileZone(const char *name)
+    {
+        Profiler &profiler = Profiler::getInstance();
+        if (profiler.isEnabled())
+        {
+            active = true;
+            profiler.beginZone(name);
+        }
+    }
+    ~ProfileZone()
+    {
+        if (active)
+            Profiler::getInstance().endZone();
+    }
+
+  private:
+    bool active = false;
+};
+
+/**
+ * @brief accumulate a profiler counter if the profiler is enabled
+ *
+ * @param name
+ * @param delta
+ */
+inline void profileCounter(const char *name, double delta)
+{
+    Profiler &profiler = Profiler::getInstance();
+    if (profiler.isEnabled())
+        profiler.addCounter(name, delta);
+}
+
+#endif
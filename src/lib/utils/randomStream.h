@@ -0,0 +1,204 @@
+/**
+ * @file randomStream.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a counter-based random number generator which provides
+ * independent random streams for the parallel tasks without shared state.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _RANDOMSTREAM
+#define _RANDOMSTREAM
+
+#include <assert.h>
+#include <cstdint>
+#include <map>
+#include <string>
+
+/**
+ * @brief RandomStream is a counter-based random number generator: the i-th number of a stream is a hash of the key of
+ * the stream and i, so it does not depend on the numbers drawn by the other streams.
+ *
+ * The key is derived from a global seed (the "RandomSeed" in the configuration) and the id of a stream. A parallel
+ * task should draw random numbers from a stream owned by itself and identified by the task (e.g., a spreading region
+ * or a SA restart) instead of libc random(), which takes a global lock and makes the results depend on the order in
+ * which the threads draw the numbers. Hence, the results are the same for any number of threads.
+ *
+ * It meets the requirements of UniformRandomBitGenerator (32-bit), so it can replace std::mt19937 or boost::mt19937.
+ */
+class RandomStream
+{
+  public:
+    typedef uint32_t result_type;
+
+    /**
+     * @brief the components drawing random numbers. The domain of a stream is folded into its key, so the components
+     * using the same stream ids (e.g., 0) do not replay the same sequence.
+     *
+     */
+    enum StreamDomain
+    {
+        StreamDomain_Default = 0,
+        StreamDomain_SAInitialization,
+        StreamDomain_SAAnnealing,
+        StreamDomain_HypergraphBipartitioner,
+        StreamDomain_ClusterPlacer,
+        StreamDomain_GlobalPlacer,
+        StreamDomain_GeneralSpreader,
+        StreamDomain_CLBLegalizer,
+        StreamDomain_MacroLegalizer,
+        StreamDomain_LongPathUpdate,
+        StreamDomain_PackingCLBSite
+    };
+
+    /**
+     * @brief Construct a new Random Stream object
+     *
+     * @param seed the global seed
+     * @param streamId the id of the stream, e.g., the id of the task using it
+     * @param domain the component using the stream
+     */
+    RandomStream(uint64_t seed = defaultSeed, uint64_t streamId = 0, StreamDomain domain = StreamDomain_Default)
+    {
+        reseed(seed, streamId, domain);
+    }
+
+    /**
+     * @brief restart the stream with the given seed, stream id and domain
+     *
+     * @param seed
+     * @param streamId
+     * @param domain
+     */
+    inline void reseed(uint64_t seed, uint64_t streamId, StreamDomain domain = StreamDomain_Default)
+    {
+        key = mix(mix(seed + (uint64_t)domain * 0x9e3779b97f4a7c15ULL) ^
+                  (streamId * 0xd1b54a32d192ed03ULL + 0x8cb92ba72f3d8dd7ULL));
+        counter = 0;
+    }
+
+    static constexpr result_type min()
+    {
+        return 0;
+    }
+
+    static constexpr result_type max()
+    {
+        return UINT32_MAX;
+    }
+
+    /**
+     * @brief draw a 32-bit random number
+     *
+     * @return result_type
+     */
+    inline result_type operator()()
+    {
+        return next64() >> 32;
+    }
+
+    /**
+     * @brief draw a 64-bit random number
+     *
+     * @return uint64_t
+     */
+    inline uint64_t next64()
+    {
+        counter++;
+        return mix(key + counter * 0x9e3779b97f4a7c15ULL);
+    }
+
+    /**
+     * @brief draw a non-negative random integer in [0, 2^31), a replacement of libc random()
+     *
+     * @return int
+     */
+    inline int randomInt()
+    {
+        return (int)(operator()() >> 1);
+    }
+
+    /**
+     * @brief draw a random integer in [0, n)
+     *
+     * @param n
+     * @return unsigned int
+     */
+    inline unsigned int uniformInt(unsigned int n)
+    {
+        assert(n > 0);
+        return ((uint64_t)operator()() * n) >> 32;
+    }
+
+    /**
+     * @brief draw a random float in [min, max]
+     *
+     * @param min
+     * @param max
+     * @return float
+     */
+    inline float uniformFloat(float min, float max)
+    {
+        return (float)((double)operator()() / UINT32_MAX) * (max - min) + min;
+    }
+
+    /**
+     * @brief skip the following numbers of the stream in O(1)
+     *
+     * @param num the number of random numbers to skip
+     */
+    inline void discard(unsigned long long num)
+    {
+        counter += num;
+    }
+
+    /**
+     * @brief get the global seed from the "RandomSeed" in the configuration, or the default seed if it is not set
+     *
+     * @param JSONCfg
+     * @return uint64_t
+     */
+    static inline uint64_t getSeedFromConfig(std::map<std::string, std::string> &JSONCfg)
+    {
+        if (JSONCfg.find("RandomSeed") != JSONCfg.end())
+            return std::stoull(JSONCfg["RandomSeed"]);
+        return defaultSeed;
+    }
+
+    static constexpr uint64_t defaultSeed = 20213654;
+
+  private:
+    /**
+     * @brief the finalizer of SplitMix64, a bijective hash with good avalanche
+     *
+     * @param z
+     * @return uint64_t
+     */
+    static inline uint64_t mix(uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t key;
+    uint64_t counter;
+};
+
+#endif
@@ -27,6 +27,7 @@
 
 #include <cstdio>
 #include <iostream>
+#include <string>
 
 // create a FILEBUF to read the unzip file pipe
 
@@ -55,4 +56,29 @@ struct FILEbuf : std::streambuf
     char buffer_[s_size];
 };
 
+/**
+ * @brief read the whole content of an archived file into a buffer, so it can be split and parsed by multiple threads
+ *
+ * @param zipFileName
+ * @param content output the decompressed content
+ * @return true if the file is decompressed successfully
+ */
+inline bool readWholeZipFile(const std::string &zipFileName, std::string &content)
+{
+    std::string unzipCmnd = "unzip -p " + zipFileName;
+    FILE *fp = popen(unzipCmnd.c_str(), "r");
+    if (!fp)
+        return false;
+    content.clear();
+    const size_t blockSize = 1 << 22;
+    size_t readSize = 0;
+    do
+    {
+        content.resize(content.size() + blockSize);
+        readSize = fread(&content[content.size() - blockSize], 1, blockSize, fp);
+        content.resize(content.size() - blockSize + readSize);
+    } while (readSize == blockSize);
+    return pclose(fp) == 0;
+}
+
 #endif
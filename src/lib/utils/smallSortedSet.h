@@ -0,0 +1,199 @@
+/**
+ * @file smallSortedSet.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a sorted set with inline storage for a small number of elements,
+ * which can be copied without heap allocation.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _SMALLSORTEDSET
+#define _SMALLSORTEDSET
+
+#include <algorithm>
+#include <assert.h>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief SmallSortedSet is a drop-in replacement of std::set<T, Compare> for the sets which usually hold only a few
+ * elements, e.g., the cells in a CLB site.
+ *
+ * The elements are kept sorted in a flat array, so the iteration order is the same as std::set<T, Compare>. The first N
+ * elements are stored inline and the set moves to a heap buffer only when it grows beyond N, so copying a small set is
+ * just a memory copy. Inserting or erasing an element invalidates the iterators.
+ *
+ * @tparam T the type of the elements, which should be trivially destructible (e.g., pointers or pairs of pointers)
+ * @tparam N the number of elements stored inline
+ * @tparam Compare the strict weak ordering of the elements
+ */
+template <typename T, unsigned int N, typename Compare = std::less<T>> class SmallSortedSet
+{
+  public:
+    typedef const T *const_iterator;
+    typedef const T *iterator;
+
+    SmallSortedSet()
+    {
+    }
+    ~SmallSortedSet()
+    {
+    }
+
+    inline iterator begin() const
+    {
+        return data();
+    }
+
+    inline iterator end() const
+    {
+        return data() + num;
+    }
+
+    inline size_t size() const
+    {
+        return num;
+    }
+
+    inline bool empty() const
+    {
+        return num == 0;
+    }
+
+    inline void clear()
+    {
+        num = 0;
+        heapElements.clear();
+    }
+
+    /**
+     * @brief find an element in the set
+     *
+     * @param val
+     * @return iterator end() if the element is not in the set
+     */
+    inline iterator find(const T &val) const
+    {
+        iterator it = lowerBound(val);
+        if (it != end() && !Compare()(val, *it))
+            return it;
+        return end();
+    }
+
+    inline size_t count(const T &val) const
+    {
+        return find(val) != end();
+    }
+
+    /**
+     * @brief insert an element into the set if it is not in the set
+     *
+     * @param val
+     * @return std::pair<iterator, bool> the iterator of the element and whether it is newly inserted
+     */
+    std::pair<iterator, bool> insert(const T &val)
+    {
+        size_t pos = lowerBound(val) - begin();
+        if (pos < num && !Compare()(val, data()[pos]))
+            return std::pair<iterator, bool>(begin() + pos, false);
+        if (num == N)
+        {
+            // spill to the heap buffer
+            heapElements.assign(inlineElements, inlineElements + N);
+        }
+        if (num >= N)
+        {
+            heapElements.insert(heapElements.begin() + pos, val);
+        }
+        else
+        {
+            std::copy_backward(inlineElements + pos, inlineElements + num, inlineElements + num + 1);
+            inlineElements[pos] = val;
+        }
+        num++;
+        return std::pair<iterator, bool>(begin() + pos, true);
+    }
+
+    template <typename... Args> inline std::pair<iterator, bool> emplace(Args &&...args)
+    {
+        return insert(T(std::forward<Args>(args)...));
+    }
+
+    /**
+     * @brief erase an element from the set if it is in the set
+     *
+     * @param val
+     * @return size_t the number of erased elements
+     */
+    size_t erase(const T &val)
+    {
+        iterator it = find(val);
+        if (it == end())
+            return 0;
+        size_t pos = it - begin();
+        if (num > N)
+        {
+            heapElements.erase(heapElements.begin() + pos);
+            if (num - 1 == N)
+            {
+                std::copy(heapElements.begin(), heapElements.end(), inlineElements);
+                heapElements.clear();
+            }
+        }
+        else
+        {
+            std::copy(inlineElements + pos + 1, inlineElements + num, inlineElements + pos);
+        }
+        num--;
+        return 1;
+    }
+
+  private:
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "SmallSortedSet only stores trivially destructible elements.");
+
+    inline const T *data() const
+    {
+        return num > N ? heapElements.data() : inlineElements;
+    }
+
+    inline iterator lowerBound(const T &val) const
+    {
+        return std::lower_bound(begin(), end(), val, Compare());
+    }
+
+    size_t num = 0;
+
+    /**
+     * @brief the elements when the set has at most N elements
+     *
+     */
+    T inlineElements[N] = {};
+
+    /**
+     * @brief the elements when the set has more than N elements
+     *
+     */
+    std::vector<T> heapElements;
+};
+
+#endif
@@ -0,0 +1,453 @@
+/**
+ * @file spatialGridIndex.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a persistent uniform-grid spatial index which supports the
+ * radius and k-nearest-neighbor queries of points grouped by keys (e.g., cell types or control sets) and the
+ * incremental moves of the points.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _SPATIALGRIDINDEX
+#define _SPATIALGRIDINDEX
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief SpatialGridIndex is a persistent spatial index of points identified by integer ids, which replaces the k-d
+ * trees rebuilt from scratch for the neighbor queries.
+ *
+ * The points are grouped by integer keys (e.g., the cell types or the control sets) and each key owns a uniform grid
+ * sized for its own points. Each bin of the grid keeps the ids of its points in a sorted array, so moving or removing a
+ * point only touches the bins involved and the query results do not depend on the order of the updates.
+ *
+ * The distance between two points is |dx| + y2xRatio * |dy|, the same as kdt::KDTree in the placer. The queries are
+ * const and can be called by multiple threads concurrently, while the updates (insert/move/remove) need exclusive
+ * access.
+ */
+class SpatialGridIndex
+{
+  public:
+    /**
+     * @brief Construct a new Spatial Grid Index object
+     *
+     * @param y2xRatio the weight of the Y distance
+     * @param pointNumPerBin the expected number of points in a bin, used to determine the size of the bins
+     */
+    SpatialGridIndex(float y2xRatio = 1.0, int pointNumPerBin = 4) : y2xRatio(y2xRatio), pointNumPerBin(pointNumPerBin)
+    {
+        assert(y2xRatio > 0);
+        assert(pointNumPerBin > 0);
+    }
+
+    /**
+     * @brief bulk-load the points, replacing all the existing ones. The grid of each key covers the bounding box of its
+     * points, and the points moved out of the bounding box later are kept in the boundary bins.
+     *
+     * @param pointX the X coordinates of the points, indexed by the point ids
+     * @param pointY the Y coordinates of the points, indexed by the point ids
+     * @param pointKey the keys of the points, indexed by the point ids. A negative key excludes the point from the
+     * index. If it is empty, all the points share the key 0.
+     */
+    void build(const std::vector<float> &pointX, const std::vector<float> &pointY,
+               const std::vector<int> &pointKey = std::vector<int>())
+    {
+        assert(pointX.size() == pointY.size());
+        assert(pointKey.empty() || pointKey.size() == pointX.size());
+        int pointNum = pointX.size();
+        X = pointX;
+        Y = pointY;
+        if (pointKey.empty())
+            keys.assign(pointNum, 0);
+        else
+            keys = pointKey;
+        binIds.assign(pointNum, -1);
+
+        int keyNum = 0;
+        for (int id = 0; id < pointNum; id++)
+            keyNum = std::max(keyNum, keys[id] + 1);
+        grids.clear();
+        grids.resize(keyNum);
+
+        // the bounding box and the number of points of each key determine the size of its bins
+        std::vector<int> keyPointNum(keyNum, 0);
+        for (int id = 0; id < pointNum; id++)
+        {
+            if (keys[id] < 0)
+                continue;
+            KeyGrid &grid = grids[keys[id]];
+            if (keyPointNum[keys[id]] == 0)
+            {
+                grid.lowX = grid.highX = X[id];
+                grid.lowY = grid.highY = Y[id];
+            }
+            grid.lowX = std::min(grid.lowX, X[id]);
+            grid.highX = std::max(grid.highX, X[id]);
+            grid.lowY = std::min(grid.lowY, Y[id]);
+            grid.highY = std::max(grid.highY, Y[id]);
+            keyPointNum[keys[id]]++;
+        }
+        for (int key = 0; key < keyNum; key++)
+            initGrid(grids[key], keyPointNum[key]);
+
+        // the ids are visited in ascending order so the bins are sorted without sorting
+        for (int id = 0; id < pointNum; id++)
+        {
+            if (keys[id] < 0)
+                continue;
+            KeyGrid &grid = grids[keys[id]];
+            binIds[id] = getBinId(grid, X[id], Y[id]);
+            grid.bins[binIds[id]].push_back(id);
+        }
+    }
+
+    /**
+     * @brief check whether a point is in the index
+     *
+     * @param id
+     * @return true if the point is in the index
+     */
+    inline bool contains(int id) const
+    {
+        return id >= 0 && id < (int)binIds.size() && binIds[id] >= 0;
+    }
+
+    /**
+     * @brief move a point in the index to a new location
+     *
+     * @param id
+     * @param x
+     * @param y
+     */
+    void move(int id, float x, float y)
+    {
+        assert(contains(id));
+        KeyGrid &grid = grids[keys[id]];
+        X[id] = x;
+        Y[id] = y;
+        int newBinId = getBinId(grid, x, y);
+        if (newBinId == binIds[id])
+            return;
+        eraseFromBin(grid.bins[binIds[id]], id);
+        insertIntoBin(grid.bins[newBinId], id);
+        binIds[id] = newBinId;
+    }
+
+    /**
+     * @brief remove a point from the index
+     *
+     * @param id
+     */
+    void remove(int id)
+    {
+        assert(contains(id));
+        eraseFromBin(grids[keys[id]].bins[binIds[id]], id);
+        binIds[id] = -1;
+    }
+
+    /**
+     * @brief insert a removed point back to the index at a new location with its original key
+     *
+     * @param id
+     * @param x
+     * @param y
+     */
+    void reinsert(int id, float x, float y)
+    {
+        assert(id >= 0 && id < (int)binIds.size() && !contains(id) && keys[id] >= 0);
+        KeyGrid &grid = grids[keys[id]];
+        X[id] = x;
+        Y[id] = y;
+        binIds[id] = getBinId(grid, x, y);
+        insertIntoBin(grid.bins[binIds[id]], id);
+    }
+
+    /**
+     * @brief find the points of a key whose distances to the query location are smaller than the radius
+     *
+     * @param x
+     * @param y
+     * @param radius
+     * @param key
+     * @return std::vector<int> the ids of the points in ascending order
+     */
+    std::vector<int> radiusSearch(float x, float y, double radius, int key = 0) const
+    {
+        std::vector<int> res;
+        if (key < 0 || key >= (int)grids.size() || grids[key].bins.empty())
+            return res;
+        const KeyGrid &grid = grids[key];
+
+        // the bins overlapping the bounding box of the query diamond, where the boundary bins cover the outside
+        int binLowX = clampBinX(grid, std::floor((x - radius - grid.lowX) / grid.binW));
+        int binHighX = clampBinX(grid, std::floor((x + radius - grid.lowX) / grid.binW));
+        int binLowY = clampBinY(grid, std::floor((y - radius / y2xRatio - grid.lowY) / grid.binH));
+        int binHighY = clampBinY(grid, std::floor((y + radius / y2xRatio - grid.lowY) / grid.binH));
+        for (int binY = binLowY; binY <= binHighY; binY++)
+        {
+            for (int binX = binLowX; binX <= binHighX; binX++)
+            {
+                if (getBinDistanceLowerBound(grid, binX, binY, x, y) >= radius)
+                    continue;
+                for (int id : grid.bins[binY * grid.binNumX + binX])
+                {
+                    if (getDistance(id, x, y) < radius)
+                        res.push_back(id);
+                }
+            }
+        }
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+
+    /**
+     * @brief find the k nearest points of a key to the query location
+     *
+     * @param x
+     * @param y
+     * @param k
+     * @param key
+     * @return std::vector<int> the ids of at most k points, sorted by (distance, id) in ascending order
+     */
+    std::vector<int> knnSearch(float x, float y, int k, int key = 0) const
+    {
+        std::vector<int> res;
+        if (k <= 0 || key < 0 || key >= (int)grids.size() || grids[key].bins.empty())
+            return res;
+        const KeyGrid &grid = grids[key];
+
+        // a max-heap of the k best (distance, id) pairs found so far
+        std::vector<std::pair<double, int>> bestPoints;
+        bestPoints.reserve(k + 1);
+        int binId = getBinId(grid, x, y);
+        int centerX = binId % grid.binNumX, centerY = binId / grid.binNumX;
+
+        // visit the rings of bins around the bin of the query location until the unvisited bins cannot be closer
+        for (int ring = 0;; ring++)
+        {
+            int binLowX = centerX - ring, binHighX = centerX + ring;
+            int binLowY = centerY - ring, binHighY = centerY + ring;
+            if (binLowX < 0 && binLowY < 0 && binHighX >= grid.binNumX && binHighY >= grid.binNumY)
+                break;
+            for (int binY = std::max(binLowY, 0); binY <= std::min(binHighY, grid.binNumY - 1); binY++)
+            {
+                bool onRingY = (binY == binLowY || binY == binHighY);
+                for (int binX = std::max(binLowX, 0); binX <= std::min(binHighX, grid.binNumX - 1); binX++)
+                {
+                    if (!onRingY && binX != binLowX && binX != binHighX)
+                        continue;
+                    if ((int)bestPoints.size() == k &&
+                        getBinDistanceLowerBound(grid, binX, binY, x, y) > bestPoints.front().first)
+                        continue;
+                    for (int id : grid.bins[binY * grid.binNumX + binX])
+                    {
+                        std::pair<double, int> candidate(getDistance(id, x, y), id);
+                        if ((int)bestPoints.size() == k && !(candidate < bestPoints.front()))
+                            continue;
+                        bestPoints.push_back(candidate);
+                        std::push_heap(bestPoints.begin(), bestPoints.end());
+                        if ((int)bestPoints.size() > k)
+                        {
+                            std::pop_heap(bestPoints.begin(), bestPoints.end());
+                            bestPoints.pop_back();
+                        }
+                    }
+                }
+            }
+            if ((int)bestPoints.size() == k &&
+                getRingDistanceLowerBound(grid, ring + 1, centerX, centerY, x, y) > bestPoints.front().first)
+                break;
+        }
+
+        std::sort_heap(bestPoints.begin(), bestPoints.end());
+        res.reserve(bestPoints.size());
+        for (auto &bestPoint : bestPoints)
+            res.push_back(bestPoint.second);
+        return res;
+    }
+
+    /**
+     * @brief get the distance between a point in the index and a location
+     *
+     * @param id
+     * @param x
+     * @param y
+     * @return double
+     */
+    inline double getDistance(int id, float x, float y) const
+    {
+        double dist = std::fabs(X[id] - x);
+        dist += y2xRatio * std::fabs(Y[id] - y);
+        return dist;
+    }
+
+  private:
+    /**
+     * @brief the uniform grid of the points sharing a key
+     *
+     */
+    struct KeyGrid
+    {
+        float lowX = 0, highX = 0, lowY = 0, highY = 0;
+        float binW = 1, binH = 1;
+        int binNumX = 0, binNumY = 0;
+
+        /**
+         * @brief the sorted ids of the points in each bin, indexed by binY * binNumX + binX
+         *
+         */
+        std::vector<std::vector<int>> bins;
+    };
+
+    /**
+     * @brief set up the bins of a grid whose bounding box is set, so each bin is expected to hold pointNumPerBin
+     * points and is square under the distance metric
+     *
+     * @param grid
+     * @param pointNum
+     */
+    void initGrid(KeyGrid &grid, int pointNum)
+    {
+        grid.bins.clear();
+        if (pointNum == 0)
+            return;
+        float width = std::max(grid.highX - grid.lowX, 1e-3f);
+        float height = std::max(grid.highY - grid.lowY, 1e-3f);
+        float binW = std::sqrt(width * height * y2xRatio * pointNumPerBin / pointNum);
+        grid.binNumX = std::max(1, std::min(maxBinNumPerAxis, (int)std::ceil(width / binW)));
+        grid.binNumY = std::max(1, std::min(maxBinNumPerAxis, (int)std::ceil(height * y2xRatio / binW)));
+        grid.binW = width / grid.binNumX;
+        grid.binH = height / grid.binNumY;
+        grid.bins.resize(grid.binNumX * grid.binNumY);
+    }
+
+    inline int clampBinX(const KeyGrid &grid, double binX) const
+    {
+        return (int)std::max(0.0, std::min((double)grid.binNumX - 1, binX));
+    }
+
+    inline int clampBinY(const KeyGrid &grid, double binY) const
+    {
+        return (int)std::max(0.0, std::min((double)grid.binNumY - 1, binY));
+    }
+
+    inline int getBinId(const KeyGrid &grid, float x, float y) const
+    {
+        int binX = clampBinX(grid, std::floor(((double)x - grid.lowX) / grid.binW));
+        int binY = clampBinY(grid, std::floor(((double)y - grid.lowY) / grid.binH));
+        return binY * grid.binNumX + binX;
+    }
+
+    /**
+     * @brief get the lower bound of the distance between a location and the points in a bin. The boundary bins extend
+     * to infinity since they also keep the points moved out of the grid.
+     *
+     * @param grid
+     * @param binX
+     * @param binY
+     * @param x
+     * @param y
+     * @return double
+     */
+    inline double getBinDistanceLowerBound(const KeyGrid &grid, int binX, int binY, float x, float y) const
+    {
+        double dx = 0, dy = 0;
+        if (binX > 0)
+            dx = std::max(dx, grid.lowX + (double)binX * grid.binW - x);
+        if (binX < grid.binNumX - 1)
+            dx = std::max(dx, x - (grid.lowX + (double)(binX + 1) * grid.binW));
+        if (binY > 0)
+            dy = std::max(dy, grid.lowY + (double)binY * grid.binH - y);
+        if (binY < grid.binNumY - 1)
+            dy = std::max(dy, y - (grid.lowY + (double)(binY + 1) * grid.binH));
+        return std::max(0.0, dx + y2xRatio * dy - boundSlack);
+    }
+
+    /**
+     * @brief get the lower bound of the distance between a location and the points in the bins on or beyond a ring
+     * around the center bin
+     *
+     * @param grid
+     * @param ring
+     * @param centerX
+     * @param centerY
+     * @param x
+     * @param y
+     * @return double
+     */
+    inline double getRingDistanceLowerBound(const KeyGrid &grid, int ring, int centerX, int centerY, float x,
+                                            float y) const
+    {
+        const double inf = std::numeric_limits<double>::infinity();
+        // the bins beyond the ring are out of the window [centerX - ring + 1, centerX + ring - 1] in X or Y
+        double lowerBound = inf;
+        if (centerX - ring >= 0)
+            lowerBound = std::min(lowerBound, x - (grid.lowX + (double)(centerX - ring + 1) * grid.binW));
+        if (centerX + ring < grid.binNumX)
+            lowerBound = std::min(lowerBound, grid.lowX + (double)(centerX + ring) * grid.binW - x);
+        if (centerY - ring >= 0)
+            lowerBound = std::min(lowerBound, y2xRatio * (y - (grid.lowY + (double)(centerY - ring + 1) * grid.binH)));
+        if (centerY + ring < grid.binNumY)
+            lowerBound = std::min(lowerBound, y2xRatio * (grid.lowY + (double)(centerY + ring) * grid.binH - y));
+        return std::max(0.0, lowerBound - boundSlack);
+    }
+
+    inline void insertIntoBin(std::vector<int> &bin, int id)
+    {
+        bin.insert(std::lower_bound(bin.begin(), bin.end(), id), id);
+    }
+
+    inline void eraseFromBin(std::vector<int> &bin, int id)
+    {
+        auto it = std::lower_bound(bin.begin(), bin.end(), id);
+        assert(it != bin.end() && *it == id);
+        bin.erase(it);
+    }
+
+    static constexpr int maxBinNumPerAxis = 2048;
+
+    /**
+     * @brief the slack subtracted from the distance lower bounds of the bins, so the rounding errors of the bin
+     * boundaries never prune a point on the boundary
+     *
+     */
+    static constexpr double boundSlack = 1e-6;
+
+    float y2xRatio;
+    int pointNumPerBin;
+
+    std::vector<float> X;
+    std::vector<float> Y;
+    std::vector<int> keys;
+
+    /**
+     * @brief the bin of each point in the grid of its key, or -1 if the point is not in the index
+     *
+     */
+    std::vector<int> binIds;
+
+    std::vector<KeyGrid> grids;
+};
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file stringInterner.cc
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This implementation file contains APIs' implementation of the sharded, arena-backed string interner.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "stringInterner.h"
+#include <algorithm>
+#include <cstring>
+
+std::string_view StringInterner::copyToArena(Shard &shard, std::string_view str)
+{
+    if (shard.curBlockUsed + str.size() > shard.curBlockSize)
+    {
+        // a long string gets a block of its own size
+        shard.curBlockSize = std::max(arenaBlockSize, str.size());
+        shard.arenaBlocks.emplace_back(new char[shard.curBlockSize]);
+        shard.curBlockUsed = 0;
+    }
+    char *dst = shard.arenaBlocks.back().get() + shard.curBlockUsed;
+    if (str.size())
+        memcpy(dst, str.data(), str.size());
+    shard.curBlockUsed += str.size();
+    return std::string_view(dst, str.size());
+}
+
+int32_t StringInterner::intern(int shardId, std::string_view str)
+{
+    assert(!finalized);
+    assert(shardId >= 0 && shardId < (int)shards.size());
+    Shard &shard = shards[shardId];
+    auto findRes = shard.str2LocalId.find(str);
+    int32_t localId;
+    if (findRes == shard.str2LocalId.end())
+    {
+        localId = shard.strs.size();
+        std::string_view strInArena = copyToArena(shard, str);
+        shard.strs.push_back(strInArena);
+        shard.str2LocalId.emplace(strInArena, localId);
+    }
+    else
+    {
+        localId = findRes->second;
+    }
+    assert((int64_t)localId * shards.size() + shardId < INT32_MAX);
+    return localId * shards.size() + shardId;
+}
+
+void StringInterner::finalize()
+{
+    stringNum = 0;
+    for (auto &shard : shards)
+    {
+        shard.base = stringNum;
+        stringNum += shard.strs.size();
+    }
+    assert(stringNum < INT32_MAX);
+    finalized = true;
+}
+
+void StringInterner::exportStringTable(std::vector<uint64_t> &offsets, std::vector<char> &chars) const
+{
+    assert(finalized);
+    offsets.resize(stringNum + 1);
+    offsets[0] = 0;
+    for (auto &shard : shards)
+        for (size_t localId = 0; localId < shard.strs.size(); localId++)
+            offsets[shard.base + localId + 1] = offsets[shard.base + localId] + shard.strs[localId].size();
+    chars.resize(offsets[stringNum]);
+
+    int shardNum = shards.size();
+#pragma omp parallel for schedule(dynamic)
+    for (int shardId = 0; shardId < shardNum; shardId++)
+    {
+        const Shard &shard = shards[shardId];
+        for (size_t localId = 0; localId < shard.strs.size(); localId++)
+        {
+            const std::string_view &str = shard.strs[localId];
+            if (str.size())
+                memcpy(chars.data() + offsets[shard.base + localId], str.data(), str.size());
+        }
+    }
+}
@@ -0,0 +1,153 @@
+/**
+ * @file stringInterner.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definitions of a sharded, arena-backed string interner which allows the
+ * strings parsed by multiple threads to be interned in parallel and mapped to stable dense ids.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _STRINGINTERNER
+#define _STRINGINTERNER
+
+#include <assert.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief StringInterner maps strings to ids with a hash table partitioned into shards by the hash values of the
+ * strings.
+ *
+ * The characters of the interned strings are copied into per-shard arenas whose blocks are never reallocated, so the
+ * keys of the hash tables stay valid. Different shards can be filled by different threads at the same time without
+ * locks. Interning a string gives a provisional id (local id in the shard and the shard id). After all the strings
+ * are interned, finalize() assigns the dense id of each string (shard by shard, in the interning order within each
+ * shard), so the dense ids only depend on the order of the strings in each shard instead of the thread scheduling.
+ */
+class StringInterner
+{
+  public:
+    /**
+     * @brief Construct a new String Interner object
+     *
+     * @param shardNum the number of shards, which should be larger than the number of threads for load balance
+     */
+    StringInterner(int shardNum = 64) : shards(shardNum)
+    {
+        assert(shardNum > 0);
+    }
+    ~StringInterner()
+    {
+    }
+
+    inline int getShardNum() const
+    {
+        return shards.size();
+    }
+
+    /**
+     * @brief get the shard which a string belongs to
+     *
+     * @param str
+     * @return int
+     */
+    inline int getShardId(std::string_view str) const
+    {
+        return (std::hash<std::string_view>()(str) >> 7) % shards.size();
+    }
+
+    /**
+     * @brief intern a string in its shard. It is thread-safe only if the other threads work on other shards.
+     *
+     * @param shardId the shard of the string, i.e., getShardId(str)
+     * @param str
+     * @return int32_t the provisional id of the string, which can be converted to the dense id after finalize()
+     */
+    int32_t intern(int shardId, std::string_view str);
+
+    /**
+     * @brief assign the dense ids of the interned strings. No string can be interned after finalization.
+     *
+     */
+    void finalize();
+
+    /**
+     * @brief convert a provisional id to the dense id in [0, getStringNum())
+     *
+     * @param provisionalId
+     * @return int32_t
+     */
+    inline int32_t getDenseId(int32_t provisionalId) const
+    {
+        assert(finalized);
+        int shardNum = shards.size();
+        return shards[provisionalId % shardNum].base + provisionalId / shardNum;
+    }
+
+    inline size_t getStringNum() const
+    {
+        assert(finalized);
+        return stringNum;
+    }
+
+    /**
+     * @brief export the interned strings in the order of their dense ids as a string table, i.e., the i-th string is
+     * chars[offsets[i], offsets[i+1]).
+     *
+     * @param offsets
+     * @param chars
+     */
+    void exportStringTable(std::vector<uint64_t> &offsets, std::vector<char> &chars) const;
+
+  private:
+    struct Shard
+    {
+        std::unordered_map<std::string_view, int32_t> str2LocalId;
+        std::vector<std::string_view> strs;
+        std::vector<std::unique_ptr<char[]>> arenaBlocks;
+        size_t curBlockUsed = 0;
+        size_t curBlockSize = 0;
+        int32_t base = 0;
+    };
+
+    /**
+     * @brief copy a string into the arena of a shard
+     *
+     * @param shard
+     * @param str
+     * @return std::string_view the view of the copy in the arena
+     */
+    std::string_view copyToArena(Shard &shard, std::string_view str);
+
+    std::vector<Shard> shards;
+    size_t stringNum = 0;
+    bool finalized = false;
+
+    /**
+     * @brief the default size of the arena blocks
+     *
+     */
+    static constexpr size_t arenaBlockSize = 1 << 20;
+};
+
+#endif
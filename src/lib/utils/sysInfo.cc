@@ -24,6 +24,8 @@
 
 #include "sysInfo.h"
 #include <assert.h>
+#include <cstdio>
+#include <sys/resource.h>
 std::string getExePath()
 {
     char result[PATH_MAX];
@@ -32,4 +34,24 @@ std::string getExePath()
     const char *path;
     path = dirname(result);
     return std::string(path);
-}
\ No newline at end of file
+}
+size_t getCurrentRSS()
+{
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp)
+        return 0;
+    long totalPages = 0, residentPages = 0;
+    if (fscanf(fp, "%ld %ld", &totalPages, &residentPages) != 2)
+        residentPages = 0;
+    fclose(fp);
+    return (size_t)residentPages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+size_t getPeakRSS()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    // ru_maxrss is in kilobytes on Linux
+    return (size_t)usage.ru_maxrss * 1024;
+}
@@ -31,4 +31,18 @@
 #include <unistd.h> // readlink
 
 std::string getExePath();
+
+/**
+ * @brief get the current resident set size of the process
+ *
+ * @return size_t in bytes (0 if it cannot be obtained)
+ */
+size_t getCurrentRSS();
+
+/**
+ * @brief get the peak resident set size of the process since it is launched
+ *
+ * @return size_t in bytes (0 if it cannot be obtained)
+ */
+size_t getPeakRSS();
 #endif
\ No newline at end of file
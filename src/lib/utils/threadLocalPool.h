@@ -0,0 +1,99 @@
+/**
+ * @file threadLocalPool.h
+ * @author Tingyuan LIANG (tliang@connect.ust.hk)
+ * @brief This header file contains the definition of a per-thread pool of memory blocks for the objects which are
+ * frequently created and destroyed by multiple threads.
+ * @version 0.1
+ * @date 2021-10-02
+ *
+ * @copyright Copyright (c) 2021 Reconfiguration Computing Systems Lab, The Hong Kong University of Science and
+ * Technology. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _THREADLOCALPOOL
+#define _THREADLOCALPOOL
+
+#include <assert.h>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * @brief ThreadLocalPool keeps the freed memory blocks of objects of type T in a free list of each thread, so the later
+ * allocations of the thread reuse them without calling the global allocator.
+ *
+ * It is used by the class-specific operator new/delete of T. A block can be freed by a thread other than the one
+ * allocating it, and then it joins the free list of the freeing thread. Each block is an independent allocation, so the
+ * blocks in use are not affected when a thread exits and releases its free list.
+ *
+ * @tparam T the type of the objects
+ * @tparam maxFreeNum the maximum number of free blocks kept by each thread
+ */
+template <typename T, unsigned int maxFreeNum = 4096> class ThreadLocalPool
+{
+  public:
+    /**
+     * @brief allocate a block for an object of type T
+     *
+     * @param size the size requested by operator new, which should be sizeof(T)
+     * @return void*
+     */
+    static inline void *allocate(size_t size)
+    {
+        assert(size == sizeof(T) && "ThreadLocalPool does not support the derived classes.");
+        FreeList &freeList = getFreeList();
+        if (freeList.blocks.empty())
+            return ::operator new(sizeof(T));
+        void *block = freeList.blocks.back();
+        freeList.blocks.pop_back();
+        return block;
+    }
+
+    /**
+     * @brief return a block to the free list of the current thread
+     *
+     * @param block
+     */
+    static inline void deallocate(void *block)
+    {
+        if (!block)
+            return;
+        FreeList &freeList = getFreeList();
+        if (freeList.blocks.size() >= maxFreeNum)
+            ::operator delete(block);
+        else
+            freeList.blocks.push_back(block);
+    }
+
+  private:
+    struct FreeList
+    {
+        std::vector<void *> blocks;
+        ~FreeList()
+        {
+            for (auto block : blocks)
+                ::operator delete(block);
+        }
+    };
+
+    static inline FreeList &getFreeList()
+    {
+        thread_local FreeList freeList;
+        return freeList;
+    }
+};
+
+#endif